@@ -0,0 +1,774 @@
+#include "data/BinnedMatrix.h"
+#include "data/CSVChunkReader.h"
+#include "data/CSVReader.h"
+#include "data/DataFrame.h"
+#include "models/BatchScoring.h"
+#include "models/ElasticNet.h"
+#include "models/GradientBoosting.h"
+#include "models/LatencyBenchmark.h"
+#include "models/LinearRegression.h"
+#include "models/NeuralNetwork.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Headless entry point: fits models and scores files from scripts, without FLTK
+
+namespace {
+
+const char* USAGE =
+    "Usage:\n"
+    "  model_builder_cli train --data FILE --target COLUMN --model TYPE --output MODEL_FILE\n"
+    "                          [--features A,B,...] [--param NAME=VALUE ...] [--separator C]\n"
+    "                          [--binned BINNED_FILE | --stream CHUNK_ROWS]\n"
+    "  model_builder_cli predict --model MODEL_FILE --data FILE [--output FILE]\n"
+    "                            [--threads N] [--chunk-rows N] [--separator C]\n"
+    "  model_builder_cli evaluate --model MODEL_FILE --data FILE [--target COLUMN]\n"
+    "                             [--threads N] [--chunk-rows N] [--separator C]\n"
+    "  model_builder_cli latency --model MODEL_FILE --data FILE [--rows N] [--repeats N]\n"
+    "                            [--separator C]\n"
+    "  model_builder_cli benchmark --model MODEL_FILE --data FILE [--target COLUMN] [--rows N]\n"
+    "                              [--repeats N] [--separator C]\n"
+    "  model_builder_cli benchmark --hidden-layers A,B,... [--rows N] [--features N] [--epochs N]\n"
+    "                              [--threads N,M,...] [--batch-size N]\n"
+    "\n"
+    "Model types: linear_regression, elastic_net, random_forest, gradient_boosting,\n"
+    "xgboost, neural_network. Parameters take the hyperparameter names of the GUI,\n"
+    "e.g. --param n_estimators=200 --param max_depth=4. Predictions are written to\n"
+    "standard output unless --output is given. latency times single-row predictions\n"
+    "on the first --rows rows of the file (default 10000) and prints percentiles in ns.\n"
+    "For the tree models, train --param compact_tolerance=T compacts the fitted model\n"
+    "before saving it, keeping every prediction on the training rows within T.\n"
+    "train --binned streams the file twice instead of loading it, writes its numeric\n"
+    "features as one byte per value to BINNED_FILE and trains a tree model on that.\n"
+    "train --stream trains a neural network reading the file again every epoch,\n"
+    "CHUNK_ROWS rows at a time (sgd or adam, numeric columns, no missing values).\n"
+    "benchmark with --model compares the inference modes of a neural network on the\n"
+    "first --rows rows: throughput, difference from the reference predictions and RMSE.\n"
+    "The int8 mode (train --param inference_mode=int8) stores int8 weights but\n"
+    "multiplies them as int16 pairs, so it is usually slower than folded and less\n"
+    "accurate. benchmark with --hidden-layers times neural network training on\n"
+    "synthetic data in float64, float32 and data-parallel for each thread count\n"
+    "(default: 1 and all cores).\n";
+
+// Thrown for malformed command lines, which print the usage
+class UsageError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Options of one subcommand, "--name value" pairs
+ */
+class Arguments {
+public:
+    Arguments(int argc, char* argv[], int first) {
+        for (int i = first; i < argc; ++i) {
+            std::string name = argv[i];
+            if (name.rfind("--", 0) != 0 || i + 1 >= argc) {
+                throw UsageError("Expected --option value, got '" + name + "'");
+            }
+            values.emplace(name.substr(2), argv[++i]);
+        }
+    }
+
+    bool has(const std::string& name) const { return values.count(name) > 0; }
+
+    std::string get(const std::string& name) const {
+        auto it = values.find(name);
+        if (it == values.end()) {
+            throw UsageError("Missing --" + name);
+        }
+        return it->second;
+    }
+
+    std::string get(const std::string& name, const std::string& fallback) const {
+        return has(name) ? get(name) : fallback;
+    }
+
+    std::vector<std::string> getAll(const std::string& name) const {
+        std::vector<std::string> result;
+        auto range = values.equal_range(name);
+        for (auto it = range.first; it != range.second; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    // Reject options the subcommand does not know, to catch typos
+    void allow(const std::set<std::string>& known) const {
+        for (const auto& entry : values) {
+            if (known.count(entry.first) == 0) {
+                throw UsageError("Unknown option --" + entry.first);
+            }
+        }
+    }
+
+private:
+    std::multimap<std::string, std::string> values;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+char parseSeparator(const Arguments& args) {
+    std::string separator = args.get("separator", ",");
+    if (separator == "\\t" || separator == "tab") {
+        return '\t';
+    }
+    if (separator.size() != 1) {
+        throw UsageError("Separator must be a single character");
+    }
+    return separator[0];
+}
+
+BatchScoring::Options parseScoringOptions(const Arguments& args) {
+    BatchScoring::Options options;
+    options.separator = parseSeparator(args);
+    if (args.has("threads")) {
+        options.threads = std::stoi(args.get("threads"));
+    }
+    if (args.has("chunk-rows")) {
+        long long rows = std::stoll(args.get("chunk-rows"));
+        if (rows <= 0) {
+            throw UsageError("--chunk-rows must be positive");
+        }
+        options.chunkRows = static_cast<size_t>(rows);
+    }
+    return options;
+}
+
+/**
+ * @brief Hyperparameters given with --param, each consumed at most once
+ */
+class Hyperparameters {
+public:
+    explicit Hyperparameters(const std::vector<std::string>& assignments) {
+        for (const auto& assignment : assignments) {
+            size_t equals = assignment.find('=');
+            if (equals == std::string::npos || equals == 0) {
+                throw UsageError("Expected --param NAME=VALUE, got '" + assignment + "'");
+            }
+            values[assignment.substr(0, equals)] = assignment.substr(equals + 1);
+        }
+    }
+
+    int getInt(const std::string& name, int fallback) {
+        return values.count(name) ? std::stoi(take(name)) : fallback;
+    }
+
+    double getDouble(const std::string& name, double fallback) {
+        return values.count(name) ? std::stod(take(name)) : fallback;
+    }
+
+    std::string getString(const std::string& name, const std::string& fallback) {
+        return values.count(name) ? take(name) : fallback;
+    }
+
+    bool getBool(const std::string& name, bool fallback) {
+        return values.count(name) ? take(name) == "true" : fallback;
+    }
+
+    // Fail on parameters the model does not use
+    void checkAllUsed(const std::string& modelType) const {
+        for (const auto& entry : values) {
+            if (used.count(entry.first) == 0) {
+                throw std::invalid_argument("Unknown hyperparameter '" + entry.first + "' for " + modelType);
+            }
+        }
+    }
+
+private:
+    std::unordered_map<std::string, std::string> values;
+    std::set<std::string> used;
+
+    std::string take(const std::string& name) {
+        used.insert(name);
+        return values.at(name);
+    }
+};
+
+/**
+ * @brief Create a model with the GUI's defaults and hyperparameter names
+ */
+std::shared_ptr<Model> createModel(const std::string& type, Hyperparameters& params) {
+    // Accept "Random Forest", "random_forest" and "RandomForest" alike
+    std::string key;
+    for (char c : type) {
+        if (c != ' ' && c != '_' && c != '-') {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+
+    std::shared_ptr<Model> model;
+    if (key == "linearregression" || key == "linear") {
+        model = std::make_shared<LinearRegression>();
+    } else if (key == "elasticnet") {
+        model = std::make_shared<ElasticNet>(params.getDouble("alpha", 0.5), params.getDouble("lambda", 1.0),
+                                             params.getInt("max_iter", 1000), params.getDouble("tol", 0.0001));
+    } else if (key == "randomforest") {
+        int n_estimators = params.getInt("n_estimators", 100);
+        int max_depth = params.getInt("max_depth", 10);
+        int min_samples_split = params.getInt("min_samples_split", 2);
+        int min_samples_leaf = params.getInt("min_samples_leaf", 1);
+        std::string max_features = params.getString("max_features", "auto");
+        bool bootstrap = params.getBool("bootstrap", true);
+        model = std::make_shared<RandomForest>(n_estimators, max_depth, min_samples_split, min_samples_leaf,
+                                               max_features, bootstrap);
+    } else if (key == "gradientboosting") {
+        double learning_rate = params.getDouble("learning_rate", 0.1);
+        int n_estimators = params.getInt("n_estimators", 100);
+        int max_depth = params.getInt("max_depth", 3);
+        int min_samples_split = params.getInt("min_samples_split", 2);
+        int min_samples_leaf = params.getInt("min_samples_leaf", 1);
+        double subsample = params.getDouble("subsample", 1.0);
+        std::string loss = params.getString("loss", "squared_error");
+        auto gb = std::make_shared<GradientBoosting>(learning_rate, n_estimators, max_depth, min_samples_split,
+                                                     min_samples_leaf, subsample, loss);
+        gb->setAlpha(params.getDouble("alpha", 0.9));
+        gb->setHuberDelta(params.getDouble("huber_delta", 1.0));
+        gb->setRandomSeed(params.getInt("random_state", -1));
+        model = gb;
+    } else if (key == "xgboost") {
+        double learning_rate = params.getDouble("learning_rate", 0.1);
+        int max_depth = params.getInt("max_depth", 6);
+        int n_estimators = params.getInt("n_estimators", 100);
+        double subsample = params.getDouble("subsample", 1.0);
+        double colsample_bytree = params.getDouble("colsample_bytree", 1.0);
+        int min_child_weight = params.getInt("min_child_weight", 1);
+        double gamma = params.getDouble("gamma", 0.0);
+        auto xgb = std::make_shared<XGBoost>(learning_rate, max_depth, n_estimators, subsample, colsample_bytree,
+                                             min_child_weight, gamma);
+        xgb->setLambda(params.getDouble("reg_lambda", 1.0));
+        xgb->setAlpha(params.getDouble("reg_alpha", 0.0));
+        std::string objective = params.getString("objective", "squared_error");
+        double huber_slope = params.getDouble("huber_slope", 1.0);
+        double tweedie_variance_power = params.getDouble("tweedie_variance_power", 1.5);
+        xgb->setObjective(objective, huber_slope, tweedie_variance_power);
+        xgb->setNumWorkers(params.getInt("n_workers", 1));
+        xgb->setRandomSeed(params.getInt("random_state", -1));
+        model = xgb;
+    } else if (key == "neuralnetwork") {
+        std::vector<int> hidden_layer_sizes;
+        for (const auto& size : splitList(params.getString("hidden_layer_sizes", "10"))) {
+            hidden_layer_sizes.push_back(std::stoi(size));
+        }
+        std::string activation = params.getString("activation", "relu");
+        double learning_rate = params.getDouble("learning_rate", 0.001);
+        int max_iter = params.getInt("max_iter", 200);
+        int batch_size = params.getInt("batch_size", 32);
+        std::string solver = params.getString("solver", "adam");
+        double alpha = params.getDouble("alpha", 0.0001);
+        auto nn = std::make_shared<NeuralNetwork>(hidden_layer_sizes, activation, learning_rate, max_iter,
+                                                  batch_size, solver, alpha);
+        nn->setPrecision(params.getString("precision", "float64"));
+        nn->setNumThreads(params.getInt("n_threads", 0));
+        nn->setDataParallelThreads(params.getInt("data_parallel_threads", 1));
+        nn->setHogwild(params.getBool("hogwild", false));
+        nn->setRandomSeed(params.getInt("random_state", -1));
+        double validation_fraction = params.getDouble("validation_fraction", 0.0);
+        nn->setEarlyStopping(validation_fraction, params.getInt("n_iter_no_change", 10));
+        std::string lr_schedule = params.getString("lr_schedule", "constant");
+        double lr_factor = params.getDouble("lr_factor", 0.5);
+        nn->setLearningRateSchedule(lr_schedule, lr_factor, params.getInt("lr_step", 10));
+        nn->setInferenceMode(params.getString("inference_mode", "reference"));
+        int n_restarts = params.getInt("n_restarts", 1);
+        nn->setRestarts(n_restarts, params.getString("restart_selection", "best"));
+        model = nn;
+    } else {
+        throw UsageError("Unknown model type '" + type + "'");
+    }
+
+    params.checkAllUsed(type);
+    return model;
+}
+
+void printMetrics(const std::unordered_map<std::string, double>& metrics) {
+    std::map<std::string, double> sorted(metrics.begin(), metrics.end());
+    std::cout.precision(10);
+    for (const auto& entry : sorted) {
+        std::cout << entry.first << ": " << entry.second << std::endl;
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compact a fitted tree model, checking the change on up to 10000 evenly spaced rows of X
+ */
+std::unordered_map<std::string, double> compactTrees(Model& model, const Eigen::MatrixXd& X, double tolerance) {
+    Eigen::Index step = std::max<Eigen::Index>(1, (X.rows() + 9999) / 10000);
+    Eigen::MatrixXd calibrationX((X.rows() + step - 1) / step, X.cols());
+    for (Eigen::Index i = 0; i < calibrationX.rows(); ++i) {
+        calibrationX.row(i) = X.row(i * step);
+    }
+    // Merged leaves may differ by no more than the tolerance either
+    double leafEpsilon = std::min(1e-6, tolerance);
+    if (auto rf = dynamic_cast<RandomForest*>(&model)) {
+        return rf->compact(calibrationX, leafEpsilon, tolerance);
+    }
+    if (auto gb = dynamic_cast<GradientBoosting*>(&model)) {
+        return gb->compact(calibrationX, leafEpsilon, tolerance);
+    }
+    if (auto xgb = dynamic_cast<XGBoost*>(&model)) {
+        return xgb->compact(calibrationX, leafEpsilon, tolerance);
+    }
+    throw std::invalid_argument("compact_tolerance applies to the tree models only, not " + model.getName());
+}
+
+/**
+ * @brief Feature columns of a file that is read in chunks
+ *
+ * Checks the header only: --features if given, otherwise every column but
+ * the target.
+ */
+std::vector<std::string> headerFeatures(const Arguments& args, const std::string& target) {
+    std::string dataPath = args.get("data");
+    CSVChunkReader header(dataPath, parseSeparator(args));
+    const std::vector<std::string>& fileColumns = header.getColumnNames();
+    if (std::find(fileColumns.begin(), fileColumns.end(), target) == fileColumns.end()) {
+        throw std::runtime_error("Target column '" + target + "' not found in " + dataPath);
+    }
+    std::vector<std::string> features;
+    if (args.has("features")) {
+        features = splitList(args.get("features"));
+        for (const auto& name : features) {
+            if (std::find(fileColumns.begin(), fileColumns.end(), name) == fileColumns.end()) {
+                throw std::runtime_error("Feature column '" + name + "' not found in " + dataPath);
+            }
+        }
+    } else {
+        for (const auto& name : fileColumns) {
+            if (name != target) {
+                features.push_back(name);
+            }
+        }
+    }
+    return features;
+}
+
+/**
+ * @brief Train a tree model out of core, on a binned copy of the file
+ *
+ * One streaming pass sketches the bin cuts of the features and a second
+ * writes every row with a target as one byte per feature to the binned
+ * file, which is then loaded, so the raw values are never all in memory.
+ */
+int trainBinned(const Arguments& args, const std::shared_ptr<Model>& model, double compactTolerance) {
+    std::string dataPath = args.get("data");
+    std::string target = args.get("target");
+    std::string binnedPath = args.get("binned");
+    char separator = parseSeparator(args);
+    std::vector<std::string> features = headerFeatures(args, target);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<double>> cuts =
+        BinnedMatrix::computeCutsFromCSV(dataPath, features, BinnedMatrix::MAX_BINS, 65536, 0, separator);
+    size_t rows = BinnedMatrix::writeBinnedCSV(dataPath, features, target, cuts, binnedPath, 65536, separator);
+    Eigen::VectorXd y;
+    BinnedMatrix data = BinnedMatrix::load(binnedPath, y);
+    std::cerr << "Binned " << rows << " rows and " << features.size() << " features to " << binnedPath << " in "
+              << secondsSince(start) << " s" << std::endl;
+
+    std::cerr << "Fitting " << model->getName() << " on " << rows << " binned rows" << std::endl;
+    start = std::chrono::steady_clock::now();
+    bool fitted = false;
+    if (auto rf = std::dynamic_pointer_cast<RandomForest>(model)) {
+        fitted = rf->fitBinned(data, y, features, target);
+    } else if (auto gb = std::dynamic_pointer_cast<GradientBoosting>(model)) {
+        fitted = gb->fitBinned(data, y, features, target);
+    } else if (auto xgb = std::dynamic_pointer_cast<XGBoost>(model)) {
+        fitted = xgb->fitBinned(data, y, features, target);
+    }
+    if (!fitted) {
+        std::cerr << "Error: fitting " << model->getName() << " failed" << std::endl;
+        return 1;
+    }
+    std::cerr << "Fitted in " << secondsSince(start) << " s" << std::endl;
+
+    if (compactTolerance >= 0.0) {
+        // Calibrate on the first rows, the only raw values read back
+        CSVChunkReader reader(dataPath, separator);
+        std::vector<std::vector<double>> chunk;
+        size_t calibrationRows = reader.readChunk(features, 10000, chunk);
+        Eigen::MatrixXd calibrationX(static_cast<Eigen::Index>(calibrationRows),
+                                     static_cast<Eigen::Index>(features.size()));
+        for (size_t c = 0; c < features.size(); ++c) {
+            calibrationX.col(static_cast<Eigen::Index>(c)) =
+                Eigen::Map<const Eigen::VectorXd>(chunk[c].data(), calibrationX.rows());
+        }
+        std::cout << "compaction:" << std::endl;
+        printMetrics(compactTrees(*model, calibrationX, compactTolerance));
+    }
+
+    model->save(args.get("output"));
+    std::cerr << "Saved model to " << args.get("output") << std::endl;
+    printMetrics(model->getStatistics());
+    return 0;
+}
+
+/**
+ * @brief Train a neural network on a file streamed in chunks every epoch
+ *
+ * Only chunkRows rows of the file are in memory at a time; see
+ * NeuralNetwork::fitFromCSV for what the streamed fit leaves out.
+ */
+int trainStreamed(const Arguments& args, NeuralNetwork& network) {
+    std::string dataPath = args.get("data");
+    std::string target = args.get("target");
+    long long chunkRows = std::stoll(args.get("stream"));
+    if (chunkRows <= 0) {
+        throw UsageError("--stream must be a positive number of rows");
+    }
+    std::vector<std::string> features = headerFeatures(args, target);
+
+    std::cerr << "Fitting " << network.getName() << " on " << dataPath << ", streamed in chunks of " << chunkRows
+              << " rows" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    if (!network.fitFromCSV(dataPath, features, target, static_cast<size_t>(chunkRows), parseSeparator(args))) {
+        std::cerr << "Error: fitting " << network.getName() << " failed" << std::endl;
+        return 1;
+    }
+    std::cerr << "Fitted in " << secondsSince(start) << " s" << std::endl;
+
+    network.save(args.get("output"));
+    std::cerr << "Saved model to " << args.get("output") << std::endl;
+    printMetrics(network.getStatistics());
+    return 0;
+}
+
+int train(const Arguments& args) {
+    args.allow({"data", "target", "model", "output", "features", "param", "separator", "binned", "stream"});
+    std::string dataPath = args.get("data");
+    std::string target = args.get("target");
+    std::string outputPath = args.get("output");
+    Hyperparameters params(args.getAll("param"));
+    double compactTolerance = params.getDouble("compact_tolerance", -1.0);
+    std::shared_ptr<Model> model = createModel(args.get("model"), params);
+    bool treeModel = std::dynamic_pointer_cast<RandomForest>(model) ||
+                     std::dynamic_pointer_cast<GradientBoosting>(model) || std::dynamic_pointer_cast<XGBoost>(model);
+    if (compactTolerance >= 0.0 && !treeModel) {
+        throw std::invalid_argument("compact_tolerance applies to the tree models only, not " + model->getName());
+    }
+    if (args.has("binned") && args.has("stream")) {
+        throw UsageError("--binned and --stream cannot be combined");
+    }
+    if (args.has("binned")) {
+        if (!treeModel) {
+            throw std::invalid_argument("--binned applies to the tree models only, not " + model->getName());
+        }
+        return trainBinned(args, model, compactTolerance);
+    }
+    if (args.has("stream")) {
+        auto network = std::dynamic_pointer_cast<NeuralNetwork>(model);
+        if (!network) {
+            throw std::invalid_argument("--stream applies to the neural network only, not " + model->getName());
+        }
+        return trainStreamed(args, *network);
+    }
+
+    CSVReader reader;
+    DataFrame data = reader.readCSV(dataPath, parseSeparator(args));
+    if (!data.hasColumn(target)) {
+        throw std::runtime_error("Target column '" + target + "' not found in " + dataPath);
+    }
+    // Date columns are read as derived _year/_month/_day columns, which the
+    // scoring commands cannot rebuild from the raw file, and only the tree
+    // models split text columns by category instead of reading their codes
+    // as numbers. Such columns are left out of the default features and
+    // refused when named.
+    std::vector<std::string> fileColumns = reader.getColumnNames();
+    auto unusable = [&](const std::string& name) -> std::string {
+        if (std::find(fileColumns.begin(), fileColumns.end(), name) == fileColumns.end()) {
+            return "is derived from a date column; store the date parts as numeric columns to use them";
+        }
+        if (data.isCategorical(name) && !treeModel) {
+            return "is a text column, which " + model->getName() + " would read as numbered categories";
+        }
+        return "";
+    };
+    std::vector<std::string> features;
+    if (args.has("features")) {
+        features = splitList(args.get("features"));
+        for (const auto& name : features) {
+            if (!data.hasColumn(name)) {
+                throw std::runtime_error("Feature column '" + name + "' not found in " + dataPath);
+            }
+            std::string reason = unusable(name);
+            if (!reason.empty()) {
+                throw std::runtime_error("Feature '" + name + "' " + reason);
+            }
+        }
+    } else {
+        for (const auto& name : data.getColumnNames()) {
+            if (name == target) {
+                continue;
+            }
+            std::string reason = unusable(name);
+            if (reason.empty()) {
+                features.push_back(name);
+            } else {
+                std::cerr << "Skipping column '" << name << "': it " << reason << std::endl;
+            }
+        }
+    }
+
+    // Drop rows without a target value; missing inputs are left for the model
+    Eigen::MatrixXd X = data.toMatrix(features);
+    std::vector<double> targetValues = data.getColumn(target);
+    std::vector<Eigen::Index> keptRows;
+    for (size_t i = 0; i < targetValues.size(); ++i) {
+        if (!std::isnan(targetValues[i])) {
+            keptRows.push_back(static_cast<Eigen::Index>(i));
+        }
+    }
+    Eigen::MatrixXd keptX(static_cast<Eigen::Index>(keptRows.size()), X.cols());
+    Eigen::VectorXd y(static_cast<Eigen::Index>(keptRows.size()));
+    for (size_t i = 0; i < keptRows.size(); ++i) {
+        keptX.row(static_cast<Eigen::Index>(i)) = X.row(keptRows[i]);
+        y(static_cast<Eigen::Index>(i)) = targetValues[static_cast<size_t>(keptRows[i])];
+    }
+    if (keptRows.size() < targetValues.size()) {
+        std::cerr << "Dropping " << targetValues.size() - keptRows.size()
+                  << " rows with a missing target value" << std::endl;
+    }
+
+    // Let the tree models split categorical columns by category membership,
+    // and keep the labels of each code so scoring maps labels the same way
+    std::vector<int> categoricalIndices;
+    std::unordered_map<std::string, std::vector<std::string>> categoryLevels;
+    for (size_t i = 0; i < features.size(); ++i) {
+        if (data.isCategorical(features[i])) {
+            categoricalIndices.push_back(static_cast<int>(i));
+            categoryLevels[features[i]] = data.getCategoryLevels(features[i]);
+        }
+    }
+    if (!categoricalIndices.empty()) {
+        if (auto rf = std::dynamic_pointer_cast<RandomForest>(model)) {
+            rf->setCategoricalFeatures(categoricalIndices);
+        } else if (auto gb = std::dynamic_pointer_cast<GradientBoosting>(model)) {
+            gb->setCategoricalFeatures(categoricalIndices);
+        } else if (auto xgb = std::dynamic_pointer_cast<XGBoost>(model)) {
+            xgb->setCategoricalFeatures(categoricalIndices);
+        }
+    }
+    model->setCategoryLevels(categoryLevels);
+
+    std::cerr << "Fitting " << model->getName() << " on " << keptX.rows() << " rows and " << keptX.cols()
+              << " features" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    if (!model->fit(keptX, y, features, target)) {
+        std::cerr << "Error: fitting " << model->getName() << " failed" << std::endl;
+        return 1;
+    }
+    std::cerr << "Fitted in " << secondsSince(start) << " s" << std::endl;
+
+    if (compactTolerance >= 0.0) {
+        std::cout << "compaction:" << std::endl;
+        printMetrics(compactTrees(*model, keptX, compactTolerance));
+    }
+
+    model->save(outputPath);
+    std::cerr << "Saved model to " << outputPath << std::endl;
+    printMetrics(model->getStatistics());
+    return 0;
+}
+
+int predict(const Arguments& args) {
+    args.allow({"model", "data", "output", "threads", "chunk-rows", "separator"});
+    BatchScoring::Options options = parseScoringOptions(args);
+    std::shared_ptr<Model> model = Model::load(args.get("model"));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t rows = BatchScoring::predictFile(*model, args.get("data"), args.get("output", "-"), options);
+    double seconds = secondsSince(start);
+    std::cerr << "Scored " << rows << " rows in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cerr << " (" << static_cast<long long>(rows / seconds) << " rows/s)";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
+
+int evaluate(const Arguments& args) {
+    args.allow({"model", "data", "target", "threads", "chunk-rows", "separator"});
+    BatchScoring::Options options = parseScoringOptions(args);
+    std::shared_ptr<Model> model = Model::load(args.get("model"));
+    printMetrics(BatchScoring::evaluateFile(*model, args.get("data"), args.get("target", ""), options));
+    return 0;
+}
+
+// Reads the given columns of the first maxRows rows of --data
+Eigen::MatrixXd readFirstRows(const Arguments& args, const Model& model, const std::vector<std::string>& columns,
+                              long long maxRows) {
+    CSVChunkReader reader(args.get("data"), parseSeparator(args));
+    reader.setCategoryLevels(model.getCategoryLevels());
+    std::vector<std::vector<double>> chunk;
+    size_t rows = reader.readChunk(columns, static_cast<size_t>(maxRows), chunk);
+    Eigen::MatrixXd X(static_cast<Eigen::Index>(rows), static_cast<Eigen::Index>(columns.size()));
+    for (size_t c = 0; c < columns.size(); ++c) {
+        X.col(static_cast<Eigen::Index>(c)) = Eigen::Map<const Eigen::VectorXd>(chunk[c].data(), X.rows());
+    }
+    return X;
+}
+
+int latency(const Arguments& args) {
+    args.allow({"model", "data", "rows", "repeats", "separator"});
+    std::shared_ptr<Model> model = Model::load(args.get("model"));
+    long long maxRows = args.has("rows") ? std::stoll(args.get("rows")) : 10000;
+    LatencyBenchmark::Options options;
+    if (args.has("repeats")) {
+        options.repeats = std::stoi(args.get("repeats"));
+    }
+    if (maxRows <= 0 || options.repeats <= 0) {
+        throw UsageError("--rows and --repeats must be positive");
+    }
+
+    // Only the model's input columns of the first rows are read
+    Eigen::MatrixXd X = readFirstRows(args, *model, model->getVariableNames(), maxRows);
+
+    std::cout << "model: " << model->getName() << std::endl;
+    printMetrics(LatencyBenchmark::run(*model, X, options));
+    return 0;
+}
+
+/**
+ * @brief Compare a network's inference modes, or time training on synthetic data
+ */
+int benchmark(const Arguments& args) {
+    if (!args.has("model")) {
+        args.allow({"hidden-layers", "rows", "features", "epochs", "threads", "batch-size"});
+        std::vector<int> hiddenLayers;
+        for (const auto& size : splitList(args.get("hidden-layers"))) {
+            hiddenLayers.push_back(std::stoi(size));
+        }
+        int rows = std::stoi(args.get("rows", "20000"));
+        int features = std::stoi(args.get("features", "20"));
+        int epochs = std::stoi(args.get("epochs", "5"));
+        int batchSize = std::stoi(args.get("batch-size", "256"));
+        std::vector<int> threadCounts = {1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))};
+        if (args.has("threads")) {
+            threadCounts.clear();
+            for (const auto& count : splitList(args.get("threads"))) {
+                threadCounts.push_back(std::stoi(count));
+            }
+        }
+        bool positive = rows > 0 && features > 0 && epochs > 0 && batchSize > 0 && !hiddenLayers.empty();
+        for (int size : hiddenLayers) {
+            positive = positive && size > 0;
+        }
+        for (int count : threadCounts) {
+            positive = positive && count > 0;
+        }
+        if (!positive) {
+            throw UsageError("--hidden-layers, --rows, --features, --epochs, --threads and --batch-size "
+                             "must be positive");
+        }
+        threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+        printMetrics(NeuralNetwork::benchmarkTraining(hiddenLayers, rows, features, epochs, threadCounts, batchSize));
+        return 0;
+    }
+
+    args.allow({"model", "data", "target", "rows", "repeats", "separator"});
+    std::shared_ptr<Model> model = Model::load(args.get("model"));
+    auto network = std::dynamic_pointer_cast<NeuralNetwork>(model);
+    if (!network) {
+        throw std::invalid_argument("benchmark --model compares the inference modes of a neural network, not " +
+                                    model->getName());
+    }
+    long long maxRows = args.has("rows") ? std::stoll(args.get("rows")) : 10000;
+    int repeats = args.has("repeats") ? std::stoi(args.get("repeats")) : 3;
+    if (maxRows <= 0 || repeats <= 0) {
+        throw UsageError("--rows and --repeats must be positive");
+    }
+
+    // The target is read when the file has it, for the RMSE of each mode
+    std::vector<std::string> columns = network->getVariableNames();
+    std::string target = args.get("target", network->getTargetName());
+    std::vector<std::string> fileColumns = CSVChunkReader(args.get("data"), parseSeparator(args)).getColumnNames();
+    bool hasTarget = std::find(fileColumns.begin(), fileColumns.end(), target) != fileColumns.end();
+    if (args.has("target") && !hasTarget) {
+        throw std::runtime_error("Target column '" + target + "' not found in " + args.get("data"));
+    }
+    if (hasTarget) {
+        columns.push_back(target);
+    }
+    Eigen::MatrixXd data = readFirstRows(args, *network, columns, maxRows);
+    Eigen::Index nFeatures = static_cast<Eigen::Index>(network->getVariableNames().size());
+    Eigen::VectorXd y;
+    if (hasTarget) {
+        std::vector<Eigen::Index> kept;
+        for (Eigen::Index i = 0; i < data.rows(); ++i) {
+            if (!std::isnan(data(i, nFeatures))) {
+                kept.push_back(i);
+            }
+        }
+        data = Eigen::MatrixXd(data(kept, Eigen::all));
+        y = data.col(nFeatures);
+    }
+
+    std::cout << "model: " << network->getName() << std::endl;
+    std::cout << "rows: " << data.rows() << std::endl;
+    printMetrics(network->benchmarkInference(data.leftCols(nFeatures), y, repeats));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "help") {
+        std::cerr << USAGE;
+        return argc < 2 ? 2 : 0;
+    }
+
+    std::string command = argv[1];
+    try {
+        Arguments args(argc, argv, 2);
+        if (command == "train") {
+            return train(args);
+        }
+        if (command == "predict") {
+            return predict(args);
+        }
+        if (command == "evaluate") {
+            return evaluate(args);
+        }
+        if (command == "latency") {
+            return latency(args);
+        }
+        if (command == "benchmark") {
+            return benchmark(args);
+        }
+        throw UsageError("Unknown command '" + command + "'");
+    } catch (const UsageError& e) {
+        std::cerr << "Error: " << e.what() << "\n\n" << USAGE;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+#include "data/CSVChunkReader.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Seed a generator for one epoch of a shuffled pass
+ *
+ * The state depends only on the seed and the epoch, so a training run can
+ * start at any epoch and still see the same row order as an uninterrupted run.
+ *
+ * @param generator Generator to seed
+ * @param seed Seed of the whole run
+ * @param epoch Zero-based epoch
+ */
+inline void seedEpochGenerator(std::mt19937& generator, std::mt19937::result_type seed, int epoch) {
+    std::seed_seq sequence{seed, static_cast<std::mt19937::result_type>(epoch)};
+    generator.seed(sequence);
+}
+
+/**
+ * @brief Background producer of shuffled mini-batches
+ *
+ * A producer thread draws rows from a Source and gathers them into a ring of
+ * preallocated, contiguous batch buffers while the training loop works on
+ * the batch in front of it. The consumer takes the next full slot with
+ * next() and hands it back with release(); no buffer is allocated after
+ * construction. Each epoch ends with a marker slot whose endOfEpoch flag is
+ * set.
+ *
+ * The loader owns its random generator and only the producer thread uses
+ * it. The generator is reseeded from the seed and the epoch number at the
+ * start of every epoch, so a fixed seed gives the same batches regardless of
+ * timing and of the epoch the loader starts at. Errors raised by the source
+ * are rethrown by next().
+ */
+template <typename Scalar>
+class BatchLoader {
+public:
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    /**
+     * @brief One slot of the ring
+     */
+    struct Batch {
+        Matrix inputs;              // batchRows x features, the first rows entries are valid
+        Vector targets;
+        Vector rowWeights;
+        Eigen::Index rows = 0;
+        bool endOfEpoch = false;    // Marker after the last batch of an epoch
+    };
+
+    /**
+     * @brief Supplier of rows, called only on the producer thread
+     */
+    class Source {
+    public:
+        virtual ~Source() = default;
+
+        /**
+         * @brief Start a new pass over the rows
+         *
+         * @param generator Generator for shuffling
+         */
+        virtual void beginEpoch(std::mt19937& generator) = 0;
+
+        /**
+         * @brief Gather the next rows of the pass into a batch
+         *
+         * @param batch Batch to fill, up to batch.inputs.rows() rows
+         * @param generator Generator for shuffling
+         * @return Eigen::Index Number of rows written, 0 at the end of the pass
+         */
+        virtual Eigen::Index fill(Batch& batch, std::mt19937& generator) = 0;
+    };
+
+    /**
+     * @brief Start producing batches
+     *
+     * @param source Rows to draw from
+     * @param features Number of input columns
+     * @param batchRows Rows per batch
+     * @param epochs Number of the epoch after the last one to produce
+     * @param seed Seed of the shuffling generator
+     * @param depth Number of slots in the ring
+     * @param firstEpoch Zero-based epoch to start at, for resuming a run
+     */
+    BatchLoader(std::unique_ptr<Source> source, Eigen::Index features, Eigen::Index batchRows,
+                int epochs, std::mt19937::result_type seed, size_t depth = 4, int firstEpoch = 0)
+        : source(std::move(source)), seed(seed), slots(std::max<size_t>(depth, 2)),
+          firstEpoch(firstEpoch), epochs(epochs), head(0), tail(0), count(0), finished(false), stopping(false),
+          stalls(0) {
+        for (auto& slot : slots) {
+            slot.inputs.resize(batchRows, features);
+            slot.targets.resize(batchRows);
+            slot.rowWeights.resize(batchRows);
+        }
+        producer = std::thread([this]() { produce(); });
+    }
+
+    ~BatchLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        slotFreed.notify_all();
+        producer.join();
+    }
+
+    BatchLoader(const BatchLoader&) = delete;
+    BatchLoader& operator=(const BatchLoader&) = delete;
+
+    /**
+     * @brief Wait for the next batch
+     *
+     * The batch stays valid until release() is called.
+     *
+     * @return const Batch& Next batch or end-of-epoch marker
+     * @throws std::runtime_error If the source failed or all epochs were consumed
+     */
+    const Batch& next() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (count == 0 && !finished) {
+            ++stalls;
+            slotFilled.wait(lock, [this]() { return count > 0 || finished; });
+        }
+        if (count == 0) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            throw std::runtime_error("Batch loader has no more batches");
+        }
+        return slots[head];
+    }
+
+    /**
+     * @brief Hand the batch returned by next() back to the producer
+     */
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            head = (head + 1) % slots.size();
+            --count;
+        }
+        slotFreed.notify_one();
+    }
+
+    /**
+     * @brief Get the number of times next() had to wait for the producer
+     *
+     * @return size_t Number of waits
+     */
+    size_t getStalls() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stalls;
+    }
+
+private:
+    std::unique_ptr<Source> source;
+    std::mt19937::result_type seed;
+    std::mt19937 generator;
+    std::vector<Batch> slots;
+    int firstEpoch;
+    int epochs;
+    size_t head;                    // Next slot for the consumer
+    size_t tail;                    // Next slot for the producer
+    size_t count;                   // Filled slots
+    bool finished;
+    bool stopping;
+    size_t stalls;
+    std::exception_ptr error;
+    mutable std::mutex mutex;
+    std::condition_variable slotFilled;
+    std::condition_variable slotFreed;
+    std::thread producer;
+
+    /**
+     * @brief Wait for a free slot; false if the loader is shutting down
+     */
+    bool acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [this]() { return count < slots.size() || stopping; });
+        return !stopping;
+    }
+
+    /**
+     * @brief Publish the slot at tail
+     */
+    void publish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tail = (tail + 1) % slots.size();
+            ++count;
+        }
+        slotFilled.notify_one();
+    }
+
+    void produce() {
+        try {
+            for (int epoch = firstEpoch; epoch < epochs; ++epoch) {
+                seedEpochGenerator(generator, seed, epoch);
+                source->beginEpoch(generator);
+                for (;;) {
+                    if (!acquire()) {
+                        return;
+                    }
+                    // Slots between tail and head are not touched by the consumer
+                    Batch& slot = slots[tail];
+                    slot.rows = source->fill(slot, generator);
+                    slot.endOfEpoch = slot.rows == 0;
+                    publish();
+                    if (slot.endOfEpoch) {
+                        break;
+                    }
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        slotFilled.notify_all();
+    }
+};
+
+/**
+ * @brief Batch source over rows held in memory
+ *
+ * Each epoch visits the rows in a random order that depends only on the
+ * generator passed to beginEpoch.
+ */
+template <typename Scalar>
+class MatrixBatchSource : public BatchLoader<Scalar>::Source {
+public:
+    using Batch = typename BatchLoader<Scalar>::Batch;
+
+    /**
+     * @brief Draw batches from matrices owned by the caller
+     *
+     * The matrices must outlive the loader.
+     *
+     * @param X Inputs, one row per sample
+     * @param y Targets
+     * @param sampleWeights Weight of each row
+     */
+    MatrixBatchSource(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, const Eigen::VectorXd& sampleWeights)
+        : X(X), y(y), sampleWeights(sampleWeights), indices(X.rows()), position(0) {
+        std::iota(indices.begin(), indices.end(), 0);
+    }
+
+    void beginEpoch(std::mt19937& generator) override {
+        std::iota(indices.begin(), indices.end(), 0);
+        std::shuffle(indices.begin(), indices.end(), generator);
+        position = 0;
+    }
+
+    Eigen::Index fill(Batch& batch, std::mt19937&) override {
+        Eigen::Index rows = std::min<Eigen::Index>(batch.inputs.rows(), X.rows() - position);
+        const Eigen::Index* rowIndices = indices.data() + position;
+
+        // Gather column by column so both matrices are walked along their storage order
+        for (Eigen::Index c = 0; c < X.cols(); ++c) {
+            const double* column = X.col(c).data();
+            Scalar* target = batch.inputs.col(c).data();
+            for (Eigen::Index r = 0; r < rows; ++r) {
+                target[r] = static_cast<Scalar>(column[rowIndices[r]]);
+            }
+        }
+        for (Eigen::Index r = 0; r < rows; ++r) {
+            batch.targets(r) = static_cast<Scalar>(y(rowIndices[r]));
+            batch.rowWeights(r) = static_cast<Scalar>(sampleWeights(rowIndices[r]));
+        }
+        position += rows;
+        return rows;
+    }
+
+private:
+    const Eigen::MatrixXd& X;
+    const Eigen::VectorXd& y;
+    const Eigen::VectorXd& sampleWeights;
+    std::vector<Eigen::Index> indices;
+    Eigen::Index position;
+};
+
+/**
+ * @brief Batch source streaming rows from a CSV file
+ *
+ * Reads the file a chunk at a time with CSVChunkReader and standardizes the
+ * rows on the way, so only one chunk is held in memory. Rows are shuffled
+ * within each chunk; the order of the chunks follows the file. All rows
+ * have weight 1, and missing values are an error.
+ */
+template <typename Scalar>
+class CSVBatchSource : public BatchLoader<Scalar>::Source {
+public:
+    using Batch = typename BatchLoader<Scalar>::Batch;
+
+    /**
+     * @brief Open a CSV file as a batch source
+     *
+     * @param filePath Path to the CSV file
+     * @param featureColumns Names of the input columns
+     * @param targetColumn Name of the target column
+     * @param featureMeans Mean subtracted from each input column
+     * @param featureStdDevs Divisor of each input column
+     * @param targetMean Mean subtracted from the target
+     * @param targetStdDev Divisor of the target
+     * @param chunkRows Rows read from the file at a time
+     * @param separator Column separator character
+     */
+    CSVBatchSource(const std::string& filePath, const std::vector<std::string>& featureColumns,
+                   const std::string& targetColumn, const Eigen::VectorXd& featureMeans,
+                   const Eigen::VectorXd& featureStdDevs, double targetMean, double targetStdDev,
+                   size_t chunkRows, char separator = ',')
+        : reader(filePath, separator), columns(featureColumns), featureMeans(featureMeans),
+          featureStdDevs(featureStdDevs), targetMean(targetMean), targetStdDev(targetStdDev),
+          chunkRows(std::max<size_t>(chunkRows, 1)), chunkSize(0), position(0) {
+        columns.push_back(targetColumn);
+        order.reserve(this->chunkRows);
+    }
+
+    void beginEpoch(std::mt19937&) override {
+        reader.rewind();
+        chunkSize = 0;
+        position = 0;
+    }
+
+    Eigen::Index fill(Batch& batch, std::mt19937& generator) override {
+        Eigen::Index rows = 0;
+        Eigen::Index features = static_cast<Eigen::Index>(columns.size()) - 1;
+        while (rows < batch.inputs.rows()) {
+            if (position == chunkSize && !readChunk(generator)) {
+                break;
+            }
+            size_t row = order[position++];
+            for (Eigen::Index c = 0; c < features; ++c) {
+                double value = chunk[c][row];
+                if (std::isnan(value)) {
+                    throw std::runtime_error("Missing value in column '" + columns[c] + "'");
+                }
+                batch.inputs(rows, c) = static_cast<Scalar>((value - featureMeans(c)) / featureStdDevs(c));
+            }
+            double target = chunk[features][row];
+            if (std::isnan(target)) {
+                throw std::runtime_error("Missing value in column '" + columns.back() + "'");
+            }
+            batch.targets(rows) = static_cast<Scalar>((target - targetMean) / targetStdDev);
+            batch.rowWeights(rows) = Scalar(1);
+            ++rows;
+        }
+        return rows;
+    }
+
+private:
+    CSVChunkReader reader;
+    std::vector<std::string> columns;     // Input columns followed by the target
+    Eigen::VectorXd featureMeans;
+    Eigen::VectorXd featureStdDevs;
+    double targetMean;
+    double targetStdDev;
+    size_t chunkRows;
+    std::vector<std::vector<double>> chunk;
+    std::vector<size_t> order;
+    size_t chunkSize;
+    size_t position;
+
+    /**
+     * @brief Read and shuffle the next chunk; false at the end of the file
+     */
+    bool readChunk(std::mt19937& generator) {
+        chunkSize = reader.readChunk(columns, chunkRows, chunk);
+        order.resize(chunkSize);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::shuffle(order.begin(), order.end(), generator);
+        position = 0;
+        return chunkSize > 0;
+    }
+};
@@ -0,0 +1,255 @@
+#include "data/BinnedMatrix.h"
+#include "data/QuantileSketch.h"
+#include "data/CSVChunkReader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const char BINNED_FILE_MAGIC[8] = {'M', 'B', 'B', 'I', 'N', '0', '0', '1'};
+
+int resolveThreads(int nThreads) {
+    if (nThreads > 0) {
+        return nThreads;
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void checkMaxBins(int maxBins) {
+    if (maxBins < 2 || maxBins > BinnedMatrix::MAX_BINS) {
+        throw std::invalid_argument("Number of bins must be between 2 and " +
+                                    std::to_string(BinnedMatrix::MAX_BINS));
+    }
+}
+
+/**
+ * @brief Sketch a block of column-major values on worker threads
+ *
+ * Rows [0, nRows) are split into one contiguous range per thread and each
+ * thread updates its own set of sketches.
+ */
+template <typename ValueFn>
+void sketchRows(size_t nRows, size_t nCols, ValueFn value,
+                std::vector<std::vector<QuantileSketch>>& threadSketches) {
+    size_t nThreads = threadSketches.size();
+    size_t rowsPerThread = (nRows + nThreads - 1) / nThreads;
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nThreads; ++t) {
+        size_t begin = t * rowsPerThread;
+        size_t end = std::min(nRows, begin + rowsPerThread);
+        if (begin >= end) {
+            break;
+        }
+        workers.emplace_back([&, t, begin, end]() {
+            auto& sketches = threadSketches[t];
+            for (size_t c = 0; c < nCols; ++c) {
+                for (size_t r = begin; r < end; ++r) {
+                    sketches[c].add(value(r, c));
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::vector<std::vector<double>> mergeCuts(std::vector<std::vector<QuantileSketch>>& threadSketches,
+                                           size_t nCols, int maxBins) {
+    std::vector<std::vector<double>> cuts(nCols);
+    for (size_t c = 0; c < nCols; ++c) {
+        QuantileSketch& merged = threadSketches[0][c];
+        for (size_t t = 1; t < threadSketches.size(); ++t) {
+            merged.merge(threadSketches[t][c]);
+        }
+        cuts[c] = merged.getCutPoints(maxBins);
+    }
+    return cuts;
+}
+
+void writeString(std::ofstream& out, const std::string& value) {
+    uint32_t length = static_cast<uint32_t>(value.size());
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(value.data(), length);
+}
+
+std::string readString(std::ifstream& in) {
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    std::string value(length, '\0');
+    in.read(&value[0], length);
+    return value;
+}
+
+} // namespace
+
+std::vector<std::vector<double>> BinnedMatrix::computeCuts(const Eigen::MatrixXd& X, int maxBins,
+                                                           int nThreads) {
+    checkMaxBins(maxBins);
+
+    size_t nCols = static_cast<size_t>(X.cols());
+    std::vector<std::vector<QuantileSketch>> threadSketches(
+        resolveThreads(nThreads), std::vector<QuantileSketch>(nCols));
+
+    sketchRows(static_cast<size_t>(X.rows()), nCols,
+               [&X](size_t r, size_t c) { return X(r, c); }, threadSketches);
+
+    return mergeCuts(threadSketches, nCols, maxBins);
+}
+
+std::vector<std::vector<double>> BinnedMatrix::computeCutsFromCSV(const std::string& filePath,
+                                                                  const std::vector<std::string>& columns,
+                                                                  int maxBins, size_t chunkRows,
+                                                                  int nThreads, char separator) {
+    checkMaxBins(maxBins);
+
+    CSVChunkReader reader(filePath, separator);
+    size_t nCols = columns.size();
+    std::vector<std::vector<QuantileSketch>> threadSketches(
+        resolveThreads(nThreads), std::vector<QuantileSketch>(nCols));
+
+    std::vector<std::vector<double>> chunk;
+    size_t rowsRead;
+    while ((rowsRead = reader.readChunk(columns, chunkRows, chunk)) > 0) {
+        sketchRows(rowsRead, nCols,
+                   [&chunk](size_t r, size_t c) { return chunk[c][r]; }, threadSketches);
+    }
+
+    return mergeCuts(threadSketches, nCols, maxBins);
+}
+
+BinnedMatrix BinnedMatrix::fromMatrix(const Eigen::MatrixXd& X,
+                                      const std::vector<std::vector<double>>& cuts,
+                                      const std::vector<std::string>& featureNames) {
+    if (cuts.size() != static_cast<size_t>(X.cols())) {
+        throw std::invalid_argument("Number of cut point sets does not match number of features");
+    }
+
+    BinnedMatrix result;
+    result.nRows = static_cast<size_t>(X.rows());
+    result.nCols = static_cast<size_t>(X.cols());
+    result.cuts = cuts;
+    result.featureNames = featureNames;
+    result.bins.resize(result.nRows * result.nCols);
+
+    for (size_t r = 0; r < result.nRows; ++r) {
+        for (size_t c = 0; c < result.nCols; ++c) {
+            result.bins[r * result.nCols + c] = binValue(cuts[c], X(r, c));
+        }
+    }
+    return result;
+}
+
+size_t BinnedMatrix::writeBinnedCSV(const std::string& filePath,
+                                    const std::vector<std::string>& featureColumns,
+                                    const std::string& targetColumn,
+                                    const std::vector<std::vector<double>>& cuts,
+                                    const std::string& outputPath,
+                                    size_t chunkRows, char separator) {
+    if (cuts.size() != featureColumns.size()) {
+        throw std::invalid_argument("Number of cut point sets does not match number of features");
+    }
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + outputPath);
+    }
+
+    // Header; the row count is patched in once the pass is done
+    uint64_t rowCount = 0;
+    uint32_t colCount = static_cast<uint32_t>(featureColumns.size());
+    out.write(BINNED_FILE_MAGIC, sizeof(BINNED_FILE_MAGIC));
+    std::streampos rowCountPos = out.tellp();
+    out.write(reinterpret_cast<const char*>(&rowCount), sizeof(rowCount));
+    out.write(reinterpret_cast<const char*>(&colCount), sizeof(colCount));
+    writeString(out, targetColumn);
+    for (size_t c = 0; c < featureColumns.size(); ++c) {
+        writeString(out, featureColumns[c]);
+        uint32_t cutCount = static_cast<uint32_t>(cuts[c].size());
+        out.write(reinterpret_cast<const char*>(&cutCount), sizeof(cutCount));
+        out.write(reinterpret_cast<const char*>(cuts[c].data()), cutCount * sizeof(double));
+    }
+
+    // Rows: one byte per feature followed by the target value
+    std::vector<std::string> columns = featureColumns;
+    columns.push_back(targetColumn);
+    CSVChunkReader reader(filePath, separator);
+    std::vector<std::vector<double>> chunk;
+    std::vector<char> record(featureColumns.size() + sizeof(double));
+    size_t rowsRead;
+    while ((rowsRead = reader.readChunk(columns, chunkRows, chunk)) > 0) {
+        for (size_t r = 0; r < rowsRead; ++r) {
+            double target = chunk.back()[r];
+            if (std::isnan(target)) {
+                continue;
+            }
+            for (size_t c = 0; c < featureColumns.size(); ++c) {
+                record[c] = static_cast<char>(binValue(cuts[c], chunk[c][r]));
+            }
+            std::memcpy(record.data() + featureColumns.size(), &target, sizeof(double));
+            out.write(record.data(), record.size());
+            ++rowCount;
+        }
+    }
+
+    out.seekp(rowCountPos);
+    out.write(reinterpret_cast<const char*>(&rowCount), sizeof(rowCount));
+    if (!out) {
+        throw std::runtime_error("Error writing binned file: " + outputPath);
+    }
+    return static_cast<size_t>(rowCount);
+}
+
+BinnedMatrix BinnedMatrix::load(const std::string& path, Eigen::VectorXd& target) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    char magic[sizeof(BINNED_FILE_MAGIC)];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, BINNED_FILE_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Not a binned data file: " + path);
+    }
+
+    uint64_t rowCount = 0;
+    uint32_t colCount = 0;
+    in.read(reinterpret_cast<char*>(&rowCount), sizeof(rowCount));
+    in.read(reinterpret_cast<char*>(&colCount), sizeof(colCount));
+
+    BinnedMatrix result;
+    result.nRows = static_cast<size_t>(rowCount);
+    result.nCols = colCount;
+    result.targetName = readString(in);
+    result.cuts.resize(colCount);
+    for (uint32_t c = 0; c < colCount; ++c) {
+        result.featureNames.push_back(readString(in));
+        uint32_t cutCount = 0;
+        in.read(reinterpret_cast<char*>(&cutCount), sizeof(cutCount));
+        result.cuts[c].resize(cutCount);
+        in.read(reinterpret_cast<char*>(result.cuts[c].data()), cutCount * sizeof(double));
+    }
+
+    result.bins.resize(result.nRows * result.nCols);
+    target.resize(static_cast<Eigen::Index>(result.nRows));
+    for (size_t r = 0; r < result.nRows; ++r) {
+        in.read(reinterpret_cast<char*>(result.bins.data() + r * result.nCols), result.nCols);
+        in.read(reinterpret_cast<char*>(&target(r)), sizeof(double));
+    }
+    if (!in) {
+        throw std::runtime_error("Binned data file is truncated: " + path);
+    }
+    return result;
+}
+
+uint8_t BinnedMatrix::binValue(const std::vector<double>& cuts, double value) {
+    if (std::isnan(value)) {
+        return MISSING_BIN;
+    }
+    return static_cast<uint8_t>(std::lower_bound(cuts.begin(), cuts.end(), value) - cuts.begin());
+}
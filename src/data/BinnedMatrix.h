@@ -0,0 +1,175 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <Eigen/Dense>
+
+/**
+ * @brief Feature matrix quantized to 8-bit bin indices
+ *
+ * Histogram-based tree training only needs to know which bin each value falls
+ * into, so the matrix stores one byte per value instead of eight. Feature f
+ * has cut points cuts[f]; a value x goes to bin i when cuts[f][i - 1] < x <= cuts[f][i],
+ * values above the last cut go to the last bin and missing values to MISSING_BIN.
+ * A split after bin i is therefore the raw-value split x <= cuts[f][i], so trees
+ * trained on bins predict on raw data unchanged.
+ *
+ * Cut points come from mergeable quantile sketches, either over an in-memory
+ * matrix or from a streaming pass over a CSV file, and a CSV file can be
+ * binned to disk in one further streaming pass.
+ */
+class BinnedMatrix {
+public:
+    static constexpr uint8_t MISSING_BIN = 255;
+    static constexpr int MAX_BINS = 255;
+
+    BinnedMatrix() = default;
+    ~BinnedMatrix() = default;
+
+    /**
+     * @brief Compute bin cut points for every column of a matrix
+     *
+     * @param X Input matrix
+     * @param maxBins Maximum number of bins per feature (at most MAX_BINS)
+     * @param nThreads Number of worker threads (0 = hardware concurrency)
+     * @return std::vector<std::vector<double>> Cut points per feature
+     */
+    static std::vector<std::vector<double>> computeCuts(const Eigen::MatrixXd& X,
+                                                        int maxBins = MAX_BINS,
+                                                        int nThreads = 0);
+
+    /**
+     * @brief Compute bin cut points from a streaming pass over a CSV file
+     *
+     * The file is read a chunk at a time; each chunk is split across worker
+     * threads that update their own sketches, and the sketches are merged at
+     * the end, so memory use does not depend on the file size.
+     *
+     * @param filePath Path to the CSV file
+     * @param columns Names of the feature columns
+     * @param maxBins Maximum number of bins per feature (at most MAX_BINS)
+     * @param chunkRows Number of rows read per chunk
+     * @param nThreads Number of worker threads (0 = hardware concurrency)
+     * @param separator Column separator character
+     * @return std::vector<std::vector<double>> Cut points per feature
+     */
+    static std::vector<std::vector<double>> computeCutsFromCSV(const std::string& filePath,
+                                                               const std::vector<std::string>& columns,
+                                                               int maxBins = MAX_BINS,
+                                                               size_t chunkRows = 65536,
+                                                               int nThreads = 0,
+                                                               char separator = ',');
+
+    /**
+     * @brief Bin an in-memory matrix
+     *
+     * @param X Input matrix
+     * @param cuts Cut points per feature
+     * @param featureNames Feature names (optional)
+     * @return BinnedMatrix Binned matrix
+     */
+    static BinnedMatrix fromMatrix(const Eigen::MatrixXd& X,
+                                   const std::vector<std::vector<double>>& cuts,
+                                   const std::vector<std::string>& featureNames = {});
+
+    /**
+     * @brief Bin a CSV file to disk in one streaming pass
+     *
+     * Each row is written as one byte per feature followed by the target value.
+     * Rows without a target value are skipped.
+     *
+     * @param filePath Path to the CSV file
+     * @param featureColumns Names of the feature columns
+     * @param targetColumn Name of the target column
+     * @param cuts Cut points per feature
+     * @param outputPath Path of the binned file to write
+     * @param chunkRows Number of rows read per chunk
+     * @param separator Column separator character
+     * @return size_t Number of rows written
+     */
+    static size_t writeBinnedCSV(const std::string& filePath,
+                                 const std::vector<std::string>& featureColumns,
+                                 const std::string& targetColumn,
+                                 const std::vector<std::vector<double>>& cuts,
+                                 const std::string& outputPath,
+                                 size_t chunkRows = 65536,
+                                 char separator = ',');
+
+    /**
+     * @brief Load a binned file written by writeBinnedCSV
+     *
+     * @param path Path of the binned file
+     * @param target Target values (output)
+     * @return BinnedMatrix Binned matrix
+     */
+    static BinnedMatrix load(const std::string& path, Eigen::VectorXd& target);
+
+    /**
+     * @brief Find the bin of a value
+     *
+     * @param cuts Cut points of the feature
+     * @param value Raw value
+     * @return uint8_t Bin index, MISSING_BIN for NaN
+     */
+    static uint8_t binValue(const std::vector<double>& cuts, double value);
+
+    /**
+     * @brief Get the bin of a row and feature
+     *
+     * @param row Row index
+     * @param feature Feature index
+     * @return uint8_t Bin index
+     */
+    uint8_t bin(size_t row, size_t feature) const { return bins[row * nCols + feature]; }
+
+    /**
+     * @brief Get the bins of a row
+     *
+     * @param row Row index
+     * @return const uint8_t* Pointer to the feature bins of the row
+     */
+    const uint8_t* rowBins(size_t row) const { return bins.data() + row * nCols; }
+
+    /**
+     * @brief Get the number of bins of a feature (excluding the missing bin)
+     *
+     * @param feature Feature index
+     * @return int Number of bins
+     */
+    int numBins(size_t feature) const { return static_cast<int>(cuts[feature].size()) + 1; }
+
+    /**
+     * @brief Get the cut points of a feature
+     *
+     * @param feature Feature index
+     * @return const std::vector<double>& Cut points
+     */
+    const std::vector<double>& getCuts(size_t feature) const { return cuts[feature]; }
+
+    /**
+     * @brief Get the feature names
+     *
+     * @return const std::vector<std::string>& Feature names
+     */
+    const std::vector<std::string>& getFeatureNames() const { return featureNames; }
+
+    /**
+     * @brief Get the name of the target column (set when loaded from a binned file)
+     *
+     * @return const std::string& Target name
+     */
+    const std::string& getTargetName() const { return targetName; }
+
+    size_t rows() const { return nRows; }
+    size_t cols() const { return nCols; }
+
+private:
+    size_t nRows = 0;
+    size_t nCols = 0;
+    std::vector<uint8_t> bins;
+    std::vector<std::vector<double>> cuts;
+    std::vector<std::string> featureNames;
+    std::string targetName;
+};
@@ -0,0 +1,232 @@
+#include "data/CSVChunkReader.h"
+#include "data/CSVReader.h"
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <charconv>
+
+namespace {
+
+std::string_view trimmed(std::string_view text) {
+    size_t start = 0;
+    size_t end = text.size();
+    while (start < end && std::isspace(static_cast<unsigned char>(text[start]))) {
+        ++start;
+    }
+    while (end > start && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(start, end - start);
+}
+
+}
+
+CSVChunkReader::CSVChunkReader(const std::string& filePath, char separator, bool hasHeader)
+    : filePath(filePath), separator(separator), hasHeader(hasHeader), lineNumber(0) {
+    file.open(filePath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        throw std::runtime_error("No data found in the file");
+    }
+
+    std::vector<std::string> fields = splitLine(line);
+    if (hasHeader) {
+        columnNames = fields;
+    } else {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            columnNames.push_back("Column" + std::to_string(i + 1));
+        }
+    }
+    rewind();
+}
+
+void CSVChunkReader::setCategoryLevels(const std::unordered_map<std::string, std::vector<std::string>>& levels) {
+    categoryCodes.clear();
+    for (const auto& column : levels) {
+        std::unordered_map<std::string, double>& codes = categoryCodes[column.first];
+        for (size_t code = 0; code < column.second.size(); ++code) {
+            codes.emplace(column.second[code], static_cast<double>(code));
+        }
+    }
+}
+
+const std::unordered_map<std::string, double>* CSVChunkReader::codesOf(const std::string& column) const {
+    auto it = categoryCodes.find(column);
+    return it == categoryCodes.end() ? nullptr : &it->second;
+}
+
+size_t CSVChunkReader::readChunk(const std::vector<std::string>& columns, size_t maxRows,
+                                 std::vector<std::vector<double>>& chunk) {
+    std::vector<size_t> positions = columnPositions(columns);
+    std::vector<const std::unordered_map<std::string, double>*> codes;
+    for (const auto& column : columns) {
+        codes.push_back(codesOf(column));
+    }
+
+    chunk.resize(columns.size());
+    for (auto& column : chunk) {
+        column.clear();
+        column.reserve(maxRows);
+    }
+
+    size_t rowsRead = 0;
+    std::string line;
+    while (rowsRead < maxRows && std::getline(file, line)) {
+        ++lineNumber;
+        std::vector<std::string> fields = splitLine(line);
+
+        // Skip empty lines
+        if (fields.empty() || (fields.size() == 1 && fields[0].empty())) {
+            continue;
+        }
+        if (fields.size() != columnNames.size()) {
+            throw std::runtime_error("Inconsistent number of columns at line " +
+                                     std::to_string(lineNumber) + " of " + filePath);
+        }
+
+        for (size_t c = 0; c < positions.size(); ++c) {
+            chunk[c].push_back(parseField(fields[positions[c]], codes[c], columns[c], lineNumber));
+        }
+        ++rowsRead;
+    }
+
+    return rowsRead;
+}
+
+size_t CSVChunkReader::readLines(size_t maxRows, std::vector<std::string>& lines,
+                                 std::vector<size_t>& lineNumbers) {
+    // Keep the line buffers of the previous call, so their memory is reused
+    if (lines.size() < maxRows) {
+        lines.resize(maxRows);
+    }
+    lineNumbers.resize(maxRows);
+
+    size_t rowsRead = 0;
+    while (rowsRead < maxRows && std::getline(file, lines[rowsRead])) {
+        ++lineNumber;
+        const std::string& line = lines[rowsRead];
+        bool blank = std::all_of(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); });
+        if (blank) {
+            continue;
+        }
+        lineNumbers[rowsRead] = lineNumber;
+        ++rowsRead;
+    }
+
+    lineNumbers.resize(rowsRead);
+    return rowsRead;
+}
+
+std::vector<size_t> CSVChunkReader::columnPositions(const std::vector<std::string>& columns) const {
+    std::vector<size_t> positions;
+    for (const auto& name : columns) {
+        auto it = std::find(columnNames.begin(), columnNames.end(), name);
+        if (it == columnNames.end()) {
+            throw std::out_of_range("Column '" + name + "' not found in " + filePath);
+        }
+        positions.push_back(static_cast<size_t>(it - columnNames.begin()));
+    }
+    return positions;
+}
+
+void CSVChunkReader::parseLines(const std::string* lines, const size_t* lineNumbers, size_t count,
+                                const std::vector<std::string>& columns, const std::vector<size_t>& positions,
+                                double* out, size_t stride) const {
+    std::vector<const std::unordered_map<std::string, double>*> codes;
+    for (const auto& column : columns) {
+        codes.push_back(codesOf(column));
+    }
+
+    // Fields are views into the line, so no strings are built per row
+    std::vector<std::string_view> fields;
+    fields.reserve(columnNames.size());
+    for (size_t r = 0; r < count; ++r) {
+        std::string_view line = lines[r];
+        fields.clear();
+        size_t start = 0;
+        for (size_t stop = line.find(separator); stop != std::string_view::npos;
+             start = stop + 1, stop = line.find(separator, start)) {
+            fields.push_back(trimmed(line.substr(start, stop - start)));
+        }
+        fields.push_back(trimmed(line.substr(start)));
+        if (fields.size() != columnNames.size()) {
+            throw std::runtime_error("Inconsistent number of columns at line " +
+                                     std::to_string(lineNumbers[r]) + " of " + filePath);
+        }
+        for (size_t c = 0; c < positions.size(); ++c) {
+            out[c * stride + r] = parseField(fields[positions[c]], codes[c], columns[c], lineNumbers[r]);
+        }
+    }
+}
+
+void CSVChunkReader::rewind() {
+    file.clear();
+    file.seekg(0, std::ios::beg);
+    lineNumber = 0;
+
+    if (hasHeader) {
+        std::string header;
+        std::getline(file, header);
+        lineNumber = 1;
+    }
+}
+
+double CSVChunkReader::parseField(std::string_view field, const std::unordered_map<std::string, double>* codes,
+                                  const std::string& column, size_t line) const {
+    if (codes) {
+        auto code = codes->find(std::string(field));
+        return code == codes->end() ? std::numeric_limits<double>::quiet_NaN() : code->second;
+    }
+
+    // Plain decimal numbers, the common case, are converted without a copy
+    const char* begin = field.data();
+    const char* end = begin + field.size();
+    const char* digits = begin;
+    if (digits != end && (*digits == '+' || *digits == '-')) {
+        ++digits;
+    }
+    if (digits != end && (std::isdigit(static_cast<unsigned char>(*digits)) || *digits == '.')) {
+        double value;
+        auto result = std::from_chars(*begin == '+' ? begin + 1 : begin, end, value);
+        if (result.ec == std::errc() && result.ptr == end) {
+            return value;
+        }
+    }
+
+    std::string text(field);
+    if (CSVReader::isMissing(text)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (!CSVReader::isNumeric(text)) {
+        throw std::runtime_error("Non-numeric value '" + text + "' in column '" + column +
+                                 "' at line " + std::to_string(line) + " of " + filePath);
+    }
+    return std::stod(text);
+}
+
+std::vector<std::string> CSVChunkReader::splitLine(const std::string& line) const {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(line);
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    if (!line.empty() && line.back() == separator) {
+        fields.push_back("");
+    }
+
+    // Trim whitespace (including carriage returns from Windows line endings)
+    for (auto& value : fields) {
+        auto notSpace = [](unsigned char c) { return !std::isspace(c); };
+        auto start = std::find_if(value.begin(), value.end(), notSpace);
+        auto end = std::find_if(value.rbegin(), value.rend(), notSpace).base();
+        value = (start < end) ? std::string(start, end) : std::string();
+    }
+    return fields;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+
+/**
+ * @brief Streaming reader for numeric CSV files
+ *
+ * Unlike CSVReader, which loads the whole file into a DataFrame, this reader
+ * returns the selected columns a chunk of rows at a time so files larger than
+ * memory can be processed in bounded memory. Missing fields are read as NaN;
+ * any other non-numeric field is an error, except in columns given category
+ * labels with setCategoryLevels, which are read as category codes.
+ */
+class CSVChunkReader {
+public:
+    /**
+     * @brief Open a CSV file for chunked reading
+     *
+     * @param filePath Path to the CSV file
+     * @param separator Column separator character (default: ',')
+     * @param hasHeader Whether the file has a header row (default: true)
+     */
+    explicit CSVChunkReader(const std::string& filePath, char separator = ',', bool hasHeader = true);
+
+    /**
+     * @brief Get the column names of the file
+     *
+     * @return const std::vector<std::string>& Column names
+     */
+    const std::vector<std::string>& getColumnNames() const { return columnNames; }
+
+    /**
+     * @brief Read columns as category labels
+     *
+     * Each field of such a column is looked up in the column's labels and
+     * read as the label's index, the code a model was trained with. Labels
+     * that are not in the list, like missing fields, are read as NaN.
+     * Replaces the labels set before.
+     *
+     * @param levels Category labels indexed by code, per column name
+     */
+    void setCategoryLevels(const std::unordered_map<std::string, std::vector<std::string>>& levels);
+
+    /**
+     * @brief Read the next chunk of rows
+     *
+     * @param columns Names of the columns to return
+     * @param maxRows Maximum number of rows to read
+     * @param chunk Column-major output, chunk[c][r] is row r of columns[c] (resized as needed)
+     * @return size_t Number of rows read, 0 at the end of the file
+     */
+    size_t readChunk(const std::vector<std::string>& columns, size_t maxRows,
+                     std::vector<std::vector<double>>& chunk);
+
+    /**
+     * @brief Read the next rows without parsing them
+     *
+     * Reading is sequential, but parsing is not: the lines returned here can
+     * be split between threads, each calling parseLines on its own range.
+     *
+     * @param maxRows Maximum number of rows to read
+     * @param lines Data lines, empty lines skipped; only the first returned count are valid
+     * @param lineNumbers File line number of each returned line, for error messages
+     * @return size_t Number of rows read, 0 at the end of the file
+     */
+    size_t readLines(size_t maxRows, std::vector<std::string>& lines, std::vector<size_t>& lineNumbers);
+
+    /**
+     * @brief Get the position of each named column in a row
+     *
+     * @param columns Column names
+     * @return std::vector<size_t> Field index of each column
+     * @throws std::out_of_range If a column is not in the file
+     */
+    std::vector<size_t> columnPositions(const std::vector<std::string>& columns) const;
+
+    /**
+     * @brief Parse lines returned by readLines
+     *
+     * Safe to call concurrently on disjoint output ranges.
+     *
+     * @param lines First line to parse
+     * @param lineNumbers File line number of each line
+     * @param count Number of lines
+     * @param columns Names of the columns to return, for error messages
+     * @param positions Field index of each column, from columnPositions
+     * @param out Column-major output, out[c * stride + r] is line r of columns[c]
+     * @param stride Distance between the columns of out
+     * @throws std::runtime_error If a line has the wrong number of fields or a non-numeric value
+     */
+    void parseLines(const std::string* lines, const size_t* lineNumbers, size_t count,
+                    const std::vector<std::string>& columns, const std::vector<size_t>& positions,
+                    double* out, size_t stride) const;
+
+    /**
+     * @brief Go back to the first data row
+     */
+    void rewind();
+
+private:
+    std::ifstream file;
+    std::string filePath;
+    char separator;
+    bool hasHeader;
+    std::vector<std::string> columnNames;
+    size_t lineNumber;
+    std::unordered_map<std::string, std::unordered_map<std::string, double>> categoryCodes;
+
+    /**
+     * @brief Split a line into trimmed fields
+     *
+     * @param line Line to split
+     * @return std::vector<std::string> Fields
+     */
+    std::vector<std::string> splitLine(const std::string& line) const;
+
+    /**
+     * @brief Get the code of each label of a column, null for a numeric column
+     */
+    const std::unordered_map<std::string, double>* codesOf(const std::string& column) const;
+
+    /**
+     * @brief Convert one trimmed field to a number, NaN if missing
+     *
+     * With codes, the field is a category label and is read as its code,
+     * NaN if it is not one of the labels.
+     */
+    double parseField(std::string_view field, const std::unordered_map<std::string, double>* codes,
+                      const std::string& column, size_t line) const;
+};
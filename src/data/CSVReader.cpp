@@ -7,6 +7,7 @@
 #include <cmath>
 #include <regex>
 #include <map>
+#include <limits>
 
 DataFrame CSVReader::readCSV(const std::string& filePath, char separator, bool hasHeader) {
     // Open the file
@@ -74,9 +75,13 @@ DataFrame CSVReader::readCSV(const std::string& filePath, char separator, bool h
         std::string columnName = columnNames[col];
         bool isDateColumn = false;
         
-        // Check if this might be a date column (check first few rows)
-        size_t checkRows = std::min(rawData.size(), size_t(5));
-        for (size_t i = 0; i < checkRows; ++i) {
+        // Check if this might be a date column (check first few present values)
+        size_t checkedRows = 0;
+        for (size_t i = 0; i < rawData.size() && checkedRows < 5; ++i) {
+            if (isMissing(rawData[i][col])) {
+                continue;
+            }
+            ++checkedRows;
             if (isDateFormat(rawData[i][col])) {
                 isDateColumn = true;
                 break;
@@ -87,28 +92,70 @@ DataFrame CSVReader::readCSV(const std::string& filePath, char separator, bool h
             // Handle date column by extracting year, month, day as separate features
             processDateColumn(df, rawData, col, columnName);
         } else {
-            // Check if column is numeric
+            // Check if column is numeric, ignoring missing values
             bool allNumeric = true;
+            size_t missingCount = 0;
             for (const auto& row : rawData) {
-                if (!isNumeric(row[col])) {
+                if (isMissing(row[col])) {
+                    ++missingCount;
+                } else if (!isNumeric(row[col])) {
                     allNumeric = false;
                     break;
                 }
             }
             
-            // Process numeric column
-            if (allNumeric) {
+            if (allNumeric && missingCount == rawData.size()) {
+                // Skip columns without any values
+                std::cerr << "Warning: Column '" << columnName 
+                          << "' contains no values and will be skipped." << std::endl;
+            } else if (allNumeric) {
+                // Process numeric column, keeping gaps as NaN
                 std::vector<double> columnData;
                 columnData.reserve(rawData.size());
                 
                 for (const auto& row : rawData) {
-                    columnData.push_back(std::stod(row[col]));
+                    if (isMissing(row[col])) {
+                        columnData.push_back(std::numeric_limits<double>::quiet_NaN());
+                    } else {
+                        columnData.push_back(std::stod(row[col]));
+                    }
                 }
                 df.addColumn(columnName, columnData);
+                
+                if (missingCount > 0) {
+                    std::cout << "Info: Column '" << columnName << "' has " << missingCount
+                              << " missing values" << std::endl;
+                }
             } else {
-                // Skip non-numeric, non-date columns with a warning
-                std::cerr << "Warning: Column '" << columnName 
-                          << "' contains non-numeric, non-date values and will be skipped." << std::endl;
+                // Encode text columns as category codes in order of first appearance
+                std::map<std::string, int> codeOf;
+                std::vector<std::string> levels;
+                std::vector<double> codes;
+                codes.reserve(rawData.size());
+                
+                for (const auto& row : rawData) {
+                    if (isMissing(row[col])) {
+                        codes.push_back(std::numeric_limits<double>::quiet_NaN());
+                        continue;
+                    }
+                    auto it = codeOf.find(row[col]);
+                    if (it == codeOf.end()) {
+                        it = codeOf.emplace(row[col], static_cast<int>(levels.size())).first;
+                        levels.push_back(row[col]);
+                    }
+                    codes.push_back(static_cast<double>(it->second));
+                }
+                
+                if (levels.size() <= MAX_CATEGORIES) {
+                    df.addCategoricalColumn(columnName, codes, levels);
+                    std::cout << "Info: Column '" << columnName << "' treated as categorical with "
+                              << levels.size() << " levels" << std::endl;
+                } else {
+                    // Skip free-text columns with a warning
+                    std::cerr << "Warning: Column '" << columnName 
+                              << "' contains non-numeric, non-date values with more than "
+                              << MAX_CATEGORIES << " distinct values and will be skipped." << std::endl;
+                }
             }
         }
     }
@@ -129,6 +176,14 @@ void CSVReader::processDateColumn(DataFrame& df, const std::vector<std::vector<s
     for (size_t row = 0; row < rowCount; ++row) {
         std::string dateStr = rawData[row][colIndex];
         
+        // Missing dates have missing components
+        if (isMissing(dateStr)) {
+            yearValues[row] = std::numeric_limits<double>::quiet_NaN();
+            monthValues[row] = std::numeric_limits<double>::quiet_NaN();
+            dayValues[row] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        
         // Extract year, month, day from the date string
         std::tuple<int, int, int> dateComponents = extractDateComponents(dateStr);
         
@@ -211,20 +266,48 @@ bool CSVReader::isNumeric(const std::string& str) {
         i = 1;
     }
     
-    // Check rest of the string
+    // Check the mantissa
     for (; i < str.length(); ++i) {
         if (std::isdigit(str[i])) {
             hasDigit = true;
         } else if (str[i] == '.' && !hasDecimal) {
             hasDecimal = true;
+        } else if ((str[i] == 'e' || str[i] == 'E') && hasDigit) {
+            break;
         } else {
             return false;
         }
     }
     
+    // Check an optional exponent (e.g. 1.5e-05)
+    if (i < str.length()) {
+        ++i;
+        if (i < str.length() && (str[i] == '+' || str[i] == '-')) {
+            ++i;
+        }
+        if (i == str.length()) {
+            return false;
+        }
+        for (; i < str.length(); ++i) {
+            if (!std::isdigit(str[i])) {
+                return false;
+            }
+        }
+    }
+    
     return hasDigit;
 }
 
+bool CSVReader::isMissing(const std::string& str) {
+    static const char* missingTokens[] = {"", "NA", "N/A", "NaN", "nan", "NAN", "null", "NULL", "?"};
+    for (const char* token : missingTokens) {
+        if (str == token) {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::vector<std::string> CSVReader::split(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
     std::string token;
@@ -234,6 +317,11 @@ std::vector<std::string> CSVReader::split(const std::string& str, char delimiter
         tokens.push_back(token);
     }
     
+    // A trailing delimiter means the last field is empty
+    if (!str.empty() && str.back() == delimiter) {
+        tokens.push_back("");
+    }
+    
     return tokens;
 }
 
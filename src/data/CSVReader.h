@@ -44,6 +44,23 @@ public:
      */
     static bool isNumeric(const std::string& str);
 
+    /**
+     * @brief Check if a string denotes a missing value
+     * 
+     * Empty fields and the usual placeholders (NA, N/A, NaN, null, ?) are
+     * treated as missing and read as NaN.
+     * 
+     * @param str String to check
+     * @return true If the string denotes a missing value
+     * @return false Otherwise
+     */
+    static bool isMissing(const std::string& str);
+
+    /**
+     * @brief Maximum number of distinct values for a text column to be read as categorical
+     */
+    static constexpr size_t MAX_CATEGORIES = 256;
+
 private:
     std::vector<std::string> columnNames;
     
@@ -31,6 +31,24 @@ std::vector<double> DataFrame::getColumn(const std::string& name) const {
     return it->second;
 }
 
+void DataFrame::addCategoricalColumn(const std::string& name, const std::vector<double>& codes,
+                                     const std::vector<std::string>& levels) {
+    addColumn(name, codes);
+    categoryLevels[name] = levels;
+}
+
+bool DataFrame::isCategorical(const std::string& name) const {
+    return categoryLevels.find(name) != categoryLevels.end();
+}
+
+std::vector<std::string> DataFrame::getCategoryLevels(const std::string& name) const {
+    auto it = categoryLevels.find(name);
+    if (it == categoryLevels.end()) {
+        throw std::out_of_range("Column '" + name + "' is not categorical");
+    }
+    return it->second;
+}
+
 Eigen::MatrixXd DataFrame::toMatrix(const std::vector<std::string>& columnNames) const {
     if (columnNames.empty()) {
         throw std::invalid_argument("No columns specified for matrix conversion");
@@ -38,8 +56,23 @@ Eigen::MatrixXd DataFrame::toMatrix(const std::vector<std::string>& columnNames)
 
     // Create a matrix with rows x columns
     Eigen::MatrixXd matrix(getNumRows(), columnNames.size());
-    
-    // Fill the matrix column by column
+    copyRows(columnNames, 0, matrix);
+    return matrix;
+}
+
+void DataFrame::copyRows(const std::vector<std::string>& columnNames, size_t firstRow,
+                         Eigen::Ref<Eigen::MatrixXd> block) const {
+    if (block.cols() != static_cast<Eigen::Index>(columnNames.size())) {
+        throw std::invalid_argument("Block has " + std::to_string(block.cols()) + " columns for " +
+                                    std::to_string(columnNames.size()) + " names");
+    }
+    size_t nRows = static_cast<size_t>(block.rows());
+    if (firstRow + nRows > getNumRows()) {
+        throw std::out_of_range("Rows " + std::to_string(firstRow) + " to " + std::to_string(firstRow + nRows) +
+                                " exceed the " + std::to_string(getNumRows()) + " rows of the DataFrame");
+    }
+
+    // Fill the block column by column
     for (size_t col = 0; col < columnNames.size(); ++col) {
         const auto& name = columnNames[col];
         auto it = data.find(name);
@@ -47,13 +80,10 @@ Eigen::MatrixXd DataFrame::toMatrix(const std::vector<std::string>& columnNames)
             throw std::out_of_range("Column '" + name + "' not found in DataFrame");
         }
 
-        const auto& columnData = it->second;
-        for (size_t row = 0; row < getNumRows(); ++row) {
-            matrix(row, col) = columnData[row];
-        }
+        const double* columnData = it->second.data() + firstRow;
+        block.col(static_cast<Eigen::Index>(col)) = Eigen::Map<const Eigen::VectorXd>(
+            columnData, static_cast<Eigen::Index>(nRows));
     }
-    
-    return matrix;
 }
 
 std::vector<std::string> DataFrame::getColumnNames() const {
@@ -77,7 +107,12 @@ DataFrame DataFrame::subset(size_t start, size_t end) const {
     for (const auto& name : columnOrder) {
         const auto& fullColumn = data.at(name);
         std::vector<double> subColumn(fullColumn.begin() + start, fullColumn.begin() + end);
-        result.addColumn(name, subColumn);
+        auto levels = categoryLevels.find(name);
+        if (levels != categoryLevels.end()) {
+            result.addCategoricalColumn(name, subColumn, levels->second);
+        } else {
+            result.addColumn(name, subColumn);
+        }
     }
     
     return result;
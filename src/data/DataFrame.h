@@ -32,6 +32,36 @@ public:
      */
     std::vector<double> getColumn(const std::string& name) const;
 
+    /**
+     * @brief Add a categorical column to the data frame
+     * 
+     * The column is stored as integer category codes so it can be used in
+     * matrices like any other column; the code i refers to levels[i].
+     * 
+     * @param name Column name
+     * @param codes Category code of each row
+     * @param levels Category labels indexed by code
+     */
+    void addCategoricalColumn(const std::string& name, const std::vector<double>& codes,
+                              const std::vector<std::string>& levels);
+
+    /**
+     * @brief Check if a column holds category codes
+     * 
+     * @param name Column name
+     * @return true If the column is categorical
+     * @return false If the column is numeric or does not exist
+     */
+    bool isCategorical(const std::string& name) const;
+
+    /**
+     * @brief Get the category labels of a categorical column
+     * 
+     * @param name Column name
+     * @return std::vector<std::string> Category labels indexed by code
+     */
+    std::vector<std::string> getCategoryLevels(const std::string& name) const;
+
     /**
      * @brief Convert multiple columns to an Eigen matrix
      * 
@@ -40,6 +70,20 @@ public:
      */
     Eigen::MatrixXd toMatrix(const std::vector<std::string>& columnNames) const;
 
+    /**
+     * @brief Copy a block of rows of multiple columns into a matrix
+     * 
+     * Fills block.rows() rows starting at firstRow, so a large frame can be
+     * processed a block at a time without converting it with toMatrix.
+     * 
+     * @param columnNames Columns to copy, one per column of block
+     * @param firstRow Index of the first row to copy
+     * @param block Destination, with one column per name
+     * @throws std::out_of_range If a column is missing or the rows run past the end
+     */
+    void copyRows(const std::vector<std::string>& columnNames, size_t firstRow,
+                  Eigen::Ref<Eigen::MatrixXd> block) const;
+
     /**
      * @brief Get all column names
      * 
@@ -115,5 +159,6 @@ public:
 private:
     std::unordered_map<std::string, std::vector<double>> data;
     std::vector<std::string> columnOrder;
+    std::unordered_map<std::string, std::vector<std::string>> categoryLevels;
     size_t rows = 0;
 };
\ No newline at end of file
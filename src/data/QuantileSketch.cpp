@@ -0,0 +1,234 @@
+#include "data/QuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+QuantileSketch::QuantileSketch(size_t maxSize, size_t bufferSize)
+    : maxSize(std::max<size_t>(maxSize, 4)), bufferSize(std::max<size_t>(bufferSize, 1)),
+      missingWeight(0.0) {
+    buffer.reserve(this->bufferSize);
+}
+
+void QuantileSketch::add(double value, double weight) {
+    if (std::isnan(value)) {
+        missingWeight += weight;
+        return;
+    }
+    if (weight <= 0.0) {
+        return;
+    }
+
+    buffer.push_back({value, weight});
+    if (buffer.size() >= bufferSize) {
+        flush();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    // Summaries of the same level cover comparable amounts of data, so they
+    // are carried upwards together to keep the accumulated error logarithmic
+    for (size_t level = 0; level < other.levels.size(); ++level) {
+        if (!other.levels[level].empty()) {
+            insert(other.levels[level], level);
+        }
+    }
+    for (const auto& item : other.buffer) {
+        add(item.first, item.second);
+    }
+    missingWeight += other.missingWeight;
+}
+
+double QuantileSketch::quantile(double q) const {
+    Summary summary = finalSummary();
+    if (summary.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double rank = std::min(std::max(q, 0.0), 1.0) * summary.back().rmax;
+    for (const auto& entry : summary) {
+        if ((entry.rmin + entry.rmax) / 2.0 >= rank) {
+            return entry.value;
+        }
+    }
+    return summary.back().value;
+}
+
+std::vector<double> QuantileSketch::getCutPoints(int maxBins) const {
+    if (maxBins < 2) {
+        throw std::invalid_argument("At least two bins are required");
+    }
+
+    std::vector<double> cuts;
+    Summary summary = finalSummary();
+    if (summary.size() < 2) {
+        return cuts;
+    }
+
+    if (summary.size() <= static_cast<size_t>(maxBins)) {
+        // Few distinct values: cut after every value except the largest
+        for (size_t i = 0; i + 1 < summary.size(); ++i) {
+            cuts.push_back(summary[i].value);
+        }
+        return cuts;
+    }
+
+    double totalWeight = summary.back().rmax;
+    size_t j = 0;
+    for (int i = 1; i < maxBins; ++i) {
+        double rank = totalWeight * i / maxBins;
+        while (j + 1 < summary.size() && (summary[j].rmin + summary[j].rmax) / 2.0 < rank) {
+            ++j;
+        }
+        double value = summary[j].value;
+        if (value < summary.back().value && (cuts.empty() || value > cuts.back())) {
+            cuts.push_back(value);
+        }
+    }
+    return cuts;
+}
+
+double QuantileSketch::getTotalWeight() const {
+    double total = 0.0;
+    for (const auto& item : buffer) {
+        total += item.second;
+    }
+    for (const auto& summary : levels) {
+        if (!summary.empty()) {
+            total += summary.back().rmax;
+        }
+    }
+    return total;
+}
+
+QuantileSketch::Summary QuantileSketch::makeSummary(std::vector<std::pair<double, double>>& items) {
+    std::sort(items.begin(), items.end());
+
+    Summary summary;
+    double cumulative = 0.0;
+    for (size_t i = 0; i < items.size();) {
+        double value = items[i].first;
+        double weight = 0.0;
+        while (i < items.size() && items[i].first == value) {
+            weight += items[i].second;
+            ++i;
+        }
+        summary.push_back({value, cumulative, cumulative + weight, weight});
+        cumulative += weight;
+    }
+    return summary;
+}
+
+QuantileSketch::Summary QuantileSketch::combine(const Summary& a, const Summary& b) {
+    if (a.empty()) {
+        return b;
+    }
+    if (b.empty()) {
+        return a;
+    }
+
+    Summary out;
+    out.reserve(a.size() + b.size());
+
+    size_t i = 0;
+    size_t j = 0;
+    double aPrevRmin = 0.0;
+    double bPrevRmin = 0.0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i].value == b[j].value) {
+            out.push_back({a[i].value, a[i].rmin + b[j].rmin, a[i].rmax + b[j].rmax,
+                           a[i].wmin + b[j].wmin});
+            aPrevRmin = a[i].rminNext();
+            bPrevRmin = b[j].rminNext();
+            ++i;
+            ++j;
+        } else if (a[i].value < b[j].value) {
+            out.push_back({a[i].value, a[i].rmin + bPrevRmin, a[i].rmax + b[j].rmaxPrev(), a[i].wmin});
+            aPrevRmin = a[i].rminNext();
+            ++i;
+        } else {
+            out.push_back({b[j].value, b[j].rmin + aPrevRmin, b[j].rmax + a[i].rmaxPrev(), b[j].wmin});
+            bPrevRmin = b[j].rminNext();
+            ++j;
+        }
+    }
+
+    // Whatever remains lies above everything in the other summary
+    double aRmax = a.back().rmax;
+    double bRmax = b.back().rmax;
+    for (; i < a.size(); ++i) {
+        out.push_back({a[i].value, a[i].rmin + bPrevRmin, a[i].rmax + bRmax, a[i].wmin});
+    }
+    for (; j < b.size(); ++j) {
+        out.push_back({b[j].value, b[j].rmin + aPrevRmin, b[j].rmax + aRmax, b[j].wmin});
+    }
+    return out;
+}
+
+QuantileSketch::Summary QuantileSketch::prune(const Summary& src, size_t maxSize) {
+    if (src.size() <= maxSize) {
+        return src;
+    }
+
+    Summary out;
+    out.reserve(maxSize);
+
+    // Keep the entries closest to evenly spaced ranks, always keeping both ends
+    double begin = src.front().rmax;
+    double range = src.back().rmin - src.front().rmax;
+    size_t n = maxSize - 1;
+    out.push_back(src.front());
+    size_t i = 1;
+    size_t lastIdx = 0;
+    for (size_t k = 1; k < n; ++k) {
+        double target2 = 2.0 * (k * range / n + begin);
+        while (i < src.size() - 1 && target2 >= src[i + 1].rmax + src[i + 1].rmin) {
+            ++i;
+        }
+        if (i == src.size() - 1) {
+            break;
+        }
+        if (target2 < src[i].rminNext() + src[i + 1].rmaxPrev()) {
+            if (i != lastIdx) {
+                out.push_back(src[i]);
+                lastIdx = i;
+            }
+        } else if (i + 1 != lastIdx) {
+            out.push_back(src[i + 1]);
+            lastIdx = i + 1;
+        }
+    }
+    if (lastIdx != src.size() - 1) {
+        out.push_back(src.back());
+    }
+    return out;
+}
+
+void QuantileSketch::insert(Summary summary, size_t level) {
+    while (level < levels.size() && !levels[level].empty()) {
+        summary = prune(combine(levels[level], summary), maxSize);
+        levels[level].clear();
+        ++level;
+    }
+    if (level >= levels.size()) {
+        levels.resize(level + 1);
+    }
+    levels[level] = std::move(summary);
+}
+
+void QuantileSketch::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+    insert(prune(makeSummary(buffer), maxSize), 0);
+    buffer.clear();
+}
+
+QuantileSketch::Summary QuantileSketch::finalSummary() const {
+    std::vector<std::pair<double, double>> items = buffer;
+    Summary summary = makeSummary(items);
+    for (const auto& level : levels) {
+        summary = combine(summary, level);
+    }
+    return summary;
+}
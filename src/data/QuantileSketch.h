@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/**
+ * @brief Mergeable weighted quantile sketch
+ *
+ * Streaming summary of a weighted column of values that answers approximate
+ * quantile queries in bounded memory. Values are buffered, turned into exact
+ * summaries and combined level by level, pruning every combined summary to a
+ * fixed number of entries (the weighted GK-style summary used by histogram
+ * tree learners). Sketches built on different chunks of data, for example on
+ * worker threads, can be merged into one.
+ *
+ * Each pruning moves ranks by at most 1/(maxSize - 1) of the weight it
+ * summarizes, and a value passes through at most one pruning per level, so
+ * after n buffers the rank of a quantile or cut point is within
+ * (log2(n) + 2) / (maxSize - 1) of the total weight of its exact rank.
+ */
+class QuantileSketch {
+public:
+    /**
+     * @brief Construct an empty sketch
+     *
+     * @param maxSize Maximum number of entries kept per summary (controls accuracy)
+     * @param bufferSize Number of raw values buffered before they are summarized
+     */
+    explicit QuantileSketch(size_t maxSize = 256, size_t bufferSize = 4096);
+
+    /**
+     * @brief Add a value to the sketch
+     *
+     * Missing values (NaN) are not part of the summary; only their weight is counted.
+     *
+     * @param value Value to add
+     * @param weight Weight of the value
+     */
+    void add(double value, double weight = 1.0);
+
+    /**
+     * @brief Merge another sketch into this one
+     *
+     * @param other Sketch to merge
+     */
+    void merge(const QuantileSketch& other);
+
+    /**
+     * @brief Get an approximate quantile
+     *
+     * @param q Quantile in [0, 1]
+     * @return double Value at the quantile, or NaN if the sketch is empty
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief Get bin boundaries for histogram-based training
+     *
+     * Returns at most maxBins - 1 increasing cut points. A value x belongs to
+     * bin i when cuts[i - 1] < x <= cuts[i]. Columns with fewer distinct values
+     * than bins get one cut per distinct value.
+     *
+     * @param maxBins Maximum number of bins
+     * @return std::vector<double> Cut points
+     */
+    std::vector<double> getCutPoints(int maxBins) const;
+
+    /**
+     * @brief Get the total weight of the present values
+     *
+     * @return double Total weight
+     */
+    double getTotalWeight() const;
+
+    /**
+     * @brief Get the total weight of the missing values
+     *
+     * @return double Missing weight
+     */
+    double getMissingWeight() const { return missingWeight; }
+
+private:
+    /**
+     * @brief Summary entry
+     *
+     * rmin and rmax bound the total weight of the values strictly below and up
+     * to and including value; wmin is the weight of value itself.
+     */
+    struct Entry {
+        double value;
+        double rmin;
+        double rmax;
+        double wmin;
+
+        double rminNext() const { return rmin + wmin; }
+        double rmaxPrev() const { return rmax - wmin; }
+    };
+    using Summary = std::vector<Entry>;
+
+    size_t maxSize;
+    size_t bufferSize;
+    std::vector<std::pair<double, double>> buffer;
+    std::vector<Summary> levels;
+    double missingWeight;
+
+    /**
+     * @brief Build an exact summary from raw weighted values
+     *
+     * @param items Values and weights (sorted in place)
+     * @return Summary Exact summary
+     */
+    static Summary makeSummary(std::vector<std::pair<double, double>>& items);
+
+    /**
+     * @brief Combine two summaries without losing accuracy
+     *
+     * @param a First summary
+     * @param b Second summary
+     * @return Summary Combined summary
+     */
+    static Summary combine(const Summary& a, const Summary& b);
+
+    /**
+     * @brief Reduce a summary to at most maxSize entries
+     *
+     * @param src Summary to prune
+     * @param maxSize Maximum number of entries
+     * @return Summary Pruned summary
+     */
+    static Summary prune(const Summary& src, size_t maxSize);
+
+    /**
+     * @brief Insert a summary at a level, carrying into higher levels when occupied
+     *
+     * @param summary Summary to insert
+     * @param level Level to insert at
+     */
+    void insert(Summary summary, size_t level);
+
+    /**
+     * @brief Summarize the buffered values into level 0
+     */
+    void flush();
+
+    /**
+     * @brief Combine the buffer and all levels into one summary
+     *
+     * @return Summary Summary of everything added so far
+     */
+    Summary finalSummary() const;
+};
@@ -0,0 +1,110 @@
+#include "data/RowCompressor.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const uint64_t HASH_SEED = 0x9E3779B97F4A7C15ULL;
+const uint64_t HASH_MULTIPLIER = 0xFF51AFD7ED558CCDULL;
+
+inline uint64_t bitsOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Accumulate one column into the per-row hash lanes
+inline void mixColumn(const double* column, Eigen::Index nRows, uint64_t* hashes) {
+    for (Eigen::Index r = 0; r < nRows; ++r) {
+        uint64_t h = hashes[r] ^ bitsOf(column[r]);
+        h *= HASH_MULTIPLIER;
+        hashes[r] = h ^ (h >> 29);
+    }
+}
+
+// Final avalanche so that hashes differing in few bits spread over the table
+inline uint64_t finalize(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+std::vector<uint64_t> RowCompressor::hashRows(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+    if (X.rows() != y.size()) {
+        throw std::invalid_argument("Number of rows in X does not match the number of target values");
+    }
+
+    Eigen::Index nRows = X.rows();
+    std::vector<uint64_t> hashes(static_cast<size_t>(nRows), HASH_SEED);
+    for (Eigen::Index c = 0; c < X.cols(); ++c) {
+        mixColumn(X.col(c).data(), nRows, hashes.data());
+    }
+    mixColumn(y.data(), nRows, hashes.data());
+
+    for (uint64_t& h : hashes) {
+        h = finalize(h);
+    }
+    return hashes;
+}
+
+size_t RowCompressor::compress(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                               Eigen::MatrixXd& uniqueX, Eigen::VectorXd& uniqueY,
+                               Eigen::VectorXd& weights) {
+    std::vector<uint64_t> hashes = hashRows(X, y);
+
+    // Each hash points to its first unique row; rows with colliding hashes
+    // but different contents are chained through nextWithSameHash
+    std::unordered_map<uint64_t, int> firstWithHash;
+    firstWithHash.reserve(hashes.size());
+    std::vector<Eigen::Index> uniqueRows;
+    std::vector<int> nextWithSameHash;
+    std::vector<double> counts;
+
+    for (Eigen::Index r = 0; r < X.rows(); ++r) {
+        auto inserted = firstWithHash.emplace(hashes[r], static_cast<int>(uniqueRows.size()));
+        if (!inserted.second) {
+            int candidate = inserted.first->second;
+            int last = candidate;
+            while (candidate >= 0 && !rowsEqual(X, y, uniqueRows[candidate], r)) {
+                last = candidate;
+                candidate = nextWithSameHash[candidate];
+            }
+            if (candidate >= 0) {
+                counts[candidate] += 1.0;
+                continue;
+            }
+            nextWithSameHash[last] = static_cast<int>(uniqueRows.size());
+        }
+        uniqueRows.push_back(r);
+        nextWithSameHash.push_back(-1);
+        counts.push_back(1.0);
+    }
+
+    Eigen::Index nUnique = static_cast<Eigen::Index>(uniqueRows.size());
+    uniqueX.resize(nUnique, X.cols());
+    uniqueY.resize(nUnique);
+    weights.resize(nUnique);
+    for (Eigen::Index i = 0; i < nUnique; ++i) {
+        uniqueX.row(i) = X.row(uniqueRows[i]);
+        uniqueY(i) = y(uniqueRows[i]);
+        weights(i) = counts[i];
+    }
+    return static_cast<size_t>(nUnique);
+}
+
+bool RowCompressor::rowsEqual(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                              Eigen::Index a, Eigen::Index b) {
+    if (bitsOf(y(a)) != bitsOf(y(b))) {
+        return false;
+    }
+    for (Eigen::Index c = 0; c < X.cols(); ++c) {
+        if (bitsOf(X(a, c)) != bitsOf(X(b, c))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <Eigen/Dense>
+
+/**
+ * @brief Collapses duplicate training rows into weighted unique rows
+ *
+ * Process data often repeats the same row many times (steady-state
+ * operation). Every model treats a row of weight k like k copies of it, so
+ * training on the unique rows with their counts as sample weights gives the
+ * same fit at a cost proportional to the number of unique rows.
+ *
+ * Rows are compared by the exact bytes of their feature and target values.
+ */
+class RowCompressor {
+public:
+    /**
+     * @brief Hash every row of a feature matrix together with its target
+     *
+     * The hash is accumulated column by column over the column-major matrix,
+     * so the inner loop runs over contiguous memory with one independent hash
+     * lane per row and vectorizes.
+     *
+     * @param X Feature matrix
+     * @param y Target values
+     * @return std::vector<uint64_t> One hash per row
+     */
+    static std::vector<uint64_t> hashRows(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
+
+    /**
+     * @brief Collapse exact duplicate rows into unique rows with counts
+     *
+     * Unique rows are kept in order of first appearance, so the same input
+     * always gives the same output.
+     *
+     * @param X Feature matrix
+     * @param y Target values
+     * @param uniqueX Unique feature rows (output)
+     * @param uniqueY Target value of each unique row (output)
+     * @param weights Number of occurrences of each unique row (output)
+     * @return size_t Number of unique rows
+     */
+    static size_t compress(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                           Eigen::MatrixXd& uniqueX, Eigen::VectorXd& uniqueY,
+                           Eigen::VectorXd& weights);
+
+private:
+    /**
+     * @brief Check whether two rows hold exactly the same bytes
+     */
+    static bool rowsEqual(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                          Eigen::Index a, Eigen::Index b);
+};
@@ -35,6 +35,10 @@ ExportDialog::ExportDialog(int w, int h, const char* title)
     modelSummaryCheck->value(1);
     y += checkboxHeight + padding;
 
+    modelFileCheck = new Fl_Check_Button(padding, y, checkboxWidth, checkboxHeight, "Fitted Model (binary, reloadable)");
+    modelFileCheck->value(0);
+    y += checkboxHeight + padding;
+
     // Create path selection components
     pathDisplay = new Fl_Box(padding, y, w - 3 * padding - 80, checkboxHeight, "No directory selected");
     pathDisplay->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
@@ -72,6 +76,7 @@ ExportDialog::ExportOptions ExportDialog::getExportOptions() const {
     options.exportSummary = modelSummaryCheck->value();
     options.exportCSV = predictedValuesCheck->value();
     options.exportPlots = scatterPlotCheck->value() || linePlotCheck->value() || importancePlotCheck->value();
+    options.exportModel = modelFileCheck->value();
     options.outputDir = selectedPath;
     
     // Set legacy fields for backward compatibility
@@ -19,6 +19,7 @@ public:
         bool exportSummary = false;
         bool exportCSV = false;
         bool exportPlots = false;
+        bool exportModel = false;
         std::string outputDir;
         
         // For backward compatibility
@@ -35,6 +36,7 @@ public:
             result += "exportSummary=" + std::string(exportSummary ? "true" : "false");
             result += ", exportCSV=" + std::string(exportCSV ? "true" : "false");
             result += ", exportPlots=" + std::string(exportPlots ? "true" : "false");
+            result += ", exportModel=" + std::string(exportModel ? "true" : "false");
             result += ", outputDir='" + outputDir + "'";
             result += "}";
             return result;
@@ -64,6 +66,7 @@ private:
     Fl_Check_Button* importancePlotCheck;
     Fl_Check_Button* predictedValuesCheck;
     Fl_Check_Button* modelSummaryCheck;
+    Fl_Check_Button* modelFileCheck;
     Fl_Button* browseButton;
     Fl_Box* pathDisplay;
     Fl_Button* exportButton;
@@ -187,6 +187,34 @@ void HyperparameterSelector::createXGBoostUI()
     addSliderParam("gamma", "Gamma (Minimum Split Loss):", 0.0, 10.0, 0.0);
     addAutoToggle("gamma");
     
+    // Add L2 and L1 regularization of the leaf weights
+    addSliderParam("reg_lambda", "L2 Regularization (lambda):", 0.0, 10.0, 1.0);
+    addAutoToggle("reg_lambda");
+    addSliderParam("reg_alpha", "L1 Regularization (alpha):", 0.0, 10.0, 0.0);
+    addAutoToggle("reg_alpha");
+    
+    // Add training objective
+    std::vector<std::string> objectiveOptions = {"squared_error", "pseudo_huber", "tweedie"};
+    addChoiceParam("objective", "Objective:", objectiveOptions, 0);
+    addAutoToggle("objective");
+    
+    // Add objective parameters (used by pseudo_huber and tweedie)
+    addSliderParam("huber_slope", "Pseudo-Huber Slope:", 0.1, 10.0, 1.0);
+    addAutoToggle("huber_slope");
+    addSliderParam("tweedie_variance_power", "Tweedie Variance Power:", 1.05, 1.95, 1.5, 0.05);
+    addAutoToggle("tweedie_variance_power");
+    
+    // Add number of local worker processes (data-parallel training)
+    addIntSliderParam("n_workers", "Worker Processes:", 1, 16, 1);
+    addAutoToggle("n_workers");
+    
+    // Add periodic checkpoints written in the background (0 = off)
+    addIntSliderParam("checkpoint_interval", "Checkpoint Every:", 0, 500, 0);
+    addAutoToggle("checkpoint_interval");
+    
+    addCheckParam("resume_checkpoint", "Resume From Checkpoint", false);
+    addAutoToggle("resume_checkpoint");
+    
     parametersGroup->end();
 }
 
@@ -256,6 +284,69 @@ void HyperparameterSelector::createNeuralNetworkUI()
     addSliderParam("alpha", "Alpha (L2 penalty):", 0.0001, 0.01, 0.0001, 0.0001);
     addAutoToggle("alpha");
     
+    // Add compute precision
+    std::vector<std::string> precisionOptions = {"float64", "float32"};
+    addChoiceParam("precision", "Precision:", precisionOptions, 0);
+    addAutoToggle("precision");
+    
+    // Add threads for the matrix products
+    addIntSliderParam("n_threads", "Threads:", 1, 64, 1);
+    addAutoToggle("n_threads");
+    
+    // Add data-parallel training threads
+    addIntSliderParam("data_parallel_threads", "Data-Parallel Threads:", 1, 64, 1);
+    addAutoToggle("data_parallel_threads");
+    
+    // Add asynchronous updates for data-parallel training
+    addCheckParam("hogwild", "Asynchronous (Hogwild) Updates", false);
+    addAutoToggle("hogwild");
+    
+    // Add validation fraction for early stopping (0 trains on all rows)
+    addSliderParam("validation_fraction", "Validation Fraction:", 0.0, 0.5, 0.1, 0.05);
+    addAutoToggle("validation_fraction");
+    
+    // Add epochs without validation improvement before stopping
+    addIntSliderParam("n_iter_no_change", "Patience (epochs):", 1, 100, 10);
+    addAutoToggle("n_iter_no_change");
+    
+    // Add learning rate schedule
+    std::vector<std::string> scheduleOptions = {"constant", "step", "cosine", "plateau"};
+    addChoiceParam("lr_schedule", "LR Schedule:", scheduleOptions, 0);
+    addAutoToggle("lr_schedule");
+    
+    // Add learning rate decay factor for the step and plateau schedules
+    addSliderParam("lr_factor", "LR Decay Factor:", 0.1, 0.9, 0.5, 0.05);
+    addAutoToggle("lr_factor");
+    
+    // Add epochs between learning rate steps
+    addIntSliderParam("lr_step", "LR Step (epochs):", 1, 200, 10);
+    addAutoToggle("lr_step");
+    
+    // Add inference mode used for predictions; int8 is slower than folded
+    // and less accurate, so it is only offered by the command-line tool
+    std::vector<std::string> inferenceOptions = {"reference", "folded"};
+    addChoiceParam("inference_mode", "Inference Mode:", inferenceOptions, 0);
+    addAutoToggle("inference_mode");
+    
+    // Add restarts from different initializations
+    addIntSliderParam("n_restarts", "Restarts:", 1, 32, 1);
+    addAutoToggle("n_restarts");
+    
+    std::vector<std::string> restartOptions = {"best", "ensemble"};
+    addChoiceParam("restart_selection", "Restart Selection:", restartOptions, 0);
+    addAutoToggle("restart_selection");
+    
+    // Add random seed
+    addIntSliderParam("random_state", "Random Seed:", 0, 1000, 42);
+    addAutoToggle("random_state");
+    
+    // Add periodic checkpoints written in the background (0 = off)
+    addIntSliderParam("checkpoint_interval", "Checkpoint Every:", 0, 500, 0);
+    addAutoToggle("checkpoint_interval");
+    
+    addCheckParam("resume_checkpoint", "Resume From Checkpoint", false);
+    addAutoToggle("resume_checkpoint");
+    
     parametersGroup->end();
 }
 
@@ -292,6 +383,21 @@ void HyperparameterSelector::createGradientBoostingUI()
     addChoiceParam("loss", "Loss Function:", lossOptions, 0);
     addAutoToggle("loss");
     
+    // Add quantile level (used by the quantile loss)
+    addSliderParam("alpha", "Quantile (quantile loss):", 0.05, 0.95, 0.9, 0.05);
+    addAutoToggle("alpha");
+    
+    // Add Huber threshold (used by the Huber loss)
+    addSliderParam("huber_delta", "Huber Delta:", 0.1, 10.0, 1.0);
+    addAutoToggle("huber_delta");
+    
+    // Add periodic checkpoints written in the background (0 = off)
+    addIntSliderParam("checkpoint_interval", "Checkpoint Every:", 0, 500, 0);
+    addAutoToggle("checkpoint_interval");
+    
+    addCheckParam("resume_checkpoint", "Resume From Checkpoint", false);
+    addAutoToggle("resume_checkpoint");
+    
     parametersGroup->end();
 }
 
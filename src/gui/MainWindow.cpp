@@ -8,10 +8,13 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <cmath>
+#include <filesystem>
 
 // Add includes for CSV handling and data
 #include "data/CSVReader.h"
 #include "data/DataFrame.h"
+#include "data/RowCompressor.h"
 
 // Include model headers
 #include "models/LinearRegression.h"
@@ -24,6 +27,51 @@
 // Include utilities
 #include "utils/Logger.h"
 
+namespace {
+
+/**
+ * @brief Set up checkpointing for a model that supports it
+ *
+ * Checkpoints go to a per-model file in the system temporary directory, so a
+ * run that was interrupted can be resumed the next time the same model is
+ * trained on the same data.
+ *
+ * @param model Model to configure
+ * @param fileName Checkpoint file name
+ * @param interval Checkpoint interval in epochs or trees; 0 disables checkpoints
+ * @param resume Whether to resume from an existing checkpoint
+ */
+template <typename ModelType>
+void configureCheckpoint(ModelType& model, const std::string& fileName, int interval, bool resume) {
+    if (interval <= 0 && !resume) {
+        return;
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "Model_Builder_Tool";
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string checkpointPath = (directory / fileName).string();
+
+    if (resume) {
+        if (std::filesystem::exists(checkpointPath)) {
+            try {
+                model.resumeFromCheckpoint(checkpointPath);
+                LOG_INFO("Resuming from checkpoint " + checkpointPath, "MainWindow");
+            } catch (const std::exception& e) {
+                LOG_WARN("Could not resume from checkpoint: " + std::string(e.what()), "MainWindow");
+            }
+        } else {
+            LOG_WARN("No checkpoint found at " + checkpointPath + ", training from scratch", "MainWindow");
+        }
+    }
+    if (interval > 0) {
+        model.setCheckpoint(checkpointPath, interval);
+        LOG_INFO("Writing checkpoints to " + checkpointPath, "MainWindow");
+    }
+}
+
+} // namespace
+
 // Define the menu items
 static Fl_Menu_Item menuItems[] = {
     {"&File", 0, 0, 0, FL_SUBMENU},
@@ -207,14 +255,36 @@ void MainWindow::handleHyperparametersSelected(const std::unordered_map<std::str
 
 void MainWindow::handleVariablesSelected(const std::vector<std::string>& inputVariables, 
                                         const std::string& targetVariable) {
+    // Only the tree ensembles split on category membership; the other models
+    // would read the category codes as ordered numbers, so refuse those columns
+    bool treeModel = currentModelType == "Random Forest" || currentModelType == "Gradient Boosting" ||
+                     currentModelType == "XGBoost";
+    if (!treeModel) {
+        std::string categoricalInputs;
+        for (const auto& name : inputVariables) {
+            if (dataFrame->isCategorical(name)) {
+                categoricalInputs += (categoricalInputs.empty() ? "" : ", ") + name;
+            }
+        }
+        if (!categoricalInputs.empty()) {
+            LOG_WARN(currentModelType + " cannot use categorical inputs: " + categoricalInputs, "MainWindow");
+            fl_alert("%s cannot use the categorical input(s) %s.\n"
+                     "Deselect them or choose Random Forest, Gradient Boosting or XGBoost.",
+                     currentModelType.c_str(), categoricalInputs.c_str());
+            return;
+        }
+    }
+    
     selectedInputVariables = inputVariables;
     selectedTargetVariable = targetVariable;
     
-    // Create model
-    model = createModel(currentModelType);
-    if (!model) {
-        fl_alert("Failed to create model");
-        return;
+    // Grow the existing ensemble if only the tree count changed, otherwise create a new model
+    if (!prepareWarmStart()) {
+        model = createModel(currentModelType);
+        if (!model) {
+            fl_alert("Failed to create model");
+            return;
+        }
     }
     
     // Update status message with model type and hyperparameters if any
@@ -237,14 +307,87 @@ void MainWindow::fitModelAndShowResults() {
             dataFrame->getColumn(selectedTargetVariable).size()
         );
         
+        // Drop rows without a target value; missing inputs are left for the model
+        std::vector<int> keptRows;
+        for (int i = 0; i < y.size(); ++i) {
+            if (!std::isnan(y(i))) {
+                keptRows.push_back(i);
+            }
+        }
+        if (keptRows.size() < static_cast<size_t>(y.size())) {
+            LOG_WARN("Dropping " + std::to_string(y.size() - keptRows.size()) +
+                     " rows with a missing target value", "MainWindow");
+            Eigen::MatrixXd keptX(keptRows.size(), X.cols());
+            Eigen::VectorXd keptY(keptRows.size());
+            for (size_t i = 0; i < keptRows.size(); ++i) {
+                keptX.row(i) = X.row(keptRows[i]);
+                keptY(i) = y(keptRows[i]);
+            }
+            X = std::move(keptX);
+            y = std::move(keptY);
+        }
+        
+        // Let the tree models split categorical columns by category membership,
+        // and keep the labels of each code so a saved model scores files alike
+        std::vector<int> categoricalIndices;
+        std::unordered_map<std::string, std::vector<std::string>> categoryLevels;
+        for (size_t i = 0; i < selectedInputVariables.size(); ++i) {
+            if (dataFrame->isCategorical(selectedInputVariables[i])) {
+                categoricalIndices.push_back(static_cast<int>(i));
+                categoryLevels[selectedInputVariables[i]] = dataFrame->getCategoryLevels(selectedInputVariables[i]);
+            }
+        }
+        model->setCategoryLevels(categoryLevels);
+        if (!categoricalIndices.empty()) {
+            if (auto rf = std::dynamic_pointer_cast<RandomForest>(model)) {
+                rf->setCategoricalFeatures(categoricalIndices);
+            } else if (auto gb = std::dynamic_pointer_cast<GradientBoosting>(model)) {
+                gb->setCategoricalFeatures(categoricalIndices);
+            } else if (auto xgb = std::dynamic_pointer_cast<XGBoost>(model)) {
+                xgb->setCategoricalFeatures(categoricalIndices);
+            }
+        }
+        
+        // Collapse repeated rows into unique rows weighted by their counts. The
+        // neural network is left out: its SGD epochs make progress in proportion
+        // to the rows visited, so fewer rows would mean fewer updates per epoch.
+        // Boosting with row subsampling is left out too: drawing a fraction of
+        // the unique rows keeps or drops all copies of a row together, which is
+        // not the same sample as drawing that fraction of the raw rows.
+        auto params = model->getParameters();
+        auto subsample = params.find("subsample");
+        bool rowSubsampling = subsample != params.end() && subsample->second < 1.0;
+        Eigen::MatrixXd uniqueX;
+        Eigen::VectorXd uniqueY;
+        Eigen::VectorXd sampleWeights;
+        size_t uniqueRows = static_cast<size_t>(X.rows());
+        if (!std::dynamic_pointer_cast<NeuralNetwork>(model) && !rowSubsampling) {
+            uniqueRows = RowCompressor::compress(X, y, uniqueX, uniqueY, sampleWeights);
+        }
+        if (uniqueRows < static_cast<size_t>(X.rows())) {
+            LOG_INFO("Compressed " + std::to_string(X.rows()) + " rows into " +
+                     std::to_string(uniqueRows) + " unique weighted rows", "MainWindow");
+            X = std::move(uniqueX);
+            y = std::move(uniqueY);
+        } else {
+            sampleWeights.resize(0);
+        }
+        
         // Fit model
         statusBar->copy_label("Fitting model...");
         Fl::check();  // Update the UI to show the status message
         
         // Pass variable names to the model when fitting
-        bool success = model->fit(X, y, selectedInputVariables, selectedTargetVariable);
+        bool success = model->fit(X, y, selectedInputVariables, selectedTargetVariable, sampleWeights);
         
         if (success) {
+            // Remember what the model was fitted with so a later run can warm start
+            fittedFilePath = currentFilePath;
+            fittedModelType = currentModelType;
+            fittedHyperparameters = currentHyperparameters;
+            fittedInputVariables = selectedInputVariables;
+            fittedTargetVariable = selectedTargetVariable;
+            
             // Configure results view based on model type
             configureResultsView();
             
@@ -320,6 +463,13 @@ void MainWindow::handleStartOver() {
     dataFrame.reset();
     model.reset();
     
+    // Forget the fitted configuration
+    fittedFilePath.clear();
+    fittedModelType.clear();
+    fittedHyperparameters.clear();
+    fittedInputVariables.clear();
+    fittedTargetVariable.clear();
+    
     // Clear selections
     currentFilePath.clear();
     currentModelType.clear();
@@ -450,6 +600,14 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
             double colsample_bytree = 1.0;
             int min_child_weight = 1;
             double gamma = 0.0;
+            double reg_lambda = 1.0;
+            double reg_alpha = 0.0;
+            std::string objective = "squared_error";
+            double huber_slope = 1.0;
+            double tweedie_variance_power = 1.5;
+            int n_workers = 1;
+            int checkpoint_interval = 0;
+            bool resume_checkpoint = false;
 
             // Parse hyperparameters if they exist
             if (!currentHyperparameters.empty()) {
@@ -482,6 +640,38 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                         currentHyperparameters.at("gamma") != "auto") {
                         gamma = std::stod(currentHyperparameters.at("gamma"));
                     }
+                    if (currentHyperparameters.find("reg_lambda") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("reg_lambda") != "auto") {
+                        reg_lambda = std::stod(currentHyperparameters.at("reg_lambda"));
+                    }
+                    if (currentHyperparameters.find("reg_alpha") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("reg_alpha") != "auto") {
+                        reg_alpha = std::stod(currentHyperparameters.at("reg_alpha"));
+                    }
+                    if (currentHyperparameters.find("objective") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("objective") != "auto") {
+                        objective = currentHyperparameters.at("objective");
+                    }
+                    if (currentHyperparameters.find("huber_slope") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("huber_slope") != "auto") {
+                        huber_slope = std::stod(currentHyperparameters.at("huber_slope"));
+                    }
+                    if (currentHyperparameters.find("tweedie_variance_power") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("tweedie_variance_power") != "auto") {
+                        tweedie_variance_power = std::stod(currentHyperparameters.at("tweedie_variance_power"));
+                    }
+                    if (currentHyperparameters.find("n_workers") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("n_workers") != "auto") {
+                        n_workers = std::stoi(currentHyperparameters.at("n_workers"));
+                    }
+                    if (currentHyperparameters.find("checkpoint_interval") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("checkpoint_interval") != "auto") {
+                        checkpoint_interval = std::stoi(currentHyperparameters.at("checkpoint_interval"));
+                    }
+                    if (currentHyperparameters.find("resume_checkpoint") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("resume_checkpoint") != "auto") {
+                        resume_checkpoint = currentHyperparameters.at("resume_checkpoint") == "true";
+                    }
                 } catch (const std::exception& e) {
                     LOG_ERR("Error parsing XGBoost hyperparameters: " + std::string(e.what()), "MainWindow");
                 }
@@ -493,10 +683,22 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                      ", subsample=" + std::to_string(subsample) + 
                      ", colsample_bytree=" + std::to_string(colsample_bytree) + 
                      ", min_child_weight=" + std::to_string(min_child_weight) + 
-                     ", gamma=" + std::to_string(gamma), "MainWindow");
+                     ", gamma=" + std::to_string(gamma) + 
+                     ", reg_lambda=" + std::to_string(reg_lambda) + 
+                     ", reg_alpha=" + std::to_string(reg_alpha) + 
+                     ", objective=" + objective + 
+                     ", n_workers=" + std::to_string(n_workers) + 
+                     ", checkpoint_interval=" + std::to_string(checkpoint_interval) + 
+                     ", resume_checkpoint=" + (resume_checkpoint ? "true" : "false"), "MainWindow");
                      
-            result = std::make_shared<XGBoost>(learning_rate, max_depth, n_estimators,
-                                             subsample, colsample_bytree, min_child_weight, gamma);
+            auto xgb = std::make_shared<XGBoost>(learning_rate, max_depth, n_estimators,
+                                               subsample, colsample_bytree, min_child_weight, gamma);
+            xgb->setLambda(reg_lambda);
+            xgb->setAlpha(reg_alpha);
+            xgb->setObjective(objective, huber_slope, tweedie_variance_power);
+            xgb->setNumWorkers(n_workers);
+            configureCheckpoint(*xgb, "xgboost.ckpt", checkpoint_interval, resume_checkpoint);
+            result = xgb;
         }
         else if (modelType == "Random Forest") {
             // Parse hyperparameters for Random Forest
@@ -558,6 +760,21 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
             int batch_size = 32;
             std::string solver = "adam";
             double alpha = 0.0001;
+            std::string precision = "float64";
+            int n_threads = 0;
+            int data_parallel_threads = 1;
+            bool hogwild = false;
+            int random_state = -1;
+            double validation_fraction = 0.0;
+            int n_iter_no_change = 10;
+            std::string lr_schedule = "constant";
+            double lr_factor = 0.5;
+            int lr_step = 10;
+            std::string inference_mode = "reference";
+            int n_restarts = 1;
+            std::string restart_selection = "best";
+            int checkpoint_interval = 0;
+            bool resume_checkpoint = false;
 
             // Parse hyperparameters if they exist
             if (!currentHyperparameters.empty()) {
@@ -598,6 +815,66 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                         currentHyperparameters.at("alpha") != "auto") {
                         alpha = std::stod(currentHyperparameters.at("alpha"));
                     }
+                    if (currentHyperparameters.find("precision") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("precision") != "auto") {
+                        precision = currentHyperparameters.at("precision");
+                    }
+                    if (currentHyperparameters.find("n_threads") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("n_threads") != "auto") {
+                        n_threads = std::stoi(currentHyperparameters.at("n_threads"));
+                    }
+                    if (currentHyperparameters.find("data_parallel_threads") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("data_parallel_threads") != "auto") {
+                        data_parallel_threads = std::stoi(currentHyperparameters.at("data_parallel_threads"));
+                    }
+                    if (currentHyperparameters.find("hogwild") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("hogwild") != "auto") {
+                        hogwild = (currentHyperparameters.at("hogwild") == "true");
+                    }
+                    if (currentHyperparameters.find("random_state") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("random_state") != "auto") {
+                        random_state = std::stoi(currentHyperparameters.at("random_state"));
+                    }
+                    if (currentHyperparameters.find("validation_fraction") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("validation_fraction") != "auto") {
+                        validation_fraction = std::stod(currentHyperparameters.at("validation_fraction"));
+                    }
+                    if (currentHyperparameters.find("n_iter_no_change") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("n_iter_no_change") != "auto") {
+                        n_iter_no_change = std::stoi(currentHyperparameters.at("n_iter_no_change"));
+                    }
+                    if (currentHyperparameters.find("lr_schedule") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("lr_schedule") != "auto") {
+                        lr_schedule = currentHyperparameters.at("lr_schedule");
+                    }
+                    if (currentHyperparameters.find("lr_factor") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("lr_factor") != "auto") {
+                        lr_factor = std::stod(currentHyperparameters.at("lr_factor"));
+                    }
+                    if (currentHyperparameters.find("lr_step") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("lr_step") != "auto") {
+                        lr_step = std::stoi(currentHyperparameters.at("lr_step"));
+                    }
+                    if (currentHyperparameters.find("inference_mode") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("inference_mode") != "auto") {
+                        inference_mode = currentHyperparameters.at("inference_mode");
+                    }
+                    if (currentHyperparameters.find("n_restarts") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("n_restarts") != "auto") {
+                        n_restarts = std::stoi(currentHyperparameters.at("n_restarts"));
+                    }
+                    if (currentHyperparameters.find("restart_selection") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("restart_selection") != "auto") {
+                        restart_selection = currentHyperparameters.at("restart_selection");
+                    }
+                    if (currentHyperparameters.find("checkpoint_interval") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("checkpoint_interval") != "auto") {
+                        checkpoint_interval = std::stoi(currentHyperparameters.at("checkpoint_interval"));
+                    }
+                    if (currentHyperparameters.find("resume_checkpoint") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("resume_checkpoint") != "auto") {
+                        resume_checkpoint = currentHyperparameters.at("resume_checkpoint") == "true";
+                    }
                 } catch (const std::exception& e) {
                     LOG_ERR("Error parsing Neural Network hyperparameters: " + std::string(e.what()), "MainWindow");
                 }
@@ -619,11 +896,37 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                      ", max_iter=" + std::to_string(max_iter) + 
                      ", batch_size=" + std::to_string(batch_size) + 
                      ", solver=" + solver + 
-                     ", alpha=" + std::to_string(alpha), "MainWindow");
+                     ", alpha=" + std::to_string(alpha) + 
+                     ", precision=" + precision + 
+                     ", n_threads=" + std::to_string(n_threads) + 
+                     ", data_parallel_threads=" + std::to_string(data_parallel_threads) + 
+                     ", hogwild=" + (hogwild ? "true" : "false") + 
+                     ", random_state=" + std::to_string(random_state) + 
+                     ", validation_fraction=" + std::to_string(validation_fraction) + 
+                     ", n_iter_no_change=" + std::to_string(n_iter_no_change) + 
+                     ", lr_schedule=" + lr_schedule + 
+                     ", lr_factor=" + std::to_string(lr_factor) + 
+                     ", lr_step=" + std::to_string(lr_step) + 
+                     ", inference_mode=" + inference_mode + 
+                     ", n_restarts=" + std::to_string(n_restarts) + 
+                     ", restart_selection=" + restart_selection + 
+                     ", checkpoint_interval=" + std::to_string(checkpoint_interval) + 
+                     ", resume_checkpoint=" + (resume_checkpoint ? "true" : "false"), "MainWindow");
                      
-            result = std::make_shared<NeuralNetwork>(hidden_layer_sizes, activation,
-                                                   learning_rate, max_iter, batch_size,
-                                                   solver, alpha);
+            auto nn = std::make_shared<NeuralNetwork>(hidden_layer_sizes, activation,
+                                                    learning_rate, max_iter, batch_size,
+                                                    solver, alpha);
+            nn->setPrecision(precision);
+            nn->setNumThreads(n_threads);
+            nn->setDataParallelThreads(data_parallel_threads);
+            nn->setHogwild(hogwild);
+            nn->setRandomSeed(random_state);
+            nn->setEarlyStopping(validation_fraction, n_iter_no_change);
+            nn->setLearningRateSchedule(lr_schedule, lr_factor, lr_step);
+            nn->setInferenceMode(inference_mode);
+            nn->setRestarts(n_restarts, restart_selection);
+            configureCheckpoint(*nn, "neural_network.ckpt", checkpoint_interval, resume_checkpoint);
+            result = nn;
         }
         else if (modelType == "Gradient Boosting") {
             // Create Gradient Boosting with selected hyperparameters
@@ -634,6 +937,10 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
             int min_samples_leaf = 1;
             double subsample = 1.0;
             std::string loss = "squared_error";
+            double alpha = 0.9;
+            double huber_delta = 1.0;
+            int checkpoint_interval = 0;
+            bool resume_checkpoint = false;
 
             // Parse hyperparameters if they exist
             if (!currentHyperparameters.empty()) {
@@ -666,6 +973,22 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                         currentHyperparameters.at("loss") != "auto") {
                         loss = currentHyperparameters.at("loss");
                     }
+                    if (currentHyperparameters.find("alpha") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("alpha") != "auto") {
+                        alpha = std::stod(currentHyperparameters.at("alpha"));
+                    }
+                    if (currentHyperparameters.find("huber_delta") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("huber_delta") != "auto") {
+                        huber_delta = std::stod(currentHyperparameters.at("huber_delta"));
+                    }
+                    if (currentHyperparameters.find("checkpoint_interval") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("checkpoint_interval") != "auto") {
+                        checkpoint_interval = std::stoi(currentHyperparameters.at("checkpoint_interval"));
+                    }
+                    if (currentHyperparameters.find("resume_checkpoint") != currentHyperparameters.end() && 
+                        currentHyperparameters.at("resume_checkpoint") != "auto") {
+                        resume_checkpoint = currentHyperparameters.at("resume_checkpoint") == "true";
+                    }
                 } catch (const std::exception& e) {
                     LOG_ERR("Error parsing Gradient Boosting hyperparameters: " + std::string(e.what()), "MainWindow");
                 }
@@ -677,11 +1000,19 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
                      ", min_samples_split=" + std::to_string(min_samples_split) + 
                      ", min_samples_leaf=" + std::to_string(min_samples_leaf) + 
                      ", subsample=" + std::to_string(subsample) + 
-                     ", loss=" + loss, "MainWindow");
+                     ", loss=" + loss + 
+                     ", alpha=" + std::to_string(alpha) + 
+                     ", huber_delta=" + std::to_string(huber_delta) + 
+                     ", checkpoint_interval=" + std::to_string(checkpoint_interval) + 
+                     ", resume_checkpoint=" + (resume_checkpoint ? "true" : "false"), "MainWindow");
                      
-            result = std::make_shared<GradientBoosting>(learning_rate, n_estimators,
-                                                      max_depth, min_samples_split,
-                                                      min_samples_leaf, subsample, loss);
+            auto gb = std::make_shared<GradientBoosting>(learning_rate, n_estimators,
+                                                       max_depth, min_samples_split,
+                                                       min_samples_leaf, subsample, loss);
+            gb->setAlpha(alpha);
+            gb->setHuberDelta(huber_delta);
+            configureCheckpoint(*gb, "gradient_boosting.ckpt", checkpoint_interval, resume_checkpoint);
+            result = gb;
         }
         else {
             LOG_ERR("Unknown model type: " + modelType, "MainWindow");
@@ -703,6 +1034,61 @@ std::shared_ptr<Model> MainWindow::createModel(const std::string& modelType) {
     return result;
 }
 
+bool MainWindow::prepareWarmStart() {
+    if (!model || fittedModelType != currentModelType || fittedFilePath != currentFilePath ||
+        fittedInputVariables != selectedInputVariables || fittedTargetVariable != selectedTargetVariable) {
+        return false;
+    }
+    
+    if (currentModelType != "Random Forest" && currentModelType != "Gradient Boosting" &&
+        currentModelType != "XGBoost") {
+        return false;
+    }
+    
+    // All hyperparameters except n_estimators must be unchanged
+    auto withoutTreeCount = [](std::unordered_map<std::string, std::string> params) {
+        params.erase("n_estimators");
+        return params;
+    };
+    if (withoutTreeCount(fittedHyperparameters) != withoutTreeCount(currentHyperparameters)) {
+        return false;
+    }
+    
+    // Resolve the requested tree count (all three ensembles default to 100)
+    int newEstimators = 100;
+    auto it = currentHyperparameters.find("n_estimators");
+    if (it != currentHyperparameters.end() && it->second != "auto") {
+        try {
+            newEstimators = std::stoi(it->second);
+        } catch (const std::exception& e) {
+            LOG_ERR("Error parsing n_estimators for warm start: " + std::string(e.what()), "MainWindow");
+            return false;
+        }
+    }
+    
+    int fittedEstimators = static_cast<int>(model->getParameters()["n_estimators"]);
+    if (newEstimators <= fittedEstimators) {
+        return false;
+    }
+    
+    if (auto rf = std::dynamic_pointer_cast<RandomForest>(model)) {
+        rf->setNEstimators(newEstimators);
+        rf->setWarmStart(true);
+    } else if (auto gb = std::dynamic_pointer_cast<GradientBoosting>(model)) {
+        gb->setNEstimators(newEstimators);
+        gb->setWarmStart(true);
+    } else if (auto xgb = std::dynamic_pointer_cast<XGBoost>(model)) {
+        xgb->setNEstimators(newEstimators);
+        xgb->setWarmStart(true);
+    } else {
+        return false;
+    }
+    
+    LOG_INFO("Warm starting " + currentModelType + ": growing from " + std::to_string(fittedEstimators) +
+             " to " + std::to_string(newEstimators) + " trees", "MainWindow");
+    return true;
+}
+
 void MainWindow::menuCallback(Fl_Widget* widget, void* userData) {
     try {
         MainWindow* window = static_cast<MainWindow*>(widget->window());
@@ -77,6 +77,13 @@ private:
     std::vector<std::string> selectedInputVariables;
     std::string selectedTargetVariable;
     
+    // Configuration the current model was last fitted with (used for warm start)
+    std::string fittedFilePath;
+    std::string fittedModelType;
+    std::unordered_map<std::string, std::string> fittedHyperparameters;
+    std::vector<std::string> fittedInputVariables;
+    std::string fittedTargetVariable;
+    
     /**
      * @brief Update the UI based on the current state
      */
@@ -90,6 +97,18 @@ private:
      */
     std::shared_ptr<Model> createModel(const std::string& modelType);
     
+    /**
+     * @brief Reuse the fitted ensemble if only its tree count grew
+     * 
+     * Checks whether the current model was fitted on the same file, variables and
+     * hyperparameters, except for a smaller n_estimators. If so, the model is
+     * switched to warm-start mode with the new tree count so that fitting only
+     * trains the additional trees.
+     * 
+     * @return bool True if the existing model was prepared for warm start
+     */
+    bool prepareWarmStart();
+    
     /**
      * @brief Fit the model with selected variables and show results
      * 
@@ -1,7 +1,10 @@
 #include "gui/PlotNavigator.h"
+#include "models/NeuralNetwork.h"
+#include "models/PermutationImportance.h"
 #include "utils/Logger.h"
 #include <FL/fl_ask.H>
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
 
 // PlotNavigator implementation
@@ -66,9 +69,8 @@ void PlotNavigator::createPlot(const std::shared_ptr<DataFrame>& data,
         
         // Load the data for the plot
         std::vector<double> actual = data->getColumn(model->getTargetName());
-        Eigen::MatrixXd X = data->toMatrix(model->getVariableNames());
-        Eigen::VectorXd predicted = model->predict(X);
-        std::vector<double> predictedVec(predicted.data(), predicted.data() + predicted.size());
+        std::vector<double> predictedVec(data->getNumRows());
+        model->predictChunked(*data, Eigen::Map<Eigen::VectorXd>(predictedVec.data(), predictedVec.size()));
         
         LOG_INFO("Scatter plot data size - Actual: " + std::to_string(actual.size()) + 
                  ", Predicted: " + std::to_string(predictedVec.size()), "PlotNavigator");
@@ -82,9 +84,8 @@ void PlotNavigator::createPlot(const std::shared_ptr<DataFrame>& data,
         
         // Load the data for the plot
         std::vector<double> actual = data->getColumn(model->getTargetName());
-        Eigen::MatrixXd X = data->toMatrix(model->getVariableNames());
-        Eigen::VectorXd predicted = model->predict(X);
-        std::vector<double> predictedVec(predicted.data(), predicted.data() + predicted.size());
+        std::vector<double> predictedVec(data->getNumRows());
+        model->predictChunked(*data, Eigen::Map<Eigen::VectorXd>(predictedVec.data(), predictedVec.size()));
         
         LOG_INFO("Time series plot data size - Actual: " + std::to_string(actual.size()) + 
                  ", Predicted: " + std::to_string(predictedVec.size()), "PlotNavigator");
@@ -103,15 +104,58 @@ void PlotNavigator::createPlot(const std::shared_ptr<DataFrame>& data,
         
         plot->createImportancePlot(importance, title, tempDataPath, tempImagePath, tempScriptPath);
     }
+    else if (plotType == "permutation_importance") {
+        // Create temporary files with proper paths
+        plot->createTempFilePaths("importance", tempDataPath, tempImagePath, tempScriptPath);
+        
+        // Shuffle each feature of the loaded rows against the true target
+        Eigen::MatrixXd X = data->toMatrix(model->getVariableNames());
+        std::vector<double> actual = data->getColumn(model->getTargetName());
+        Eigen::VectorXd y = Eigen::Map<const Eigen::VectorXd>(actual.data(), actual.size());
+        
+        // Rows without a target value were not fitted and have no loss
+        std::vector<Eigen::Index> rows;
+        for (Eigen::Index i = 0; i < y.size(); ++i) {
+            if (!std::isnan(y(i))) {
+                rows.push_back(i);
+            }
+        }
+        if (rows.size() < static_cast<size_t>(y.size())) {
+            LOG_WARN("Skipping " + std::to_string(y.size() - rows.size()) +
+                     " rows with a missing target value", "PlotNavigator");
+        }
+        PermutationImportance::Options options;
+        options.maxRows = 10000;
+        PermutationImportance::Result result = PermutationImportance::compute(*model, X, y, options,
+                                                                               Eigen::VectorXd(), rows);
+        
+        // Scale means and spreads by the total, like the other importance plots
+        double total = 0.0;
+        for (const auto& score : result.features) {
+            total += std::max(score.mean, 0.0);
+        }
+        std::unordered_map<std::string, double> importance = PermutationImportance::normalizedMeans(result);
+        std::unordered_map<std::string, double> importanceStd;
+        for (const auto& score : result.features) {
+            importanceStd[score.name] = total > 1e-12 ? score.stdDev / total : 0.0;
+            LOG_INFO("Permutation importance of " + score.name + ": " + std::to_string(score.mean) + 
+                     " +/- " + std::to_string(score.stdDev), "PlotNavigator");
+        }
+        
+        LOG_INFO("Permutation importance on " + std::to_string(result.rows) + " rows with " + 
+                 std::to_string(options.repeats) + " repeats", "PlotNavigator");
+        
+        plot->createImportancePlot(importance, title, tempDataPath, tempImagePath, tempScriptPath,
+                                  importanceStd);
+    }
     else if (plotType == "residual") {
         // Create temporary files with proper paths
         plot->createTempFilePaths("residual", tempDataPath, tempImagePath, tempScriptPath);
         
         // Load the data for the plot
         std::vector<double> actual = data->getColumn(model->getTargetName());
-        Eigen::MatrixXd X = data->toMatrix(model->getVariableNames());
-        Eigen::VectorXd predicted = model->predict(X);
-        std::vector<double> predictedVec(predicted.data(), predicted.data() + predicted.size());
+        std::vector<double> predictedVec(data->getNumRows());
+        model->predictChunked(*data, Eigen::Map<Eigen::VectorXd>(predictedVec.data(), predictedVec.size()));
         
         LOG_INFO("Residual plot data size - Actual: " + std::to_string(actual.size()) + 
                  ", Predicted: " + std::to_string(predictedVec.size()), "PlotNavigator");
@@ -119,6 +163,43 @@ void PlotNavigator::createPlot(const std::shared_ptr<DataFrame>& data,
         plot->createResidualPlot(actual, predictedVec, title,
                                 tempDataPath, tempImagePath, tempScriptPath);
     }
+    else if (plotType == "tree") {
+        // Create temporary files with proper paths
+        plot->createTempFilePaths("tree", tempDataPath, tempImagePath, tempScriptPath);
+        
+        // Send only the top levels of the first tree; the plot draws deeper
+        // subtrees as collapsed nodes labelled with their size
+        std::vector<TreeInspection::NodeInfo> nodes = model->inspectTree(0, 0, 3);
+        std::string treeStructure = TreeInspection::toJSON(nodes, model->getVariableNames(), 0);
+        
+        LOG_INFO("Tree plot with " + std::to_string(nodes.size()) + " of " + 
+                 std::to_string(nodes.empty() ? 0 : nodes.front().subtreeSize) + " nodes", "PlotNavigator");
+        
+        plot->createTreeVisualizationPlot(treeStructure, title,
+                                         tempDataPath, tempImagePath, tempScriptPath);
+    }
+    else if (plotType == "loss_curve") {
+        // Create temporary files with proper paths
+        plot->createTempFilePaths("loss_curve", tempDataPath, tempImagePath, tempScriptPath);
+        
+        // Per-epoch losses recorded by the last fit of a neural network
+        std::vector<double> trainingLoss;
+        std::vector<double> validationLoss;
+        if (auto network = std::dynamic_pointer_cast<NeuralNetwork>(model)) {
+            trainingLoss = network->getTrainingLossHistory();
+            validationLoss = network->getValidationLossHistory();
+        }
+        std::vector<int> epochs(trainingLoss.size());
+        for (size_t i = 0; i < epochs.size(); ++i) {
+            epochs[i] = static_cast<int>(i) + 1;
+        }
+        
+        LOG_INFO("Loss curve with " + std::to_string(trainingLoss.size()) + " epochs", "PlotNavigator");
+        
+        plot->createLearningCurvePlot(trainingLoss, validationLoss, epochs, title,
+                                     tempDataPath, tempImagePath, tempScriptPath,
+                                     "Epoch", "Loss (MSE, standardized target)");
+    }
     
     // Update plot navigator
     add(plot);
@@ -121,7 +121,8 @@ void PlotWidget::regeneratePlot() {
             break;
         case PlotType::Importance:
             createImportancePlot(storedImportance, storedTitle, 
-                                "temp_plot_data.csv", "temp_plot_image.png", "temp_plot_script.py");
+                                "temp_plot_data.csv", "temp_plot_image.png", "temp_plot_script.py",
+                                storedImportanceStd);
             break;
         case PlotType::Residual:
             createResidualPlot(storedActualValues, storedPredictedValues, storedTitle,
@@ -129,7 +130,8 @@ void PlotWidget::regeneratePlot() {
             break;
         case PlotType::LearningCurve:
             createLearningCurvePlot(storedTrainingScores, storedValidationScores, storedTrainingSizes, storedTitle,
-                                   "temp_plot_data.csv", "temp_plot_image.png", "temp_plot_script.py");
+                                   "temp_plot_data.csv", "temp_plot_image.png", "temp_plot_script.py",
+                                   storedXLabel, storedYLabel);
             break;
         case PlotType::NeuralNetworkArchitecture:
             createNeuralNetworkArchitecturePlot(storedLayerSizes, storedTitle,
@@ -525,11 +527,13 @@ void PlotWidget::createImportancePlot(const std::unordered_map<std::string, doub
                                     const std::string& title,
                                     const std::string& tempDataPath,
                                     const std::string& tempImagePath,
-                                    const std::string& tempScriptPath)
+                                    const std::string& tempScriptPath,
+                                    const std::unordered_map<std::string, double>& importanceStd)
 {
     // Store data for regeneration
     currentPlotType = PlotType::Importance;
     storedImportance = importance;
+    storedImportanceStd = importanceStd;
     storedTitle = title;
 
     try {
@@ -557,9 +561,18 @@ void PlotWidget::createImportancePlot(const std::unordered_map<std::string, doub
             return;
         }
         
-        dataFileStream << "feature,importance\n";
-        for (const auto& pair : importance) {
-            dataFileStream << pair.first << "," << pair.second << "\n";
+        if (importanceStd.empty()) {
+            dataFileStream << "feature,importance\n";
+            for (const auto& pair : importance) {
+                dataFileStream << pair.first << "," << pair.second << "\n";
+            }
+        } else {
+            dataFileStream << "feature,importance,std\n";
+            for (const auto& pair : importance) {
+                auto stdIt = importanceStd.find(pair.first);
+                dataFileStream << pair.first << "," << pair.second << ","
+                               << (stdIt != importanceStd.end() ? stdIt->second : 0.0) << "\n";
+            }
         }
         dataFileStream.close();
         
@@ -670,7 +683,8 @@ bool PlotWidget::savePlot(const std::string& filename) {
                                 fullTempDataPath, fullTempImagePath, fullTempScriptPath);
             break;
         case PlotType::Importance:
-            createImportancePlot(storedImportance, storedTitle, fullTempDataPath, fullTempImagePath, fullTempScriptPath);
+            createImportancePlot(storedImportance, storedTitle, fullTempDataPath, fullTempImagePath, fullTempScriptPath,
+                                storedImportanceStd);
             break;
         case PlotType::None:
             return false;
@@ -680,7 +694,8 @@ bool PlotWidget::savePlot(const std::string& filename) {
             break;
         case PlotType::LearningCurve:
             createLearningCurvePlot(storedTrainingScores, storedValidationScores, storedTrainingSizes, storedTitle,
-                                    fullTempDataPath, fullTempImagePath, fullTempScriptPath);
+                                    fullTempDataPath, fullTempImagePath, fullTempScriptPath,
+                                    storedXLabel, storedYLabel);
             break;
         case PlotType::NeuralNetworkArchitecture:
             createNeuralNetworkArchitecturePlot(storedLayerSizes, storedTitle,
@@ -845,13 +860,17 @@ void PlotWidget::createLearningCurvePlot(const std::vector<double>& trainingScor
                                        const std::string& title,
                                        const std::string& tempDataPath,
                                        const std::string& tempImagePath,
-                                       const std::string& tempScriptPath)
+                                       const std::string& tempScriptPath,
+                                       const std::string& xLabel,
+                                       const std::string& yLabel)
 {
     // Store data for regeneration
     currentPlotType = PlotType::LearningCurve;
     storedTrainingScores = trainingScores;
     storedValidationScores = validationScores;
     storedTrainingSizes = trainingSizes;
+    storedXLabel = xLabel;
+    storedYLabel = yLabel;
     storedTitle = title;
 
     try {
@@ -879,11 +898,15 @@ void PlotWidget::createLearningCurvePlot(const std::vector<double>& trainingScor
             return;
         }
         
-        // Store learning curve data
+        // Store learning curve data; missing validation scores are left blank
         dataFileStream << "training_size,training_score,validation_score\n";
-        size_t minSize = std::min(trainingSizes.size(), std::min(trainingScores.size(), validationScores.size()));
+        size_t minSize = std::min(trainingSizes.size(), trainingScores.size());
         for (size_t i = 0; i < minSize; ++i) {
-            dataFileStream << trainingSizes[i] << "," << trainingScores[i] << "," << validationScores[i] << "\n";
+            dataFileStream << trainingSizes[i] << "," << trainingScores[i] << ",";
+            if (i < validationScores.size()) {
+                dataFileStream << validationScores[i];
+            }
+            dataFileStream << "\n";
         }
         dataFileStream.close();
         
@@ -901,6 +924,8 @@ void PlotWidget::createLearningCurvePlot(const std::vector<double>& trainingScor
         cmd << " --data_file \"" << formatPathForPython(dataFile.string()) << "\"";
         cmd << " --output_file \"" << formatPathForPython(outputFile.string()) << "\"";
         cmd << " --title \"" << title << "\"";
+        cmd << " --x_label \"" << xLabel << "\"";
+        cmd << " --y_label \"" << yLabel << "\"";
         cmd << " --width " << (plotBox->w() / 100.0);
         cmd << " --height " << (plotBox->h() / 100.0);
         
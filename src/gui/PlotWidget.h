@@ -42,12 +42,16 @@ public:
 
     /**
      * @brief Create an importance plot
+     * 
+     * @param importanceStd Standard deviation of each score, drawn as error
+     *        bars (empty for none)
      */
     void createImportancePlot(const std::unordered_map<std::string, double>& importance,
                              const std::string& title,
                              const std::string& tempDataPath = "temp_plot_data.csv",
                              const std::string& tempImagePath = "temp_plot_image.png",
-                             const std::string& tempScriptPath = "temp_plot_script.py");
+                             const std::string& tempScriptPath = "temp_plot_script.py",
+                             const std::unordered_map<std::string, double>& importanceStd = {});
 
     /**
      * @brief Create a residual plot
@@ -61,6 +65,10 @@ public:
 
     /**
      * @brief Create a learning curve plot
+     * 
+     * Also draws per-epoch loss curves, with the epochs as trainingSizes.
+     * validationScores may be shorter than trainingScores or empty, in which
+     * case only the training curve is drawn.
      */
     void createLearningCurvePlot(const std::vector<double>& trainingScores,
                                 const std::vector<double>& validationScores,
@@ -68,7 +76,9 @@ public:
                                 const std::string& title,
                                 const std::string& tempDataPath = "temp_plot_data.csv",
                                 const std::string& tempImagePath = "temp_plot_image.png",
-                                const std::string& tempScriptPath = "temp_plot_script.py");
+                                const std::string& tempScriptPath = "temp_plot_script.py",
+                                const std::string& xLabel = "Training Set Size",
+                                const std::string& yLabel = "Score");
 
     /**
      * @brief Create a neural network architecture plot
@@ -151,6 +161,7 @@ private:
     std::string storedYLabel;
     std::string storedTitle;
     std::unordered_map<std::string, double> storedImportance;
+    std::unordered_map<std::string, double> storedImportanceStd;
     std::vector<double> storedTrainingScores;
     std::vector<double> storedValidationScores;
     std::vector<int> storedTrainingSizes;
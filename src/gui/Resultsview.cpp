@@ -2,6 +2,7 @@
 #include "gui/ResultsView.h"
 #include "gui/PlotWidget.h"
 #include "gui/PlotNavigator.h"
+#include "models/NeuralNetwork.h"
 #include "utils/Logger.h"
 #include <FL/Fl.H>
 #include <FL/Fl_Group.H>
@@ -25,7 +26,7 @@
 // ResultsView implementation
 ResultsView::ResultsView(int x, int y, int w, int h)
     : Fl_Group(x, y, w, h),
-      exportDialog(std::make_unique<ExportDialog>(400, 300, "Export Options"))
+      exportDialog(std::make_unique<ExportDialog>(400, 340, "Export Options"))
 {
     begin();
     
@@ -296,19 +297,7 @@ void ResultsView::createPlots() {
         return;
     }
 
-    // Get actual and predicted values
-    Eigen::MatrixXd X = dataFrame->toMatrix(inputVariables);
-    Eigen::VectorXd y = Eigen::Map<Eigen::VectorXd>(
-        dataFrame->getColumn(targetVariable).data(),
-        dataFrame->getColumn(targetVariable).size()
-    );
-    Eigen::VectorXd predictions = model->predict(X);
-
-    // Convert Eigen vectors to std::vector
-    std::vector<double> actualValues(y.data(), y.data() + y.size());
-    std::vector<double> predictedValues(predictions.data(), predictions.data() + predictions.size());
-
-    // Clear existing plots
+    // Clear existing plots; each plot predicts the rows it needs
     plotNavigator->clearPlots();
 
     // Create standard plots for all models
@@ -329,6 +318,12 @@ void ResultsView::createPlots() {
         "importance", 
         "Feature Importance"
     );
+
+    plotNavigator->createPlot(
+        dataFrame, model,
+        "permutation_importance", 
+        "Permutation Importance (mean +/- std)"
+    );
     
     // Only create residual plot for non-linear regression models
     if (model->getName() != "Linear Regression") {
@@ -456,14 +451,20 @@ void ResultsView::exportResults(const ExportDialog::ExportOptions& options) {
                 // Write header
                 file << targetVariable << ",Predicted\n";
                 
-                // Generate predictions
-                Eigen::MatrixXd X = dataFrame->toMatrix(inputVariables);
-                Eigen::VectorXd predictions = model->predict(X);
+                // Predict and write one block of rows at a time
                 std::vector<double> targetData = dataFrame->getColumn(targetVariable);
-                
-                // Write data
-                for (int i = 0; i < predictions.size(); ++i) {
-                    file << targetData[i] << "," << predictions(i) << "\n";
+                Eigen::Index nRows = static_cast<Eigen::Index>(targetData.size());
+                Eigen::Index blockRows = Model::DEFAULT_BLOCK_ROWS;
+                Eigen::MatrixXd block;
+                Eigen::VectorXd predictions(std::min(nRows, blockRows));
+                for (Eigen::Index first = 0; first < nRows; first += blockRows) {
+                    Eigen::Index rows = std::min(blockRows, nRows - first);
+                    block.resize(rows, static_cast<Eigen::Index>(inputVariables.size()));
+                    dataFrame->copyRows(inputVariables, static_cast<size_t>(first), block);
+                    model->predictInto(block, predictions.head(rows));
+                    for (Eigen::Index i = 0; i < rows; ++i) {
+                        file << targetData[first + i] << "," << predictions(i) << "\n";
+                    }
                 }
                 
                 file.close();
@@ -473,6 +474,13 @@ void ResultsView::exportResults(const ExportDialog::ExportOptions& options) {
             }
         }
         
+        if (options.exportModel) {
+            // Fitted model in the binary format read back by Model::load
+            std::string modelPath = exportPath + "/model.mbm";
+            model->save(modelPath);
+            fl_message("Fitted model exported to %s", modelPath.c_str());
+        }
+        
         if (exportPlots) {
             // Export all plots
             for (size_t i = 0; i < plotNavigator->getPlotCount(); ++i) {
@@ -534,6 +542,11 @@ void ResultsView::updateRandomForestDisplay() {
         // Add feature importance plot
         auto importance = model->getFeatureImportance();
         plotNavigator->createPlot(dataFrame, model, "importance", "Feature Importance");
+        
+        // Add the top levels of the first tree
+        if (model->getTreeCount() > 0) {
+            plotNavigator->createPlot(dataFrame, model, "tree", "Tree Structure");
+        }
     }
 }
 
@@ -550,6 +563,11 @@ void ResultsView::updateXGBoostDisplay() {
         // Add feature importance plot
         auto importance = model->getFeatureImportance();
         plotNavigator->createPlot(dataFrame, model, "importance", "Feature Importance");
+        
+        // Add the top levels of the first tree
+        if (model->getTreeCount() > 0) {
+            plotNavigator->createPlot(dataFrame, model, "tree", "Tree Structure");
+        }
     }
 }
 
@@ -566,6 +584,11 @@ void ResultsView::updateGradientBoostingDisplay() {
         // Add feature importance plot
         auto importance = model->getFeatureImportance();
         plotNavigator->createPlot(dataFrame, model, "importance", "Feature Importance");
+        
+        // Add the top levels of the first tree
+        if (model->getTreeCount() > 0) {
+            plotNavigator->createPlot(dataFrame, model, "tree", "Tree Structure");
+        }
     }
 }
 
@@ -602,6 +625,12 @@ void ResultsView::updateNeuralNetworkDisplay() {
             // Create architecture plot
             plotNavigator->createPlot(dataFrame, model, "nn_architecture", "Neural Network Architecture");
         }
+        
+        // Add the per-epoch training and validation loss of the fit
+        auto network = std::dynamic_pointer_cast<NeuralNetwork>(model);
+        if (network && !network->getTrainingLossHistory().empty()) {
+            plotNavigator->createPlot(dataFrame, model, "loss_curve", "Training Loss");
+        }
     }
 }
 
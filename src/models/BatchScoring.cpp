@@ -0,0 +1,356 @@
+#include "models/BatchScoring.h"
+#include "data/CSVChunkReader.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Smallest row block handed to a thread, so short chunks are not split too finely
+const size_t MIN_BLOCK_ROWS = 1024;
+
+// Error sums of a row block, merged in row order
+struct ErrorSums {
+    double count = 0.0;
+    double meanTarget = 0.0;
+    double targetSquares = 0.0;     // Sum of squared deviations from meanTarget
+    double squaredError = 0.0;
+    double absoluteError = 0.0;
+
+    void add(double target, double prediction) {
+        count += 1.0;
+        double delta = target - meanTarget;
+        meanTarget += delta / count;
+        targetSquares += delta * (target - meanTarget);
+        double error = target - prediction;
+        squaredError += error * error;
+        absoluteError += std::abs(error);
+    }
+
+    void merge(const ErrorSums& other) {
+        if (other.count == 0.0) {
+            return;
+        }
+        double total = count + other.count;
+        double delta = other.meanTarget - meanTarget;
+        meanTarget += delta * other.count / total;
+        targetSquares += other.targetSquares + delta * delta * count * other.count / total;
+        squaredError += other.squaredError;
+        absoluteError += other.absoluteError;
+        count = total;
+    }
+};
+
+/**
+ * @brief Reads, parses and predicts a CSV file chunk by chunk
+ *
+ * Each chunk is cut into row blocks. For every block, onBlock receives the
+ * block index, the parsed columns (model inputs first, then the extra
+ * columns) and the predictions; afterwards onChunk receives the number of
+ * blocks. The next chunk is read while the current one is processed.
+ */
+class ChunkPipeline {
+public:
+    ChunkPipeline(const Model& model, const std::string& inputPath, const std::vector<std::string>& extraColumns,
+                  const BatchScoring::Options& options)
+        : model(model), reader(inputPath, options.separator), options(options) {
+        if (options.chunkRows == 0 || options.threads < 0) {
+            throw std::invalid_argument("Chunk size must be positive and the number of threads non-negative");
+        }
+        columns = model.getVariableNames();
+        if (columns.empty()) {
+            throw std::runtime_error("Model must be fitted before scoring");
+        }
+        BatchScoring::checkColumns(model, reader.getColumnNames(), inputPath);
+        nFeatures = static_cast<Eigen::Index>(columns.size());
+        columns.insert(columns.end(), extraColumns.begin(), extraColumns.end());
+        positions = reader.columnPositions(columns);
+        reader.setCategoryLevels(model.getCategoryLevels());
+
+        threads = options.threads > 0 ? options.threads
+                                      : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        blockRows = std::max(MIN_BLOCK_ROWS, (options.chunkRows + threads - 1) / static_cast<size_t>(threads));
+        scratch.resize(static_cast<size_t>(threads));
+    }
+
+    size_t maxBlocks() const { return (options.chunkRows + blockRows - 1) / blockRows; }
+
+    template <typename BlockFunction, typename ChunkFunction>
+    size_t run(BlockFunction onBlock, ChunkFunction onChunk) {
+        Lines current;
+        Lines next;
+        size_t totalRows = 0;
+        current.rows = reader.readLines(options.chunkRows, current.text, current.numbers);
+        while (current.rows > 0) {
+            auto pending = std::async(std::launch::async, [this, &next] {
+                next.rows = reader.readLines(options.chunkRows, next.text, next.numbers);
+            });
+            try {
+                size_t nBlocks = (current.rows + blockRows - 1) / blockRows;
+                processChunk(current, nBlocks, onBlock);
+                onChunk(nBlocks);
+            } catch (...) {
+                pending.wait();
+                throw;
+            }
+            pending.get();
+            totalRows += current.rows;
+            std::swap(current, next);
+        }
+        return totalRows;
+    }
+
+private:
+    struct Lines {
+        std::vector<std::string> text;
+        std::vector<size_t> numbers;
+        size_t rows = 0;
+    };
+
+    // Reused by one thread from block to block
+    struct Scratch {
+        Eigen::MatrixXd values;
+        Eigen::VectorXd predictions;
+    };
+
+    const Model& model;
+    CSVChunkReader reader;
+    BatchScoring::Options options;
+    std::vector<std::string> columns;
+    std::vector<size_t> positions;
+    Eigen::Index nFeatures = 0;
+    int threads = 1;
+    size_t blockRows = MIN_BLOCK_ROWS;
+    std::vector<Scratch> scratch;
+
+    template <typename BlockFunction>
+    void processChunk(const Lines& lines, size_t nBlocks, BlockFunction& onBlock) {
+        std::atomic<size_t> nextBlock{0};
+        std::vector<std::exception_ptr> errors(nBlocks);
+        auto work = [&](Scratch& buffer) {
+            for (size_t block = nextBlock++; block < nBlocks; block = nextBlock++) {
+                try {
+                    size_t begin = block * blockRows;
+                    size_t rows = std::min(blockRows, lines.rows - begin);
+                    Eigen::Index nRows = static_cast<Eigen::Index>(rows);
+                    buffer.values.resize(nRows, static_cast<Eigen::Index>(columns.size()));
+                    reader.parseLines(lines.text.data() + begin, lines.numbers.data() + begin, rows, columns,
+                                      positions, buffer.values.data(), rows);
+                    // The feature columns come first, so the model reads them in place
+                    buffer.predictions.resize(nRows);
+                    model.predictInto(buffer.values.leftCols(nFeatures), buffer.predictions);
+                    onBlock(block, buffer.values, buffer.predictions);
+                } catch (...) {
+                    errors[block] = std::current_exception();
+                }
+            }
+        };
+
+        int used = static_cast<int>(std::min<size_t>(static_cast<size_t>(threads), nBlocks));
+        std::vector<std::thread> pool;
+        for (int t = 1; t < used; ++t) {
+            pool.emplace_back(work, std::ref(scratch[static_cast<size_t>(t)]));
+        }
+        work(scratch[0]);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
+
+// Append the shortest text that reads back to the same value
+void appendNumber(std::string& text, double value) {
+    char buffer[32];
+    if (std::isnan(value)) {
+        text += "NaN";
+        return;
+    }
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    text.append(buffer, result.ptr);
+}
+
+} // namespace
+
+namespace BatchScoring {
+
+void checkColumns(const Model& model, const std::vector<std::string>& header, const std::string& inputPath) {
+    std::vector<std::string> expected = model.getVariableNames();
+    std::string missing;
+    std::string repeated;
+    std::string hints;
+    for (const auto& name : expected) {
+        auto count = std::count(header.begin(), header.end(), name);
+        if (count == 0) {
+            missing += (missing.empty() ? "" : ", ") + name;
+
+            // CSVReader splits a date column into three derived features
+            for (const std::string suffix : {"_year", "_month", "_day"}) {
+                size_t stem = name.size() - std::min(name.size(), suffix.size());
+                if (stem > 0 && name.compare(stem, suffix.size(), suffix) == 0 &&
+                    std::find(header.begin(), header.end(), name.substr(0, stem)) != header.end()) {
+                    hints = " Date columns are split into _year, _month and _day parts in training;"
+                            " scoring needs those parts as numeric columns.";
+                }
+            }
+        } else if (count > 1) {
+            repeated += (repeated.empty() ? "" : ", ") + name;
+        }
+    }
+    if (missing.empty() && repeated.empty()) {
+        return;
+    }
+
+    std::string expectedList;
+    for (const auto& name : expected) {
+        expectedList += (expectedList.empty() ? "" : ", ") + name;
+    }
+    std::string message = inputPath + " does not match the model's schema:";
+    if (!missing.empty()) {
+        message += " missing column(s) " + missing + ";";
+    }
+    if (!repeated.empty()) {
+        message += " repeated column(s) " + repeated + ";";
+    }
+    throw std::runtime_error(message + " the model expects " + expectedList + "." + hints);
+}
+
+size_t predictFile(const Model& model, const std::string& inputPath, const std::string& outputPath,
+                   const Options& options) {
+    ChunkPipeline pipeline(model, inputPath, {}, options);
+
+    // A file is written under a temporary name and renamed once complete
+    bool toStandardOutput = outputPath == "-";
+    std::string temporaryPath = outputPath + ".tmp";
+    std::FILE* output = toStandardOutput ? stdout : std::fopen(temporaryPath.c_str(), "wb");
+    if (!output) {
+        throw std::runtime_error("Could not open output file: " + outputPath);
+    }
+    auto closeOutput = [&] {
+        bool ok = std::fflush(output) == 0;
+        if (!toStandardOutput) {
+            ok = std::fclose(output) == 0 && ok;
+        }
+        output = nullptr;
+        return ok;
+    };
+
+    // Formatted blocks of two chunks: one being written while the other is filled
+    std::vector<std::string> texts[2];
+    texts[0].resize(pipeline.maxBlocks());
+    texts[1].resize(pipeline.maxBlocks());
+    int filling = 0;
+    std::future<bool> writing;
+    auto writeTexts = [output](const std::vector<std::string>* blocks, size_t nBlocks) {
+        for (size_t b = 0; b < nBlocks; ++b) {
+            const std::string& text = (*blocks)[b];
+            if (std::fwrite(text.data(), 1, text.size(), output) != text.size()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    size_t rows = 0;
+    try {
+        if (std::fputs("prediction\n", output) < 0) {
+            throw std::runtime_error("Could not write to " + outputPath);
+        }
+        rows = pipeline.run(
+            [&](size_t block, const Eigen::MatrixXd&, const Eigen::VectorXd& predictions) {
+                std::string& text = texts[filling][block];
+                text.clear();
+                for (Eigen::Index i = 0; i < predictions.size(); ++i) {
+                    appendNumber(text, predictions(i));
+                    text += '\n';
+                }
+            },
+            [&](size_t nBlocks) {
+                if (writing.valid() && !writing.get()) {
+                    throw std::runtime_error("Could not write to " + outputPath);
+                }
+                writing = std::async(std::launch::async, writeTexts, &texts[filling], nBlocks);
+                filling = 1 - filling;
+            });
+        if (writing.valid() && !writing.get()) {
+            throw std::runtime_error("Could not write to " + outputPath);
+        }
+    } catch (...) {
+        if (writing.valid()) {
+            writing.wait();
+        }
+        closeOutput();
+        if (!toStandardOutput) {
+            std::remove(temporaryPath.c_str());
+        }
+        throw;
+    }
+
+    if (!closeOutput()) {
+        if (!toStandardOutput) {
+            std::remove(temporaryPath.c_str());
+        }
+        throw std::runtime_error("Could not write to " + outputPath);
+    }
+    if (!toStandardOutput) {
+#ifdef _WIN32
+        // rename does not replace an existing file on Windows
+        std::remove(outputPath.c_str());
+#endif
+        if (std::rename(temporaryPath.c_str(), outputPath.c_str()) != 0) {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("Cannot replace " + outputPath);
+        }
+    }
+    return rows;
+}
+
+std::unordered_map<std::string, double> evaluateFile(const Model& model, const std::string& inputPath,
+                                                     const std::string& targetColumn, const Options& options) {
+    std::string target = targetColumn.empty() ? model.getTargetName() : targetColumn;
+    ChunkPipeline pipeline(model, inputPath, {target}, options);
+
+    std::vector<ErrorSums> blockSums(pipeline.maxBlocks());
+    ErrorSums total;
+    size_t rows = pipeline.run(
+        [&](size_t block, const Eigen::MatrixXd& values, const Eigen::VectorXd& predictions) {
+            ErrorSums sums;
+            Eigen::Index targetCol = values.cols() - 1;
+            for (Eigen::Index i = 0; i < predictions.size(); ++i) {
+                if (!std::isnan(values(i, targetCol))) {
+                    sums.add(values(i, targetCol), predictions(i));
+                }
+            }
+            blockSums[block] = sums;
+        },
+        [&](size_t nBlocks) {
+            for (size_t b = 0; b < nBlocks; ++b) {
+                total.merge(blockSums[b]);
+            }
+        });
+
+    if (total.count == 0.0) {
+        throw std::runtime_error("No rows with a target value in " + inputPath);
+    }
+
+    std::unordered_map<std::string, double> metrics;
+    metrics["rmse"] = std::sqrt(total.squaredError / total.count);
+    metrics["mae"] = total.absoluteError / total.count;
+    metrics["r_squared"] = total.targetSquares > 0.0 ? 1.0 - total.squaredError / total.targetSquares : 0.0;
+    metrics["n_samples"] = total.count;
+    metrics["n_rows"] = static_cast<double>(rows);
+    return metrics;
+}
+
+} // namespace BatchScoring
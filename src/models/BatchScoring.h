@@ -0,0 +1,89 @@
+#pragma once
+
+#include "models/Model.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Streams a CSV file through a fitted model
+ *
+ * The file is read a chunk of rows at a time, so files of any size are
+ * scored in bounded memory: at most two chunks of input text and two
+ * chunks of formatted predictions are held at once. Reading the next
+ * chunk, scoring the current one and writing the previous one's
+ * predictions overlap. The current chunk is cut into row blocks that a pool
+ * of threads parses and predicts, each into its own reused scratch matrix,
+ * so parsing, which dominates for most models, scales with the threads too.
+ *
+ * The model's input variables are looked up by name in the file header, so
+ * the file may hold other columns in any order. Feature columns must be
+ * numeric, except categorical inputs, whose labels are read as the codes
+ * saved with the model (see Model::setCategoryLevels); missing values and
+ * labels not seen in training are read as NaN. Model::predictInto must be safe
+ * to call concurrently, which holds for the const predictInto of every
+ * model here.
+ */
+namespace BatchScoring {
+
+/**
+ * @brief Settings of a scoring run
+ */
+struct Options {
+    size_t chunkRows = 65536;   // Rows read and held in memory at once
+    int threads = 0;            // Worker threads (0 for the hardware concurrency)
+    char separator = ',';       // Column separator of the input file
+};
+
+/**
+ * @brief Check a file header against the model's training schema
+ *
+ * Columns are matched by name, so the header may hold the input variables
+ * in another order and other columns besides; each input variable must
+ * appear exactly once. Called by predictFile and evaluateFile before any
+ * row is read.
+ *
+ * @param model Fitted model
+ * @param header Column names of the file, in file order
+ * @param inputPath Path of the file, for the message
+ * @throws std::runtime_error Naming the missing and repeated columns and the columns the model expects
+ */
+void checkColumns(const Model& model, const std::vector<std::string>& header, const std::string& inputPath);
+
+/**
+ * @brief Write a prediction for every row of a CSV file
+ *
+ * The output is a CSV file with a single "prediction" column, one row per
+ * input row in input order. Values are written in their shortest form that
+ * reads back to the same double.
+ *
+ * @param model Fitted model
+ * @param inputPath CSV file with the model's input variables
+ * @param outputPath Output CSV file, or "-" for standard output
+ * @param options Chunk size, threads and separator
+ * @return size_t Number of rows scored
+ * @throws std::invalid_argument If the options are invalid
+ * @throws std::runtime_error If the model is not fitted or a file cannot be read or written
+ */
+size_t predictFile(const Model& model, const std::string& inputPath, const std::string& outputPath,
+                   const Options& options = Options());
+
+/**
+ * @brief Score a CSV file against its target column
+ *
+ * Rows without a target value are skipped. The sums are combined in row
+ * order, so the metrics do not depend on the number of threads.
+ *
+ * @param model Fitted model
+ * @param inputPath CSV file with the model's input variables and the target
+ * @param targetColumn Name of the target column (empty for the model's target)
+ * @param options Chunk size, threads and separator
+ * @return std::unordered_map<std::string, double> rmse, mae, r_squared, n_samples and n_rows
+ * @throws std::invalid_argument If the options are invalid
+ * @throws std::runtime_error If the model is not fitted or the file cannot be read
+ */
+std::unordered_map<std::string, double> evaluateFile(const Model& model, const std::string& inputPath,
+                                                     const std::string& targetColumn = "",
+                                                     const Options& options = Options());
+
+} // namespace BatchScoring
@@ -0,0 +1,114 @@
+#include "models/BoostingObjective.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+void BoostingObjective::checkTarget(const Eigen::VectorXd&) const {
+}
+
+Eigen::VectorXd BoostingObjective::transform(const Eigen::VectorXd& margins) const {
+    Eigen::VectorXd predictions(margins.size());
+    for (int i = 0; i < margins.size(); ++i) {
+        predictions(i) = transform(margins(i));
+    }
+    return predictions;
+}
+
+std::shared_ptr<BoostingObjective> BoostingObjective::create(const std::string& name,
+                                                             double huberSlope,
+                                                             double tweedieVariancePower) {
+    if (name == "squared_error") {
+        return std::make_shared<SquaredErrorObjective>();
+    } else if (name == "pseudo_huber") {
+        return std::make_shared<PseudoHuberObjective>(huberSlope);
+    } else if (name == "tweedie") {
+        return std::make_shared<TweedieObjective>(tweedieVariancePower);
+    }
+    throw std::invalid_argument("Unknown objective: " + name);
+}
+
+double SquaredErrorObjective::initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const {
+    return weights.dot(y) / weights.sum();
+}
+
+void SquaredErrorObjective::computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                                             Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const {
+    gradients = margin - y;
+    hessians.setOnes(y.size());
+}
+
+PseudoHuberObjective::PseudoHuberObjective(double slope) : slope(slope) {
+    if (slope <= 0.0) {
+        throw std::invalid_argument("Pseudo-Huber slope must be positive");
+    }
+}
+
+double PseudoHuberObjective::initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const {
+    // The weighted median is robust to the outliers this loss is chosen for
+    std::vector<std::pair<double, double>> values;
+    values.reserve(y.size());
+    for (int i = 0; i < y.size(); ++i) {
+        values.push_back({y(i), weights(i)});
+    }
+    std::sort(values.begin(), values.end());
+    double half = weights.sum() / 2.0;
+    double cumulative = 0.0;
+    for (const auto& value : values) {
+        cumulative += value.second;
+        if (cumulative > half) {
+            return value.first;
+        }
+    }
+    return values.back().first;
+}
+
+void PseudoHuberObjective::computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                                            Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const {
+    gradients.resize(y.size());
+    hessians.resize(y.size());
+    for (int i = 0; i < y.size(); ++i) {
+        double r = margin(i) - y(i);
+        double scale = 1.0 + (r / slope) * (r / slope);
+        double root = std::sqrt(scale);
+        gradients(i) = r / root;
+        hessians(i) = 1.0 / (scale * root);
+    }
+}
+
+TweedieObjective::TweedieObjective(double variancePower) : variancePower(variancePower) {
+    if (variancePower <= 1.0 || variancePower >= 2.0) {
+        throw std::invalid_argument("Tweedie variance power must be between 1 and 2");
+    }
+}
+
+void TweedieObjective::checkTarget(const Eigen::VectorXd& y) const {
+    if (y.minCoeff() < 0.0) {
+        throw std::invalid_argument("Tweedie objective requires non-negative targets");
+    }
+    if (y.sum() <= 0.0) {
+        throw std::invalid_argument("Tweedie objective requires at least one positive target");
+    }
+}
+
+double TweedieObjective::initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const {
+    return std::log(weights.dot(y) / weights.sum());
+}
+
+void TweedieObjective::computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                                        Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const {
+    gradients.resize(y.size());
+    hessians.resize(y.size());
+    double rho = variancePower;
+    for (int i = 0; i < y.size(); ++i) {
+        double a = std::exp((1.0 - rho) * margin(i));
+        double b = std::exp((2.0 - rho) * margin(i));
+        gradients(i) = -y(i) * a + b;
+        hessians(i) = -y(i) * (1.0 - rho) * a + (2.0 - rho) * b;
+    }
+}
+
+double TweedieObjective::transform(double margin) const {
+    return std::exp(margin);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <Eigen/Dense>
+
+/**
+ * @brief Loss function optimized by second-order gradient boosting
+ *
+ * The booster works on a raw margin F (the sum of the tree outputs). An
+ * objective provides the per-row gradient and hessian of its loss with
+ * respect to F, the constant starting margin, and the transform from margin
+ * to prediction (identity except for log-link objectives).
+ */
+class BoostingObjective {
+public:
+    virtual ~BoostingObjective() = default;
+
+    /**
+     * @brief Get the objective name
+     *
+     * @return std::string Objective name
+     */
+    virtual std::string getName() const = 0;
+
+    /**
+     * @brief Check that the target values are valid for this objective
+     *
+     * @param y Target values
+     * @throws std::invalid_argument If the targets are outside the objective's domain
+     */
+    virtual void checkTarget(const Eigen::VectorXd& y) const;
+
+    /**
+     * @brief Get the constant margin the boosting starts from
+     *
+     * @param y Target values
+     * @param weights Per-row sample weights
+     * @return double Initial margin
+     */
+    virtual double initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const = 0;
+
+    /**
+     * @brief Compute per-row gradients and hessians of the loss
+     *
+     * @param y Target values
+     * @param margin Current margins
+     * @param gradients First derivatives of the loss w.r.t. the margin (output)
+     * @param hessians Second derivatives of the loss w.r.t. the margin (output)
+     */
+    virtual void computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                                  Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const = 0;
+
+    /**
+     * @brief Transform a margin into a prediction
+     *
+     * @param margin Raw margin
+     * @return double Prediction
+     */
+    virtual double transform(double margin) const { return margin; }
+
+    /**
+     * @brief Transform a vector of margins into predictions
+     *
+     * @param margins Raw margins
+     * @return Eigen::VectorXd Predictions
+     */
+    Eigen::VectorXd transform(const Eigen::VectorXd& margins) const;
+
+    /**
+     * @brief Create an objective by name
+     *
+     * @param name "squared_error", "pseudo_huber" or "tweedie"
+     * @param huberSlope Slope parameter (delta) of the pseudo-Huber loss
+     * @param tweedieVariancePower Variance power of the Tweedie loss, in (1, 2)
+     * @return std::shared_ptr<BoostingObjective> Objective
+     * @throws std::invalid_argument If the name or a parameter is invalid
+     */
+    static std::shared_ptr<BoostingObjective> create(const std::string& name,
+                                                     double huberSlope = 1.0,
+                                                     double tweedieVariancePower = 1.5);
+};
+
+/**
+ * @brief Squared error: gradient F - y, unit hessian
+ */
+class SquaredErrorObjective : public BoostingObjective {
+public:
+    std::string getName() const override { return "squared_error"; }
+    double initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const override;
+    void computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                          Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const override;
+};
+
+/**
+ * @brief Pseudo-Huber loss delta^2 (sqrt(1 + (r/delta)^2) - 1)
+ *
+ * A smooth Huber loss: quadratic for small residuals, linear for large ones,
+ * with a hessian everywhere so Newton leaf values stay well defined.
+ */
+class PseudoHuberObjective : public BoostingObjective {
+public:
+    explicit PseudoHuberObjective(double slope);
+    std::string getName() const override { return "pseudo_huber"; }
+    double initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const override;
+    void computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                          Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const override;
+
+private:
+    double slope;
+};
+
+/**
+ * @brief Tweedie deviance with a log link
+ *
+ * For non-negative targets with a point mass at zero (e.g. counts or
+ * amounts). The margin is the log of the prediction.
+ */
+class TweedieObjective : public BoostingObjective {
+public:
+    explicit TweedieObjective(double variancePower);
+    std::string getName() const override { return "tweedie"; }
+    void checkTarget(const Eigen::VectorXd& y) const override;
+    double initialMargin(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const override;
+    void computeGradients(const Eigen::VectorXd& y, const Eigen::VectorXd& margin,
+                          Eigen::VectorXd& gradients, Eigen::VectorXd& hessians) const override;
+    double transform(double margin) const override;
+
+private:
+    double variancePower;
+};
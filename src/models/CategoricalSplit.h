@@ -0,0 +1,200 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include "models/ThresholdSplit.h"
+
+/**
+ * @brief Split search and membership tests for categorical features
+ *
+ * Categorical features are stored in the input matrix as non-negative integer
+ * codes. A categorical split sends every row whose code is in a bitset to the
+ * left child and everything else (including unseen or invalid codes) to the
+ * right child. Rows whose code is missing (NaN) follow the default direction
+ * stored with the split.
+ */
+namespace CategoricalSplit {
+
+/**
+ * @brief Result of a categorical split search
+ */
+struct Result {
+    bool found = false;
+    double gain = 0.0;
+    std::vector<uint64_t> leftCategories;
+    bool missingLeft = false;
+};
+
+/**
+ * @brief Check whether a feature value belongs to a category set
+ *
+ * @param words Words of the category bitset
+ * @param wordCount Number of words
+ * @param value Feature value holding the integer category code
+ * @return bool True if the code is in the set
+ */
+inline bool contains(const uint64_t* words, size_t wordCount, double value) {
+    if (!(value >= 0.0)) {
+        return false;
+    }
+    size_t code = static_cast<size_t>(value);
+    size_t word = code / 64;
+    return word < wordCount && ((words[word] >> (code % 64)) & 1ULL);
+}
+
+inline bool contains(const std::vector<uint64_t>& bitset, double value) {
+    return contains(bitset.data(), bitset.size(), value);
+}
+
+/**
+ * @brief Decide which child a feature value goes to
+ *
+ * @param words Words of the left child's category bitset
+ * @param wordCount Number of words
+ * @param value Feature value holding the integer category code
+ * @param missingLeft Default direction for missing values
+ * @return bool True if the value goes to the left child
+ */
+inline bool goesLeft(const uint64_t* words, size_t wordCount, double value, bool missingLeft) {
+    if (std::isnan(value)) {
+        return missingLeft;
+    }
+    return contains(words, wordCount, value);
+}
+
+inline bool goesLeft(const std::vector<uint64_t>& bitset, double value, bool missingLeft) {
+    return goesLeft(bitset.data(), bitset.size(), value, missingLeft);
+}
+
+/**
+ * @brief Add a category code to a bitset
+ *
+ * @param bitset Category bitset
+ * @param code Category code
+ */
+inline void insert(std::vector<uint64_t>& bitset, int code) {
+    size_t word = static_cast<size_t>(code) / 64;
+    if (word >= bitset.size()) {
+        bitset.resize(word + 1, 0);
+    }
+    bitset[word] |= 1ULL << (code % 64);
+}
+
+/**
+ * @brief Find the best binary partition of the categories of a feature
+ *
+ * Uses Fisher's ordering: categories are sorted by their mean gradient
+ * (sum of gradients / sum of hessians), after which the optimal partition is
+ * one of the k - 1 prefixes of that ordering. The search costs one pass over
+ * the rows plus O(k log k) for k categories.
+ *
+ * Rows with a missing code are tried on both sides of every candidate
+ * partition and the better side is kept as the default direction.
+ *
+ * The gain of a partition is computed as for threshold splits, see
+ * ThresholdSplit::regularizedScore.
+ *
+ * @param indices Row indices at the node
+ * @param code Callable returning the feature value (category code) of a row
+ * @param gradient Callable returning the gradient (or target) of a row
+ * @param hessian Callable returning the hessian (or weight) of a row
+ * @param minChildWeight Minimum hessian sum required on each side
+ * @param lambda L2 regularization added to the hessian sums
+ * @param alpha L1 regularization of the gradient sums
+ * @return Result Best partition found
+ */
+template <typename CodeFn, typename GradFn, typename HessFn>
+Result findBestPartition(const std::vector<int>& indices, CodeFn code, GradFn gradient,
+                         HessFn hessian, double minChildWeight, double lambda = 0.0,
+                         double alpha = 0.0) {
+    Result result;
+
+    // Accumulate gradient statistics per category
+    std::vector<double> gradSums;
+    std::vector<double> hessSums;
+    double missingGrad = 0.0;
+    double missingHess = 0.0;
+    double totalGrad = 0.0;
+    double totalHess = 0.0;
+    for (int idx : indices) {
+        double g = gradient(idx);
+        double h = hessian(idx);
+        totalGrad += g;
+        totalHess += h;
+
+        double value = code(idx);
+        if (std::isnan(value)) {
+            missingGrad += g;
+            missingHess += h;
+            continue;
+        }
+        if (value < 0.0) {
+            // Invalid codes always go right, so they only count towards the totals
+            continue;
+        }
+        size_t c = static_cast<size_t>(value);
+        if (c >= gradSums.size()) {
+            gradSums.resize(c + 1, 0.0);
+            hessSums.resize(c + 1, 0.0);
+        }
+        gradSums[c] += g;
+        hessSums[c] += h;
+    }
+
+    // Order the categories present at this node by mean gradient
+    std::vector<std::pair<double, int>> order;
+    for (size_t c = 0; c < hessSums.size(); ++c) {
+        if (hessSums[c] > 0.0) {
+            order.push_back({gradSums[c] / hessSums[c], static_cast<int>(c)});
+        }
+    }
+    if (order.size() < 2) {
+        return result;
+    }
+    std::sort(order.begin(), order.end());
+
+    bool hasMissing = missingHess > 0.0;
+    double parentScore = ThresholdSplit::regularizedScore(totalGrad, totalHess, lambda, alpha);
+    double prefixGrad = 0.0;
+    double prefixHess = 0.0;
+    size_t bestPrefix = 0;
+
+    for (size_t i = 0; i + 1 < order.size(); ++i) {
+        int c = order[i].second;
+        prefixGrad += gradSums[c];
+        prefixHess += hessSums[c];
+
+        for (int direction = 0; direction < (hasMissing ? 2 : 1); ++direction) {
+            bool missingLeft = hasMissing && direction == 0;
+            double leftGrad = prefixGrad + (missingLeft ? missingGrad : 0.0);
+            double leftHess = prefixHess + (missingLeft ? missingHess : 0.0);
+            double rightGrad = totalGrad - leftGrad;
+            double rightHess = totalHess - leftHess;
+            if (leftHess < minChildWeight || rightHess < minChildWeight) {
+                continue;
+            }
+
+            double gain = ThresholdSplit::regularizedScore(leftGrad, leftHess, lambda, alpha) +
+                          ThresholdSplit::regularizedScore(rightGrad, rightHess, lambda, alpha) - parentScore;
+            if (!result.found || gain > result.gain) {
+                result.found = true;
+                result.gain = gain;
+                result.missingLeft = missingLeft;
+                bestPrefix = i + 1;
+            }
+        }
+    }
+
+    if (result.found) {
+        for (size_t i = 0; i < bestPrefix; ++i) {
+            insert(result.leftCategories, order[i].second);
+        }
+    }
+
+    return result;
+}
+
+} // namespace CategoricalSplit
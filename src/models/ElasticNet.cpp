@@ -1,7 +1,10 @@
 #include "models/ElasticNet.h"
+#include "models/ModelFile.h"
+#include <cassert>
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
 ElasticNet::ElasticNet() 
     : intercept(0.0), rSquared(0.0), adjustedRSquared(0.0), rmse(0.0),
@@ -17,21 +20,36 @@ ElasticNet::ElasticNet(double alpha, double lambda, int maxIter, double tol)
 
 bool ElasticNet::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                     const std::vector<std::string>& variableNames,
-                    const std::string& targetName) {
+                    const std::string& targetName,
+                    const Eigen::VectorXd& sampleWeights) {
     if (X.rows() != y.rows()) {
         std::cerr << "Error: Number of samples in X (" << X.rows() 
                  << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
         return false;
     }
 
-    if (X.rows() <= X.cols()) {
-        std::cerr << "Error: Number of samples (" << X.rows() 
+    Eigen::VectorXd weights;
+    if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+        return false;
+    }
+
+    // Rows with zero weight do not count towards the sample size
+    int nWeightedRows = static_cast<int>((weights.array() > 0.0).count());
+    if (nWeightedRows <= X.cols()) {
+        std::cerr << "Error: Number of samples (" << nWeightedRows 
                  << ") must be greater than number of features (" << X.cols() << ")." << std::endl;
         return false;
     }
 
+    if (X.hasNaN() || y.hasNaN()) {
+        std::cerr << "Error: " << getName() << " does not support missing values. "
+                 << "Use a tree-based model or remove rows with missing values." << std::endl;
+        return false;
+    }
+
     try {
-        nSamples = X.rows();
+        // With frequency weights the effective sample size is the total weight
+        nSamples = static_cast<int>(std::round(weights.sum()));
         nFeatures = X.cols();
 
         // Store variable names
@@ -60,20 +78,20 @@ bool ElasticNet::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         targetVariableName = targetName.empty() ? "Target" : targetName;
 
         // Calculate feature standard deviations for importance calculation
-        calculateFeatureStdDevs(X);
+        calculateFeatureStdDevs(X, weights);
 
         // Initialize coefficients to zeros
         coefficients = Eigen::VectorXd::Zero(nFeatures);
         intercept = 0.0;
 
         // Run coordinate descent algorithm to find optimal coefficients
-        coordinateDescent(X, y);
+        coordinateDescent(X, y, weights);
 
         // Set isFitted to true
         isFitted = true;
         
         // Calculate statistics
-        calculateStatistics(X, y);
+        calculateStatistics(X, y, weights);
 
         return true;
     } catch (const std::exception& e) {
@@ -82,23 +100,24 @@ bool ElasticNet::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
     }
 }
 
-void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                   const Eigen::VectorXd& weights) {
     std::cout << "Starting coordinate descent optimization" << std::endl;
     std::cout << "X dimensions: " << X.rows() << " x " << X.cols() << std::endl;
     std::cout << "y dimensions: " << y.size() << std::endl;
     
-    // Center the data (subtract mean)
-    double y_mean = y.mean();
+    // Center the data (subtract the weighted mean)
+    double totalWeight = weights.sum();
+    double y_mean = weights.dot(y) / totalWeight;
     std::cout << "y mean: " << y_mean << std::endl;
     
     Eigen::VectorXd y_centered = y.array() - y_mean;
     Eigen::MatrixXd X_centered = X;
     
     // Center each column of X
+    Eigen::VectorXd X_mean = (X.transpose() * weights) / totalWeight;
     for (int j = 0; j < X.cols(); ++j) {
-        Eigen::VectorXd col = X.col(j);
-        double mean = col.mean();
-        X_centered.col(j) = col.array() - mean;
+        X_centered.col(j) = X.col(j).array() - X_mean(j);
     }
     
     // Initialize coefficients
@@ -120,23 +139,22 @@ void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::Vector
         return;
     }
     
+    // Weighted columns and their weighted squared norms do not change between
+    // iterations, so compute them once instead of once per coordinate update
+    Eigen::MatrixXd weighted_X = weights.asDiagonal() * X_centered;
+    Eigen::VectorXd weighted_norms(nFeatures);
+    for (int j = 0; j < nFeatures; ++j) {
+        weighted_norms(j) = weighted_X.col(j).dot(X_centered.col(j));
+    }
+    
     // Iterate until convergence or max iterations
     for (int iter = 0; iter < maxIter; ++iter) {
         double max_change = 0.0;
         
         // Update each coefficient using coordinate descent
         for (int j = 0; j < nFeatures; ++j) {
-            // Get the column of X
-            Eigen::VectorXd X_j = X_centered.col(j);
-            
-            // Calculate dot product with current residuals
-            if (X_j.size() != residuals.size()) {
-                std::cerr << "Error: X_j size (" << X_j.size() 
-                         << ") doesn't match residuals size (" << residuals.size() << ")" << std::endl;
-                return;
-            }
-            
-            double rho = X_j.dot(residuals) + coefficients(j) * X_j.squaredNorm();
+            // Weighted inner products, equal to the sums over repeated rows
+            double rho = weighted_X.col(j).dot(residuals) + coefficients(j) * weighted_norms(j);
             
             // Calculate update with soft thresholding
             double old_coef = coefficients(j);
@@ -152,7 +170,7 @@ void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::Vector
             // Update residuals
             double delta_coef = coefficients(j) - old_coef;
             if (delta_coef != 0.0) {
-                residuals -= X_j * delta_coef;
+                residuals -= X_centered.col(j) * delta_coef;
             }
             
             // Track maximum coefficient change
@@ -172,8 +190,6 @@ void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::Vector
     }
     
     // Calculate intercept
-    Eigen::VectorXd X_mean = X.colwise().mean();  // Use colwise() for clarity
-    
     // Safety check
     if (X_mean.size() != coefficients.size()) {
         std::cerr << "Error: X_mean size (" << X_mean.size() 
@@ -188,6 +204,11 @@ void ElasticNet::coordinateDescent(const Eigen::MatrixXd& X, const Eigen::Vector
 }
 
 Eigen::VectorXd ElasticNet::predict(const Eigen::MatrixXd& X) const {
+    return predictInBlocks(X);
+}
+
+void ElasticNet::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                             Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -197,8 +218,33 @@ Eigen::VectorXd ElasticNet::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
+
+    predictions.noalias() = X * coefficients;
+    predictions.array() += intercept;
+}
+
+template <typename T>
+double ElasticNet::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Summed in column order, as the product in predictInto is for each row
+    double sum = 0.0;
+    for (Eigen::Index j = 0; j < coefficients.size(); ++j) {
+        sum += coefficients(j) * static_cast<double>(features[j]);
+    }
+    return sum + intercept;
+}
 
-    return X * coefficients + Eigen::VectorXd::Constant(X.rows(), intercept);
+double ElasticNet::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double ElasticNet::predictOne(const float* features) const noexcept {
+    return predictRow(features);
 }
 
 std::string ElasticNet::getName() const {
@@ -271,19 +317,21 @@ std::string ElasticNet::getTargetName() const {
     return targetVariableName;
 }
 
-void ElasticNet::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+void ElasticNet::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                      const Eigen::VectorXd& weights) {
     // Get predictions
     Eigen::VectorXd y_pred = predict(X);
+    double totalWeight = weights.sum();
     
     // Calculate SST (total sum of squares)
-    double y_mean = y.mean();
-    double sst = (y.array() - y_mean).square().sum();
+    double y_mean = weights.dot(y) / totalWeight;
+    double sst = (weights.array() * (y.array() - y_mean).square()).sum();
     
     // Calculate SSR (regression sum of squares)
-    double ssr = (y_pred.array() - y_mean).square().sum();
+    double ssr = (weights.array() * (y_pred.array() - y_mean).square()).sum();
     
     // Calculate SSE (error sum of squares)
-    double sse = (y.array() - y_pred.array()).square().sum();
+    double sse = (weights.array() * (y.array() - y_pred.array()).square()).sum();
     
     // Calculate R²
     rSquared = ssr / sst;
@@ -292,18 +340,20 @@ void ElasticNet::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::Vect
     adjustedRSquared = 1.0 - (1.0 - rSquared) * (nSamples - 1) / (nSamples - nFeatures - 1);
     
     // Calculate RMSE
-    rmse = std::sqrt(sse / nSamples);
+    rmse = std::sqrt(sse / totalWeight);
 }
 
-void ElasticNet::calculateFeatureStdDevs(const Eigen::MatrixXd& X) {
+void ElasticNet::calculateFeatureStdDevs(const Eigen::MatrixXd& X, const Eigen::VectorXd& weights) {
     // Initialize feature standard deviations vector
     featureStdDevs = Eigen::VectorXd(X.cols());
+    double totalWeight = weights.sum();
     
-    // Calculate standard deviation for each feature
+    // Calculate the weighted standard deviation for each feature
     for (int i = 0; i < X.cols(); ++i) {
         Eigen::VectorXd feature = X.col(i);
-        double mean = feature.mean();
-        featureStdDevs(i) = std::sqrt((feature.array() - mean).square().sum() / (feature.size() - 1));
+        double mean = weights.dot(feature) / totalWeight;
+        double sumSquares = (weights.array() * (feature.array() - mean).square()).sum();
+        featureStdDevs(i) = std::sqrt(sumSquares / std::max(totalWeight - 1.0, 1.0));
     }
 }
 
@@ -343,4 +393,50 @@ std::unordered_map<std::string, double> ElasticNet::getFeatureImportance() const
     }
     
     return importance;
-} 
\ No newline at end of file
+} 
+
+void ElasticNet::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+
+    writer.putValue<double>("alpha", alpha);
+    writer.putValue<double>("lambda", lambda);
+    writer.putValue<int32_t>("max_iter", maxIter);
+    writer.putValue<double>("tol", tol);
+    writer.putVector("coefficients", coefficients);
+    writer.putValue<double>("intercept", intercept);
+    writer.putValue<double>("r_squared", rSquared);
+    writer.putValue<double>("adjusted_r_squared", adjustedRSquared);
+    writer.putValue<double>("rmse", rmse);
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putVector("feature_std_devs", featureStdDevs);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+}
+
+void ElasticNet::readModel(const ModelFile::Reader& reader) {
+    Eigen::VectorXd storedCoefficients = reader.vector("coefficients");
+    Eigen::VectorXd storedStdDevs = reader.vector("feature_std_devs");
+    std::vector<std::string> names = reader.strings("variable_names");
+    if (storedStdDevs.size() != storedCoefficients.size() ||
+        names.size() != static_cast<size_t>(storedCoefficients.size())) {
+        throw std::runtime_error("ElasticNet model file sizes do not match");
+    }
+
+    alpha = reader.value<double>("alpha");
+    lambda = reader.value<double>("lambda");
+    maxIter = reader.value<int32_t>("max_iter");
+    tol = reader.value<double>("tol");
+    coefficients = storedCoefficients;
+    intercept = reader.value<double>("intercept");
+    rSquared = reader.value<double>("r_squared");
+    adjustedRSquared = reader.value<double>("adjusted_r_squared");
+    rmse = reader.value<double>("rmse");
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    nFeatures = static_cast<int>(coefficients.size());
+    featureStdDevs = storedStdDevs;
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    isFitted = true;
+}
@@ -0,0 +1,142 @@
+#include "models/FlatForest.h"
+#include "models/CategoricalSplit.h"
+#include "models/ThresholdSplit.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Rows scored together, so the nodes near the roots stay in cache across trees
+const Eigen::Index ROW_BLOCK = 256;
+
+}
+
+void FlatForest::point(const Arrays& arrays) {
+    treeOffsets = view(arrays.treeOffsets);
+    features = view(arrays.features);
+    rightChildren = view(arrays.rightChildren);
+    flags = view(arrays.flags);
+    thresholds = view(arrays.thresholds);
+    values = view(arrays.values);
+    covers = view(arrays.covers);
+    gains = view(arrays.gains);
+    categoryOffsets = view(arrays.categoryOffsets);
+    categoryWords = view(arrays.categoryWords);
+}
+
+FlatForest FlatForest::fromFile(const ModelFile::Reader& reader, int nFeatures) {
+    FlatForest forest;
+    forest.owner = reader.file();
+    forest.treeOffsets = reader.array<int64_t>("trees.offsets");
+    forest.features = reader.array<int32_t>("trees.features");
+    forest.rightChildren = reader.array<int32_t>("trees.right");
+    forest.flags = reader.array<uint8_t>("trees.flags");
+    forest.thresholds = reader.array<double>("trees.thresholds");
+    forest.values = reader.array<double>("trees.values");
+    forest.covers = reader.array<double>("trees.covers");
+    forest.gains = reader.array<double>("trees.gains");
+    forest.categoryOffsets = reader.array<int64_t>("trees.category_offsets");
+    forest.categoryWords = reader.array<uint64_t>("trees.category_words");
+    forest.validate(nFeatures);
+    return forest;
+}
+
+void FlatForest::validate(int nFeatures) const {
+    auto fail = [](const std::string& reason) {
+        throw std::runtime_error("Invalid tree arrays in model file: " + reason);
+    };
+
+    if (treeOffsets.empty() || treeOffsets[0] != 0) {
+        fail("tree offsets must start at 0");
+    }
+    size_t nNodes = features.size;
+    if (static_cast<uint64_t>(treeOffsets[treeOffsets.size - 1]) != nNodes) {
+        fail("tree offsets do not cover the nodes");
+    }
+    if (rightChildren.size != nNodes || flags.size != nNodes || thresholds.size != nNodes ||
+        values.size != nNodes || covers.size != nNodes || gains.size != nNodes ||
+        categoryOffsets.size != nNodes + 1) {
+        fail("node arrays differ in length");
+    }
+    if (categoryOffsets[0] != 0 || static_cast<uint64_t>(categoryOffsets[nNodes]) != categoryWords.size) {
+        fail("category offsets do not cover the category words");
+    }
+    for (size_t i = 0; i < nNodes; ++i) {
+        if (categoryOffsets[i + 1] < categoryOffsets[i]) {
+            fail("category offsets are not increasing");
+        }
+    }
+
+    for (size_t t = 0; t + 1 < treeOffsets.size; ++t) {
+        int64_t begin = treeOffsets[t];
+        int64_t end = treeOffsets[t + 1];
+        if (end <= begin) {
+            fail("tree " + std::to_string(t) + " is empty");
+        }
+        for (int64_t i = begin; i < end; ++i) {
+            if (features[i] < 0) {
+                continue;
+            }
+            // Children come after their parent within the same tree, so every walk ends at a leaf
+            if (features[i] >= nFeatures || i + 1 >= end || rightChildren[i] <= i + 1 || rightChildren[i] >= end) {
+                fail("node " + std::to_string(i) + " of tree " + std::to_string(t) + " is out of range");
+            }
+        }
+    }
+}
+
+void FlatForest::write(ModelFile::Writer& writer) const {
+    writer.putArray("trees.offsets", treeOffsets.data, treeOffsets.size);
+    writer.putArray("trees.features", features.data, features.size);
+    writer.putArray("trees.right", rightChildren.data, rightChildren.size);
+    writer.putArray("trees.flags", flags.data, flags.size);
+    writer.putArray("trees.thresholds", thresholds.data, thresholds.size);
+    writer.putArray("trees.values", values.data, values.size);
+    writer.putArray("trees.covers", covers.data, covers.size);
+    writer.putArray("trees.gains", gains.data, gains.size);
+    writer.putArray("trees.category_offsets", categoryOffsets.data, categoryOffsets.size);
+    writer.putArray("trees.category_words", categoryWords.data, categoryWords.size);
+}
+
+template <typename T>
+double FlatForest::walk(size_t tree, const T* x, Eigen::Index stride) const noexcept {
+    int64_t node = treeOffsets[tree];
+    while (features[node] >= 0) {
+        double value = static_cast<double>(x[features[node] * stride]);
+        bool defaultLeft = (flags[node] & DEFAULT_LEFT) != 0;
+        bool left;
+        if (flags[node] & CATEGORICAL) {
+            int64_t first = categoryOffsets[node];
+            left = CategoricalSplit::goesLeft(categoryWords.data + first,
+                                              static_cast<size_t>(categoryOffsets[node + 1] - first),
+                                              value, defaultLeft);
+        } else {
+            left = ThresholdSplit::goesLeft(value, thresholds[node], defaultLeft);
+        }
+        node = left ? node + 1 : rightChildren[node];
+    }
+    return values[node];
+}
+
+double FlatForest::predictTree(size_t tree, const double* x, Eigen::Index stride) const noexcept {
+    return walk(tree, x, stride);
+}
+
+double FlatForest::predictTree(size_t tree, const float* x, Eigen::Index stride) const noexcept {
+    return walk(tree, x, stride);
+}
+
+void FlatForest::accumulate(const Eigen::Ref<const Eigen::MatrixXd>& X, double scale,
+                            Eigen::Ref<Eigen::VectorXd> predictions) const {
+    size_t nTrees = treeCount();
+    const double* base = X.data();
+    Eigen::Index stride = X.outerStride();
+    for (Eigen::Index blockStart = 0; blockStart < X.rows(); blockStart += ROW_BLOCK) {
+        Eigen::Index blockEnd = std::min(X.rows(), blockStart + ROW_BLOCK);
+        for (size_t t = 0; t < nTrees; ++t) {
+            for (Eigen::Index i = blockStart; i < blockEnd; ++i) {
+                predictions(i) += scale * predictTree(t, base + i, stride);
+            }
+        }
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "models/ModelFile.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Tree ensemble stored as flat node arrays
+ *
+ * The nodes of all trees are stored in preorder, one array per node field,
+ * so the left child of an internal node is the next node and only the right
+ * child's index is kept. This is the tree layout of model files: loading a
+ * file points the arrays into the memory mapping, and predictions walk them
+ * directly. The node objects the models train with can be rebuilt per tree
+ * with buildTree.
+ *
+ * The templates work on any node type exposing isLeaf, featureIndex,
+ * splitValue, outputValue, leftChild, rightChild, isCategorical,
+ * categoryBitset, defaultLeft, cover and gain.
+ */
+class FlatForest {
+public:
+    FlatForest() = default;
+
+    /**
+     * @brief Flatten trees of node objects
+     *
+     * @param roots Root of each tree
+     * @return FlatForest Forest owning its arrays
+     */
+    template <typename NodePtr>
+    static FlatForest fromTrees(const std::vector<NodePtr>& roots) {
+        auto arrays = std::make_shared<Arrays>();
+        arrays->treeOffsets.push_back(0);
+        arrays->categoryOffsets.push_back(0);
+        for (const auto& root : roots) {
+            appendNode(*arrays, root);
+            arrays->treeOffsets.push_back(static_cast<int64_t>(arrays->features.size()));
+        }
+        FlatForest forest;
+        forest.point(*arrays);
+        forest.owner = arrays;
+        return forest;
+    }
+
+    /**
+     * @brief Point a forest into the sections of a model file
+     *
+     * The node arrays are checked so that every walk stays inside its tree.
+     *
+     * @param reader Model file holding the forest
+     * @param nFeatures Number of input features of the model
+     * @return FlatForest Forest viewing the mapped file
+     * @throws std::runtime_error If the arrays are missing or inconsistent
+     */
+    static FlatForest fromFile(const ModelFile::Reader& reader, int nFeatures);
+
+    /**
+     * @brief Add the node arrays to a model file
+     *
+     * @param writer Model file being written
+     */
+    void write(ModelFile::Writer& writer) const;
+
+    bool empty() const { return treeCount() == 0; }
+
+    size_t treeCount() const { return treeOffsets.empty() ? 0 : treeOffsets.size - 1; }
+
+    /**
+     * @brief Predict one row with one tree
+     *
+     * @param tree Tree index
+     * @param x First feature of the row
+     * @param stride Distance between consecutive features of the row
+     * @return double Output of the leaf the row reaches
+     */
+    double predictTree(size_t tree, const double* x, Eigen::Index stride) const noexcept;
+    double predictTree(size_t tree, const float* x, Eigen::Index stride) const noexcept;
+
+    /**
+     * @brief Add scale times each tree's output to the predictions
+     *
+     * Trees are added to each row in order, as the models do with their node
+     * trees, so both give the same floating-point sums.
+     *
+     * @param X Input features, read in place
+     * @param scale Factor applied to every tree output
+     * @param predictions Running predictions, one per row of X
+     */
+    void accumulate(const Eigen::Ref<const Eigen::MatrixXd>& X, double scale,
+                    Eigen::Ref<Eigen::VectorXd> predictions) const;
+
+    /**
+     * @brief Rebuild one tree as node objects
+     *
+     * @param tree Tree index
+     * @return Root of the rebuilt tree
+     */
+    template <typename Node>
+    std::shared_ptr<Node> buildTree(size_t tree) const {
+        return buildNode<Node>(treeOffsets[tree]);
+    }
+
+    /**
+     * @brief Rebuild all trees as node objects
+     *
+     * @return Root of each rebuilt tree
+     */
+    template <typename Node>
+    std::vector<std::shared_ptr<Node>> buildTrees() const {
+        std::vector<std::shared_ptr<Node>> roots;
+        for (size_t t = 0; t < treeCount(); ++t) {
+            roots.push_back(buildTree<Node>(t));
+        }
+        return roots;
+    }
+
+private:
+    static const uint8_t DEFAULT_LEFT = 1;
+    static const uint8_t CATEGORICAL = 2;
+
+    struct Arrays {
+        std::vector<int64_t> treeOffsets;       // First node of each tree, then the node count
+        std::vector<int32_t> features;          // -1 for leaves
+        std::vector<int32_t> rightChildren;     // -1 for leaves
+        std::vector<uint8_t> flags;
+        std::vector<double> thresholds;
+        std::vector<double> values;
+        std::vector<double> covers;
+        std::vector<double> gains;
+        std::vector<int64_t> categoryOffsets;   // First bitset word of each node, then the word count
+        std::vector<uint64_t> categoryWords;
+    };
+
+    // Keeps the arrays alive: owned Arrays or the mapped file
+    std::shared_ptr<const void> owner;
+    ModelFile::ArrayView<int64_t> treeOffsets;
+    ModelFile::ArrayView<int32_t> features;
+    ModelFile::ArrayView<int32_t> rightChildren;
+    ModelFile::ArrayView<uint8_t> flags;
+    ModelFile::ArrayView<double> thresholds;
+    ModelFile::ArrayView<double> values;
+    ModelFile::ArrayView<double> covers;
+    ModelFile::ArrayView<double> gains;
+    ModelFile::ArrayView<int64_t> categoryOffsets;
+    ModelFile::ArrayView<uint64_t> categoryWords;
+
+    void point(const Arrays& arrays);
+
+    template <typename T>
+    double walk(size_t tree, const T* x, Eigen::Index stride) const noexcept;
+    void validate(int nFeatures) const;
+
+    template <typename T>
+    static ModelFile::ArrayView<T> view(const std::vector<T>& values) {
+        ModelFile::ArrayView<T> result;
+        result.data = values.data();
+        result.size = values.size();
+        return result;
+    }
+
+    template <typename NodePtr>
+    static int64_t appendNode(Arrays& arrays, const NodePtr& node) {
+        int64_t index = static_cast<int64_t>(arrays.features.size());
+        bool split = node && !node->isLeaf;
+        arrays.features.push_back(split ? node->featureIndex : -1);
+        arrays.rightChildren.push_back(-1);
+        arrays.flags.push_back(node ? static_cast<uint8_t>((node->defaultLeft ? DEFAULT_LEFT : 0) |
+                                                           (node->isCategorical ? CATEGORICAL : 0))
+                                    : 0);
+        arrays.thresholds.push_back(node ? node->splitValue : 0.0);
+        // A missing node predicts 0, as in the models' predictTree
+        arrays.values.push_back(node ? node->outputValue : 0.0);
+        arrays.covers.push_back(node ? node->cover : 0.0);
+        arrays.gains.push_back(node ? node->gain : 0.0);
+        if (node) {
+            arrays.categoryWords.insert(arrays.categoryWords.end(), node->categoryBitset.begin(),
+                                        node->categoryBitset.end());
+        }
+        arrays.categoryOffsets.push_back(static_cast<int64_t>(arrays.categoryWords.size()));
+        if (split) {
+            appendNode(arrays, node->leftChild);
+            arrays.rightChildren[index] = static_cast<int32_t>(appendNode(arrays, node->rightChild));
+        }
+        return index;
+    }
+
+    template <typename Node>
+    std::shared_ptr<Node> buildNode(int64_t index) const {
+        auto node = std::make_shared<Node>();
+        node->isLeaf = features[index] < 0;
+        node->featureIndex = features[index];
+        node->splitValue = thresholds[index];
+        node->outputValue = values[index];
+        node->isCategorical = (flags[index] & CATEGORICAL) != 0;
+        node->defaultLeft = (flags[index] & DEFAULT_LEFT) != 0;
+        node->categoryBitset.assign(categoryWords.data + categoryOffsets[index],
+                                    categoryWords.data + categoryOffsets[index + 1]);
+        node->cover = covers[index];
+        node->gain = gains[index];
+        if (!node->isLeaf) {
+            node->leftChild = buildNode<Node>(index + 1);
+            node->rightChild = buildNode<Node>(rightChildren[index]);
+        }
+        return node;
+    }
+};
@@ -1,14 +1,27 @@
 #include "models/GradientBoosting.h"
+#include "models/TreeCompaction.h"
+#include "models/CategoricalSplit.h"
+#include "models/ThresholdSplit.h"
+#include "models/HistogramTree.h"
+#include "models/ModelFile.h"
+#include "models/TreeWalk.h"
+#include "utils/BinaryBuffer.h"
+#include <cassert>
 #include <cmath>
+#include <chrono>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
 
 GradientBoosting::GradientBoosting()
     : learningRate(0.1), nEstimators(100), maxDepth(3), minSamplesSplit(2), 
-      minSamplesLeaf(1), subsample(1.0), loss("squared_error"),
-      isFitted(false), nSamples(0), nFeatures(0), rmse(0.0), initialPrediction(0.0) {
+      minSamplesLeaf(1), subsample(1.0), loss("squared_error"), alpha(0.9), huberDelta(1.0), warmStart(false),
+      isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0), initialPrediction(0.0),
+      trainingTargetSum(0.0), randomSeed(-1), rng(std::random_device()()), checkpointInterval(10), resumePending(false) {
 }
 
 GradientBoosting::GradientBoosting(double learning_rate, int n_estimators, int max_depth, 
@@ -16,14 +29,18 @@ GradientBoosting::GradientBoosting(double learning_rate, int n_estimators, int m
                                  double subsample, const std::string& loss)
     : learningRate(learning_rate), nEstimators(n_estimators), maxDepth(max_depth),
       minSamplesSplit(min_samples_split), minSamplesLeaf(min_samples_leaf),
-      subsample(subsample), loss(loss),
-      isFitted(false), nSamples(0), nFeatures(0), rmse(0.0), initialPrediction(0.0) {
+      subsample(subsample), loss(loss), alpha(0.9), huberDelta(1.0), warmStart(false),
+      isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0), initialPrediction(0.0),
+      trainingTargetSum(0.0), randomSeed(-1), rng(std::random_device()()), checkpointInterval(10), resumePending(false) {
 }
 
 bool GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                           const std::vector<std::string>& variableNames,
-                          const std::string& targetName) {
+                          const std::string& targetName,
+                          const Eigen::VectorXd& sampleWeights) {
     try {
+        materializeTrees();
+        
         // Check dimensions
         if (X.rows() != y.rows()) {
             std::cerr << "Error: Number of samples in X (" << X.rows() 
@@ -31,13 +48,37 @@ bool GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             return false;
         }
         
+        // Missing feature values are handled by the splits, a missing target is not
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        Eigen::VectorXd weights;
+        if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+            return false;
+        }
+        
+        // Warm start resumes from the stored training predictions, which are
+        // only valid for the exact data the existing trees were fitted on.
+        // A loaded checkpoint resumes the same way
+        bool continuing = warmStart || resumePending;
+        bool resume = continuing && isFitted &&
+                      X.rows() == nSamples && X.cols() == nFeatures &&
+                      trainingPredictions.size() == y.size() &&
+                      y.sum() == trainingTargetSum &&
+                      weights.sum() == sampleWeightSum &&
+                      static_cast<int>(trees.size()) <= nEstimators;
+        if (continuing && isFitted && !resume) {
+            std::cerr << "Warning: Warm start not possible (training data or tree count changed). "
+                      << "Retraining Gradient Boosting from scratch." << std::endl;
+        }
+        resumePending = false;
+        
         nSamples = X.rows();
+        sampleWeightSum = weights.sum();
         nFeatures = X.cols();
         
-        // Initialize random number generator
-        std::random_device rd;
-        std::mt19937 rng(rd());
-        
         // Store variable names
         if (variableNames.size() == 0) {
             // Generate default variable names
@@ -63,18 +104,42 @@ bool GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         // Store target variable name
         targetVariableName = targetName.empty() ? "Target" : targetName;
         
-        // Clear existing trees
-        trees.clear();
-        
-        // Step 1: Initialize model with a constant value
-        // For regression, this is the mean of the target values
-        initialPrediction = y.mean();
+        // Mark categorical features
+        categoricalMask.assign(nFeatures, false);
+        for (int idx : categoricalFeatureIndices) {
+            if (idx >= 0 && idx < nFeatures) {
+                categoricalMask[idx] = true;
+            }
+        }
         
         // Current predictions
-        Eigen::VectorXd F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        Eigen::VectorXd F;
+        
+        if (resume) {
+            // Keep the existing trees and continue from their predictions
+            F = trainingPredictions;
+        } else {
+            // Clear existing trees
+            trees.clear();
+            if (randomSeed >= 0) {
+                rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+            }
+            
+            // Step 1: Initialize model with the constant value minimizing the loss
+            initialPrediction = calculateInitialPrediction(y, weights);
+            F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        }
+        
+        // Snapshots are written on the writer's thread while boosting goes on
+        double targetSum = y.sum();
+        std::unique_ptr<CheckpointWriter> checkpointWriter;
+        if (!checkpointPath.empty()) {
+            checkpointWriter = std::make_unique<CheckpointWriter>(checkpointPath, getName());
+        }
+        size_t firstTree = trees.size();
         
         // Step 2: For m = 1 to M (number of estimators):
-        for (int m = 0; m < nEstimators; ++m) {
+        for (int m = static_cast<int>(trees.size()); m < nEstimators; ++m) {
             // a) Calculate pseudo-residuals
             Eigen::VectorXd residuals = calculatePseudoResiduals(y, F);
             
@@ -95,20 +160,42 @@ bool GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             
             // c) Fit a regression tree to the pseudo-residuals
             RegressionTree tree(nFeatures);
-            tree.root = buildTree(X, residuals, sampleIndices, 0, tree);
+            tree.root = buildTree(X, residuals, weights, sampleIndices, 0, tree);
             
-            // d) Update the model
+            // d) Re-estimate the leaf values on the raw residuals for non-squared losses
+            if (loss != "squared_error") {
+                refitLeafValues(tree.root, sampleIndices, y - F, weights,
+                    [&X](const std::shared_ptr<TreeNode>& node, int idx) {
+                        double value = X(idx, node->featureIndex);
+                        if (node->isCategorical) {
+                            return CategoricalSplit::goesLeft(node->categoryBitset, value, node->defaultLeft);
+                        }
+                        return ThresholdSplit::goesLeft(value, node->splitValue, node->defaultLeft);
+                    });
+            }
+            
+            // e) Update the model
             for (int i = 0; i < nSamples; ++i) {
                 F(i) += learningRate * predictTree(X.row(i), tree.root);
             }
             
             // Store the tree
             trees.push_back(tree);
+            
+            if (checkpointWriter && trees.size() % checkpointInterval == 0) {
+                submitCheckpoint(*checkpointWriter, F, targetSum);
+            }
+        }
+        if (checkpointWriter && trees.size() > firstTree && trees.size() % checkpointInterval != 0) {
+            submitCheckpoint(*checkpointWriter, F, targetSum);
         }
         
-        // Calculate RMSE
-        Eigen::VectorXd predictions = predict(X);
-        rmse = std::sqrt((predictions - y).array().square().mean());
+        // Store the training predictions so a later warm start can resume from them
+        trainingPredictions = F;
+        trainingTargetSum = targetSum;
+        
+        // Calculate RMSE (F already holds the training predictions)
+        rmse = std::sqrt(weights.dot((F - y).array().square().matrix()) / sampleWeightSum);
         
         // Calculate feature importance
         calculateFeatureImportance();
@@ -121,9 +208,120 @@ bool GradientBoosting::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
     }
 }
 
+bool GradientBoosting::fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                       const std::vector<std::string>& variableNames,
+                       const std::string& targetName) {
+    try {
+        materializeTrees();
+        
+        // Check dimensions
+        if (static_cast<size_t>(y.size()) != data.rows()) {
+            std::cerr << "Error: Number of samples in binned data (" << data.rows() 
+                    << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
+            return false;
+        }
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        nSamples = static_cast<int>(data.rows());
+        sampleWeightSum = static_cast<double>(nSamples);
+        nFeatures = static_cast<int>(data.cols());
+        
+        // Store variable names
+        if (variableNames.size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = variableNames;
+        } else if (data.getFeatureNames().size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = data.getFeatureNames();
+        } else {
+            inputVariableNames.clear();
+            for (int i = 0; i < nFeatures; ++i) {
+                inputVariableNames.push_back("Variable_" + std::to_string(i+1));
+            }
+        }
+        
+        // Store target variable name
+        if (!targetName.empty()) {
+            targetVariableName = targetName;
+        } else {
+            targetVariableName = data.getTargetName().empty() ? "Target" : data.getTargetName();
+        }
+        
+        // Binned training treats every feature as numeric
+        categoricalMask.assign(nFeatures, false);
+        
+        HistogramTree::Params params;
+        params.maxDepth = maxDepth;
+        params.minChildWeight = minSamplesLeaf;
+        params.minSplitWeight = std::max(minSamplesSplit, minSamplesLeaf + 1);
+        
+        std::vector<int> allFeatureIndices(nFeatures);
+        std::iota(allFeatureIndices.begin(), allFeatureIndices.end(), 0);
+        auto selectFeatures = [&allFeatureIndices]() { return allFeatureIndices; };
+        auto leafValue = [](double sum, double count) { return count > 0.0 ? sum / count : 0.0; };
+        Eigen::VectorXd ones = Eigen::VectorXd::Ones(nSamples);
+        
+        // The member generator, so a fixed seed also makes binned fits reproducible
+        if (randomSeed >= 0) {
+            rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+        }
+        
+        // Initialize model with the constant value minimizing the loss
+        trees.clear();
+        initialPrediction = calculateInitialPrediction(y, ones);
+        Eigen::VectorXd F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        
+        for (int m = 0; m < nEstimators; ++m) {
+            Eigen::VectorXd residuals = calculatePseudoResiduals(y, F);
+            
+            // Subsample for this tree
+            std::vector<int> sampleIndices(nSamples);
+            std::iota(sampleIndices.begin(), sampleIndices.end(), 0);
+            if (subsample < 1.0) {
+                std::shuffle(sampleIndices.begin(), sampleIndices.end(), rng);
+                sampleIndices.resize(static_cast<int>(nSamples * subsample));
+            }
+            
+            RegressionTree tree(nFeatures);
+            auto onSplit = [&tree](TreeNode& node, int feature, double gain, double count) {
+                node.impurityDecrease = gain / count;
+                tree.featureImportance[feature] += gain;
+            };
+            tree.root = HistogramTree::build<TreeNode>(data, sampleIndices, residuals, ones, params,
+                                                       leafValue, selectFeatures, onSplit);
+            
+            if (loss != "squared_error") {
+                refitLeafValues(tree.root, sampleIndices, y - F, ones,
+                    [&data](const std::shared_ptr<TreeNode>& node, int idx) {
+                        return HistogramTree::goesLeft(node, data, idx);
+                    });
+            }
+            
+            for (int i = 0; i < nSamples; ++i) {
+                F(i) += learningRate * HistogramTree::predict(tree.root, data, i);
+            }
+            trees.push_back(tree);
+        }
+        
+        // The stored predictions belong to the raw-data path, so warm start is not possible
+        trainingPredictions.resize(0);
+        
+        rmse = std::sqrt((F - y).array().square().mean());
+        calculateFeatureImportance();
+        
+        isFitted = true;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting Gradient Boosting model: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::buildTree(
     const Eigen::MatrixXd& X, 
     const Eigen::VectorXd& residuals,
+    const Eigen::VectorXd& weights,
     const std::vector<int>& sampleIndices,
     int depth,
     RegressionTree& tree) {
@@ -131,13 +329,20 @@ std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::buildTree(
     // Create a new node
     auto node = std::make_shared<TreeNode>();
     
+    // Sample counts are weight sums, so a row with weight k counts as k samples
+    double nodeWeight = 0.0;
+    for (int idx : sampleIndices) {
+        nodeWeight += weights(idx);
+    }
+    node->cover = nodeWeight;
+    
     // Check stopping criteria
     if (depth >= maxDepth || 
-        static_cast<int>(sampleIndices.size()) < minSamplesSplit || 
-        static_cast<int>(sampleIndices.size()) <= minSamplesLeaf) {
+        nodeWeight < minSamplesSplit || 
+        nodeWeight <= minSamplesLeaf) {
         
         node->isLeaf = true;
-        node->outputValue = calculateMean(residuals, sampleIndices);
+        node->outputValue = calculateMean(residuals, weights, sampleIndices);
         return node;
     }
     
@@ -147,17 +352,17 @@ std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::buildTree(
     double bestScore;
     double impurityDecrease;
     std::vector<int> leftIndices, rightIndices;
+    std::vector<uint64_t> bestCategories;
+    bool bestMissingLeft = false;
     
-    findBestSplit(X, residuals, sampleIndices, bestFeatureIndex, bestSplitValue, 
-                bestScore, impurityDecrease, leftIndices, rightIndices);
+    findBestSplit(X, residuals, weights, sampleIndices, bestFeatureIndex, bestSplitValue, 
+                bestScore, impurityDecrease, leftIndices, rightIndices, bestCategories, bestMissingLeft);
     
     // If we couldn't find a good split or one side is empty, make it a leaf
-    if (bestFeatureIndex == -1 || leftIndices.empty() || rightIndices.empty() || 
-        static_cast<int>(leftIndices.size()) < minSamplesLeaf || 
-        static_cast<int>(rightIndices.size()) < minSamplesLeaf) {
-        
+    // (findBestSplit already enforces minSamplesLeaf on the child weights)
+    if (bestFeatureIndex == -1 || leftIndices.empty() || rightIndices.empty()) {
         node->isLeaf = true;
-        node->outputValue = calculateMean(residuals, sampleIndices);
+        node->outputValue = calculateMean(residuals, weights, sampleIndices);
         return node;
     }
     
@@ -165,14 +370,18 @@ std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::buildTree(
     node->isLeaf = false;
     node->featureIndex = bestFeatureIndex;
     node->splitValue = bestSplitValue;
+    node->isCategorical = !bestCategories.empty();
+    node->categoryBitset = bestCategories;
+    node->defaultLeft = bestMissingLeft;
     node->impurityDecrease = impurityDecrease;
+    node->gain = nodeWeight * impurityDecrease;
     
     // Update feature importance in this tree
-    tree.featureImportance[bestFeatureIndex] += impurityDecrease * sampleIndices.size();
+    tree.featureImportance[bestFeatureIndex] += impurityDecrease * nodeWeight;
     
     // Recursively build left and right subtrees
-    node->leftChild = buildTree(X, residuals, leftIndices, depth + 1, tree);
-    node->rightChild = buildTree(X, residuals, rightIndices, depth + 1, tree);
+    node->leftChild = buildTree(X, residuals, weights, leftIndices, depth + 1, tree);
+    node->rightChild = buildTree(X, residuals, weights, rightIndices, depth + 1, tree);
     
     return node;
 }
@@ -180,119 +389,108 @@ std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::buildTree(
 void GradientBoosting::findBestSplit(
     const Eigen::MatrixXd& X,
     const Eigen::VectorXd& residuals,
+    const Eigen::VectorXd& weights,
     const std::vector<int>& sampleIndices,
     int& bestFeatureIndex,
     double& bestSplitValue,
     double& bestScore,
     double& impurityDecrease,
     std::vector<int>& leftIndices,
-    std::vector<int>& rightIndices) {
+    std::vector<int>& rightIndices,
+    std::vector<uint64_t>& bestCategories,
+    bool& bestMissingLeft) {
     
     // Initialize best values
     bestScore = std::numeric_limits<double>::lowest();
     bestFeatureIndex = -1;
     bestSplitValue = 0.0;
+    bestCategories.clear();
+    bestMissingLeft = false;
     impurityDecrease = 0.0;
     
-    // Calculate the MSE before splitting
-    double nodeMSE = calculateMSE(residuals, sampleIndices);
-    double nodeSize = static_cast<double>(sampleIndices.size());
+    double nodeSize = 0.0;
+    for (int idx : sampleIndices) {
+        nodeSize += weights(idx);
+    }
     
     // Try splitting on each feature
     for (int featIdx = 0; featIdx < nFeatures; ++featIdx) {
-        // Sort sample indices by the feature value
-        std::vector<std::pair<double, int>> featureValueIndices;
-        for (int idx : sampleIndices) {
-            featureValueIndices.push_back({X(idx, featIdx), idx});
-        }
-        
-        std::sort(featureValueIndices.begin(), featureValueIndices.end());
-        
-        // Try each possible split point
-        for (size_t i = 0; i < featureValueIndices.size() - 1; ++i) {
-            // Skip if the next value is the same as the current one
-            if (i < featureValueIndices.size() - 1 && 
-                featureValueIndices[i].first == featureValueIndices[i + 1].first) {
-                continue;
-            }
-            
-            // Generate left and right sample indices
-            std::vector<int> tempLeftIndices, tempRightIndices;
-            for (const auto& pair : featureValueIndices) {
-                if (pair.first <= featureValueIndices[i].first) {
-                    tempLeftIndices.push_back(pair.second);
-                } else {
-                    tempRightIndices.push_back(pair.second);
-                }
-            }
-            
-            // Skip if either side has too few samples
-            if (static_cast<int>(tempLeftIndices.size()) < minSamplesLeaf || 
-                static_cast<int>(tempRightIndices.size()) < minSamplesLeaf) {
-                continue;
-            }
-            
-            // Calculate MSE after splitting
-            double leftMSE = calculateMSE(residuals, tempLeftIndices);
-            double rightMSE = calculateMSE(residuals, tempRightIndices);
+        // Categorical features use a Fisher-ordered partition of their categories
+        if (isCategoricalFeature(featIdx)) {
+            CategoricalSplit::Result split = CategoricalSplit::findBestPartition(
+                sampleIndices,
+                [&X, featIdx](int idx) { return X(idx, featIdx); },
+                [&residuals, &weights](int idx) { return weights(idx) * residuals(idx); },
+                [&weights](int idx) { return weights(idx); },
+                static_cast<double>(minSamplesLeaf));
             
-            // Calculate weighted MSE reduction (score)
-            double leftSize = static_cast<double>(tempLeftIndices.size());
-            double rightSize = static_cast<double>(tempRightIndices.size());
-            
-            double weightedMSE = (leftSize * leftMSE + rightSize * rightMSE) / nodeSize;
-            double score = nodeMSE - weightedMSE;
-            
-            // Check if this is the best split so far
-            if (score > bestScore) {
+            // The partition gain is a reduction of the summed squared error
+            double score = split.gain / nodeSize;
+            if (split.found && score > bestScore) {
                 bestScore = score;
                 bestFeatureIndex = featIdx;
+                bestSplitValue = 0.0;
+                bestCategories = split.leftCategories;
+                bestMissingLeft = split.missingLeft;
+                impurityDecrease = score;
                 
-                // Use average of current and next value as split point if possible
-                if (i < featureValueIndices.size() - 1) {
-                    bestSplitValue = (featureValueIndices[i].first + featureValueIndices[i + 1].first) / 2.0;
+                leftIndices.clear();
+                rightIndices.clear();
+                for (int idx : sampleIndices) {
+                    if (CategoricalSplit::goesLeft(bestCategories, X(idx, featIdx), bestMissingLeft)) {
+                        leftIndices.push_back(idx);
+                    } else {
+                        rightIndices.push_back(idx);
+                    }
+                }
+            }
+            continue;
+        }
+        
+        // Sweep thresholds over the present values, trying missing values on both sides
+        ThresholdSplit::Result split = ThresholdSplit::findBestThreshold(
+            sampleIndices,
+            [&X, featIdx](int idx) { return X(idx, featIdx); },
+            [&residuals, &weights](int idx) { return weights(idx) * residuals(idx); },
+            [&weights](int idx) { return weights(idx); },
+            static_cast<double>(minSamplesLeaf));
+        
+        // The split gain is a reduction of the summed squared error
+        double score = split.gain / nodeSize;
+        
+        // Check if this is the best split so far
+        if (split.found && score > bestScore) {
+            bestScore = score;
+            bestFeatureIndex = featIdx;
+            bestSplitValue = split.threshold;
+            bestMissingLeft = split.missingLeft;
+            bestCategories.clear();
+            impurityDecrease = score;
+            
+            // Update the sample indices for left and right children
+            leftIndices.clear();
+            rightIndices.clear();
+            for (int idx : sampleIndices) {
+                if (ThresholdSplit::goesLeft(X(idx, featIdx), bestSplitValue, bestMissingLeft)) {
+                    leftIndices.push_back(idx);
                 } else {
-                    bestSplitValue = featureValueIndices[i].first;
+                    rightIndices.push_back(idx);
                 }
-                
-                // Calculate impurity decrease
-                impurityDecrease = nodeMSE - weightedMSE;
-                
-                // Update the sample indices for left and right children
-                leftIndices = tempLeftIndices;
-                rightIndices = tempRightIndices;
             }
         }
     }
 }
 
-double GradientBoosting::calculateMSE(const Eigen::VectorXd& residuals, const std::vector<int>& indices) const {
-    if (indices.empty()) {
-        return 0.0;
-    }
-    
-    double mean = calculateMean(residuals, indices);
-    
-    double sumSquaredDiff = 0.0;
-    for (int idx : indices) {
-        double diff = residuals(idx) - mean;
-        sumSquaredDiff += diff * diff;
-    }
-    
-    return sumSquaredDiff / indices.size();
-}
-
-double GradientBoosting::calculateMean(const Eigen::VectorXd& residuals, const std::vector<int>& indices) const {
-    if (indices.empty()) {
-        return 0.0;
-    }
-    
+double GradientBoosting::calculateMean(const Eigen::VectorXd& residuals, const Eigen::VectorXd& weights,
+                                       const std::vector<int>& indices) const {
     double sum = 0.0;
+    double totalWeight = 0.0;
     for (int idx : indices) {
-        sum += residuals(idx);
+        sum += weights(idx) * residuals(idx);
+        totalWeight += weights(idx);
     }
     
-    return sum / indices.size();
+    return totalWeight > 0.0 ? sum / totalWeight : 0.0;
 }
 
 Eigen::VectorXd GradientBoosting::calculatePseudoResiduals(
@@ -311,23 +509,163 @@ Eigen::VectorXd GradientBoosting::calculatePseudoResiduals(
         return residuals;
     } else if (loss == "huber") {
         // For Huber loss, combine MSE and MAE
-        const double delta = 1.0;  // Threshold parameter
         Eigen::VectorXd residuals(y.size());
         for (int i = 0; i < y.size(); ++i) {
             double diff = y(i) - predictions(i);
-            if (std::abs(diff) <= delta) {
+            if (std::abs(diff) <= huberDelta) {
                 residuals(i) = diff;  // MSE gradient for small errors
             } else {
-                residuals(i) = delta * ((diff > 0) ? 1.0 : -1.0);  // MAE gradient for large errors
+                residuals(i) = huberDelta * ((diff > 0) ? 1.0 : -1.0);  // MAE gradient for large errors
             }
         }
         return residuals;
+    } else if (loss == "quantile") {
+        // For quantile (pinball) loss, under-predictions weigh alpha, over-predictions 1 - alpha
+        Eigen::VectorXd residuals(y.size());
+        for (int i = 0; i < y.size(); ++i) {
+            residuals(i) = (y(i) > predictions(i)) ? alpha : alpha - 1.0;
+        }
+        return residuals;
     } else {
         // Default to squared error
         return y - predictions;
     }
 }
 
+namespace {
+
+// Linearly interpolated quantile of weighted values (value, weight), sorts the values.
+// A value with integer weight k is treated as k copies of it.
+double quantileOf(std::vector<std::pair<double, double>>& values, double q) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    double totalWeight = 0.0;
+    for (const auto& value : values) {
+        totalWeight += value.second;
+    }
+    
+    // Value at a rank of the (virtually) expanded sorted sample
+    auto valueAtRank = [&values](double rank) {
+        double cumulative = 0.0;
+        for (const auto& value : values) {
+            cumulative += value.second;
+            if (cumulative > rank) {
+                return value.first;
+            }
+        }
+        return values.back().first;
+    };
+    
+    double position = q * std::max(totalWeight - 1.0, 0.0);
+    double lower = std::floor(position);
+    double lowerValue = valueAtRank(lower);
+    if (position == lower) {
+        return lowerValue;
+    }
+    double upperValue = valueAtRank(std::ceil(position));
+    return lowerValue + (position - lower) * (upperValue - lowerValue);
+}
+
+} // namespace
+
+double GradientBoosting::calculateInitialPrediction(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const {
+    if (loss == "squared_error") {
+        return weights.dot(y) / weights.sum();
+    }
+    std::vector<std::pair<double, double>> values;
+    values.reserve(y.size());
+    for (int i = 0; i < y.size(); ++i) {
+        values.push_back({y(i), weights(i)});
+    }
+    return calculateOptimalLeafValue(values);
+}
+
+double GradientBoosting::calculateOptimalLeafValue(std::vector<std::pair<double, double>>& residuals) const {
+    if (residuals.empty()) {
+        return 0.0;
+    }
+    
+    if (loss == "absolute_error") {
+        return quantileOf(residuals, 0.5);
+    } else if (loss == "quantile") {
+        return quantileOf(residuals, alpha);
+    } else if (loss == "huber") {
+        // IRLS from the median: each step is a Newton step on the Huber loss,
+        // whose curvature is the number of residuals inside the quadratic zone
+        double value = quantileOf(residuals, 0.5);
+        for (int iter = 0; iter < 20; ++iter) {
+            double gradientSum = 0.0;
+            double curvature = 0.0;
+            double totalWeight = 0.0;
+            for (const auto& r : residuals) {
+                double diff = r.first - value;
+                if (std::abs(diff) <= huberDelta) {
+                    gradientSum += r.second * diff;
+                    curvature += r.second;
+                } else {
+                    gradientSum += r.second * huberDelta * ((diff > 0) ? 1.0 : -1.0);
+                }
+                totalWeight += r.second;
+            }
+            
+            // Without residuals in the quadratic zone, take Friedman's single step
+            double step = curvature > 0.0 ? gradientSum / curvature
+                                           : gradientSum / totalWeight;
+            value += step;
+            if (curvature == 0.0 || std::abs(step) < 1e-10 * (1.0 + std::abs(value))) {
+                break;
+            }
+        }
+        return value;
+    }
+    
+    double sum = 0.0;
+    double totalWeight = 0.0;
+    for (const auto& r : residuals) {
+        sum += r.second * r.first;
+        totalWeight += r.second;
+    }
+    return totalWeight > 0.0 ? sum / totalWeight : 0.0;
+}
+
+void GradientBoosting::refitLeafValues(
+    const std::shared_ptr<TreeNode>& root,
+    const std::vector<int>& sampleIndices,
+    const Eigen::VectorXd& rawResiduals,
+    const Eigen::VectorXd& weights,
+    const std::function<bool(const std::shared_ptr<TreeNode>&, int)>& goesLeft) const {
+    
+    if (!root) {
+        return;
+    }
+    
+    if (root->isLeaf) {
+        if (sampleIndices.empty()) {
+            return;
+        }
+        std::vector<std::pair<double, double>> residuals;
+        residuals.reserve(sampleIndices.size());
+        for (int idx : sampleIndices) {
+            residuals.push_back({rawResiduals(idx), weights(idx)});
+        }
+        root->outputValue = calculateOptimalLeafValue(residuals);
+        return;
+    }
+    
+    std::vector<int> leftIndices, rightIndices;
+    for (int idx : sampleIndices) {
+        if (goesLeft(root, idx)) {
+            leftIndices.push_back(idx);
+        } else {
+            rightIndices.push_back(idx);
+        }
+    }
+    refitLeafValues(root->leftChild, leftIndices, rawResiduals, weights, goesLeft);
+    refitLeafValues(root->rightChild, rightIndices, rawResiduals, weights, goesLeft);
+}
+
 double GradientBoosting::predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const {
     if (!node) {
         return 0.0;
@@ -337,8 +675,16 @@ double GradientBoosting::predictTree(const Eigen::VectorXd& x, const std::shared
         return node->outputValue;
     }
     
+    // Categorical nodes send the categories in the bitset to the left child
+    if (node->isCategorical) {
+        if (CategoricalSplit::goesLeft(node->categoryBitset, x(node->featureIndex), node->defaultLeft)) {
+            return predictTree(x, node->leftChild);
+        }
+        return predictTree(x, node->rightChild);
+    }
+    
     // Navigate to the appropriate child based on the feature value
-    if (x(node->featureIndex) <= node->splitValue) {
+    if (ThresholdSplit::goesLeft(x(node->featureIndex), node->splitValue, node->defaultLeft)) {
         return predictTree(x, node->leftChild);
     } else {
         return predictTree(x, node->rightChild);
@@ -346,6 +692,11 @@ double GradientBoosting::predictTree(const Eigen::VectorXd& x, const std::shared
 }
 
 Eigen::VectorXd GradientBoosting::predict(const Eigen::MatrixXd& X) const {
+    return predictInBlocks(X);
+}
+
+void GradientBoosting::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                                   Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -355,18 +706,347 @@ Eigen::VectorXd GradientBoosting::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
     
     // Initialize predictions with the initial prediction (global mean)
-    Eigen::VectorXd predictions = Eigen::VectorXd::Constant(X.rows(), initialPrediction);
+    predictions.setConstant(initialPrediction);
+    
+    // A loaded ensemble is scored from the mapped node arrays
+    if (!flatTrees.empty()) {
+        flatTrees.accumulate(X, learningRate, predictions);
+        return;
+    }
+    
+    // Add contributions from each tree, copying each row once for all tree walks
+    Eigen::VectorXd row(nFeatures);
+    for (Eigen::Index i = 0; i < X.rows(); ++i) {
+        row = X.row(i).transpose();
+        for (const auto& tree : trees) {
+            predictions(i) += learningRate * predictTree(row, tree.root);
+        }
+    }
+}
+
+template <typename T>
+double GradientBoosting::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
     
-    // Add contributions from each tree
+    // Trees are added in order to the initial prediction, as in predictInto
+    double sum = initialPrediction;
+    if (!flatTrees.empty()) {
+        for (size_t t = 0; t < flatTrees.treeCount(); ++t) {
+            sum += learningRate * flatTrees.predictTree(t, features, 1);
+        }
+        return sum;
+    }
     for (const auto& tree : trees) {
-        for (int i = 0; i < X.rows(); ++i) {
-            predictions(i) += learningRate * predictTree(X.row(i), tree.root);
+        sum += learningRate * TreeWalk::leafValue(tree.root.get(), features);
+    }
+    return sum;
+}
+
+double GradientBoosting::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double GradientBoosting::predictOne(const float* features) const noexcept {
+    return predictRow(features);
+}
+
+void GradientBoosting::setWarmStart(bool enabled) {
+    warmStart = enabled;
+}
+
+bool GradientBoosting::getWarmStart() const {
+    return warmStart;
+}
+
+void GradientBoosting::setNEstimators(int n_estimators) {
+    nEstimators = n_estimators;
+}
+
+void GradientBoosting::setAlpha(double alpha) {
+    if (alpha <= 0.0 || alpha >= 1.0) {
+        throw std::invalid_argument("Quantile alpha must be between 0 and 1");
+    }
+    this->alpha = alpha;
+}
+
+void GradientBoosting::setHuberDelta(double delta) {
+    if (delta <= 0.0) {
+        throw std::invalid_argument("Huber delta must be positive");
+    }
+    huberDelta = delta;
+}
+
+void GradientBoosting::setRandomSeed(int seed) {
+    randomSeed = seed < 0 ? -1 : seed;
+}
+
+void GradientBoosting::setCheckpoint(const std::string& filePath, int interval) {
+    if (interval < 1) {
+        throw std::invalid_argument("Checkpoint interval must be at least 1 tree");
+    }
+    checkpointPath = filePath;
+    checkpointInterval = interval;
+}
+
+void GradientBoosting::submitCheckpoint(CheckpointWriter& writer, const Eigen::VectorXd& F,
+                                        double targetSum) const {
+    // The trees are not modified after they are added, so the writer thread
+    // can share them; everything else is copied
+    writer.submit([trees = trees, F = Eigen::VectorXd(F), generator = rng, targetSum,
+                   loss = loss, names = inputVariableNames, target = targetVariableName,
+                   rows = nSamples, features = nFeatures, weightSum = sampleWeightSum,
+                   initial = initialPrediction](std::vector<char>& buffer) {
+        using namespace BinaryBuffer;
+        appendValue<int64_t>(buffer, rows);
+        appendValue<int32_t>(buffer, features);
+        appendValue<double>(buffer, weightSum);
+        appendValue<double>(buffer, targetSum);
+        appendString(buffer, loss);
+        appendValue<double>(buffer, initial);
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(names.size()));
+        for (const auto& name : names) {
+            appendString(buffer, name);
+        }
+        appendString(buffer, target);
+        
+        std::ostringstream generatorState;
+        generatorState << generator;
+        appendString(buffer, generatorState.str());
+        appendMatrix(buffer, F);
+        
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(trees.size()));
+        for (const auto& tree : trees) {
+            appendDoubles(buffer, tree.featureImportance);
+            serializeTree(tree.root, buffer);
+        }
+    });
+}
+
+void GradientBoosting::resumeFromCheckpoint(const std::string& filePath) {
+    using namespace BinaryBuffer;
+    std::vector<char> buffer = CheckpointWriter::readPayload(filePath, getName());
+    size_t offset = 0;
+    int rows = static_cast<int>(readValue<int64_t>(buffer, offset));
+    int features = readValue<int32_t>(buffer, offset);
+    double weightSum = readValue<double>(buffer, offset);
+    double targetSum = readValue<double>(buffer, offset);
+    std::string storedLoss = readString(buffer, offset);
+    double initial = readValue<double>(buffer, offset);
+    std::vector<std::string> names(readValue<uint32_t>(buffer, offset));
+    for (auto& name : names) {
+        name = readString(buffer, offset);
+    }
+    std::string target = readString(buffer, offset);
+    
+    std::istringstream generatorState(readString(buffer, offset));
+    std::mt19937 generator;
+    generatorState >> generator;
+    if (!generatorState) {
+        throw std::runtime_error("Malformed generator state in checkpoint");
+    }
+    Eigen::VectorXd F = readVector(buffer, offset);
+    
+    std::vector<RegressionTree> storedTrees;
+    uint32_t treeCount = readValue<uint32_t>(buffer, offset);
+    for (uint32_t t = 0; t < treeCount; ++t) {
+        RegressionTree tree(features);
+        tree.featureImportance = readDoubles(buffer, offset);
+        tree.root = deserializeTree(buffer, offset);
+        if (tree.featureImportance.size() != static_cast<size_t>(features)) {
+            throw std::runtime_error("Malformed tree in checkpoint");
+        }
+        storedTrees.push_back(std::move(tree));
+    }
+    if (F.size() != rows || names.size() != static_cast<size_t>(features)) {
+        throw std::runtime_error("Checkpoint sizes do not match");
+    }
+    
+    // Only change the model once the whole file has been read
+    nSamples = rows;
+    nFeatures = features;
+    sampleWeightSum = weightSum;
+    trainingTargetSum = targetSum;
+    loss = storedLoss;
+    initialPrediction = initial;
+    inputVariableNames = names;
+    targetVariableName = target;
+    rng = generator;
+    trainingPredictions = F;
+    trees = std::move(storedTrees);
+    flatTrees = FlatForest();
+    flatTreeImportance.resize(0, 0);
+    categoricalMask.assign(nFeatures, false);
+    for (int idx : categoricalFeatureIndices) {
+        if (idx >= 0 && idx < nFeatures) {
+            categoricalMask[idx] = true;
+        }
+    }
+    calculateFeatureImportance();
+    isFitted = true;
+    resumePending = true;
+}
+
+void GradientBoosting::serializeTree(const std::shared_ptr<TreeNode>& node, std::vector<char>& buffer) {
+    using namespace BinaryBuffer;
+    appendValue<uint8_t>(buffer, node->isLeaf ? 1 : 0);
+    appendValue<uint8_t>(buffer, node->isCategorical ? 1 : 0);
+    appendValue<uint8_t>(buffer, node->defaultLeft ? 1 : 0);
+    appendValue<int32_t>(buffer, node->featureIndex);
+    appendValue<double>(buffer, node->splitValue);
+    appendValue<double>(buffer, node->outputValue);
+    appendValue<double>(buffer, node->impurityDecrease);
+    appendValue<double>(buffer, node->cover);
+    appendValue<double>(buffer, node->gain);
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(node->categoryBitset.size()));
+    for (uint64_t word : node->categoryBitset) {
+        appendValue<uint64_t>(buffer, word);
+    }
+    if (!node->isLeaf) {
+        serializeTree(node->leftChild, buffer);
+        serializeTree(node->rightChild, buffer);
+    }
+}
+
+std::shared_ptr<GradientBoosting::TreeNode> GradientBoosting::deserializeTree(const std::vector<char>& buffer,
+                                                                              size_t& offset) {
+    using namespace BinaryBuffer;
+    auto node = std::make_shared<TreeNode>();
+    node->isLeaf = readValue<uint8_t>(buffer, offset) != 0;
+    node->isCategorical = readValue<uint8_t>(buffer, offset) != 0;
+    node->defaultLeft = readValue<uint8_t>(buffer, offset) != 0;
+    node->featureIndex = readValue<int32_t>(buffer, offset);
+    node->splitValue = readValue<double>(buffer, offset);
+    node->outputValue = readValue<double>(buffer, offset);
+    node->impurityDecrease = readValue<double>(buffer, offset);
+    node->cover = readValue<double>(buffer, offset);
+    node->gain = readValue<double>(buffer, offset);
+    uint32_t words = readValue<uint32_t>(buffer, offset);
+    for (uint32_t i = 0; i < words; ++i) {
+        node->categoryBitset.push_back(readValue<uint64_t>(buffer, offset));
+    }
+    if (!node->isLeaf) {
+        node->leftChild = deserializeTree(buffer, offset);
+        node->rightChild = deserializeTree(buffer, offset);
+    }
+    return node;
+}
+
+std::unordered_map<std::string, double> GradientBoosting::compact(const Eigen::MatrixXd& calibrationX,
+                                                          double leafEpsilon,
+                                                          double treeTolerance) {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    bool hasCalibration = calibrationX.rows() > 0;
+    if (hasCalibration && calibrationX.cols() != nFeatures) {
+        throw std::invalid_argument("Number of features in calibration data (" + std::to_string(calibrationX.cols()) + 
+                                   ") does not match the number of features the model was trained on (" + 
+                                   std::to_string(nFeatures) + ")");
+    }
+    
+    materializeTrees();
+    std::unordered_map<std::string, double> report;
+    
+    auto countAllNodes = [this]() {
+        int total = 0;
+        for (const auto& tree : trees) {
+            total += TreeCompaction::countNodes(tree.root);
         }
+        return total;
+    };
+    
+    report["trees_before"] = static_cast<double>(trees.size());
+    report["nodes_before"] = static_cast<double>(countAllNodes());
+    
+    // Reference predictions and latency of the uncompacted ensemble
+    Eigen::VectorXd reference;
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        reference = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_before"] = std::chrono::duration<double, std::milli>(end - start).count();
     }
     
-    return predictions;
+    // Node-level compaction of every tree
+    for (auto& tree : trees) {
+        tree.root = TreeCompaction::compactTree(tree.root, nFeatures, leafEpsilon);
+    }
+    
+    // Drop trees whose shrunken contribution keeps the predictions within tolerance
+    if (hasCalibration && !trees.empty()) {
+        int nTrees = static_cast<int>(trees.size());
+        Eigen::MatrixXd contributions(calibrationX.rows(), nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            for (int i = 0; i < calibrationX.rows(); ++i) {
+                contributions(i, t) = learningRate * predictTree(calibrationX.row(i), trees[t].root);
+            }
+        }
+        
+        // Try the trees with the smallest contribution first
+        std::vector<int> order(nTrees);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<double> magnitude(nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            magnitude[t] = contributions.col(t).cwiseAbs().maxCoeff();
+        }
+        std::sort(order.begin(), order.end(), [&magnitude](int a, int b) {
+            return magnitude[a] < magnitude[b];
+        });
+        
+        Eigen::VectorXd current = Eigen::VectorXd::Constant(calibrationX.rows(), initialPrediction) +
+                                  contributions.rowwise().sum();
+        std::vector<bool> keep(nTrees, true);
+        
+        for (int t : order) {
+            Eigen::VectorXd candidate = current - contributions.col(t);
+            if ((candidate - reference).cwiseAbs().maxCoeff() < treeTolerance) {
+                current = candidate;
+                keep[t] = false;
+            }
+        }
+        
+        std::vector<RegressionTree> keptTrees;
+        for (int t = 0; t < nTrees; ++t) {
+            if (keep[t]) {
+                keptTrees.push_back(trees[t]);
+            }
+        }
+        trees = std::move(keptTrees);
+    }
+    
+    // The stored training predictions no longer match the trees
+    trainingPredictions.resize(0);
+    
+    calculateFeatureImportance();
+    
+    report["trees_after"] = static_cast<double>(trees.size());
+    report["nodes_after"] = static_cast<double>(countAllNodes());
+    
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        Eigen::VectorXd compacted = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_after"] = std::chrono::duration<double, std::milli>(end - start).count();
+        report["max_prediction_change"] = (compacted - reference).cwiseAbs().maxCoeff();
+    }
+    
+    return report;
+}
+
+void GradientBoosting::setCategoricalFeatures(const std::vector<int>& featureIndices) {
+    categoricalFeatureIndices = featureIndices;
+}
+
+bool GradientBoosting::isCategoricalFeature(int featureIndex) const {
+    return featureIndex >= 0 && featureIndex < static_cast<int>(categoricalMask.size()) &&
+           categoricalMask[featureIndex];
 }
 
 std::string GradientBoosting::getName() const {
@@ -381,6 +1061,9 @@ std::unordered_map<std::string, double> GradientBoosting::getParameters() const
     params["min_samples_split"] = static_cast<double>(minSamplesSplit);
     params["min_samples_leaf"] = static_cast<double>(minSamplesLeaf);
     params["subsample"] = subsample;
+    params["alpha"] = alpha;
+    params["huber_delta"] = huberDelta;
+    params["random_seed"] = static_cast<double>(randomSeed);
     
     return params;
 }
@@ -388,9 +1071,9 @@ std::unordered_map<std::string, double> GradientBoosting::getParameters() const
 std::unordered_map<std::string, double> GradientBoosting::getStatistics() const {
     std::unordered_map<std::string, double> stats;
     stats["rmse"] = rmse;
-    stats["n_samples"] = static_cast<double>(nSamples);
+    stats["n_samples"] = sampleWeightSum;
     stats["n_features"] = static_cast<double>(nFeatures);
-    stats["n_trees"] = static_cast<double>(trees.size());
+    stats["n_trees"] = static_cast<double>(getTreeCount());
     
     return stats;
 }
@@ -466,4 +1149,145 @@ std::unordered_map<std::string, double> GradientBoosting::getFeatureImportance()
     }
     
     return featureImportanceScores;
-} 
\ No newline at end of file
+}
+
+size_t GradientBoosting::getTreeCount() const {
+    return flatTrees.empty() ? trees.size() : flatTrees.treeCount();
+}
+
+std::vector<TreeInspection::NodeInfo> GradientBoosting::inspectTree(size_t treeIndex, int nodeId, int maxDepth) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    if (treeIndex >= getTreeCount()) {
+        throw std::out_of_range("Tree index " + std::to_string(treeIndex) + " is out of range");
+    }
+    if (!flatTrees.empty()) {
+        return TreeInspection::collect(flatTrees.buildTree<TreeNode>(treeIndex), nodeId, maxDepth);
+    }
+    return TreeInspection::collect(trees[treeIndex].root, nodeId, maxDepth);
+}
+
+void GradientBoosting::materializeTrees() {
+    if (flatTrees.empty()) {
+        return;
+    }
+    std::vector<RegressionTree> built;
+    for (size_t t = 0; t < flatTrees.treeCount(); ++t) {
+        RegressionTree tree(nFeatures);
+        tree.root = flatTrees.buildTree<TreeNode>(t);
+        tree.featureImportance.assign(flatTreeImportance.col(t).data(),
+                                      flatTreeImportance.col(t).data() + nFeatures);
+        built.push_back(std::move(tree));
+    }
+    trees = std::move(built);
+    flatTrees = FlatForest();
+    flatTreeImportance.resize(0, 0);
+}
+
+void GradientBoosting::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    writer.putValue<double>("learning_rate", learningRate);
+    writer.putValue<int32_t>("n_estimators", nEstimators);
+    writer.putValue<int32_t>("max_depth", maxDepth);
+    writer.putValue<int32_t>("min_samples_split", minSamplesSplit);
+    writer.putValue<int32_t>("min_samples_leaf", minSamplesLeaf);
+    writer.putValue<double>("subsample", subsample);
+    writer.putString("loss", loss);
+    writer.putValue<double>("alpha", alpha);
+    writer.putValue<double>("huber_delta", huberDelta);
+    writer.putValue<uint8_t>("warm_start", warmStart ? 1 : 0);
+    writer.putValue<int32_t>("random_seed", randomSeed);
+    writer.putArray("categorical_indices", std::vector<int32_t>(categoricalFeatureIndices.begin(),
+                                                                categoricalFeatureIndices.end()));
+    
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putValue<double>("sample_weight_sum", sampleWeightSum);
+    writer.putValue<int32_t>("n_features", nFeatures);
+    writer.putValue<double>("rmse", rmse);
+    writer.putValue<double>("initial_prediction", initialPrediction);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+    
+    // Training predictions let a loaded model continue with a warm start
+    writer.putVector("training_predictions", trainingPredictions);
+    writer.putValue<double>("training_target_sum", trainingTargetSum);
+    
+    std::vector<double> importance;
+    for (const auto& name : inputVariableNames) {
+        importance.push_back(featureImportanceScores.at(name));
+    }
+    writer.putArray("feature_importance", importance);
+    
+    if (!flatTrees.empty()) {
+        writer.putMatrix("trees.importance", flatTreeImportance);
+        flatTrees.write(writer);
+        return;
+    }
+    Eigen::MatrixXd treeImportance(nFeatures, static_cast<Eigen::Index>(trees.size()));
+    std::vector<std::shared_ptr<TreeNode>> roots;
+    for (size_t t = 0; t < trees.size(); ++t) {
+        treeImportance.col(t) = Eigen::Map<const Eigen::VectorXd>(trees[t].featureImportance.data(), nFeatures);
+        roots.push_back(trees[t].root);
+    }
+    writer.putMatrix("trees.importance", treeImportance);
+    FlatForest::fromTrees(roots).write(writer);
+}
+
+void GradientBoosting::readModel(const ModelFile::Reader& reader) {
+    int features = reader.value<int32_t>("n_features");
+    std::vector<std::string> names = reader.strings("variable_names");
+    auto importance = reader.array<double>("feature_importance");
+    auto categorical = reader.array<int32_t>("categorical_indices");
+    Eigen::MatrixXd treeImportance = reader.matrix("trees.importance");
+    FlatForest forest = FlatForest::fromFile(reader, features);
+    if (names.size() != static_cast<size_t>(features) ||
+        importance.size != static_cast<size_t>(features) || treeImportance.rows() != features ||
+        static_cast<size_t>(treeImportance.cols()) != forest.treeCount()) {
+        throw std::runtime_error("Gradient Boosting model file sizes do not match");
+    }
+    
+    learningRate = reader.value<double>("learning_rate");
+    nEstimators = reader.value<int32_t>("n_estimators");
+    maxDepth = reader.value<int32_t>("max_depth");
+    minSamplesSplit = reader.value<int32_t>("min_samples_split");
+    minSamplesLeaf = reader.value<int32_t>("min_samples_leaf");
+    subsample = reader.value<double>("subsample");
+    loss = reader.string("loss");
+    alpha = reader.value<double>("alpha");
+    huberDelta = reader.value<double>("huber_delta");
+    warmStart = reader.value<uint8_t>("warm_start") != 0;
+    randomSeed = reader.has("random_seed") ? reader.value<int32_t>("random_seed") : -1;
+    
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    sampleWeightSum = reader.value<double>("sample_weight_sum");
+    nFeatures = features;
+    rmse = reader.value<double>("rmse");
+    initialPrediction = reader.value<double>("initial_prediction");
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    trainingPredictions = reader.vector("training_predictions");
+    trainingTargetSum = reader.value<double>("training_target_sum");
+    
+    featureImportanceScores.clear();
+    for (int i = 0; i < nFeatures; ++i) {
+        featureImportanceScores[inputVariableNames[i]] = importance[i];
+    }
+    
+    categoricalFeatureIndices.assign(categorical.begin(), categorical.end());
+    categoricalMask.assign(nFeatures, false);
+    for (int idx : categoricalFeatureIndices) {
+        if (idx >= 0 && idx < nFeatures) {
+            categoricalMask[idx] = true;
+        }
+    }
+    
+    trees.clear();
+    flatTrees = forest;
+    flatTreeImportance = treeImportance;
+    resumePending = false;
+    isFitted = true;
+}
@@ -1,8 +1,15 @@
 #pragma once
 
 #include "models/Model.h"
+#include "models/FlatForest.h"
+#include "data/BinnedMatrix.h"
+#include "utils/CheckpointWriter.h"
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
 
 /**
  * @brief Gradient Boosting regression model
@@ -40,11 +47,31 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
      * @return bool True if fitting was successful, false otherwise
      */
     bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             const std::vector<std::string>& variableNames = {},
-            const std::string& targetName = "") override;
+            const std::string& targetName = "",
+            const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) override;
+
+    /**
+     * @brief Fit the Gradient Boosting model to binned data
+     * 
+     * Trees are grown from per-bin gradient histograms, so the raw feature
+     * matrix never needs to be in memory. Split thresholds are the bin cut
+     * values, and the fitted model predicts on raw data as usual. Categorical
+     * feature settings and warm start are not used on this path.
+     * 
+     * @param data Binned input features
+     * @param y Target variable (response variable)
+     * @param variableNames Names of the input variables (defaults to the binned feature names)
+     * @param targetName Name of the target variable
+     * @return bool True if fitting was successful, false otherwise
+     */
+    bool fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                  const std::vector<std::string>& variableNames = {},
+                  const std::string& targetName = "");
 
     /**
      * @brief Make predictions using the fitted Gradient Boosting model
@@ -54,6 +81,24 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::MatrixXd& X) const override;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * @param X Input features for prediction, read in place
+     * @param predictions Output span with one element per row of X
+     */
+    void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                     Eigen::Ref<Eigen::VectorXd> predictions) const override;
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * @param features First of the row's feature values, in training column order
+     * @return double Predicted value
+     */
+    double predictOne(const double* features) const noexcept override;
+    double predictOne(const float* features) const noexcept override;
+
     /**
      * @brief Get the name of the model
      * 
@@ -106,6 +151,134 @@ public:
      */
     std::unordered_map<std::string, double> getFeatureImportance() const override;
 
+    /**
+     * @brief Get the number of trees in the fitted model
+     * 
+     * @return size_t Number of trees
+     */
+    size_t getTreeCount() const override;
+
+    /**
+     * @brief Inspect the nodes of one fitted tree
+     * 
+     * @param treeIndex Index of the tree, below getTreeCount()
+     * @param nodeId Preorder id of the subtree root (0 for the whole tree)
+     * @param maxDepth Levels below the subtree root to include (-1 for all)
+     * @return std::vector<TreeInspection::NodeInfo> Nodes of the subtree
+     */
+    std::vector<TreeInspection::NodeInfo> inspectTree(size_t treeIndex, int nodeId = 0,
+                                                      int maxDepth = -1) const override;
+
+    /**
+     * @brief Enable or disable warm-start training
+     * 
+     * When enabled and the model is already fitted on the same data, the next
+     * call to fit() keeps the existing trees and resumes boosting from the stored
+     * training predictions, so only the additional rounds are trained.
+     * 
+     * @param enabled Whether to reuse the existing trees on the next fit
+     */
+    void setWarmStart(bool enabled);
+
+    /**
+     * @brief Check whether warm-start training is enabled
+     * 
+     * @return bool True if warm start is enabled
+     */
+    bool getWarmStart() const;
+
+    /**
+     * @brief Set the number of boosting stages
+     * 
+     * @param n_estimators Number of boosting stages (trees)
+     */
+    void setNEstimators(int n_estimators);
+
+    /**
+     * @brief Set the quantile predicted by the quantile loss
+     * 
+     * @param alpha Quantile level in (0, 1)
+     */
+    void setAlpha(double alpha);
+
+    /**
+     * @brief Set the Huber loss threshold
+     * 
+     * Residuals smaller than delta are penalized quadratically, larger ones linearly.
+     * 
+     * @param delta Threshold (must be positive)
+     */
+    void setHuberDelta(double delta);
+
+    /**
+     * @brief Set the seed of the row subsampling
+     * 
+     * A fit that starts from scratch reseeds the generator, so it is
+     * reproducible; a warm start or resumed checkpoint continues its stream.
+     * 
+     * @param seed Non-negative seed, or -1 to continue the model's random stream
+     */
+    void setRandomSeed(int seed);
+
+    /**
+     * @brief Mark input features as categorical
+     * 
+     * Categorical features hold non-negative integer category codes. The trees split
+     * them by category membership instead of by threshold, so they do not need to be
+     * one-hot encoded.
+     * 
+     * @param featureIndices Column indices of the categorical features
+     */
+    void setCategoricalFeatures(const std::vector<int>& featureIndices);
+
+    /**
+     * @brief Compact the fitted ensemble for faster inference
+     * 
+     * Removes splits already decided by an ancestor, merges leaves whose outputs
+     * differ by at most leafEpsilon, collapses identical subtrees and drops trees
+     * whose removal changes every calibration prediction by less than treeTolerance.
+     * 
+     * @param calibrationX Calibration inputs used to validate tree removal (may be empty)
+     * @param leafEpsilon Tolerance for merging leaf values
+     * @param treeTolerance Maximum allowed change of any calibration prediction
+     * @return std::unordered_map<std::string, double> Model size and predict latency before and after
+     */
+    std::unordered_map<std::string, double> compact(const Eigen::MatrixXd& calibrationX,
+                                                    double leafEpsilon = 1e-6,
+                                                    double treeTolerance = 1e-4);
+
+    /**
+     * @brief Write training checkpoints while fitting
+     * 
+     * Every interval trees, and once more when boosting ends, fit hands the
+     * trees, the training predictions and the generator state to a
+     * CheckpointWriter, which writes them on its own thread. Not used by
+     * fitBinned.
+     * 
+     * @param filePath Checkpoint file (empty to disable checkpointing)
+     * @param interval Trees between checkpoints
+     * @throws std::invalid_argument If interval is less than 1
+     */
+    void setCheckpoint(const std::string& filePath, int interval = 10);
+
+    /**
+     * @brief Load a checkpoint and continue boosting from it on the next fit
+     * 
+     * The model takes the trees, loss, variable names and generator state of
+     * the checkpoint and can predict right away. The next fit on the same
+     * data resumes like a warm start and grows exactly the trees the
+     * interrupted fit would have, up to the current number of estimators.
+     * The other hyperparameters must match the interrupted fit.
+     * 
+     * @param filePath Checkpoint written during an earlier fit
+     * @throws std::runtime_error If the file is not a readable Gradient Boosting checkpoint
+     */
+    void resumeFromCheckpoint(const std::string& filePath);
+
+protected:
+    void writeModel(ModelFile::Writer& writer) const override;
+    void readModel(const ModelFile::Reader& reader) override;
+
 private:
     // Model hyperparameters
     double learningRate;
@@ -115,14 +288,31 @@ private:
     int minSamplesLeaf;
     double subsample;
     std::string loss;
+    double alpha;
+    double huberDelta;
+    bool warmStart;
     
     // Model state
     bool isFitted;
     int nSamples;
+    double sampleWeightSum;
     int nFeatures;
     double rmse;
     double initialPrediction;
     
+    // Training predictions (F) and target checksum kept for warm start
+    Eigen::VectorXd trainingPredictions;
+    double trainingTargetSum;
+    
+    // Subsampling generator; lives as long as the model so checkpoints can store it
+    int randomSeed;         // -1 if fits do not reseed the generator
+    std::mt19937 rng;
+    
+    // Checkpointing
+    std::string checkpointPath;
+    int checkpointInterval;
+    bool resumePending;     // Set by resumeFromCheckpoint until the next fit
+    
     // Variable names storage
     std::vector<std::string> inputVariableNames;
     std::string targetVariableName;
@@ -130,6 +320,10 @@ private:
     // Feature importance scores
     std::unordered_map<std::string, double> featureImportanceScores;
     
+    // Categorical feature indices and the per-feature mask derived from them
+    std::vector<int> categoricalFeatureIndices;
+    std::vector<bool> categoricalMask;
+    
     // Model implementation details
     class TreeNode {
     public:
@@ -139,10 +333,16 @@ private:
         double outputValue;
         std::shared_ptr<TreeNode> leftChild;
         std::shared_ptr<TreeNode> rightChild;
+        bool isCategorical;
+        std::vector<uint64_t> categoryBitset;
+        bool defaultLeft;  // Direction taken by samples with a missing feature value
         double impurityDecrease;
+        double cover;  // Sample weight reaching the node
+        double gain;   // Reduction of the weighted squared error by the split
         
         TreeNode() : isLeaf(true), featureIndex(-1), splitValue(0.0), outputValue(0.0),
-                   leftChild(nullptr), rightChild(nullptr), impurityDecrease(0.0) {}
+                   leftChild(nullptr), rightChild(nullptr), isCategorical(false), defaultLeft(false), impurityDecrease(0.0),
+                   cover(0.0), gain(0.0) {}
     };
     
     class RegressionTree {
@@ -157,11 +357,24 @@ private:
     
     std::vector<RegressionTree> trees;
     
+    // Trees of a loaded model and their per-tree importances (one column per tree),
+    // scored from the model file until the ensemble is trained further
+    FlatForest flatTrees;
+    Eigen::MatrixXd flatTreeImportance;
+    
+    /**
+     * @brief Rebuild the trees of a loaded model as nodes
+     * 
+     * Does nothing unless the model was loaded and not modified since.
+     */
+    void materializeTrees();
+    
     /**
      * @brief Build a regression tree for gradient boosting
      * 
      * @param X Input features
      * @param residuals Current residuals
+     * @param weights Per-row sample weights
      * @param sampleIndices Indices of samples to use
      * @param depth Current depth
      * @param tree Reference to the tree being built
@@ -169,6 +382,7 @@ private:
      */
     std::shared_ptr<TreeNode> buildTree(const Eigen::MatrixXd& X, 
                                       const Eigen::VectorXd& residuals,
+                                      const Eigen::VectorXd& weights,
                                       const std::vector<int>& sampleIndices,
                                       int depth,
                                       RegressionTree& tree);
@@ -178,6 +392,7 @@ private:
      * 
      * @param X Input features
      * @param residuals Current residuals
+     * @param weights Per-row sample weights
      * @param sampleIndices Indices of samples to use
      * @param bestFeatureIndex Best feature index (output)
      * @param bestSplitValue Best split value (output)
@@ -185,34 +400,33 @@ private:
      * @param impurityDecrease Decrease in impurity (output)
      * @param leftIndices Left child sample indices (output)
      * @param rightIndices Right child sample indices (output)
+     * @param bestCategories Left-child category set if the best split is categorical (output)
+     * @param bestMissingLeft Whether samples with a missing value go left (output)
      */
     void findBestSplit(const Eigen::MatrixXd& X,
                      const Eigen::VectorXd& residuals,
+                     const Eigen::VectorXd& weights,
                      const std::vector<int>& sampleIndices,
                      int& bestFeatureIndex,
                      double& bestSplitValue,
                      double& bestScore,
                      double& impurityDecrease,
                      std::vector<int>& leftIndices,
-                     std::vector<int>& rightIndices);
-    
-    /**
-     * @brief Calculate the mean squared error
-     * 
-     * @param residuals Current residuals
-     * @param indices Sample indices
-     * @return double MSE value
-     */
-    double calculateMSE(const Eigen::VectorXd& residuals, const std::vector<int>& indices) const;
+                     std::vector<int>& rightIndices,
+                     std::vector<uint64_t>& bestCategories,
+                     bool& bestMissingLeft);
+
     
     /**
-     * @brief Calculate the mean of residuals
+     * @brief Calculate the weighted mean of residuals
      * 
      * @param residuals Current residuals
+     * @param weights Per-row sample weights
      * @param indices Sample indices
      * @return double Mean value
      */
-    double calculateMean(const Eigen::VectorXd& residuals, const std::vector<int>& indices) const;
+    double calculateMean(const Eigen::VectorXd& residuals, const Eigen::VectorXd& weights,
+                         const std::vector<int>& indices) const;
     
     /**
      * @brief Calculate the pseudo-residuals based on the loss function
@@ -223,6 +437,54 @@ private:
      */
     Eigen::VectorXd calculatePseudoResiduals(const Eigen::VectorXd& y, const Eigen::VectorXd& predictions) const;
     
+    /**
+     * @brief Check whether a feature was marked as categorical
+     * 
+     * @param featureIndex Feature index
+     * @return bool True if the feature is categorical
+     */
+    bool isCategoricalFeature(int featureIndex) const;
+    
+    /**
+     * @brief Calculate the constant model minimizing the loss
+     * 
+     * @param y Target values
+     * @param weights Per-row sample weights
+     * @return double Mean, median or alpha-quantile depending on the loss
+     */
+    double calculateInitialPrediction(const Eigen::VectorXd& y, const Eigen::VectorXd& weights) const;
+    
+    /**
+     * @brief Calculate the leaf value minimizing the loss over a leaf's raw residuals
+     * 
+     * Median for absolute error, alpha-quantile for quantile loss and an IRLS
+     * (Newton) estimate started from the median for Huber loss.
+     * 
+     * @param residuals Raw residuals (y - F) of the samples in the leaf paired
+     *        with their sample weights (reordered)
+     * @return double Optimal leaf value
+     */
+    double calculateOptimalLeafValue(std::vector<std::pair<double, double>>& residuals) const;
+    
+    /**
+     * @brief Replace the leaf values of a tree by the loss-optimal values
+     * 
+     * The tree is fitted to the pseudo-residuals, whose leaf means are a poor
+     * step for non-squared losses. Each leaf is re-estimated from the raw
+     * residuals of the training samples that reach it.
+     * 
+     * @param root Root of the tree
+     * @param sampleIndices Training samples used for the tree
+     * @param rawResiduals Raw residuals y - F
+     * @param weights Per-row sample weights
+     * @param goesLeft Callable (node, sample index) deciding the branch of a sample
+     */
+    void refitLeafValues(const std::shared_ptr<TreeNode>& root,
+                         const std::vector<int>& sampleIndices,
+                         const Eigen::VectorXd& rawResiduals,
+                         const Eigen::VectorXd& weights,
+                         const std::function<bool(const std::shared_ptr<TreeNode>&, int)>& goesLeft) const;
+    
     /**
      * @brief Predict using a single tree
      * 
@@ -232,8 +494,44 @@ private:
      */
     double predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const;
     
+    /**
+     * @brief Body of both predictOne overloads: all trees for one row
+     * 
+     * @param features First of the row's feature values
+     * @return double Prediction value
+     */
+    template <typename T>
+    double predictRow(const T* features) const noexcept;
+    
     /**
      * @brief Calculate feature importance based on impurity reduction
      */
     void calculateFeatureImportance();
+    
+    /**
+     * @brief Hand the current boosting state to the checkpoint writer
+     * 
+     * @param writer Checkpoint writer of the running fit
+     * @param F Current training predictions
+     * @param targetSum Sum of the training targets
+     */
+    void submitCheckpoint(CheckpointWriter& writer, const Eigen::VectorXd& F, double targetSum) const;
+    
+    /**
+     * @brief Append a tree to a byte buffer in preorder
+     * 
+     * @param node Root of the tree
+     * @param buffer Output buffer
+     */
+    static void serializeTree(const std::shared_ptr<TreeNode>& node, std::vector<char>& buffer);
+    
+    /**
+     * @brief Read a tree written by serializeTree
+     * 
+     * @param buffer Input buffer
+     * @param offset Read position, advanced past the tree
+     * @return std::shared_ptr<TreeNode> Root of the tree
+     * @throws std::runtime_error If the buffer is malformed
+     */
+    static std::shared_ptr<TreeNode> deserializeTree(const std::vector<char>& buffer, size_t& offset);
 }; 
\ No newline at end of file
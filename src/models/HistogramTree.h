@@ -0,0 +1,238 @@
+#pragma once
+
+#include "data/BinnedMatrix.h"
+#include "models/ThresholdSplit.h"
+#include <vector>
+#include <memory>
+#include <limits>
+#include <Eigen/Dense>
+
+/**
+ * @brief Histogram-based tree growing on binned data shared by the tree ensembles
+ *
+ * The builder works on any node type exposing isLeaf, featureIndex, splitValue,
+ * outputValue, leftChild, rightChild, isCategorical, defaultLeft, cover and gain. Split
+ * thresholds are stored as raw cut values, so the resulting trees predict on
+ * unbinned data with the models' usual predictTree.
+ */
+namespace HistogramTree {
+
+/**
+ * @brief Tree growing limits
+ */
+struct Params {
+    int maxDepth = 6;
+    double minChildWeight = 1.0;   // Minimum hessian sum in each child
+    double minSplitWeight = 2.0;   // Minimum hessian sum for a node to be split
+    double lambda = 0.0;           // L2 regularization added to the hessian sums
+    double alpha = 0.0;            // L1 regularization of the gradient sums
+    double minGain = 0.0;          // Minimum gain for a split to be kept
+};
+
+/**
+ * @brief Reduction used when all rows are local: leaves the sums unchanged
+ */
+struct LocalReduce {
+    void operator()(std::vector<double>&) const {}
+};
+
+/**
+ * @brief Decide which child a binned row goes to
+ *
+ * @param node Split node
+ * @param data Binned data
+ * @param row Row index
+ * @return bool True if the row goes to the left child
+ */
+template <typename NodePtr>
+bool goesLeft(const NodePtr& node, const BinnedMatrix& data, size_t row) {
+    uint8_t bin = data.bin(row, node->featureIndex);
+    if (bin == BinnedMatrix::MISSING_BIN) {
+        return node->defaultLeft;
+    }
+    const std::vector<double>& cuts = data.getCuts(node->featureIndex);
+    double upper = bin < cuts.size() ? cuts[bin] : std::numeric_limits<double>::infinity();
+    return upper <= node->splitValue;
+}
+
+/**
+ * @brief Predict a binned row with a single tree
+ *
+ * @param node Root of the tree
+ * @param data Binned data
+ * @param row Row index
+ * @return double Tree output
+ */
+template <typename NodePtr>
+double predict(NodePtr node, const BinnedMatrix& data, size_t row) {
+    while (!node->isLeaf) {
+        node = goesLeft(node, data, row) ? node->leftChild : node->rightChild;
+    }
+    return node->outputValue;
+}
+
+/**
+ * @brief Grow a tree on binned data
+ *
+ * At each node the gradient and hessian sums of the selected features are
+ * accumulated per bin in one pass over the node's rows, and every bin boundary
+ * is scored with missing values sent left and right. Rows are partitioned
+ * only once the best split is known.
+ *
+ * When the rows are sharded over several workers, each worker calls build on
+ * its own rows with a reduce callable that sums a buffer element-wise across
+ * all workers (an allreduce). The node totals and the histograms go through
+ * reduce before they are used, so every worker takes the same decisions and
+ * grows the same tree. selectFeatures must then return the same features on
+ * every worker.
+ *
+ * @param data Binned data
+ * @param rows Row indices at the node
+ * @param gradients Per-row gradients (or targets)
+ * @param hessians Per-row hessians (or weights)
+ * @param params Tree growing limits
+ * @param leafValue Callable (sumGradients, sumHessians) -> leaf output
+ * @param selectFeatures Callable returning the feature indices to consider at a node
+ * @param onSplit Callable (node, featureIndex, gain, hessianSum) called for every split
+ * @param depth Depth of the node
+ * @param reduce Callable summing a std::vector<double> across workers in place
+ * @return std::shared_ptr<Node> Root of the grown subtree
+ */
+template <typename Node, typename LeafFn, typename FeatureFn, typename SplitFn,
+          typename ReduceFn = LocalReduce>
+std::shared_ptr<Node> build(const BinnedMatrix& data, const std::vector<int>& rows,
+                            const Eigen::VectorXd& gradients, const Eigen::VectorXd& hessians,
+                            const Params& params, LeafFn leafValue, FeatureFn selectFeatures,
+                            SplitFn onSplit, int depth = 0, ReduceFn reduce = ReduceFn()) {
+    auto node = std::make_shared<Node>();
+
+    std::vector<double> totals(2, 0.0);
+    for (int idx : rows) {
+        totals[0] += gradients(idx);
+        totals[1] += hessians(idx);
+    }
+    reduce(totals);
+    double sumGrad = totals[0];
+    double sumHess = totals[1];
+    node->isLeaf = true;
+    node->outputValue = leafValue(sumGrad, sumHess);
+    node->cover = sumHess;
+
+    if (depth >= params.maxDepth || sumHess < params.minSplitWeight) {
+        return node;
+    }
+
+    double parentScore = ThresholdSplit::regularizedScore(sumGrad, sumHess, params.lambda, params.alpha);
+    bool found = false;
+    double bestGain = params.minGain;
+    int bestFeature = -1;
+    int bestBin = -1;
+    bool bestMissingLeft = false;
+
+    // Histograms of all selected features in one buffer, so they can be
+    // reduced at once: per feature nBins gradient sums, nBins hessian sums,
+    // then the missing-value gradient and hessian sums
+    std::vector<int> features = selectFeatures();
+    std::vector<size_t> offsets(features.size());
+    size_t histogramSize = 0;
+    for (size_t k = 0; k < features.size(); ++k) {
+        offsets[k] = histogramSize;
+        histogramSize += 2 * static_cast<size_t>(data.numBins(features[k])) + 2;
+    }
+    std::vector<double> histograms(histogramSize, 0.0);
+    for (size_t k = 0; k < features.size(); ++k) {
+        int feature = features[k];
+        int nBins = data.numBins(feature);
+        double* gradHist = histograms.data() + offsets[k];
+        double* hessHist = gradHist + nBins;
+        double* missing = hessHist + nBins;
+        for (int idx : rows) {
+            uint8_t bin = data.bin(idx, feature);
+            if (bin == BinnedMatrix::MISSING_BIN) {
+                missing[0] += gradients(idx);
+                missing[1] += hessians(idx);
+            } else {
+                gradHist[bin] += gradients(idx);
+                hessHist[bin] += hessians(idx);
+            }
+        }
+    }
+    reduce(histograms);
+
+    for (size_t k = 0; k < features.size(); ++k) {
+        int feature = features[k];
+        int nBins = data.numBins(feature);
+        if (nBins < 2) {
+            continue;
+        }
+        const double* gradHist = histograms.data() + offsets[k];
+        const double* hessHist = gradHist + nBins;
+        double missingGrad = hessHist[nBins];
+        double missingHess = hessHist[nBins + 1];
+
+        // Scan the bin boundaries
+        bool hasMissing = missingHess > 0.0;
+        double prefixGrad = 0.0;
+        double prefixHess = 0.0;
+        for (int b = 0; b + 1 < nBins; ++b) {
+            prefixGrad += gradHist[b];
+            prefixHess += hessHist[b];
+            if (hessHist[b] == 0.0) {
+                continue;
+            }
+
+            for (int direction = 0; direction < (hasMissing ? 2 : 1); ++direction) {
+                bool missingLeft = direction == 0;
+                double leftGrad = prefixGrad + (missingLeft ? missingGrad : 0.0);
+                double leftHess = prefixHess + (missingLeft ? missingHess : 0.0);
+                double rightGrad = sumGrad - leftGrad;
+                double rightHess = sumHess - leftHess;
+                if (leftHess < params.minChildWeight || rightHess < params.minChildWeight) {
+                    continue;
+                }
+
+                double gain = ThresholdSplit::regularizedScore(leftGrad, leftHess, params.lambda, params.alpha) +
+                              ThresholdSplit::regularizedScore(rightGrad, rightHess, params.lambda, params.alpha) -
+                              parentScore;
+                if (gain > bestGain) {
+                    found = true;
+                    bestGain = gain;
+                    bestFeature = feature;
+                    bestBin = b;
+                    bestMissingLeft = hasMissing ? missingLeft : leftHess >= rightHess;
+                }
+            }
+        }
+    }
+
+    if (!found) {
+        return node;
+    }
+
+    node->isLeaf = false;
+    node->isCategorical = false;
+    node->featureIndex = bestFeature;
+    node->splitValue = data.getCuts(bestFeature)[bestBin];
+    node->defaultLeft = bestMissingLeft;
+    node->gain = bestGain;
+    onSplit(*node, bestFeature, bestGain, sumHess);
+
+    // Partition the rows once, now that the split is fixed
+    std::vector<int> leftRows;
+    std::vector<int> rightRows;
+    for (int idx : rows) {
+        if (goesLeft(node, data, idx)) {
+            leftRows.push_back(idx);
+        } else {
+            rightRows.push_back(idx);
+        }
+    }
+
+    node->leftChild = build<Node>(data, leftRows, gradients, hessians, params, leafValue,
+                                  selectFeatures, onSplit, depth + 1, reduce);
+    node->rightChild = build<Node>(data, rightRows, gradients, hessians, params, leafValue,
+                                   selectFeatures, onSplit, depth + 1, reduce);
+    return node;
+}
+
+} // namespace HistogramTree
@@ -0,0 +1,93 @@
+#include "models/LatencyBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using RowMatrixD = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+using RowMatrixF = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+/**
+ * @brief Time call(row) for every row, repeats times, after a warm-up
+ *
+ * @return std::vector<double> Nanoseconds per call
+ */
+template <typename Call>
+std::vector<double> timeCalls(Eigen::Index rows, const LatencyBenchmark::Options& options, Call call) {
+    volatile double sink = 0.0;
+    for (Eigen::Index i = 0; i < std::min<Eigen::Index>(rows, options.warmupRows); ++i) {
+        sink = sink + call(i);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(rows) * static_cast<size_t>(options.repeats));
+    for (int r = 0; r < options.repeats; ++r) {
+        for (Eigen::Index i = 0; i < rows; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            double value = call(i);
+            auto end = std::chrono::steady_clock::now();
+            sink = sink + value;
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+    }
+    return samples;
+}
+
+void addPercentiles(std::unordered_map<std::string, double>& results, const std::string& path,
+                    std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+    results[path + "_p50_ns"] = percentile(0.50);
+    results[path + "_p99_ns"] = percentile(0.99);
+    results[path + "_mean_ns"] = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+} // namespace
+
+namespace LatencyBenchmark {
+
+std::unordered_map<std::string, double> run(const Model& model, const Eigen::MatrixXd& X, const Options& options) {
+    if (X.rows() == 0) {
+        throw std::invalid_argument("No rows to benchmark");
+    }
+    if (options.repeats < 1 || options.warmupRows < 0) {
+        throw std::invalid_argument("Repeats must be positive and warm-up rows non-negative");
+    }
+
+    // predict checks the model and the columns before anything is timed
+    Eigen::VectorXd reference = model.predict(X);
+    RowMatrixD rowsD = X;
+    RowMatrixF rowsF = X.cast<float>();
+    Eigen::MatrixXd one(1, X.cols());
+
+    std::unordered_map<std::string, double> results;
+    addPercentiles(results, "predict_one", timeCalls(X.rows(), options, [&](Eigen::Index i) {
+        return model.predictOne(rowsD.row(i).data());
+    }));
+    addPercentiles(results, "predict_one_float", timeCalls(X.rows(), options, [&](Eigen::Index i) {
+        return model.predictOne(rowsF.row(i).data());
+    }));
+    addPercentiles(results, "predict_matrix", timeCalls(X.rows(), options, [&](Eigen::Index i) {
+        one = X.row(i);
+        return model.predict(one)(0);
+    }));
+
+    double deltaD = 0.0;
+    double deltaF = 0.0;
+    for (Eigen::Index i = 0; i < X.rows(); ++i) {
+        deltaD = std::max(deltaD, std::abs(model.predictOne(rowsD.row(i).data()) - reference(i)));
+        deltaF = std::max(deltaF, std::abs(model.predictOne(rowsF.row(i).data()) - reference(i)));
+    }
+    results["max_abs_delta_predict_one"] = deltaD;
+    results["max_abs_delta_predict_one_float"] = deltaF;
+    results["samples"] = static_cast<double>(X.rows()) * options.repeats;
+    return results;
+}
+
+} // namespace LatencyBenchmark
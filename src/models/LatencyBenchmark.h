@@ -0,0 +1,46 @@
+#pragma once
+
+#include "models/Model.h"
+#include <Eigen/Dense>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Single-row prediction latency of a fitted model
+ *
+ * Measures the paths an online scoring service can take with one row at a
+ * time: predictOne on a double row, predictOne on a float row, and predict
+ * on a one-row matrix. Every call is timed on its own with a steady clock,
+ * so the percentiles include the clock reads, a few tens of nanoseconds.
+ * The rows are copied into row-major buffers before timing starts; the
+ * matrix path includes copying its row into a reused one-row matrix.
+ */
+namespace LatencyBenchmark {
+
+/**
+ * @brief Settings of a latency run
+ */
+struct Options {
+    int repeats = 5;            // Passes over the rows, each call timed
+    int warmupRows = 1000;      // Untimed calls per path before measuring
+};
+
+/**
+ * @brief Time single-row predictions over the rows of X
+ *
+ * Reports "<path>_p50_ns", "<path>_p99_ns" and "<path>_mean_ns" for the
+ * paths "predict_one", "predict_one_float" and "predict_matrix", the largest
+ * difference of each predictOne path from predict ("max_abs_delta_<path>"),
+ * and the number of timed calls per path ("samples").
+ *
+ * @param model Fitted model
+ * @param X Rows to predict, with the columns the model was trained on
+ * @param options Repeats and warm-up
+ * @return std::unordered_map<std::string, double> Latencies in nanoseconds and deltas
+ * @throws std::invalid_argument If X is empty, has the wrong columns or the options are invalid
+ * @throws std::runtime_error If the model is not fitted
+ */
+std::unordered_map<std::string, double> run(const Model& model, const Eigen::MatrixXd& X,
+                                            const Options& options = Options());
+
+} // namespace LatencyBenchmark
@@ -1,6 +1,10 @@
 #include "models/LinearRegression.h"
+#include "models/ModelFile.h"
+#include <cassert>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 LinearRegression::LinearRegression() 
     : intercept(0.0), rSquared(0.0), adjustedRSquared(0.0), rmse(0.0),
@@ -9,21 +13,36 @@ LinearRegression::LinearRegression()
 
 bool LinearRegression::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                           const std::vector<std::string>& variableNames,
-                          const std::string& targetName) {
+                          const std::string& targetName,
+                          const Eigen::VectorXd& sampleWeights) {
     if (X.rows() != y.rows()) {
         std::cerr << "Error: Number of samples in X (" << X.rows() 
                  << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
         return false;
     }
 
-    if (X.rows() <= X.cols()) {
-        std::cerr << "Error: Number of samples (" << X.rows() 
+    Eigen::VectorXd weights;
+    if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+        return false;
+    }
+
+    // Rows with zero weight do not count towards the sample size
+    int nWeightedRows = static_cast<int>((weights.array() > 0.0).count());
+    if (nWeightedRows <= X.cols()) {
+        std::cerr << "Error: Number of samples (" << nWeightedRows 
                  << ") must be greater than number of features (" << X.cols() << ")." << std::endl;
         return false;
     }
 
+    if (X.hasNaN() || y.hasNaN()) {
+        std::cerr << "Error: " << getName() << " does not support missing values. "
+                 << "Use a tree-based model or remove rows with missing values." << std::endl;
+        return false;
+    }
+
     try {
-        nSamples = X.rows();
+        // With frequency weights the effective sample size is the total weight
+        nSamples = static_cast<int>(std::round(weights.sum()));
         nFeatures = X.cols();
 
         // Store variable names
@@ -52,15 +71,16 @@ bool LinearRegression::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         targetVariableName = targetName.empty() ? "Target" : targetName;
 
         // Calculate feature standard deviations for importance calculation
-        calculateFeatureStdDevs(X);
+        calculateFeatureStdDevs(X, weights);
 
         // Add a column of ones to X for the intercept
-        Eigen::MatrixXd X_aug(nSamples, nFeatures + 1);
+        Eigen::MatrixXd X_aug(X.rows(), nFeatures + 1);
         X_aug.col(0).setOnes();
         X_aug.rightCols(nFeatures) = X;
 
-        // Compute coefficients using normal equation: (X'X)^(-1)X'y
-        Eigen::VectorXd theta = (X_aug.transpose() * X_aug).inverse() * X_aug.transpose() * y;
+        // Compute coefficients using the weighted normal equation: (X'WX)^(-1)X'Wy
+        Eigen::MatrixXd X_weighted = weights.asDiagonal() * X_aug;
+        Eigen::VectorXd theta = (X_weighted.transpose() * X_aug).inverse() * X_weighted.transpose() * y;
 
         // Extract intercept and coefficients
         intercept = theta(0);
@@ -70,7 +90,7 @@ bool LinearRegression::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         isFitted = true;
         
         // Calculate statistics after setting isFitted to true
-        calculateStatistics(X, y);
+        calculateStatistics(X, y, weights);
 
         return true;
     } catch (const std::exception& e) {
@@ -80,6 +100,11 @@ bool LinearRegression::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
 }
 
 Eigen::VectorXd LinearRegression::predict(const Eigen::MatrixXd& X) const {
+    return predictInBlocks(X);
+}
+
+void LinearRegression::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                                   Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -89,8 +114,33 @@ Eigen::VectorXd LinearRegression::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
 
-    return X * coefficients + Eigen::VectorXd::Constant(X.rows(), intercept);
+    predictions.noalias() = X * coefficients;
+    predictions.array() += intercept;
+}
+
+template <typename T>
+double LinearRegression::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Summed in column order, as the product in predictInto is for each row
+    double sum = 0.0;
+    for (Eigen::Index j = 0; j < coefficients.size(); ++j) {
+        sum += coefficients(j) * static_cast<double>(features[j]);
+    }
+    return sum + intercept;
+}
+
+double LinearRegression::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double LinearRegression::predictOne(const float* features) const noexcept {
+    return predictRow(features);
 }
 
 std::string LinearRegression::getName() const {
@@ -156,19 +206,21 @@ std::string LinearRegression::getTargetName() const {
     return targetVariableName;
 }
 
-void LinearRegression::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+void LinearRegression::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                      const Eigen::VectorXd& weights) {
     // Get predictions
     Eigen::VectorXd y_pred = predict(X);
+    double totalWeight = weights.sum();
     
     // Calculate SST (total sum of squares)
-    double y_mean = y.mean();
-    double sst = (y.array() - y_mean).square().sum();
+    double y_mean = weights.dot(y) / totalWeight;
+    double sst = (weights.array() * (y.array() - y_mean).square()).sum();
     
     // Calculate SSR (regression sum of squares)
-    double ssr = (y_pred.array() - y_mean).square().sum();
+    double ssr = (weights.array() * (y_pred.array() - y_mean).square()).sum();
     
     // Calculate SSE (error sum of squares)
-    double sse = (y.array() - y_pred.array()).square().sum();
+    double sse = (weights.array() * (y.array() - y_pred.array()).square()).sum();
     
     // Calculate R²
     rSquared = ssr / sst;
@@ -177,18 +229,20 @@ void LinearRegression::calculateStatistics(const Eigen::MatrixXd& X, const Eigen
     adjustedRSquared = 1.0 - (1.0 - rSquared) * (nSamples - 1) / (nSamples - nFeatures - 1);
     
     // Calculate RMSE
-    rmse = std::sqrt(sse / nSamples);
+    rmse = std::sqrt(sse / totalWeight);
 }
 
-void LinearRegression::calculateFeatureStdDevs(const Eigen::MatrixXd& X) {
+void LinearRegression::calculateFeatureStdDevs(const Eigen::MatrixXd& X, const Eigen::VectorXd& weights) {
     // Initialize feature standard deviations vector
     featureStdDevs = Eigen::VectorXd(X.cols());
+    double totalWeight = weights.sum();
     
-    // Calculate standard deviation for each feature
+    // Calculate the weighted standard deviation for each feature
     for (int i = 0; i < X.cols(); ++i) {
         Eigen::VectorXd feature = X.col(i);
-        double mean = feature.mean();
-        featureStdDevs(i) = std::sqrt((feature.array() - mean).square().sum() / (feature.size() - 1));
+        double mean = weights.dot(feature) / totalWeight;
+        double sumSquares = (weights.array() * (feature.array() - mean).square()).sum();
+        featureStdDevs(i) = std::sqrt(sumSquares / std::max(totalWeight - 1.0, 1.0));
     }
 }
 
@@ -216,4 +270,42 @@ std::unordered_map<std::string, double> LinearRegression::getFeatureImportance()
     }
     
     return importance;
-}
\ No newline at end of file
+}
+
+void LinearRegression::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+
+    writer.putVector("coefficients", coefficients);
+    writer.putValue<double>("intercept", intercept);
+    writer.putValue<double>("r_squared", rSquared);
+    writer.putValue<double>("adjusted_r_squared", adjustedRSquared);
+    writer.putValue<double>("rmse", rmse);
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putVector("feature_std_devs", featureStdDevs);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+}
+
+void LinearRegression::readModel(const ModelFile::Reader& reader) {
+    Eigen::VectorXd storedCoefficients = reader.vector("coefficients");
+    Eigen::VectorXd storedStdDevs = reader.vector("feature_std_devs");
+    std::vector<std::string> names = reader.strings("variable_names");
+    if (storedStdDevs.size() != storedCoefficients.size() ||
+        names.size() != static_cast<size_t>(storedCoefficients.size())) {
+        throw std::runtime_error("Linear Regression model file sizes do not match");
+    }
+
+    coefficients = storedCoefficients;
+    intercept = reader.value<double>("intercept");
+    rSquared = reader.value<double>("r_squared");
+    adjustedRSquared = reader.value<double>("adjusted_r_squared");
+    rmse = reader.value<double>("rmse");
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    nFeatures = static_cast<int>(coefficients.size());
+    featureStdDevs = storedStdDevs;
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    isFitted = true;
+}
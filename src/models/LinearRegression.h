@@ -20,11 +20,13 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
      * @return bool True if fitting was successful, false otherwise
      */
     bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             const std::vector<std::string>& variableNames = {},
-            const std::string& targetName = "") override;
+            const std::string& targetName = "",
+            const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) override;
 
     /**
      * @brief Make predictions using the fitted linear regression model
@@ -34,6 +36,24 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::MatrixXd& X) const override;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * @param X Input features for prediction, read in place
+     * @param predictions Output span with one element per row of X
+     */
+    void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                     Eigen::Ref<Eigen::VectorXd> predictions) const override;
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * @param features First of the row's feature values, in training column order
+     * @return double Predicted value
+     */
+    double predictOne(const double* features) const noexcept override;
+    double predictOne(const float* features) const noexcept override;
+
     /**
      * @brief Get the name of the model
      * 
@@ -123,6 +143,10 @@ public:
      */
     std::unordered_map<std::string, double> getFeatureImportance() const override;
 
+protected:
+    void writeModel(ModelFile::Writer& writer) const override;
+    void readModel(const ModelFile::Reader& reader) override;
+
 private:
     Eigen::VectorXd coefficients;
     double intercept;
@@ -145,13 +169,25 @@ private:
      * 
      * @param X Input features used for fitting
      * @param y Target values used for fitting
+     * @param weights Sample weights used for fitting
      */
-    void calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
+    void calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                             const Eigen::VectorXd& weights);
 
     /**
      * @brief Calculate feature standard deviations
      * 
      * @param X Input features matrix
+     * @param weights Sample weights
+     */
+    void calculateFeatureStdDevs(const Eigen::MatrixXd& X, const Eigen::VectorXd& weights);
+
+    /**
+     * @brief Body of both predictOne overloads
+     * 
+     * @param features First of the row's feature values
+     * @return double Prediction value
      */
-    void calculateFeatureStdDevs(const Eigen::MatrixXd& X);
+    template <typename T>
+    double predictRow(const T* features) const noexcept;
 };
\ No newline at end of file
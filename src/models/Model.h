@@ -2,9 +2,22 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
 #include <unordered_map>
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
 #include <Eigen/Dense>
 #include "data/DataFrame.h"
+#include "models/ParallelPredict.h"
+#include "models/TreeInspection.h"
+
+namespace ModelFile {
+class Writer;
+class Reader;
+}
 
 /**
  * @brief Base class for statistical models
@@ -23,11 +36,14 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights, e.g. duplicate counts
+     *        (empty for unit weights). A row with weight k is fitted as k copies of it.
      * @return bool True if fitting was successful, false otherwise
      */
     virtual bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, 
                     const std::vector<std::string>& variableNames = {},
-                    const std::string& targetName = "") = 0;
+                    const std::string& targetName = "",
+                    const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) = 0;
 
     /**
      * @brief Make predictions using the fitted model
@@ -37,6 +53,123 @@ public:
      */
     virtual Eigen::VectorXd predict(const Eigen::MatrixXd& X) const = 0;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * X may be any column-major view, such as a block of rows of a larger
+     * matrix or a map over the caller's buffer. Models that can read it in
+     * place do not copy it. The values are the same as those of predict.
+     * 
+     * @param X Input features for prediction
+     * @param predictions Output span with one element per row of X
+     * @throws std::invalid_argument If the output length does not match X
+     */
+    virtual void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                             Eigen::Ref<Eigen::VectorXd> predictions) const {
+        checkOutputSize(X, predictions);
+        predictions = predict(X);
+    }
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * For scoring one row at a time with low latency. The row is read
+     * through the pointer in the model's column order, one value per input
+     * variable, and nothing checks its length: debug builds assert that the
+     * pointer is set and the model fitted, release builds return NaN for an
+     * unfitted model. The tree and linear models need no scratch memory; the
+     * network works in a fixed buffer on the stack.
+     * Safe to call concurrently.
+     * 
+     * @param features First of the row's feature values
+     * @return double Predicted value
+     */
+    virtual double predictOne(const double* features) const noexcept = 0;
+
+    /**
+     * @brief Predict a single row of float features without allocating or throwing
+     * 
+     * Same as the double overload, for callers holding float32 rows; the
+     * values are widened to double as they are read.
+     * 
+     * @param features First of the row's feature values
+     * @return double Predicted value
+     */
+    virtual double predictOne(const float* features) const noexcept = 0;
+
+    /**
+     * @brief Fills one block of input rows for predictChunked
+     * 
+     * Called with the index of the block's first row and a matrix with one
+     * row per row of the block and one column per input variable.
+     */
+    using RowBlockSource = std::function<void(Eigen::Index firstRow, Eigen::Ref<Eigen::MatrixXd> block)>;
+
+    static constexpr Eigen::Index DEFAULT_BLOCK_ROWS = 4096;
+
+    /**
+     * @brief Make predictions for rows supplied one block at a time
+     * 
+     * Only one block of inputs is held at once, so the rows never have to be
+     * gathered into one matrix. The block buffer is reused from block to block.
+     * 
+     * @param nRows Number of rows to predict
+     * @param source Fills each block of input rows
+     * @param predictions Output span with nRows elements
+     * @param blockRows Rows per block
+     * @throws std::invalid_argument If the output length or block size is invalid
+     */
+    void predictChunked(Eigen::Index nRows, const RowBlockSource& source, Eigen::Ref<Eigen::VectorXd> predictions,
+                        Eigen::Index blockRows = DEFAULT_BLOCK_ROWS) const {
+        if (predictions.size() != nRows) {
+            throw std::invalid_argument("Output has " + std::to_string(predictions.size()) +
+                                        " elements for " + std::to_string(nRows) + " rows");
+        }
+        if (blockRows <= 0) {
+            throw std::invalid_argument("Block size must be positive");
+        }
+        Eigen::MatrixXd block;
+        Eigen::Index nFeatures = static_cast<Eigen::Index>(getVariableNames().size());
+        for (Eigen::Index first = 0; first < nRows; first += blockRows) {
+            Eigen::Index rows = std::min(blockRows, nRows - first);
+            block.resize(rows, nFeatures);
+            source(first, block);
+            predictInto(block, predictions.segment(first, rows));
+        }
+    }
+
+    /**
+     * @brief Make predictions for the rows of a data frame, one block at a time
+     * 
+     * The model's input variables are copied from the data frame block by
+     * block instead of building the full matrix with DataFrame::toMatrix.
+     * The blocks run on the ParallelPredict executor, each thread copying
+     * into its own reused block buffer.
+     * 
+     * @param data Data frame with the model's input variables
+     * @param predictions Output span with one element per row of data
+     * @param options Threads and rows per block (0 to size blocks to the L2 cache)
+     * @throws std::invalid_argument If the output length does not match data
+     * @throws std::out_of_range If an input variable is missing from data
+     */
+    void predictChunked(const DataFrame& data, Eigen::Ref<Eigen::VectorXd> predictions,
+                        const ParallelPredict::Options& options = ParallelPredict::Options()) const {
+        Eigen::Index nRows = static_cast<Eigen::Index>(data.getNumRows());
+        if (predictions.size() != nRows) {
+            throw std::invalid_argument("Output has " + std::to_string(predictions.size()) +
+                                        " elements for " + std::to_string(nRows) + " rows");
+        }
+        std::vector<std::string> names = getVariableNames();
+        ParallelPredict::Plan plan = ParallelPredict::plan(nRows, predictRowBytes(), options);
+        std::vector<Eigen::MatrixXd> blocks(static_cast<size_t>(plan.workers));
+        ParallelPredict::run(plan, [&](int worker, Eigen::Index firstRow, Eigen::Index rows) {
+            Eigen::MatrixXd& block = blocks[static_cast<size_t>(worker)];
+            block.resize(rows, static_cast<Eigen::Index>(names.size()));
+            data.copyRows(names, static_cast<size_t>(firstRow), block);
+            predictInto(block, predictions.segment(firstRow, rows));
+        });
+    }
+
     /**
      * @brief Get the name of the model
      * 
@@ -79,6 +212,31 @@ public:
      */
     virtual std::string getTargetName() const = 0;
 
+    /**
+     * @brief Set the category labels of the categorical input variables
+     * 
+     * The models see a categorical column as integer codes, which CSVReader
+     * assigns in order of first appearance, so the same label can get
+     * another code in another file. The labels are saved with the model, and
+     * scoring a file maps each label to the code it had in training, with
+     * labels the model never saw read as missing. Replaces any labels set
+     * before, so set them (or an empty map) whenever the model is fitted.
+     * 
+     * @param levels Category labels indexed by code, per input variable name
+     */
+    void setCategoryLevels(const std::unordered_map<std::string, std::vector<std::string>>& levels) {
+        categoryLevels = levels;
+    }
+
+    /**
+     * @brief Get the category labels of the categorical input variables
+     * 
+     * @return const std::unordered_map<std::string, std::vector<std::string>>& Labels indexed by code, per variable
+     */
+    const std::unordered_map<std::string, std::vector<std::string>>& getCategoryLevels() const {
+        return categoryLevels;
+    }
+
     /**
      * @brief Get the feature importance scores
      * 
@@ -89,4 +247,159 @@ public:
      * @return std::unordered_map<std::string, double> Map of feature names to importance scores
      */
     virtual std::unordered_map<std::string, double> getFeatureImportance() const = 0;
-};
\ No newline at end of file
+
+    /**
+     * @brief Get the number of trees in the fitted model
+     * 
+     * @return size_t Number of trees (0 for models that are not tree ensembles)
+     */
+    virtual size_t getTreeCount() const { return 0; }
+
+    /**
+     * @brief Inspect the nodes of one fitted tree
+     * 
+     * Returns the subtree rooted at nodeId in preorder, down to maxDepth levels
+     * below it, with per-node cover and gain. Nodes whose children were cut off
+     * are marked as not expanded and carry their children's ids, so a viewer
+     * can fetch only the part of a large tree it displays. See TreeInspection
+     * for summaries, depth histograms and the JSON and binary encodings.
+     * 
+     * @param treeIndex Index of the tree, below getTreeCount()
+     * @param nodeId Preorder id of the subtree root (0 for the whole tree)
+     * @param maxDepth Levels below the subtree root to include (-1 for all)
+     * @return std::vector<TreeInspection::NodeInfo> Nodes of the subtree
+     * @throws std::out_of_range If the tree index or node id is invalid
+     */
+    virtual std::vector<TreeInspection::NodeInfo> inspectTree(size_t treeIndex, int nodeId = 0,
+                                                              int maxDepth = -1) const {
+        (void)treeIndex;
+        (void)nodeId;
+        (void)maxDepth;
+        throw std::out_of_range("Model has no trees");
+    }
+
+    /**
+     * @brief Save the fitted model to a binary file
+     * 
+     * The file holds the hyperparameters and the fitted state in the
+     * versioned, memory-mappable layout described in ModelFile, together
+     * with a hash of the training schema.
+     * 
+     * @param filePath Path of the model file
+     * @throws std::runtime_error If the model is not fitted or the file cannot be written
+     */
+    void save(const std::string& filePath) const;
+
+    /**
+     * @brief Load a model written by save
+     * 
+     * The file is memory mapped. Tree ensembles score directly from the
+     * mapped node arrays; their node objects are only rebuilt if the model
+     * is trained further, compacted or inspected.
+     * 
+     * @param filePath Path of the model file
+     * @return std::shared_ptr<Model> The fitted model, of the type that was saved
+     * @throws std::runtime_error If the file is not a readable model file
+     */
+    static std::shared_ptr<Model> load(const std::string& filePath);
+
+protected:
+    /**
+     * @brief Add the model's sections to a model file
+     * 
+     * @param writer Model file being written
+     * @throws std::runtime_error If the model is not fitted
+     */
+    virtual void writeModel(ModelFile::Writer& writer) const = 0;
+
+    /**
+     * @brief Restore the model from the sections of a model file
+     * 
+     * @param reader Model file being read
+     * @throws std::runtime_error If sections are missing or inconsistent
+     */
+    virtual void readModel(const ModelFile::Reader& reader) = 0;
+
+    /**
+     * @brief Predict the rows of X on the ParallelPredict executor
+     * 
+     * The models' predict calls this, so that every model scores large
+     * inputs on all cores: X is cut into cache-sized row blocks, and each
+     * block is passed to predictInto as a view of X and written straight
+     * into its range of the result.
+     * 
+     * @param X Input features for prediction
+     * @param options Threads and block size of the executor
+     * @return Eigen::VectorXd Predicted values
+     */
+    Eigen::VectorXd predictInBlocks(const Eigen::MatrixXd& X,
+                                    const ParallelPredict::Options& options = ParallelPredict::Options()) const {
+        Eigen::VectorXd predictions(X.rows());
+        ParallelPredict::run(ParallelPredict::plan(X.rows(), predictRowBytes(), options),
+                             [&](int, Eigen::Index firstRow, Eigen::Index rows) {
+                                 predictInto(X.middleRows(firstRow, rows), predictions.segment(firstRow, rows));
+                             });
+        return predictions;
+    }
+
+    /**
+     * @brief Memory one row touches during predictInto, for sizing row blocks
+     * 
+     * Counts the row's inputs and output; models with larger per-row working
+     * memory add it.
+     * 
+     * @return size_t Bytes per row
+     */
+    virtual size_t predictRowBytes() const {
+        return sizeof(double) * (getVariableNames().size() + 1);
+    }
+
+    /**
+     * @brief Check that an output span of predictInto has one element per row
+     * 
+     * @throws std::invalid_argument If the lengths differ
+     */
+    static void checkOutputSize(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                                const Eigen::Ref<Eigen::VectorXd>& predictions) {
+        if (predictions.size() != X.rows()) {
+            throw std::invalid_argument("Output has " + std::to_string(predictions.size()) +
+                                        " elements for " + std::to_string(X.rows()) + " rows");
+        }
+    }
+
+    /**
+     * @brief Validate sample weights passed to fit()
+     * 
+     * @param sampleWeights Weights given by the caller (empty for unit weights)
+     * @param nSamples Number of training rows
+     * @param weights Validated weights, all ones if none were given (output)
+     * @return bool True if the weights are usable, false otherwise
+     */
+    static bool resolveSampleWeights(const Eigen::VectorXd& sampleWeights, Eigen::Index nSamples,
+                                     Eigen::VectorXd& weights) {
+        if (sampleWeights.size() == 0) {
+            weights = Eigen::VectorXd::Ones(nSamples);
+            return true;
+        }
+        if (sampleWeights.size() != nSamples) {
+            std::cerr << "Error: Number of sample weights (" << sampleWeights.size()
+                     << ") does not match number of samples (" << nSamples << ")." << std::endl;
+            return false;
+        }
+        for (Eigen::Index i = 0; i < sampleWeights.size(); ++i) {
+            if (!std::isfinite(sampleWeights(i)) || sampleWeights(i) < 0.0) {
+                std::cerr << "Error: Sample weights must be finite and non-negative." << std::endl;
+                return false;
+            }
+        }
+        if (sampleWeights.sum() <= 0.0) {
+            std::cerr << "Error: Sample weights must not all be zero." << std::endl;
+            return false;
+        }
+        weights = sampleWeights;
+        return true;
+    }
+
+private:
+    std::unordered_map<std::string, std::vector<std::string>> categoryLevels;
+};
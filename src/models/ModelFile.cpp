@@ -0,0 +1,360 @@
+#include "models/ModelFile.h"
+#include "models/Model.h"
+#include "models/LinearRegression.h"
+#include "models/ElasticNet.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include "models/GradientBoosting.h"
+#include "models/NeuralNetwork.h"
+#include "utils/BinaryBuffer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace ModelFile {
+
+namespace {
+
+const char MAGIC[8] = {'M', 'B', 'M', 'O', 'D', 'E', 'L', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const size_t HEADER_SIZE = 64;
+const size_t TABLE_ENTRY_SIZE = 64;
+const size_t TABLE_NAME_SIZE = 40;
+
+size_t elementSize(ElementType type) {
+    switch (type) {
+        case ElementType::BYTE: return 1;
+        case ElementType::INT32: return 4;
+        case ElementType::INT64: return 8;
+        case ElementType::UINT64: return 8;
+        case ElementType::FLOAT64: return 8;
+    }
+    return 0;
+}
+
+size_t alignUp(size_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+void appendPadding(std::vector<char>& buffer, size_t size) {
+    buffer.resize(buffer.size() + size, '\0');
+}
+
+} // namespace
+
+uint64_t schemaHash(const std::vector<std::string>& variableNames, const std::string& targetName) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    // Length prefixes keep ("ab", "c") apart from ("a", "bc")
+    uint64_t count = variableNames.size();
+    mix(&count, sizeof(count));
+    for (const auto& name : variableNames) {
+        uint64_t length = name.size();
+        mix(&length, sizeof(length));
+        mix(name.data(), name.size());
+    }
+    uint64_t length = targetName.size();
+    mix(&length, sizeof(length));
+    mix(targetName.data(), targetName.size());
+    return hash;
+}
+
+Info readInfo(const std::string& filePath) {
+    return Reader(filePath).info();
+}
+
+void Writer::addSection(const std::string& name, ElementType type, const void* values, size_t count,
+                        size_t elementSize) {
+    if (name.empty() || name.size() > MAX_SECTION_NAME) {
+        throw std::invalid_argument("Section name '" + name + "' must have 1 to " +
+                                    std::to_string(MAX_SECTION_NAME) + " characters");
+    }
+    for (const auto& section : sections) {
+        if (section.name == name) {
+            throw std::invalid_argument("Section " + name + " was added twice");
+        }
+    }
+    Section section;
+    section.name = name;
+    section.type = type;
+    section.count = count;
+    const char* bytes = static_cast<const char*>(values);
+    section.bytes.assign(bytes, bytes + count * elementSize);
+    sections.push_back(std::move(section));
+}
+
+void Writer::putString(const std::string& name, const std::string& value) {
+    addSection(name, ElementType::BYTE, value.data(), value.size(), 1);
+}
+
+void Writer::putStrings(const std::string& name, const std::vector<std::string>& values) {
+    std::vector<char> buffer;
+    BinaryBuffer::appendValue<uint64_t>(buffer, values.size());
+    for (const auto& value : values) {
+        BinaryBuffer::appendString(buffer, value);
+    }
+    addSection(name, ElementType::BYTE, buffer.data(), buffer.size(), 1);
+}
+
+void Writer::putVector(const std::string& name, const Eigen::VectorXd& values) {
+    putArray(name, values.data(), static_cast<size_t>(values.size()));
+}
+
+void Writer::putMatrix(const std::string& name, const Eigen::MatrixXd& matrix) {
+    putArray(name, matrix.data(), static_cast<size_t>(matrix.size()));
+    int64_t shape[2] = {static_cast<int64_t>(matrix.rows()), static_cast<int64_t>(matrix.cols())};
+    putArray(name + ".shape", shape, 2);
+}
+
+void Writer::write(const std::string& filePath, const std::string& modelName, uint64_t schemaHash) const {
+    Section nameSection;
+    nameSection.name = "model_name";
+    nameSection.type = ElementType::BYTE;
+    nameSection.count = modelName.size();
+    nameSection.bytes.assign(modelName.begin(), modelName.end());
+    std::vector<const Section*> allSections;
+    for (const auto& section : sections) {
+        allSections.push_back(&section);
+    }
+    allSections.push_back(&nameSection);
+
+    // Lay out the sections after the header and the section table
+    std::vector<uint64_t> offsets;
+    size_t offset = alignUp(HEADER_SIZE + allSections.size() * TABLE_ENTRY_SIZE);
+    for (const Section* section : allSections) {
+        offsets.push_back(offset);
+        offset = alignUp(offset + section->bytes.size());
+    }
+    uint64_t fileSize = offset;
+
+    std::vector<char> head;
+    head.insert(head.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    BinaryBuffer::appendValue<uint32_t>(head, FORMAT_VERSION);
+    BinaryBuffer::appendValue<uint32_t>(head, BYTE_ORDER_MARK);
+    BinaryBuffer::appendValue<uint64_t>(head, schemaHash);
+    BinaryBuffer::appendValue<uint64_t>(head, allSections.size());
+    BinaryBuffer::appendValue<uint64_t>(head, HEADER_SIZE);
+    BinaryBuffer::appendValue<uint64_t>(head, fileSize);
+    appendPadding(head, HEADER_SIZE - head.size());
+    for (size_t i = 0; i < allSections.size(); ++i) {
+        char name[TABLE_NAME_SIZE] = {};
+        std::memcpy(name, allSections[i]->name.data(), allSections[i]->name.size());
+        head.insert(head.end(), name, name + TABLE_NAME_SIZE);
+        BinaryBuffer::appendValue<uint32_t>(head, static_cast<uint32_t>(allSections[i]->type));
+        BinaryBuffer::appendValue<uint32_t>(head, 0);
+        BinaryBuffer::appendValue<uint64_t>(head, offsets[i]);
+        BinaryBuffer::appendValue<uint64_t>(head, allSections[i]->count);
+    }
+
+    std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Cannot open " + temporaryPath + " for writing");
+        }
+        std::vector<char> padding(SECTION_ALIGNMENT, '\0');
+        file.write(head.data(), static_cast<std::streamsize>(head.size()));
+        size_t position = head.size();
+        for (size_t i = 0; i < allSections.size(); ++i) {
+            file.write(padding.data(), static_cast<std::streamsize>(offsets[i] - position));
+            file.write(allSections[i]->bytes.data(), static_cast<std::streamsize>(allSections[i]->bytes.size()));
+            position = offsets[i] + allSections[i]->bytes.size();
+        }
+        file.write(padding.data(), static_cast<std::streamsize>(fileSize - position));
+        if (!file) {
+            throw std::runtime_error("Could not write " + temporaryPath);
+        }
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(filePath.c_str());
+#endif
+    if (std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace " + filePath);
+    }
+}
+
+Reader::Reader(const std::string& filePath) : mapping(std::make_shared<MappedFile>(filePath)) {
+    const char* data = mapping->data();
+    size_t size = mapping->size();
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error(filePath + " is not a model file");
+    }
+
+    std::vector<char> head(data, data + HEADER_SIZE);
+    size_t offset = sizeof(MAGIC);
+    header.version = BinaryBuffer::readValue<uint32_t>(head, offset);
+    if (BinaryBuffer::readValue<uint32_t>(head, offset) != BYTE_ORDER_MARK) {
+        throw std::runtime_error(filePath + " was written on a machine with another byte order");
+    }
+    if (header.version == 0 || header.version > FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported model file version " + std::to_string(header.version) +
+                                 " in " + filePath);
+    }
+    header.schemaHash = BinaryBuffer::readValue<uint64_t>(head, offset);
+    uint64_t sectionCount = BinaryBuffer::readValue<uint64_t>(head, offset);
+    uint64_t tableOffset = BinaryBuffer::readValue<uint64_t>(head, offset);
+    uint64_t fileSize = BinaryBuffer::readValue<uint64_t>(head, offset);
+    if (fileSize != size || tableOffset > size || sectionCount > (size - tableOffset) / TABLE_ENTRY_SIZE) {
+        throw std::runtime_error(filePath + " is truncated or corrupt");
+    }
+
+    std::vector<char> table(data + tableOffset, data + tableOffset + sectionCount * TABLE_ENTRY_SIZE);
+    offset = 0;
+    for (uint64_t i = 0; i < sectionCount; ++i) {
+        const char* name = table.data() + offset;
+        size_t nameLength = strnlen(name, TABLE_NAME_SIZE);
+        std::string sectionName(name, nameLength);
+        offset += TABLE_NAME_SIZE;
+        Section section;
+        section.type = static_cast<ElementType>(BinaryBuffer::readValue<uint32_t>(table, offset));
+        BinaryBuffer::readValue<uint32_t>(table, offset);
+        section.offset = BinaryBuffer::readValue<uint64_t>(table, offset);
+        section.count = BinaryBuffer::readValue<uint64_t>(table, offset);
+
+        size_t width = elementSize(section.type);
+        if (nameLength == TABLE_NAME_SIZE || width == 0 || section.offset % SECTION_ALIGNMENT != 0 ||
+            section.offset > size || section.count > (size - section.offset) / width) {
+            throw std::runtime_error("Section table of " + filePath + " is corrupt");
+        }
+        sections[sectionName] = section;
+    }
+    header.modelName = string("model_name");
+}
+
+bool Reader::has(const std::string& name) const {
+    return sections.count(name) > 0;
+}
+
+const Reader::Section& Reader::find(const std::string& name, ElementType type) const {
+    auto it = sections.find(name);
+    if (it == sections.end()) {
+        throw std::runtime_error("Section " + name + " is missing from " + mapping->path());
+    }
+    if (it->second.type != type) {
+        throw std::runtime_error("Section " + name + " of " + mapping->path() + " has an unexpected type");
+    }
+    return it->second;
+}
+
+std::string Reader::string(const std::string& name) const {
+    ArrayView<uint8_t> bytes = array<uint8_t>(name);
+    return std::string(reinterpret_cast<const char*>(bytes.data), bytes.size);
+}
+
+std::vector<std::string> Reader::strings(const std::string& name) const {
+    ArrayView<uint8_t> bytes = array<uint8_t>(name);
+    std::vector<char> buffer(bytes.begin(), bytes.end());
+    size_t offset = 0;
+    uint64_t count = BinaryBuffer::readValue<uint64_t>(buffer, offset);
+    if (count > buffer.size()) {
+        throw std::runtime_error("Section " + name + " of " + mapping->path() + " is corrupt");
+    }
+    std::vector<std::string> values;
+    values.reserve(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; ++i) {
+        values.push_back(BinaryBuffer::readString(buffer, offset));
+    }
+    return values;
+}
+
+Eigen::VectorXd Reader::vector(const std::string& name) const {
+    ArrayView<double> values = array<double>(name);
+    return Eigen::Map<const Eigen::VectorXd>(values.data, static_cast<Eigen::Index>(values.size));
+}
+
+Eigen::MatrixXd Reader::matrix(const std::string& name) const {
+    ArrayView<double> values = array<double>(name);
+    ArrayView<int64_t> shape = array<int64_t>(name + ".shape");
+    if (shape.size != 2 || shape[0] < 0 || shape[1] < 0 ||
+        (shape[0] > 0 && static_cast<uint64_t>(shape[1]) > values.size / static_cast<uint64_t>(shape[0])) ||
+        static_cast<uint64_t>(shape[0] * shape[1]) != values.size) {
+        throw std::runtime_error("Matrix " + name + " of " + mapping->path() + " has an invalid shape");
+    }
+    return Eigen::Map<const Eigen::MatrixXd>(values.data, shape[0], shape[1]);
+}
+
+} // namespace ModelFile
+
+void Model::save(const std::string& filePath) const {
+    ModelFile::Writer writer;
+    writeModel(writer);
+
+    // Category labels of the categorical inputs, in input order, flattened
+    // with the number of labels of each column
+    std::vector<std::string> categoryColumns;
+    std::vector<std::string> labels;
+    std::vector<int64_t> labelCounts;
+    for (const auto& name : getVariableNames()) {
+        auto levels = categoryLevels.find(name);
+        if (levels != categoryLevels.end()) {
+            categoryColumns.push_back(name);
+            labels.insert(labels.end(), levels->second.begin(), levels->second.end());
+            labelCounts.push_back(static_cast<int64_t>(levels->second.size()));
+        }
+    }
+    if (!categoryColumns.empty()) {
+        writer.putStrings("category_columns", categoryColumns);
+        writer.putStrings("category_labels", labels);
+        writer.putArray("category_label_counts", labelCounts);
+    }
+    writer.write(filePath, getName(), ModelFile::schemaHash(getVariableNames(), getTargetName()));
+}
+
+std::shared_ptr<Model> Model::load(const std::string& filePath) {
+    ModelFile::Reader reader(filePath);
+    const std::string& name = reader.info().modelName;
+
+    std::shared_ptr<Model> model;
+    if (name == "Linear Regression") {
+        model = std::make_shared<LinearRegression>();
+    } else if (name == "ElasticNet") {
+        model = std::make_shared<ElasticNet>();
+    } else if (name == "Random Forest") {
+        model = std::make_shared<RandomForest>();
+    } else if (name == "XGBoost") {
+        model = std::make_shared<XGBoost>();
+    } else if (name == "Gradient Boosting") {
+        model = std::make_shared<GradientBoosting>();
+    } else if (name == "NeuralNetwork") {
+        model = std::make_shared<NeuralNetwork>();
+    } else {
+        throw std::runtime_error(filePath + " holds an unknown model type: " + name);
+    }
+
+    model->readModel(reader);
+
+    // An integrity check only: the hash and the names come from the same
+    // model, so this catches a damaged file, not data of another schema
+    if (ModelFile::schemaHash(model->getVariableNames(), model->getTargetName()) != reader.info().schemaHash) {
+        throw std::runtime_error("Schema hash of " + filePath + " does not match the stored variable names");
+    }
+
+    if (reader.has("category_columns")) {
+        std::vector<std::string> categoryColumns = reader.strings("category_columns");
+        std::vector<std::string> labels = reader.strings("category_labels");
+        ModelFile::ArrayView<int64_t> labelCounts = reader.array<int64_t>("category_label_counts");
+        if (labelCounts.size != categoryColumns.size()) {
+            throw std::runtime_error("Category labels of " + filePath + " are corrupt");
+        }
+        std::unordered_map<std::string, std::vector<std::string>> levels;
+        size_t first = 0;
+        for (size_t c = 0; c < categoryColumns.size(); ++c) {
+            if (labelCounts[c] < 0 || static_cast<uint64_t>(labelCounts[c]) > labels.size() - first) {
+                throw std::runtime_error("Category labels of " + filePath + " are corrupt");
+            }
+            size_t last = first + static_cast<size_t>(labelCounts[c]);
+            levels[categoryColumns[c]].assign(labels.begin() + static_cast<std::ptrdiff_t>(first),
+                                              labels.begin() + static_cast<std::ptrdiff_t>(last));
+            first = last;
+        }
+        model->setCategoryLevels(levels);
+    }
+    return model;
+}
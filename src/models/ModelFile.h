@@ -0,0 +1,244 @@
+#pragma once
+
+#include "utils/MappedFile.h"
+#include <Eigen/Dense>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Versioned binary format used by Model::save and Model::load
+ *
+ * A model file is a 64-byte header, a table of named sections and the
+ * section data. Every section is a typed array that starts on a 64-byte
+ * boundary, so once the file is memory mapped, coefficient vectors, weight
+ * matrices and flat tree arrays can be used in place: the tree ensembles
+ * score straight from the mapping without building any nodes. Matrices are
+ * stored column-major, as Eigen keeps them.
+ *
+ * The header holds a magic string, the format version, a byte order mark
+ * and a hash of the training schema (feature names in order and the target
+ * name). Model::load checks the hash against the names stored in the
+ * file, which only detects a damaged file: both were written from the same
+ * model. Whether data fits the model is checked where the data is read, as
+ * BatchScoring::checkColumns does against a file header. Values are stored
+ * in the byte order of the machine that wrote them; reading a file from a
+ * machine with the other byte order fails.
+ *
+ * Besides the model's own sections, Model::save stores the category labels
+ * of categorical inputs (see Model::setCategoryLevels) in the sections
+ * "category_columns", "category_labels" and "category_label_counts".
+ */
+namespace ModelFile {
+
+const uint32_t FORMAT_VERSION = 1;
+const size_t SECTION_ALIGNMENT = 64;
+const size_t MAX_SECTION_NAME = 39;
+
+/**
+ * @brief Element type of a section
+ */
+enum class ElementType : uint32_t {
+    BYTE = 1,
+    INT32 = 2,
+    INT64 = 3,
+    UINT64 = 4,
+    FLOAT64 = 5
+};
+
+template <typename T> struct ElementTypeOf;
+template <> struct ElementTypeOf<uint8_t> { static constexpr ElementType value = ElementType::BYTE; };
+template <> struct ElementTypeOf<int32_t> { static constexpr ElementType value = ElementType::INT32; };
+template <> struct ElementTypeOf<int64_t> { static constexpr ElementType value = ElementType::INT64; };
+template <> struct ElementTypeOf<uint64_t> { static constexpr ElementType value = ElementType::UINT64; };
+template <> struct ElementTypeOf<double> { static constexpr ElementType value = ElementType::FLOAT64; };
+
+/**
+ * @brief Read-only view of a section's elements
+ */
+template <typename T>
+struct ArrayView {
+    const T* data = nullptr;
+    size_t size = 0;
+
+    const T& operator[](size_t i) const { return data[i]; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+};
+
+/**
+ * @brief Header fields of a model file
+ */
+struct Info {
+    std::string modelName;
+    uint32_t version = 0;
+    uint64_t schemaHash = 0;
+};
+
+/**
+ * @brief Hash the training schema of a model
+ *
+ * FNV-1a over the number of features, each feature name and the target
+ * name. Two data sets with the same columns in the same order hash alike.
+ *
+ * @param variableNames Names of the input variables, in column order
+ * @param targetName Name of the target variable
+ * @return uint64_t Schema hash
+ */
+uint64_t schemaHash(const std::vector<std::string>& variableNames, const std::string& targetName);
+
+/**
+ * @brief Read the header of a model file without loading the model
+ *
+ * @param filePath Path of the model file
+ * @return Info Model name, format version and schema hash
+ * @throws std::runtime_error If the file is not a readable model file
+ */
+Info readInfo(const std::string& filePath);
+
+/**
+ * @brief Collects the sections of a model and writes them to a file
+ */
+class Writer {
+public:
+    /**
+     * @brief Add an array section
+     *
+     * @param name Section name, unique within the file
+     * @param values First element
+     * @param count Number of elements
+     * @throws std::invalid_argument If the name is empty, too long or already used
+     */
+    template <typename T>
+    void putArray(const std::string& name, const T* values, size_t count) {
+        addSection(name, ElementTypeOf<T>::value, values, count, sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const std::string& name, const std::vector<T>& values) {
+        putArray(name, values.data(), values.size());
+    }
+
+    template <typename T>
+    void putValue(const std::string& name, T value) {
+        putArray(name, &value, 1);
+    }
+
+    void putString(const std::string& name, const std::string& value);
+    void putStrings(const std::string& name, const std::vector<std::string>& values);
+
+    /**
+     * @brief Add a vector section
+     */
+    void putVector(const std::string& name, const Eigen::VectorXd& values);
+
+    /**
+     * @brief Add a matrix as its column-major values and a "<name>.shape" section
+     */
+    void putMatrix(const std::string& name, const Eigen::MatrixXd& matrix);
+
+    /**
+     * @brief Write the file
+     *
+     * The file is written under a temporary name and renamed, so an existing
+     * model file is only replaced by a complete one.
+     *
+     * @param filePath Path of the model file
+     * @param modelName Name of the model, as returned by Model::getName
+     * @param schemaHash Hash of the training schema
+     * @throws std::runtime_error If the file cannot be written
+     */
+    void write(const std::string& filePath, const std::string& modelName, uint64_t schemaHash) const;
+
+private:
+    struct Section {
+        std::string name;
+        ElementType type;
+        uint64_t count;
+        std::vector<char> bytes;
+    };
+    std::vector<Section> sections;
+
+    void addSection(const std::string& name, ElementType type, const void* values, size_t count,
+                    size_t elementSize);
+};
+
+/**
+ * @brief Memory-maps a model file and gives access to its sections
+ *
+ * Array views point into the mapping and stay valid as long as the reader
+ * or a copy of file() is alive.
+ */
+class Reader {
+public:
+    /**
+     * @brief Map a model file and read its section table
+     *
+     * @param filePath Path of the model file
+     * @throws std::runtime_error If the file is not a readable model file
+     */
+    explicit Reader(const std::string& filePath);
+
+    const Info& info() const { return header; }
+
+    /**
+     * @brief Check whether a section exists
+     */
+    bool has(const std::string& name) const;
+
+    /**
+     * @brief Get a section as a typed view into the mapping
+     *
+     * @throws std::runtime_error If the section is missing or has another type
+     */
+    template <typename T>
+    ArrayView<T> array(const std::string& name) const {
+        const Section& section = find(name, ElementTypeOf<T>::value);
+        ArrayView<T> view;
+        view.data = reinterpret_cast<const T*>(mapping->data() + section.offset);
+        view.size = static_cast<size_t>(section.count);
+        return view;
+    }
+
+    /**
+     * @brief Get a single-element section
+     *
+     * @throws std::runtime_error If the section is missing, has another type or another length
+     */
+    template <typename T>
+    T value(const std::string& name) const {
+        ArrayView<T> view = array<T>(name);
+        if (view.size != 1) {
+            throw std::runtime_error("Section " + name + " of " + mapping->path() + " is not a single value");
+        }
+        return view[0];
+    }
+
+    std::string string(const std::string& name) const;
+    std::vector<std::string> strings(const std::string& name) const;
+    Eigen::VectorXd vector(const std::string& name) const;
+    Eigen::MatrixXd matrix(const std::string& name) const;
+
+    /**
+     * @brief Get the mapping, to keep array views alive beyond the reader
+     */
+    std::shared_ptr<const MappedFile> file() const { return mapping; }
+
+private:
+    struct Section {
+        ElementType type;
+        uint64_t offset;
+        uint64_t count;
+    };
+    std::shared_ptr<const MappedFile> mapping;
+    std::unordered_map<std::string, Section> sections;
+    Info header;
+
+    const Section& find(const std::string& name, ElementType type) const;
+};
+
+} // namespace ModelFile
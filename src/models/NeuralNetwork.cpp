@@ -1,17 +1,192 @@
 #include "models/NeuralNetwork.h"
+#include "models/PermutationImportance.h"
+#include "models/ModelFile.h"
+#include "utils/BinaryBuffer.h"
+#include <cassert>
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <numeric>  // For std::iota and std::accumulate
 #include <sstream>
 #include <random>
 #include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Set Eigen's thread count for the lifetime of the object
+ *
+ * Eigen only runs products on several threads when built with OpenMP;
+ * otherwise nbThreads stays 1 whatever is set, which is reported once.
+ */
+class ScopedEigenThreads {
+public:
+    explicit ScopedEigenThreads(int numThreads) : previous(Eigen::nbThreads()) {
+        if (numThreads > 0) {
+            Eigen::setNbThreads(numThreads);
+        }
+        static std::once_flag warned;
+        if (numThreads > 1 && Eigen::nbThreads() == 1) {
+            std::call_once(warned, [numThreads]() {
+                std::cerr << "Warning: " << numThreads << " threads were requested for the matrix products, "
+                          << "but Eigen was built without OpenMP and runs them on one thread. "
+                          << "Compile with -fopenmp to use them." << std::endl;
+            });
+        }
+    }
+    ~ScopedEigenThreads() {
+        Eigen::setNbThreads(previous);
+    }
+
+private:
+    int previous;
+};
+
+/**
+ * @brief Reusable barrier for a fixed number of threads
+ */
+class StepBarrier {
+public:
+    explicit StepBarrier(int count) : count(count), waiting(0), generation(0) {
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        size_t arrivedGeneration = generation;
+        if (++waiting == count) {
+            waiting = 0;
+            ++generation;
+            condition.notify_all();
+            return;
+        }
+        condition.wait(lock, [&]() { return generation != arrivedGeneration; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    int count;
+    int waiting;
+    size_t generation;
+};
+
+using RowMatrixF = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+/**
+ * @brief Apply an activation in place to a tile of float activations
+ */
+void activateRows(Eigen::Ref<RowMatrixF> Z, Activation activation) {
+    switch (activation) {
+        case Activation::RELU:
+            Z.array() = Z.array().max(0.0f);
+            break;
+        case Activation::SIGMOID:
+            Z.array() = 1.0f / (1.0f + (-Z.array()).exp());
+            break;
+        case Activation::TANH:
+            Z.array() = Z.array().tanh();
+            break;
+        case Activation::LINEAR:
+            break;
+    }
+}
+
+/**
+ * @brief Multiply one quantized activation row by int8 weights with int32 accumulation
+ *
+ * The row is given as pairs of int16 values packed into int32 (element 2k in
+ * the low half). The weights are laid out as [pair][output][2] with outputs
+ * padded to a multiple of 8, so one multiply-add of a broadcast pair against
+ * 16 weights yields partial sums for 8 outputs.
+ *
+ * @param pairedRow Activation pairs
+ * @param weights Quantized weights
+ * @param pairs Number of activation pairs
+ * @param paddedOutputs Number of outputs, a multiple of 8
+ * @param sums Output sums, paddedOutputs entries
+ */
+void multiplyInt8(const int32_t* pairedRow, const int8_t* weights, Eigen::Index pairs,
+                  Eigen::Index paddedOutputs, int32_t* sums) {
+#if defined(__AVX2__)
+    for (Eigen::Index block = 0; block < paddedOutputs; block += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        const int8_t* column = weights + block * 2;
+        for (Eigen::Index k = 0; k < pairs; ++k) {
+            __m256i a = _mm256_set1_epi32(pairedRow[k]);
+            __m256i w = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + k * paddedOutputs * 2)));
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+            acc = _mm256_dpwssd_epi32(acc, a, w);
+#else
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a, w));
+#endif
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + block), acc);
+    }
+#else
+    std::fill(sums, sums + paddedOutputs, 0);
+    for (Eigen::Index k = 0; k < pairs; ++k) {
+        int32_t low = static_cast<int16_t>(pairedRow[k] & 0xFFFF);
+        int32_t high = static_cast<int16_t>(pairedRow[k] >> 16);
+        const int8_t* row = weights + k * paddedOutputs * 2;
+        for (Eigen::Index o = 0; o < paddedOutputs; ++o) {
+            sums[o] += low * row[2 * o] + high * row[2 * o + 1];
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Append a list of matrices or vectors to a checkpoint payload
+ */
+template <typename MatrixType>
+void appendMatrices(std::vector<char>& buffer, const std::vector<MatrixType>& matrices) {
+    BinaryBuffer::appendValue<uint32_t>(buffer, static_cast<uint32_t>(matrices.size()));
+    for (const auto& matrix : matrices) {
+        BinaryBuffer::appendMatrix(buffer, matrix);
+    }
+}
+
+/**
+ * @brief Read a list written by appendMatrices
+ */
+template <typename MatrixType>
+std::vector<MatrixType> readMatrices(const std::vector<char>& buffer, size_t& offset) {
+    uint32_t count = BinaryBuffer::readValue<uint32_t>(buffer, offset);
+    std::vector<MatrixType> matrices;
+    for (uint32_t i = 0; i < count; ++i) {
+        matrices.push_back(BinaryBuffer::readMatrix(buffer, offset));
+    }
+    return matrices;
+}
+
+} // namespace
 
 NeuralNetwork::NeuralNetwork() 
     : hiddenActivation(Activation::RELU), outputActivation(Activation::LINEAR),
       learningRate(0.01), epochs(1000), batchSize(32), tol(0.0001),
+      solver(Solver::SGD), alpha(0.0), useFloat32(false), numThreads(0),
+      randomSeed(-1), dataParallelThreads(1), hogwild(false),
+      validationFraction(0.0), patience(10), schedule(LearningRateSchedule::CONSTANT),
+      scheduleFactor(0.5), scheduleStep(10), currentLearningRate(learningRate), bestEpoch(0),
+      beta1(0.9), beta2(0.999), epsilon(1e-8), adamStep(0), lbfgsMemory(10), nIterations(0),
+      rng(std::random_device()()), loaderStalls(0),
+      restarts(1), restartEnsemble(false), restartThreads(0), checkpointInterval(10),
       rSquared(0.0), adjustedRSquared(0.0), rmse(0.0),
-      nSamples(0), nFeatures(0), isFitted(false) {
+      nSamples(0), nFeatures(0), isFitted(false),
+      inferenceMode(InferenceMode::REFERENCE), compiledOutputScale(1.0), compiledOutputShift(0.0) {
     // Initialize with a simple architecture (one hidden layer with 10 neurons)
     layerSizes = {10};
 }
@@ -25,8 +200,16 @@ NeuralNetwork::NeuralNetwork(const std::vector<int>& hiddenLayers,
                          double tol)
     : layerSizes(hiddenLayers), hiddenActivation(activation), outputActivation(outputActivation),
       learningRate(learningRate), epochs(epochs), batchSize(batchSize), tol(tol),
+      solver(Solver::SGD), alpha(0.0), useFloat32(false), numThreads(0),
+      randomSeed(-1), dataParallelThreads(1), hogwild(false),
+      validationFraction(0.0), patience(10), schedule(LearningRateSchedule::CONSTANT),
+      scheduleFactor(0.5), scheduleStep(10), currentLearningRate(learningRate), bestEpoch(0),
+      beta1(0.9), beta2(0.999), epsilon(1e-8), adamStep(0), lbfgsMemory(10), nIterations(0),
+      rng(std::random_device()()), loaderStalls(0),
+      restarts(1), restartEnsemble(false), restartThreads(0), checkpointInterval(10),
       rSquared(0.0), adjustedRSquared(0.0), rmse(0.0),
-      nSamples(0), nFeatures(0), isFitted(false) {
+      nSamples(0), nFeatures(0), isFitted(false),
+      inferenceMode(InferenceMode::REFERENCE), compiledOutputScale(1.0), compiledOutputShift(0.0) {
 }
 
 NeuralNetwork::NeuralNetwork(const std::vector<int>& hiddenLayers,
@@ -38,8 +221,16 @@ NeuralNetwork::NeuralNetwork(const std::vector<int>& hiddenLayers,
                          double alpha)
     : layerSizes(hiddenLayers),
       learningRate(learningRate), epochs(epochs), batchSize(batchSize), tol(0.0001),
+      solver(Solver::ADAM), alpha(0.0), useFloat32(false), numThreads(0),
+      randomSeed(-1), dataParallelThreads(1), hogwild(false),
+      validationFraction(0.0), patience(10), schedule(LearningRateSchedule::CONSTANT),
+      scheduleFactor(0.5), scheduleStep(10), currentLearningRate(learningRate), bestEpoch(0),
+      beta1(0.9), beta2(0.999), epsilon(1e-8), adamStep(0), lbfgsMemory(10), nIterations(0),
+      rng(std::random_device()()), loaderStalls(0),
+      restarts(1), restartEnsemble(false), restartThreads(0), checkpointInterval(10),
       rSquared(0.0), adjustedRSquared(0.0), rmse(0.0),
-      nSamples(0), nFeatures(0), isFitted(false) {
+      nSamples(0), nFeatures(0), isFitted(false),
+      inferenceMode(InferenceMode::REFERENCE), compiledOutputScale(1.0), compiledOutputShift(0.0) {
     
     // Convert activation string to enum
     if (activation == "relu") {
@@ -59,24 +250,183 @@ NeuralNetwork::NeuralNetwork(const std::vector<int>& hiddenLayers,
     // For now, always use LINEAR for output activation
     outputActivation = Activation::LINEAR;
     
-    // Note: solver parameter currently not used in this implementation
-    // but could be extended to support different optimization algorithms
-    if (solver != "adam" && solver != "sgd" && solver != "lbfgs") {
-        std::cerr << "Warning: Solver '" << solver << "' not supported. Using default implementation." << std::endl;
+    try {
+        setSolver(solver);
+    } catch (const std::invalid_argument&) {
+        std::cerr << "Warning: Solver '" << solver << "' not supported. Using adam as default." << std::endl;
+        this->solver = Solver::ADAM;
+    }
+    
+    if (alpha < 0.0) {
+        std::cerr << "Warning: Negative alpha " << alpha << ". Using no L2 penalty." << std::endl;
+    } else {
+        this->alpha = alpha;
+    }
+}
+
+void NeuralNetwork::setSolver(const std::string& solver) {
+    if (solver == "adam") {
+        this->solver = Solver::ADAM;
+    } else if (solver == "sgd") {
+        this->solver = Solver::SGD;
+    } else if (solver == "lbfgs") {
+        this->solver = Solver::LBFGS;
+    } else {
+        throw std::invalid_argument("Unknown solver '" + solver + "' (expected adam, sgd or lbfgs)");
+    }
+}
+
+void NeuralNetwork::setAlpha(double alpha) {
+    if (alpha < 0.0) {
+        throw std::invalid_argument("alpha must be non-negative");
+    }
+    this->alpha = alpha;
+}
+
+void NeuralNetwork::setPrecision(const std::string& precision) {
+    if (precision == "float64") {
+        useFloat32 = false;
+    } else if (precision == "float32") {
+        useFloat32 = true;
+    } else {
+        throw std::invalid_argument("Unknown precision '" + precision + "' (expected float64 or float32)");
+    }
+}
+
+void NeuralNetwork::setNumThreads(int numThreads) {
+    if (numThreads < 0) {
+        throw std::invalid_argument("numThreads must be non-negative");
+    }
+    this->numThreads = numThreads;
+}
+
+void NeuralNetwork::setRandomSeed(int seed) {
+    randomSeed = seed < 0 ? -1 : seed;
+}
+
+void NeuralNetwork::setDataParallelThreads(int threads) {
+    if (threads < 1) {
+        throw std::invalid_argument("Number of data-parallel threads must be at least 1");
+    }
+    dataParallelThreads = threads;
+}
+
+void NeuralNetwork::setHogwild(bool enabled) {
+    hogwild = enabled;
+}
+
+void NeuralNetwork::setEarlyStopping(double validationFraction, int patience) {
+    if (validationFraction < 0.0 || validationFraction >= 1.0) {
+        throw std::invalid_argument("Validation fraction must be in [0, 1)");
+    }
+    if (patience < 1) {
+        throw std::invalid_argument("Patience must be at least 1");
+    }
+    this->validationFraction = validationFraction;
+    this->patience = patience;
+}
+
+void NeuralNetwork::setLearningRateSchedule(const std::string& schedule, double factor, int stepEpochs) {
+    if (factor <= 0.0 || factor > 1.0) {
+        throw std::invalid_argument("Learning rate factor must be in (0, 1]");
+    }
+    if (stepEpochs < 1) {
+        throw std::invalid_argument("Learning rate step must be at least 1 epoch");
+    }
+    if (schedule == "constant") {
+        this->schedule = LearningRateSchedule::CONSTANT;
+    } else if (schedule == "step") {
+        this->schedule = LearningRateSchedule::STEP;
+    } else if (schedule == "cosine") {
+        this->schedule = LearningRateSchedule::COSINE;
+    } else if (schedule == "plateau") {
+        this->schedule = LearningRateSchedule::PLATEAU;
+    } else {
+        throw std::invalid_argument("Unknown learning rate schedule '" + schedule +
+                                    "' (expected constant, step, cosine or plateau)");
+    }
+    scheduleFactor = factor;
+    scheduleStep = stepEpochs;
+}
+
+const std::vector<double>& NeuralNetwork::getTrainingLossHistory() const {
+    return trainingLossHistory;
+}
+
+const std::vector<double>& NeuralNetwork::getValidationLossHistory() const {
+    return validationLossHistory;
+}
+
+void NeuralNetwork::setRestarts(int restarts, const std::string& selection, int threads) {
+    if (restarts < 1) {
+        throw std::invalid_argument("Number of restarts must be at least 1");
+    }
+    if (threads < 0) {
+        throw std::invalid_argument("Number of restart threads must be non-negative");
+    }
+    if (selection == "best") {
+        restartEnsemble = false;
+    } else if (selection == "ensemble") {
+        restartEnsemble = true;
+    } else {
+        throw std::invalid_argument("Unknown restart selection '" + selection + "' (expected best or ensemble)");
+    }
+    this->restarts = restarts;
+    restartThreads = threads;
+}
+
+void NeuralNetwork::setCheckpoint(const std::string& filePath, int interval) {
+    if (interval < 1) {
+        throw std::invalid_argument("Checkpoint interval must be at least 1 epoch");
+    }
+    checkpointPath = filePath;
+    checkpointInterval = interval;
+}
+
+void NeuralNetwork::resumeFromCheckpoint(const std::string& filePath) {
+    std::vector<char> payload = CheckpointWriter::readPayload(filePath, getName());
+    resumeState = std::make_shared<TrainingCheckpoint>(TrainingCheckpoint::read(payload));
+}
+
+void NeuralNetwork::setInferenceMode(const std::string& mode) {
+    if (mode == "reference") {
+        inferenceMode = InferenceMode::REFERENCE;
+    } else if (mode == "folded") {
+        inferenceMode = InferenceMode::FOLDED;
+    } else if (mode == "int8") {
+        inferenceMode = InferenceMode::INT8;
+    } else {
+        throw std::invalid_argument("Unknown inference mode '" + mode + "' (expected reference, folded or int8)");
     }
 }
 
 bool NeuralNetwork::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                      const std::vector<std::string>& variableNames,
-                     const std::string& targetName) {
+                     const std::string& targetName,
+                     const Eigen::VectorXd& sampleWeights) {
     if (X.rows() != y.rows()) {
         std::cerr << "Error: Number of samples in X (" << X.rows() 
                  << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
         return false;
     }
 
+    if (X.hasNaN() || y.hasNaN()) {
+        std::cerr << "Error: " << getName() << " does not support missing values. "
+                 << "Use a tree-based model or remove rows with missing values." << std::endl;
+        return false;
+    }
+
+    Eigen::VectorXd rowWeights;
+    if (!resolveSampleWeights(sampleWeights, y.size(), rowWeights)) {
+        return false;
+    }
+
     try {
-        nSamples = X.rows();
+        ScopedEigenThreads threads(numThreads);
+        
+        // With frequency weights the effective sample size is the total weight
+        int nRows = X.rows();
+        nSamples = static_cast<int>(std::round(rowWeights.sum()));
         nFeatures = X.cols();
 
         // Store variable names
@@ -105,287 +455,1348 @@ bool NeuralNetwork::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         targetVariableName = targetName.empty() ? "Target" : targetName;
 
         // Calculate normalization parameters
-        calculateNormalizationParams(X, y);
+        calculateNormalizationParams(X, y, rowWeights);
 
-        // Initialize network architecture
-        // Input layer (nFeatures) -> Hidden layers -> Output layer (1)
-        std::vector<int> architecture;
-        architecture.push_back(nFeatures);
-        for (int hiddenSize : layerSizes) {
-            architecture.push_back(hiddenSize);
+        // A fixed seed restarts the generator, so the whole fit is reproducible;
+        // otherwise each fit continues the model's random stream
+        if (randomSeed >= 0) {
+            rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+        }
+        
+        fitFingerprint = TrainingCheckpoint();
+        fitFingerprint.rows = nRows;
+        fitFingerprint.features = nFeatures;
+        fitFingerprint.featureSum = X.sum();
+        fitFingerprint.targetSum = y.sum();
+        fitFingerprint.weightSum = rowWeights.sum();
+        fitFingerprint.layerSizes = layerSizes;
+        fitFingerprint.solver = static_cast<int>(solver);
+        fitFingerprint.float32 = useFloat32;
+        fitFingerprint.validationFraction = validationFraction;
+        
+        // Resuming restarts the generator where the interrupted fit started
+        // it, so the initialization, split and shuffle seed below repeat
+        std::shared_ptr<const TrainingCheckpoint> resume = std::move(resumeState);
+        resumeState.reset();
+        if (resume && (!resume->sameFit(fitFingerprint) || solver == Solver::LBFGS || restarts > 1)) {
+            std::cerr << "Warning: Checkpoint does not match the training data, network or solver. "
+                      << "Training Neural Network from scratch." << std::endl;
+            resume.reset();
         }
-        architecture.push_back(1);  // One output neuron for regression
+        if (resume) {
+            rng = resume->fitStartGenerator;
+        }
+        if (!checkpointPath.empty() && (solver == Solver::LBFGS || restarts > 1)) {
+            std::cerr << "Warning: Checkpoints are not written for L-BFGS or restarts." << std::endl;
+        }
+        fitFingerprint.fitStartGenerator = rng;
+        std::mt19937& gen = rng;
 
-        // Initialize weights and biases
-        weights.clear();
-        biases.clear();
+        // Input layer (nFeatures) -> Hidden layers -> Output layer (1)
+        initializeParameters();
+
+        // Normalize features
+        Eigen::MatrixXd X_norm = normalizeFeatures(X);
         
-        for (size_t i = 0; i < architecture.size() - 1; ++i) {
-            int inputSize = architecture[i];
-            int outputSize = architecture[i + 1];
-            
-            // Initialize weights with Xavier initialization
-            double weightScale = std::sqrt(2.0 / (inputSize + outputSize));
+        // Normalize target
+        Eigen::VectorXd y_norm = (y.array() - targetMean) / targetStdDev;
+        
+        // Hold out a random share of the rows for early stopping. The
+        // normalization above still uses every row, so the validation loss is
+        // on the same scale as the training loss
+        Eigen::VectorXd trainingWeights = rowWeights;
+        Eigen::MatrixXd X_validation;
+        Eigen::VectorXd y_validation;
+        Eigen::VectorXd w_validation;
+        std::vector<int> heldOutRows;
+        if (validationFraction > 0.0 && solver != Solver::LBFGS && nRows > 1) {
+            int nValidation = static_cast<int>(std::round(validationFraction * nRows));
+            nValidation = std::max(1, std::min(nValidation, nRows - 1));
+            std::vector<int> order(nRows);
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), gen);
             
-            // Create random weight matrix with values ~ N(0, weightScale)
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::normal_distribution<double> dist(0.0, weightScale);
+            Eigen::MatrixXd X_train(nRows - nValidation, nFeatures);
+            Eigen::VectorXd y_train(nRows - nValidation);
+            Eigen::VectorXd w_train(nRows - nValidation);
+            X_validation.resize(nValidation, nFeatures);
+            y_validation.resize(nValidation);
+            w_validation.resize(nValidation);
+            for (int i = 0; i < nRows; ++i) {
+                int row = order[i];
+                if (i < nValidation) {
+                    X_validation.row(i) = X_norm.row(row);
+                    y_validation(i) = y_norm(row);
+                    w_validation(i) = rowWeights(row);
+                } else {
+                    X_train.row(i - nValidation) = X_norm.row(row);
+                    y_train(i - nValidation) = y_norm(row);
+                    w_train(i - nValidation) = rowWeights(row);
+                }
+            }
             
-            Eigen::MatrixXd W(outputSize, inputSize);
-            for (int r = 0; r < outputSize; ++r) {
-                for (int c = 0; c < inputSize; ++c) {
-                    W(r, c) = dist(gen);
+            if (w_validation.sum() > 0.0 && w_train.sum() > 0.0) {
+                X_norm.swap(X_train);
+                y_norm.swap(y_train);
+                trainingWeights.swap(w_train);
+                heldOutRows.assign(order.begin(), order.begin() + nValidation);
+            } else {
+                std::cerr << "Warning: Validation or training rows have no weight. "
+                          << "Training without early stopping." << std::endl;
+                X_validation.resize(0, 0);
+            }
+        }
+        
+        ensembleMembers.clear();
+        restartScores.clear();
+        if (restarts > 1) {
+            trainRestarts(X_norm, y_norm, trainingWeights, X_validation, y_validation, w_validation);
+        } else {
+            trainNetwork(X_norm, y_norm, trainingWeights, X_validation, y_validation, w_validation, gen,
+                         resume.get());
+        }
+
+        // Set isFitted to true
+        isFitted = true;
+        compileInference();
+        
+        // Calculate statistics on all rows, including any validation rows
+        calculateStatistics(X, y, rowWeights);
+        keepImportanceRows(X, y, rowWeights, heldOutRows);
+
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting Neural Network model: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool NeuralNetwork::fitFromCSV(const std::string& filePath, const std::vector<std::string>& featureColumns,
+                               const std::string& targetColumn, size_t chunkRows, char separator) {
+    if (solver == Solver::LBFGS) {
+        std::cerr << "Error: L-BFGS needs all rows in memory. "
+                 << "Use fit or a mini-batch solver (sgd or adam) to train from a file." << std::endl;
+        return false;
+    }
+    if (featureColumns.empty()) {
+        std::cerr << "Error: No feature columns given." << std::endl;
+        return false;
+    }
+    if (validationFraction > 0.0 || dataParallelThreads > 1 || restarts > 1 ||
+        !checkpointPath.empty() || resumeState) {
+        std::cerr << "Warning: Early stopping, data-parallel threads, restarts and checkpoints "
+                 << "are not applied when training from a file." << std::endl;
+        resumeState.reset();
+    }
+
+    try {
+        ScopedEigenThreads threads(numThreads);
+        chunkRows = std::max<size_t>(chunkRows, 1);
+        std::vector<std::string> columns = featureColumns;
+        columns.push_back(targetColumn);
+        size_t nCols = columns.size();
+        
+        // First pass: running means and sums of squared deviations (Welford)
+        CSVChunkReader reader(filePath, separator);
+        std::vector<std::vector<double>> chunk;
+        Eigen::VectorXd means = Eigen::VectorXd::Zero(nCols);
+        Eigen::VectorXd squares = Eigen::VectorXd::Zero(nCols);
+        double count = 0.0;
+        size_t rowsRead;
+        while ((rowsRead = reader.readChunk(columns, chunkRows, chunk)) > 0) {
+            for (size_t r = 0; r < rowsRead; ++r) {
+                count += 1.0;
+                for (size_t c = 0; c < nCols; ++c) {
+                    double value = chunk[c][r];
+                    if (std::isnan(value)) {
+                        std::cerr << "Error: " << getName() << " does not support missing values "
+                                 << "(column '" << columns[c] << "')." << std::endl;
+                        return false;
+                    }
+                    double delta = value - means(c);
+                    means(c) += delta / count;
+                    squares(c) += delta * (value - means(c));
                 }
             }
-            weights.push_back(W);
+        }
+        if (count < 2.0) {
+            std::cerr << "Error: At least two rows are needed to fit " << getName() << "." << std::endl;
+            return false;
+        }
+        
+        nSamples = static_cast<int>(count);
+        nFeatures = static_cast<int>(featureColumns.size());
+        inputVariableNames = featureColumns;
+        targetVariableName = targetColumn;
+        
+        // Same standardization as calculateNormalizationParams with unit weights
+        featureMeans = means.head(nFeatures);
+        featureStdDevs = (squares.head(nFeatures) / (count - 1.0)).cwiseSqrt();
+        for (int i = 0; i < nFeatures; ++i) {
+            if (featureStdDevs(i) < 1e-10) {
+                featureStdDevs(i) = 1.0;
+            }
+        }
+        targetMean = means(nFeatures);
+        targetStdDev = std::sqrt(squares(nFeatures) / (count - 1.0));
+        if (targetStdDev < 1e-10) {
+            targetStdDev = 1.0;
+        }
+        
+        if (randomSeed >= 0) {
+            rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+        }
+        initializeParameters();
+        
+        nIterations = 0;
+        loaderStalls = 0;
+        bestEpoch = 0;
+        currentLearningRate = learningRate;
+        trainingLossHistory.clear();
+        validationLossHistory.clear();
+        trainingLossHistory.reserve(epochs);
+        ensembleMembers.clear();
+        restartScores.clear();
+        
+        // Every epoch streams the file again through the batch loader
+        EpochMonitor monitor;
+        Eigen::Index nRows = static_cast<Eigen::Index>(count);
+        if (useFloat32) {
+            trainMiniBatch<float>(std::make_unique<CSVBatchSource<float>>(
+                                      filePath, featureColumns, targetColumn, featureMeans, featureStdDevs,
+                                      targetMean, targetStdDev, chunkRows, separator),
+                                  nRows, count, rng, monitor);
+        } else {
+            trainMiniBatch<double>(std::make_unique<CSVBatchSource<double>>(
+                                       filePath, featureColumns, targetColumn, featureMeans, featureStdDevs,
+                                       targetMean, targetStdDev, chunkRows, separator),
+                                   nRows, count, rng, monitor);
+        }
+        isFitted = true;
+        compileInference();
+        
+        // Last pass: the statistics of calculateStatistics, one chunk at a time
+        reader.rewind();
+        double sst = 0.0;
+        double ssr = 0.0;
+        double sse = 0.0;
+        Eigen::MatrixXd X_chunk;
+        const Eigen::Index maxImportanceRows = 2000;
+        importanceX.resize(0, nFeatures);
+        importanceY.resize(0);
+        while ((rowsRead = reader.readChunk(columns, chunkRows, chunk)) > 0) {
+            X_chunk.resize(rowsRead, nFeatures);
+            for (int c = 0; c < nFeatures; ++c) {
+                X_chunk.col(c) = Eigen::Map<const Eigen::VectorXd>(chunk[c].data(), rowsRead);
+            }
+            Eigen::VectorXd predicted = predict(X_chunk);
+            Eigen::Map<const Eigen::VectorXd> actual(chunk.back().data(), rowsRead);
             
-            // Initialize biases to zero
-            Eigen::VectorXd b = Eigen::VectorXd::Zero(outputSize);
-            biases.push_back(b);
+            // The first rows of the file are kept for permutation importance
+            Eigen::Index keep = std::min<Eigen::Index>(rowsRead, maxImportanceRows - importanceX.rows());
+            if (keep > 0) {
+                Eigen::Index kept = importanceX.rows();
+                importanceX.conservativeResize(kept + keep, Eigen::NoChange);
+                importanceY.conservativeResize(kept + keep);
+                importanceX.bottomRows(keep) = X_chunk.topRows(keep);
+                importanceY.tail(keep) = actual.head(keep);
+            }
+            sst += (actual.array() - targetMean).square().sum();
+            ssr += (predicted.array() - targetMean).square().sum();
+            sse += (actual - predicted).squaredNorm();
         }
+        rSquared = ssr / sst;
+        adjustedRSquared = 1.0 - (1.0 - rSquared) * (nSamples - 1) / (nSamples - nFeatures - 1);
+        rmse = std::sqrt(sse / count);
+        importanceWeights = Eigen::VectorXd::Ones(importanceY.size());
+        
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting Neural Network model from " << filePath << ": " << e.what() << std::endl;
+        return false;
+    }
+}
 
-        // Normalize features
-        Eigen::MatrixXd X_norm = normalizeFeatures(X);
+void NeuralNetwork::trainNetwork(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                 const Eigen::VectorXd& sampleWeights, const Eigen::MatrixXd& validationX,
+                                 const Eigen::VectorXd& validationY, const Eigen::VectorXd& validationWeights,
+                                 std::mt19937& generator, const TrainingCheckpoint* resume) {
+    nIterations = 0;
+    loaderStalls = 0;
+    bestEpoch = 0;
+    currentLearningRate = learningRate;
+    trainingLossHistory.clear();
+    validationLossHistory.clear();
+    trainingLossHistory.reserve(epochs);
+    
+    // The validation rows are only read, so restarts can share them
+    EpochMonitor monitor;
+    if (validationX.rows() > 0) {
+        monitor.validationX = &validationX;
+        monitor.validationY = &validationY;
+        monitor.validationWeights = &validationWeights;
+        allocateWorkspace(monitor.validationWorkspace, validationX.rows(), false);
+        monitor.bestWeights = weights;
+        monitor.bestBiases = biases;
+        validationLossHistory.reserve(epochs);
+    }
+    if (resume) {
+        restoreCheckpoint(*resume, monitor);
+    }
+    
+    // Snapshots are written on the writer's thread while training goes on
+    std::unique_ptr<CheckpointWriter> checkpointWriter;
+    if (!checkpointPath.empty() && solver != Solver::LBFGS) {
+        checkpointWriter = std::make_unique<CheckpointWriter>(checkpointPath, getName());
+        monitor.checkpointWriter = checkpointWriter.get();
+    }
+    
+    // L-BFGS works on the full batch, the other solvers on mini-batches
+    if (solver == Solver::LBFGS) {
+        trainLBFGS(X, y, sampleWeights);
+    } else if (dataParallelThreads > 1) {
+        if (useFloat32) {
+            trainDataParallel<float>(X, y, sampleWeights, generator, monitor);
+        } else {
+            trainDataParallel<double>(X, y, sampleWeights, generator, monitor);
+        }
+    } else if (useFloat32) {
+        trainMiniBatch<float>(std::make_unique<MatrixBatchSource<float>>(X, y, sampleWeights),
+                              X.rows(), sampleWeights.sum(), generator, monitor);
+    } else {
+        trainMiniBatch<double>(std::make_unique<MatrixBatchSource<double>>(X, y, sampleWeights),
+                               X.rows(), sampleWeights.sum(), generator, monitor);
+    }
+    
+    // Checkpoint the last epoch unless endEpoch just did
+    if (monitor.checkpointWriter && nIterations > monitor.firstEpoch && nIterations % checkpointInterval != 0) {
+        submitCheckpoint(nIterations, monitor);
+    }
+    
+    // Keep the weights of the epoch with the lowest validation loss
+    if (bestEpoch > 0) {
+        weights = monitor.bestWeights;
+        biases = monitor.bestBiases;
+    }
+}
+
+void NeuralNetwork::submitCheckpoint(int epochsDone, const EpochMonitor& monitor) {
+    // Copy the state here; serializing and writing run on the writer thread
+    TrainingCheckpoint checkpoint = fitFingerprint;
+    checkpoint.epochsDone = epochsDone;
+    checkpoint.weights = weights;
+    checkpoint.biases = biases;
+    checkpoint.adamStep = adamStep;
+    checkpoint.weightMoments = weightMoments;
+    checkpoint.weightSquaredMoments = weightSquaredMoments;
+    checkpoint.biasMoments = biasMoments;
+    checkpoint.biasSquaredMoments = biasSquaredMoments;
+    checkpoint.learningRate = currentLearningRate;
+    checkpoint.bestEpoch = bestEpoch;
+    checkpoint.trainingLossHistory = trainingLossHistory;
+    checkpoint.validationLossHistory = validationLossHistory;
+    checkpoint.bestWeights = monitor.bestWeights;
+    checkpoint.bestBiases = monitor.bestBiases;
+    checkpoint.bestLoss = monitor.bestLoss;
+    checkpoint.previousLoss = monitor.previousLoss;
+    checkpoint.epochsWithoutImprovement = monitor.epochsWithoutImprovement;
+    checkpoint.plateauLoss = monitor.plateauLoss;
+    checkpoint.plateauEpochs = monitor.plateauEpochs;
+    monitor.checkpointWriter->submit([checkpoint = std::move(checkpoint)](std::vector<char>& buffer) {
+        checkpoint.append(buffer);
+    });
+}
+
+void NeuralNetwork::restoreCheckpoint(const TrainingCheckpoint& checkpoint, EpochMonitor& monitor) {
+    weights = checkpoint.weights;
+    biases = checkpoint.biases;
+    adamStep = checkpoint.adamStep;
+    weightMoments = checkpoint.weightMoments;
+    weightSquaredMoments = checkpoint.weightSquaredMoments;
+    biasMoments = checkpoint.biasMoments;
+    biasSquaredMoments = checkpoint.biasSquaredMoments;
+    currentLearningRate = checkpoint.learningRate;
+    bestEpoch = checkpoint.bestEpoch;
+    trainingLossHistory = checkpoint.trainingLossHistory;
+    validationLossHistory = checkpoint.validationLossHistory;
+    nIterations = checkpoint.epochsDone;
+    
+    if (monitor.validationX) {
+        monitor.bestWeights = checkpoint.bestWeights;
+        monitor.bestBiases = checkpoint.bestBiases;
+    }
+    monitor.bestLoss = checkpoint.bestLoss;
+    monitor.previousLoss = checkpoint.previousLoss;
+    monitor.epochsWithoutImprovement = checkpoint.epochsWithoutImprovement;
+    monitor.plateauLoss = checkpoint.plateauLoss;
+    monitor.plateauEpochs = checkpoint.plateauEpochs;
+    monitor.firstEpoch = checkpoint.epochsDone;
+}
+
+void NeuralNetwork::TrainingCheckpoint::append(std::vector<char>& buffer) const {
+    using namespace BinaryBuffer;
+    appendValue<int64_t>(buffer, rows);
+    appendValue<int32_t>(buffer, features);
+    appendValue<double>(buffer, featureSum);
+    appendValue<double>(buffer, targetSum);
+    appendValue<double>(buffer, weightSum);
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(layerSizes.size()));
+    for (int size : layerSizes) {
+        appendValue<int32_t>(buffer, size);
+    }
+    appendValue<int32_t>(buffer, solver);
+    appendValue<uint8_t>(buffer, float32 ? 1 : 0);
+    appendValue<double>(buffer, validationFraction);
+    
+    std::ostringstream generatorState;
+    generatorState << fitStartGenerator;
+    appendString(buffer, generatorState.str());
+    
+    appendValue<int32_t>(buffer, epochsDone);
+    appendMatrices(buffer, weights);
+    appendMatrices(buffer, biases);
+    appendValue<int64_t>(buffer, adamStep);
+    appendMatrices(buffer, weightMoments);
+    appendMatrices(buffer, weightSquaredMoments);
+    appendMatrices(buffer, biasMoments);
+    appendMatrices(buffer, biasSquaredMoments);
+    appendValue<double>(buffer, learningRate);
+    appendValue<int32_t>(buffer, bestEpoch);
+    appendDoubles(buffer, trainingLossHistory);
+    appendDoubles(buffer, validationLossHistory);
+    
+    appendMatrices(buffer, bestWeights);
+    appendMatrices(buffer, bestBiases);
+    appendValue<double>(buffer, bestLoss);
+    appendValue<double>(buffer, previousLoss);
+    appendValue<int32_t>(buffer, epochsWithoutImprovement);
+    appendValue<double>(buffer, plateauLoss);
+    appendValue<int32_t>(buffer, plateauEpochs);
+}
+
+NeuralNetwork::TrainingCheckpoint NeuralNetwork::TrainingCheckpoint::read(const std::vector<char>& buffer) {
+    using namespace BinaryBuffer;
+    size_t offset = 0;
+    TrainingCheckpoint checkpoint;
+    checkpoint.rows = readValue<int64_t>(buffer, offset);
+    checkpoint.features = readValue<int32_t>(buffer, offset);
+    checkpoint.featureSum = readValue<double>(buffer, offset);
+    checkpoint.targetSum = readValue<double>(buffer, offset);
+    checkpoint.weightSum = readValue<double>(buffer, offset);
+    uint32_t layers = readValue<uint32_t>(buffer, offset);
+    for (uint32_t i = 0; i < layers; ++i) {
+        checkpoint.layerSizes.push_back(readValue<int32_t>(buffer, offset));
+    }
+    checkpoint.solver = readValue<int32_t>(buffer, offset);
+    checkpoint.float32 = readValue<uint8_t>(buffer, offset) != 0;
+    checkpoint.validationFraction = readValue<double>(buffer, offset);
+    
+    std::istringstream generatorState(readString(buffer, offset));
+    generatorState >> checkpoint.fitStartGenerator;
+    if (!generatorState) {
+        throw std::runtime_error("Malformed generator state in checkpoint");
+    }
+    
+    checkpoint.epochsDone = readValue<int32_t>(buffer, offset);
+    checkpoint.weights = readMatrices<Eigen::MatrixXd>(buffer, offset);
+    checkpoint.biases = readMatrices<Eigen::VectorXd>(buffer, offset);
+    checkpoint.adamStep = readValue<int64_t>(buffer, offset);
+    checkpoint.weightMoments = readMatrices<Eigen::MatrixXd>(buffer, offset);
+    checkpoint.weightSquaredMoments = readMatrices<Eigen::MatrixXd>(buffer, offset);
+    checkpoint.biasMoments = readMatrices<Eigen::VectorXd>(buffer, offset);
+    checkpoint.biasSquaredMoments = readMatrices<Eigen::VectorXd>(buffer, offset);
+    checkpoint.learningRate = readValue<double>(buffer, offset);
+    checkpoint.bestEpoch = readValue<int32_t>(buffer, offset);
+    checkpoint.trainingLossHistory = readDoubles(buffer, offset);
+    checkpoint.validationLossHistory = readDoubles(buffer, offset);
+    
+    checkpoint.bestWeights = readMatrices<Eigen::MatrixXd>(buffer, offset);
+    checkpoint.bestBiases = readMatrices<Eigen::VectorXd>(buffer, offset);
+    checkpoint.bestLoss = readValue<double>(buffer, offset);
+    checkpoint.previousLoss = readValue<double>(buffer, offset);
+    checkpoint.epochsWithoutImprovement = readValue<int32_t>(buffer, offset);
+    checkpoint.plateauLoss = readValue<double>(buffer, offset);
+    checkpoint.plateauEpochs = readValue<int32_t>(buffer, offset);
+    
+    if (checkpoint.weights.size() != checkpoint.layerSizes.size() + 1 ||
+        checkpoint.biases.size() != checkpoint.weights.size()) {
+        throw std::runtime_error("Checkpoint weights do not match its layer sizes");
+    }
+    if (checkpoint.bestEpoch > static_cast<int>(checkpoint.validationLossHistory.size())) {
+        throw std::runtime_error("Checkpoint best epoch has no validation loss");
+    }
+    return checkpoint;
+}
+
+bool NeuralNetwork::TrainingCheckpoint::sameFit(const TrainingCheckpoint& other) const {
+    return rows == other.rows && features == other.features && featureSum == other.featureSum &&
+           targetSum == other.targetSum && weightSum == other.weightSum &&
+           layerSizes == other.layerSizes && solver == other.solver &&
+           float32 == other.float32 && validationFraction == other.validationFraction;
+}
+
+void NeuralNetwork::trainRestarts(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                  const Eigen::VectorXd& sampleWeights, const Eigen::MatrixXd& validationX,
+                                  const Eigen::VectorXd& validationY, const Eigen::VectorXd& validationWeights) {
+    // Each restart is a copy of this network with its own seed, drawn here
+    // in order so a fixed random seed reproduces every restart
+    std::vector<std::shared_ptr<NeuralNetwork>> members;
+    members.reserve(restarts);
+    for (int k = 0; k < restarts; ++k) {
+        auto member = std::make_shared<NeuralNetwork>(*this);
+        member->restarts = 1;
+        member->dataParallelThreads = 1;
+        member->ensembleMembers.clear();
+        member->compiledLayers.clear();
+        member->checkpointPath.clear();
+        member->importanceX.resize(0, 0);
+        member->rng.seed(rng());
+        members.push_back(member);
+    }
+    
+    int threads = restartThreads > 0 ? restartThreads
+                                     : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, restarts);
+    
+    // The pool already uses the cores, so keep each product on one thread
+    ScopedEigenThreads productThreads(1);
+    std::atomic<int> nextRestart(0);
+    std::vector<std::exception_ptr> errors(restarts);
+    auto work = [&]() {
+        for (int k = nextRestart++; k < restarts; k = nextRestart++) {
+            try {
+                NeuralNetwork& member = *members[k];
+                member.initializeParameters();
+                member.trainNetwork(X, y, sampleWeights, validationX, validationY, validationWeights, member.rng);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    
+    // Rank by the best validation loss, or the last training loss without
+    // early stopping
+    restartScores.resize(restarts);
+    int best = 0;
+    for (int k = 0; k < restarts; ++k) {
+        const NeuralNetwork& member = *members[k];
+        if (member.bestEpoch > 0) {
+            restartScores[k] = member.validationLossHistory[member.bestEpoch - 1];
+        } else if (!member.trainingLossHistory.empty()) {
+            restartScores[k] = member.trainingLossHistory.back();
+        } else {
+            restartScores[k] = std::numeric_limits<double>::infinity();
+        }
+        if (restartScores[k] < restartScores[best]) {
+            best = k;
+        }
+    }
+    
+    const NeuralNetwork& winner = *members[best];
+    weights = winner.weights;
+    biases = winner.biases;
+    nIterations = winner.nIterations;
+    bestEpoch = winner.bestEpoch;
+    loaderStalls = winner.loaderStalls;
+    currentLearningRate = winner.currentLearningRate;
+    trainingLossHistory = winner.trainingLossHistory;
+    validationLossHistory = winner.validationLossHistory;
+    initializeSolverState();
+    
+    if (restartEnsemble) {
+        for (auto& member : members) {
+            member->isFitted = true;
+            member->compileInference();
+        }
+        ensembleMembers = std::move(members);
+    }
+}
+
+void NeuralNetwork::calculateNormalizationParams(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                                 const Eigen::VectorXd& sampleWeights) {
+    double totalWeight = sampleWeights.sum();
+    double dof = std::max(totalWeight - 1.0, 1.0);
+    
+    // Calculate feature means
+    featureMeans = (X.transpose() * sampleWeights) / totalWeight;
+    
+    // Calculate feature standard deviations
+    featureStdDevs = Eigen::VectorXd(X.cols());
+    for (int i = 0; i < X.cols(); ++i) {
+        Eigen::VectorXd col = X.col(i);
+        featureStdDevs(i) = std::sqrt((sampleWeights.array() * (col.array() - featureMeans(i)).square()).sum() / dof);
         
-        // Normalize target
-        Eigen::VectorXd y_norm = (y.array() - targetMean) / targetStdDev;
+        // Handle constant features (std dev = 0)
+        if (featureStdDevs(i) < 1e-10) {
+            featureStdDevs(i) = 1.0;
+        }
+    }
+    
+    // Calculate target mean and standard deviation
+    targetMean = sampleWeights.dot(y) / totalWeight;
+    targetStdDev = std::sqrt((sampleWeights.array() * (y.array() - targetMean).square()).sum() / dof);
+    
+    // Handle constant target (std dev = 0)
+    if (targetStdDev < 1e-10) {
+        targetStdDev = 1.0;
+    }
+}
+
+Eigen::MatrixXd NeuralNetwork::normalizeFeatures(const Eigen::Ref<const Eigen::MatrixXd>& X) const {
+    Eigen::MatrixXd X_norm = X;
+    
+    for (int i = 0; i < X.cols(); ++i) {
+        X_norm.col(i) = (X.col(i).array() - featureMeans(i)) / featureStdDevs(i);
+    }
+    
+    return X_norm;
+}
+
+template <typename Scalar>
+void NeuralNetwork::trainMiniBatch(std::unique_ptr<typename BatchLoader<Scalar>::Source> source, Eigen::Index nRows,
+                                   double totalWeight, std::mt19937& generator, EpochMonitor& monitor) {
+    // Buffers for the mini-batch loop; after this no step allocates
+    Eigen::Index batchRows = std::max<Eigen::Index>(1, std::min<Eigen::Index>(batchSize, nRows));
+    TrainingWorkspace<Scalar> workspace;
+    allocateWorkspace(workspace, batchRows, true);
+    
+    // The loader shuffles and gathers the next batches on its own thread
+    BatchLoader<Scalar> loader(std::move(source), nFeatures, batchRows, epochs, generator(), 4,
+                               monitor.firstEpoch);
+    
+    // Training loop
+    for (int epoch = monitor.firstEpoch; epoch < epochs; ++epoch) {
+        double epochLoss = 0.0;
         
-        // Initialize variables for training
-        double prevLoss = std::numeric_limits<double>::max();
-        
-        // Training loop
-        for (int epoch = 0; epoch < epochs; ++epoch) {
-            // Shuffle indices for stochastic gradient descent
-            std::vector<int> indices(nSamples);
-            std::iota(indices.begin(), indices.end(), 0);
-            std::random_device rd;
-            std::mt19937 g(rd());
-            std::shuffle(indices.begin(), indices.end(), g);
+        // Mini-batch gradient descent
+        for (;;) {
+            const typename BatchLoader<Scalar>::Batch& batch = loader.next();
+            if (batch.endOfEpoch) {
+                loader.release();
+                break;
+            }
+            auto X_batch = batch.inputs.topRows(batch.rows);
+            auto y_batch = batch.targets.head(batch.rows);
+            auto w_batch = batch.rowWeights.head(batch.rows);
+            if (w_batch.sum() <= 0) {
+                loader.release();
+                continue;
+            }
             
-            double epochLoss = 0.0;
+            // Forward propagation
+            forwardPropagate<Scalar>(X_batch, workspace);
             
-            // Mini-batch gradient descent
-            for (int i = 0; i < nSamples; i += batchSize) {
-                int actualBatchSize = std::min(batchSize, nSamples - i);
-                
-                // Create batch
-                Eigen::MatrixXd X_batch(actualBatchSize, nFeatures);
-                Eigen::VectorXd y_batch(actualBatchSize);
-                
-                for (int j = 0; j < actualBatchSize; ++j) {
-                    X_batch.row(j) = X_norm.row(indices[i + j]);
-                    y_batch(j) = y_norm(indices[i + j]);
+            // Backward propagation
+            backwardPropagate<Scalar>(X_batch, y_batch, w_batch, workspace);
+            
+            // Calculate batch loss (weighted MSE) before the weights change,
+            // then hand the batch buffer back to the loader
+            auto predictions = workspace.activations.back().col(0).head(batch.rows);
+            epochLoss += static_cast<double>(w_batch.dot((predictions - y_batch).array().square().matrix()));
+            loader.release();
+            
+            // Update parameters
+            updateParameters<Scalar>(workspace.weightGrads, workspace.biasGrads);
+            syncWorkspaceWeights(workspace);
+        }
+        
+        // Average loss for the epoch
+        epochLoss /= totalWeight;
+        if (endEpoch(epoch, epochLoss, monitor)) {
+            break;
+        }
+    }
+    loaderStalls = loader.getStalls();
+}
+
+template <typename Scalar>
+void NeuralNetwork::trainDataParallel(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                      const Eigen::VectorXd& sampleWeights, std::mt19937& generator,
+                                      EpochMonitor& monitor) {
+    int nRows = X.rows();
+    int threads = dataParallelThreads;
+    int batchRows = std::max(1, std::min(batchSize, nRows));
+    double totalWeight = sampleWeights.sum();
+    
+    // The threads already split the work, so keep each product on one thread
+    ScopedEigenThreads productThreads(1);
+    
+    std::vector<TrainingWorkspace<Scalar>> workspaces(threads);
+    for (auto& workspace : workspaces) {
+        allocateWorkspace(workspace, batchRows, true);
+    }
+    std::vector<int> indices(nRows);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::vector<double> shardLoss(threads, 0.0);
+    std::vector<double> shardWeight(threads, 0.0);
+    StepBarrier barrier(threads);
+    bool converged = false;
+    
+    // Each epoch's order depends only on the seed and the epoch, as in BatchLoader
+    std::mt19937::result_type shuffleSeed = generator();
+    std::mt19937 epochGenerator;
+    auto shuffleEpoch = [&](int epoch) {
+        std::iota(indices.begin(), indices.end(), 0);
+        seedEpochGenerator(epochGenerator, shuffleSeed, epoch);
+        std::shuffle(indices.begin(), indices.end(), epochGenerator);
+    };
+    
+    // Runs on thread 0 between barriers, while no other thread touches the weights
+    auto finishEpoch = [&](int epoch, double epochLoss) {
+        converged = endEpoch(epoch, epochLoss / totalWeight, monitor);
+    };
+    
+    // Synchronous steps: thread k takes rows [k * batchRows, (k + 1) * batchRows)
+    // of each threads * batchRows step, then the gradients are reduced into
+    // workspace 0 for one optimizer step
+    auto runSynchronous = [&](int k) {
+        TrainingWorkspace<Scalar>& workspace = workspaces[k];
+        int stepRows = threads * batchRows;
+        double epochLoss = 0.0;
+        for (int epoch = monitor.firstEpoch; epoch < epochs; ++epoch) {
+            if (k == 0) {
+                shuffleEpoch(epoch);
+                epochLoss = 0.0;
+            }
+            barrier.wait();
+            
+            for (int start = 0; start < nRows; start += stepRows) {
+                int begin = start + k * batchRows;
+                int rows = std::max(0, std::min(batchRows, nRows - begin));
+                shardLoss[k] = 0.0;
+                shardWeight[k] = 0.0;
+                if (rows > 0) {
+                    syncWorkspaceWeights(workspace);
+                    gatherBatch(X, y, sampleWeights, indices.data() + begin, rows, workspace);
+                    auto X_batch = workspace.inputs.topRows(rows);
+                    auto y_batch = workspace.targets.head(rows);
+                    auto w_batch = workspace.rowWeights.head(rows);
+                    Scalar batchWeight = w_batch.sum();
+                    if (batchWeight > 0) {
+                        forwardPropagate<Scalar>(X_batch, workspace);
+                        backwardPropagate<Scalar>(X_batch, y_batch, w_batch, workspace);
+                        auto predictions = workspace.activations.back().col(0).head(rows);
+                        shardLoss[k] = static_cast<double>(w_batch.dot((predictions - y_batch).array().square().matrix()));
+                        shardWeight[k] = static_cast<double>(batchWeight);
+                    }
                 }
                 
-                // Forward propagation
-                std::vector<Eigen::MatrixXd> activations = forwardPropagate(X_batch);
-                
-                // Backward propagation
-                auto [weightGrads, biasGrads] = backwardPropagate(X_batch, y_batch, activations);
+                // Turn the shard's weighted mean gradients into weighted sums
+                for (size_t l = 0; l < workspace.weightGrads.size(); ++l) {
+                    workspace.weightGrads[l] *= static_cast<Scalar>(shardWeight[k]);
+                    workspace.biasGrads[l] *= static_cast<Scalar>(shardWeight[k]);
+                }
+                barrier.wait();
                 
-                // Update parameters
-                updateParameters(weightGrads, biasGrads);
+                // Tree reduction: at each level thread k adds in thread k + stride
+                for (int stride = 1; stride < threads; stride *= 2) {
+                    if (k % (2 * stride) == 0 && k + stride < threads) {
+                        const TrainingWorkspace<Scalar>& other = workspaces[k + stride];
+                        for (size_t l = 0; l < workspace.weightGrads.size(); ++l) {
+                            workspace.weightGrads[l] += other.weightGrads[l];
+                            workspace.biasGrads[l] += other.biasGrads[l];
+                        }
+                    }
+                    barrier.wait();
+                }
                 
-                // Calculate batch loss (MSE)
-                Eigen::VectorXd predictions = activations.back();
-                double batchLoss = (predictions - y_batch).array().square().mean();
-                epochLoss += batchLoss * actualBatchSize;
+                if (k == 0) {
+                    double stepWeight = 0.0;
+                    for (int j = 0; j < threads; ++j) {
+                        stepWeight += shardWeight[j];
+                        epochLoss += shardLoss[j];
+                    }
+                    if (stepWeight > 0.0) {
+                        for (size_t l = 0; l < workspace.weightGrads.size(); ++l) {
+                            workspace.weightGrads[l] /= static_cast<Scalar>(stepWeight);
+                            workspace.biasGrads[l] /= static_cast<Scalar>(stepWeight);
+                        }
+                        updateParameters<Scalar>(workspace.weightGrads, workspace.biasGrads);
+                    }
+                }
+                barrier.wait();
             }
             
-            // Average loss for the epoch
-            epochLoss /= nSamples;
+            if (k == 0) {
+                finishEpoch(epoch, epochLoss);
+            }
+            barrier.wait();
+            if (converged) {
+                break;
+            }
+        }
+    };
+    
+    // Hogwild: thread k trains on its contiguous share of each epoch and
+    // updates the shared weights without waiting for the others
+    auto runHogwild = [&](int k) {
+        TrainingWorkspace<Scalar>& workspace = workspaces[k];
+        int shareBegin = static_cast<int>(static_cast<long long>(k) * nRows / threads);
+        int shareEnd = static_cast<int>(static_cast<long long>(k + 1) * nRows / threads);
+        for (int epoch = monitor.firstEpoch; epoch < epochs; ++epoch) {
+            if (k == 0) {
+                shuffleEpoch(epoch);
+            }
+            barrier.wait();
             
-            // Check for convergence
-            double improvement = std::abs(prevLoss - epochLoss);
-            prevLoss = epochLoss;
+            shardLoss[k] = 0.0;
+            for (int i = shareBegin; i < shareEnd; i += batchRows) {
+                int rows = std::min(batchRows, shareEnd - i);
+                syncWorkspaceWeights(workspace);
+                gatherBatch(X, y, sampleWeights, indices.data() + i, rows, workspace);
+                auto X_batch = workspace.inputs.topRows(rows);
+                auto y_batch = workspace.targets.head(rows);
+                auto w_batch = workspace.rowWeights.head(rows);
+                if (w_batch.sum() <= 0) {
+                    continue;
+                }
+                forwardPropagate<Scalar>(X_batch, workspace);
+                backwardPropagate<Scalar>(X_batch, y_batch, w_batch, workspace);
+                auto predictions = workspace.activations.back().col(0).head(rows);
+                shardLoss[k] += static_cast<double>(w_batch.dot((predictions - y_batch).array().square().matrix()));
+                updateParameters<Scalar>(workspace.weightGrads, workspace.biasGrads);
+            }
+            barrier.wait();
             
-            if (improvement < tol) {
+            if (k == 0) {
+                finishEpoch(epoch, std::accumulate(shardLoss.begin(), shardLoss.end(), 0.0));
+            }
+            barrier.wait();
+            if (converged) {
                 break;
             }
         }
+    };
+    
+    // The calling thread works as thread 0
+    std::vector<std::thread> helpers;
+    for (int k = 1; k < threads; ++k) {
+        helpers.emplace_back([&, k]() {
+            if (hogwild) {
+                runHogwild(k);
+            } else {
+                runSynchronous(k);
+            }
+        });
+    }
+    if (hogwild) {
+        runHogwild(0);
+    } else {
+        runSynchronous(0);
+    }
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+}
+
+template <typename Scalar>
+void NeuralNetwork::allocateWorkspace(TrainingWorkspace<Scalar>& workspace, Eigen::Index rows, bool training) const {
+    size_t numLayers = weights.size();
+    workspace.activations.resize(numLayers);
+    for (size_t l = 0; l < numLayers; ++l) {
+        workspace.activations[l].resize(rows, weights[l].rows());
+    }
+    syncWorkspaceWeights(workspace);
+    if (!training) {
+        return;
+    }
+    
+    workspace.inputs.resize(rows, nFeatures);
+    workspace.targets.resize(rows);
+    workspace.rowWeights.resize(rows);
+    workspace.deltas.resize(numLayers);
+    workspace.weightGrads.resize(numLayers);
+    workspace.biasGrads.resize(numLayers);
+    for (size_t l = 0; l < numLayers; ++l) {
+        workspace.deltas[l].resize(rows, weights[l].rows());
+        workspace.weightGrads[l].resize(weights[l].rows(), weights[l].cols());
+        workspace.biasGrads[l].resize(biases[l].size());
+    }
+}
+
+template <typename Scalar>
+void NeuralNetwork::syncWorkspaceWeights(TrainingWorkspace<Scalar>& workspace) const {
+    if constexpr (!std::is_same<Scalar, double>::value) {
+        // Same-sized assignments reuse the existing storage
+        workspace.weights.resize(weights.size());
+        workspace.biases.resize(biases.size());
+        for (size_t l = 0; l < weights.size(); ++l) {
+            workspace.weights[l] = weights[l].template cast<Scalar>();
+            workspace.biases[l] = biases[l].template cast<Scalar>();
+        }
+    }
+}
 
-        // Set isFitted to true
-        isFitted = true;
-        
-        // Calculate statistics
-        calculateStatistics(X, y);
+template <typename Scalar>
+const std::vector<NeuralNetwork::Matrix<Scalar>>&
+NeuralNetwork::workspaceWeights(const TrainingWorkspace<Scalar>& workspace) const {
+    if constexpr (std::is_same<Scalar, double>::value) {
+        return weights;
+    } else {
+        return workspace.weights;
+    }
+}
 
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error fitting Neural Network model: " << e.what() << std::endl;
-        return false;
+template <typename Scalar>
+const std::vector<NeuralNetwork::Vector<Scalar>>&
+NeuralNetwork::workspaceBiases(const TrainingWorkspace<Scalar>& workspace) const {
+    if constexpr (std::is_same<Scalar, double>::value) {
+        return biases;
+    } else {
+        return workspace.biases;
     }
 }
 
-void NeuralNetwork::calculateNormalizationParams(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
-    // Calculate feature means
-    featureMeans = X.colwise().mean();
-    
-    // Calculate feature standard deviations
-    featureStdDevs = Eigen::VectorXd(X.cols());
-    for (int i = 0; i < X.cols(); ++i) {
-        Eigen::VectorXd col = X.col(i);
-        featureStdDevs(i) = std::sqrt((col.array() - featureMeans(i)).square().sum() / (col.size() - 1));
-        
-        // Handle constant features (std dev = 0)
-        if (featureStdDevs(i) < 1e-10) {
-            featureStdDevs(i) = 1.0;
+template <typename Scalar>
+void NeuralNetwork::gatherBatch(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                const Eigen::VectorXd& sampleWeights, const int* rowIndices, Eigen::Index rows,
+                                TrainingWorkspace<Scalar>& workspace) const {
+    // Gather column by column so both matrices are walked along their storage order
+    for (Eigen::Index c = 0; c < X.cols(); ++c) {
+        const double* source = X.col(c).data();
+        Scalar* target = workspace.inputs.col(c).data();
+        for (Eigen::Index r = 0; r < rows; ++r) {
+            target[r] = static_cast<Scalar>(source[rowIndices[r]]);
         }
     }
-    
-    // Calculate target mean and standard deviation
-    targetMean = y.mean();
-    targetStdDev = std::sqrt((y.array() - targetMean).square().sum() / (y.size() - 1));
-    
-    // Handle constant target (std dev = 0)
-    if (targetStdDev < 1e-10) {
-        targetStdDev = 1.0;
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        workspace.targets(r) = static_cast<Scalar>(y(rowIndices[r]));
+        workspace.rowWeights(r) = static_cast<Scalar>(sampleWeights(rowIndices[r]));
     }
 }
 
-Eigen::MatrixXd NeuralNetwork::normalizeFeatures(const Eigen::MatrixXd& X) const {
-    Eigen::MatrixXd X_norm = X;
+template <typename Scalar>
+void NeuralNetwork::forwardPropagate(const Eigen::Ref<const Matrix<Scalar>>& X,
+                                     TrainingWorkspace<Scalar>& workspace) const {
+    const auto& layerWeights = workspaceWeights(workspace);
+    const auto& layerBiases = workspaceBiases(workspace);
+    Eigen::Index rows = X.rows();
+    size_t numLayers = layerWeights.size();
     
-    for (int i = 0; i < X.cols(); ++i) {
-        X_norm.col(i) = (X.col(i).array() - featureMeans(i)) / featureStdDevs(i);
+    for (size_t l = 0; l < numLayers; ++l) {
+        // Linear transformation Z = XW^T straight into the layer's buffer,
+        // then the bias and activation in one pass over it
+        auto Z = workspace.activations[l].topRows(rows);
+        if (l == 0) {
+            Z.noalias() = X * layerWeights[l].transpose();
+        } else {
+            Z.noalias() = workspace.activations[l - 1].topRows(rows) * layerWeights[l].transpose();
+        }
+        applyActivation<Scalar>(Z, layerBiases[l], l + 1 < numLayers ? hiddenActivation : outputActivation);
     }
-    
-    return X_norm;
 }
 
-std::vector<Eigen::MatrixXd> NeuralNetwork::forwardPropagate(const Eigen::MatrixXd& X) const {
-    std::vector<Eigen::MatrixXd> activations;
+template <typename Scalar>
+void NeuralNetwork::backwardPropagate(const Eigen::Ref<const Matrix<Scalar>>& X,
+                                      const Eigen::Ref<const Vector<Scalar>>& y,
+                                      const Eigen::Ref<const Vector<Scalar>>& sampleWeights,
+                                      TrainingWorkspace<Scalar>& workspace) const {
+    const auto& layerWeights = workspaceWeights(workspace);
+    Eigen::Index rows = X.rows();
+    int numLayers = layerWeights.size();
     
-    // Input layer activation is just the input
-    activations.push_back(X);
-    
-    // Forward pass through hidden layers
-    Eigen::MatrixXd current = X;
+    // Calculate error at output layer; each row's error is scaled by its
+    // share of the total weight so the gradients below are those of the
+    // weighted mean loss
+    Scalar totalWeight = sampleWeights.sum();
+    auto outputDelta = workspace.deltas[numLayers - 1].topRows(rows);
+    outputDelta.col(0) = (workspace.activations[numLayers - 1].col(0).head(rows) - y)
+                             .cwiseProduct(sampleWeights) / totalWeight;
+    if (outputActivation != Activation::LINEAR) {
+        applyActivationDerivative<Scalar>(outputDelta, workspace.activations[numLayers - 1].topRows(rows),
+                                          outputActivation);
+    }
     
-    for (size_t i = 0; i < weights.size() - 1; ++i) {
-        // Linear transformation: Z = XW^T + b
-        Eigen::MatrixXd Z = current * weights[i].transpose();
-        Z.rowwise() += biases[i].transpose();
+    // Backward pass (output to input)
+    for (int l = numLayers - 1; l >= 0; --l) {
+        auto delta = workspace.deltas[l].topRows(rows);
         
-        // Apply activation function
-        current = applyActivation(Z, hiddenActivation);
+        // Calculate gradients
+        if (l == 0) {
+            workspace.weightGrads[l].noalias() = delta.transpose() * X;
+        } else {
+            workspace.weightGrads[l].noalias() = delta.transpose() * workspace.activations[l - 1].topRows(rows);
+        }
+        workspace.biasGrads[l].noalias() = delta.colwise().sum().transpose();
         
-        // Store activation
-        activations.push_back(current);
+        // Propagate error backward through the previous layer's activation
+        if (l > 0) {
+            auto previousDelta = workspace.deltas[l - 1].topRows(rows);
+            previousDelta.noalias() = delta * layerWeights[l];
+            applyActivationDerivative<Scalar>(previousDelta, workspace.activations[l - 1].topRows(rows),
+                                              hiddenActivation);
+        }
     }
-    
-    // Output layer
-    size_t lastLayerIdx = weights.size() - 1;
-    Eigen::MatrixXd Z = current * weights[lastLayerIdx].transpose();
-    Z.rowwise() += biases[lastLayerIdx].transpose();
-    
-    // Apply output activation function
-    current = applyActivation(Z, outputActivation);
-    
-    // Store output activation
-    activations.push_back(current);
-    
-    return activations;
 }
 
-std::pair<std::vector<Eigen::MatrixXd>, std::vector<Eigen::VectorXd>> 
-NeuralNetwork::backwardPropagate(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, 
-                               const std::vector<Eigen::MatrixXd>& activations) {
-    int numLayers = weights.size();
-    
-    // Initialize gradient containers
-    std::vector<Eigen::MatrixXd> weightGrads(numLayers);
-    std::vector<Eigen::VectorXd> biasGrads(numLayers);
+template <typename Scalar>
+void NeuralNetwork::updateParameters(const std::vector<Matrix<Scalar>>& weightGrads,
+                                     const std::vector<Vector<Scalar>>& biasGrads) {
+    // The L2 penalty adds alpha * W to each weight gradient. All updates are
+    // coefficient-wise expressions over the preallocated moment buffers, so
+    // no temporaries are created
+    if (solver == Solver::SGD) {
+        for (size_t i = 0; i < weights.size(); ++i) {
+            weights[i] -= currentLearningRate * (weightGrads[i].template cast<double>() + alpha * weights[i]);
+            biases[i] -= currentLearningRate * biasGrads[i].template cast<double>();
+        }
+        return;
+    }
     
-    // Calculate error at output layer
-    Eigen::MatrixXd outputError(y.size(), 1);
-    outputError.col(0) = activations.back().col(0) - y;
+    // Adam with bias correction folded into the step size
+    ++adamStep;
+    double t = static_cast<double>(adamStep);
+    double stepSize = currentLearningRate * std::sqrt(1.0 - std::pow(beta2, t)) / (1.0 - std::pow(beta1, t));
+    for (size_t i = 0; i < weights.size(); ++i) {
+        auto weightGrad = weightGrads[i].template cast<double>() + alpha * weights[i];
+        weightMoments[i] = beta1 * weightMoments[i] + (1.0 - beta1) * weightGrad;
+        weightSquaredMoments[i].array() = beta2 * weightSquaredMoments[i].array() +
+            (1.0 - beta2) * weightGrad.array().square();
+        weights[i].array() -= stepSize * weightMoments[i].array() /
+            (weightSquaredMoments[i].array().sqrt() + epsilon);
+        
+        auto biasGrad = biasGrads[i].template cast<double>();
+        biasMoments[i] = beta1 * biasMoments[i] + (1.0 - beta1) * biasGrad;
+        biasSquaredMoments[i].array() = beta2 * biasSquaredMoments[i].array() +
+            (1.0 - beta2) * biasGrad.array().square();
+        biases[i].array() -= stepSize * biasMoments[i].array() /
+            (biasSquaredMoments[i].array().sqrt() + epsilon);
+    }
+}
+
+bool NeuralNetwork::endEpoch(int epoch, double trainingLoss, EpochMonitor& monitor) {
+    nIterations = epoch + 1;
+    trainingLossHistory.push_back(trainingLoss);
     
-    // Backward pass (output to input)
-    Eigen::MatrixXd delta = outputError;
+    // Without validation rows, stop once the training loss stalls
+    bool stop = false;
+    double monitoredLoss = trainingLoss;
+    if (monitor.validationX) {
+        forwardPropagate<double>(*monitor.validationX, monitor.validationWorkspace);
+        auto predictions = monitor.validationWorkspace.activations.back().col(0);
+        double validationLoss = monitor.validationWeights->dot(
+            (predictions - *monitor.validationY).array().square().matrix()) / monitor.validationWeights->sum();
+        validationLossHistory.push_back(validationLoss);
+        monitoredLoss = validationLoss;
+        
+        if (validationLoss < monitor.bestLoss - tol) {
+            monitor.bestLoss = validationLoss;
+            monitor.epochsWithoutImprovement = 0;
+            bestEpoch = epoch + 1;
+            for (size_t i = 0; i < weights.size(); ++i) {
+                monitor.bestWeights[i] = weights[i];
+                monitor.bestBiases[i] = biases[i];
+            }
+        } else if (++monitor.epochsWithoutImprovement >= patience) {
+            stop = true;
+        }
+    } else {
+        stop = std::abs(monitor.previousLoss - trainingLoss) < tol;
+    }
+    monitor.previousLoss = trainingLoss;
     
-    if (outputActivation != Activation::LINEAR) {
-        // If non-linear output, apply activation derivative
-        Eigen::MatrixXd derivOutput = applyActivationDerivative(activations.back(), outputActivation);
-        delta = delta.array() * derivOutput.array();
+    // Learning rate for the next epoch
+    switch (schedule) {
+        case LearningRateSchedule::CONSTANT:
+            break;
+        case LearningRateSchedule::STEP:
+            currentLearningRate = learningRate * std::pow(scheduleFactor, (epoch + 1) / scheduleStep);
+            break;
+        case LearningRateSchedule::COSINE:
+            currentLearningRate = 0.5 * learningRate * (1.0 + std::cos(std::acos(-1.0) * (epoch + 1) / epochs));
+            break;
+        case LearningRateSchedule::PLATEAU:
+            if (monitoredLoss < monitor.plateauLoss - tol) {
+                monitor.plateauLoss = monitoredLoss;
+                monitor.plateauEpochs = 0;
+            } else if (++monitor.plateauEpochs >= scheduleStep) {
+                currentLearningRate *= scheduleFactor;
+                monitor.plateauEpochs = 0;
+            }
+            break;
     }
     
-    // Output layer gradients
-    weightGrads[numLayers - 1] = delta.transpose() * activations[numLayers - 1] / X.rows();
-    biasGrads[numLayers - 1] = delta.colwise().sum() / X.rows();
+    if (monitor.checkpointWriter && (epoch + 1) % checkpointInterval == 0) {
+        submitCheckpoint(epoch + 1, monitor);
+    }
+    return stop;
+}
+
+void NeuralNetwork::initializeParameters() {
+    std::vector<int> architecture;
+    architecture.push_back(nFeatures);
+    for (int hiddenSize : layerSizes) {
+        architecture.push_back(hiddenSize);
+    }
+    architecture.push_back(1);  // One output neuron for regression
     
-    // Hidden layers (backwards)
-    for (int l = numLayers - 2; l >= 0; --l) {
-        // Propagate error backward
-        delta = delta * weights[l + 1];
+    weights.clear();
+    biases.clear();
+    maxLayerWidth = 1;
+    for (size_t i = 0; i < architecture.size() - 1; ++i) {
+        int inputSize = architecture[i];
+        int outputSize = architecture[i + 1];
         
-        // Apply activation derivative
-        Eigen::MatrixXd derivActivation = applyActivationDerivative(activations[l + 1], hiddenActivation);
-        delta = delta.array() * derivActivation.array();
+        // Xavier initialization: W ~ N(0, sqrt(2 / (fan_in + fan_out)))
+        double weightScale = std::sqrt(2.0 / (inputSize + outputSize));
+        std::normal_distribution<double> dist(0.0, weightScale);
         
-        // Calculate gradients
-        weightGrads[l] = delta.transpose() * activations[l] / X.rows();
-        biasGrads[l] = delta.colwise().sum() / X.rows();
+        Eigen::MatrixXd W(outputSize, inputSize);
+        for (int r = 0; r < outputSize; ++r) {
+            for (int c = 0; c < inputSize; ++c) {
+                W(r, c) = dist(rng);
+            }
+        }
+        weights.push_back(W);
+        biases.push_back(Eigen::VectorXd::Zero(outputSize));
+        maxLayerWidth = std::max(maxLayerWidth, outputSize);
     }
     
-    return {weightGrads, biasGrads};
+    initializeSolverState();
+}
+
+void NeuralNetwork::initializeSolverState() {
+    adamStep = 0;
+    weightMoments.clear();
+    weightSquaredMoments.clear();
+    biasMoments.clear();
+    biasSquaredMoments.clear();
+    lbfgsSteps.resize(0, 0);
+    lbfgsGradientSteps.resize(0, 0);
+    
+    if (solver == Solver::ADAM) {
+        for (size_t i = 0; i < weights.size(); ++i) {
+            weightMoments.push_back(Eigen::MatrixXd::Zero(weights[i].rows(), weights[i].cols()));
+            weightSquaredMoments.push_back(Eigen::MatrixXd::Zero(weights[i].rows(), weights[i].cols()));
+            biasMoments.push_back(Eigen::VectorXd::Zero(biases[i].size()));
+            biasSquaredMoments.push_back(Eigen::VectorXd::Zero(biases[i].size()));
+        }
+    } else if (solver == Solver::LBFGS) {
+        Eigen::Index n = parameterCount();
+        lbfgsSteps = Eigen::MatrixXd::Zero(n, lbfgsMemory);
+        lbfgsGradientSteps = Eigen::MatrixXd::Zero(n, lbfgsMemory);
+        lbfgsRho = Eigen::VectorXd::Zero(lbfgsMemory);
+        lbfgsAlpha = Eigen::VectorXd::Zero(lbfgsMemory);
+    }
+}
+
+Eigen::Index NeuralNetwork::parameterCount() const {
+    Eigen::Index count = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        count += weights[i].size() + biases[i].size();
+    }
+    return count;
+}
+
+void NeuralNetwork::packParameters(Eigen::VectorXd& parameters) const {
+    Eigen::Index offset = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        parameters.segment(offset, weights[i].size()) =
+            Eigen::Map<const Eigen::VectorXd>(weights[i].data(), weights[i].size());
+        offset += weights[i].size();
+        parameters.segment(offset, biases[i].size()) = biases[i];
+        offset += biases[i].size();
+    }
+}
+
+void NeuralNetwork::unpackParameters(const Eigen::VectorXd& parameters) {
+    Eigen::Index offset = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        Eigen::Map<Eigen::VectorXd>(weights[i].data(), weights[i].size()) =
+            parameters.segment(offset, weights[i].size());
+        offset += weights[i].size();
+        biases[i] = parameters.segment(offset, biases[i].size());
+        offset += biases[i].size();
+    }
 }
 
-void NeuralNetwork::updateParameters(const std::vector<Eigen::MatrixXd>& weightGrads,
-                                  const std::vector<Eigen::VectorXd>& biasGrads) {
+double NeuralNetwork::evaluateObjective(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                        const Eigen::VectorXd& sampleWeights, TrainingWorkspace<double>& workspace,
+                                        Eigen::VectorXd& gradient) {
+    forwardPropagate<double>(X, workspace);
+    backwardPropagate<double>(X, y, sampleWeights, workspace);
+    const std::vector<Eigen::MatrixXd>& weightGrads = workspace.weightGrads;
+    const std::vector<Eigen::VectorXd>& biasGrads = workspace.biasGrads;
+    
+    // backwardPropagate returns the gradient of half the weighted mean squared error
+    double loss = 0.5 * sampleWeights.dot((workspace.activations.back().col(0) - y).array().square().matrix()) /
+                  sampleWeights.sum();
+    Eigen::Index offset = 0;
     for (size_t i = 0; i < weights.size(); ++i) {
-        weights[i] -= learningRate * weightGrads[i];
-        biases[i] -= learningRate * biasGrads[i];
+        loss += 0.5 * alpha * weights[i].squaredNorm();
+        gradient.segment(offset, weights[i].size()) =
+            Eigen::Map<const Eigen::VectorXd>(weightGrads[i].data(), weightGrads[i].size()) +
+            alpha * Eigen::Map<const Eigen::VectorXd>(weights[i].data(), weights[i].size());
+        offset += weights[i].size();
+        gradient.segment(offset, biases[i].size()) = biasGrads[i];
+        offset += biases[i].size();
     }
+    return loss;
 }
 
-Eigen::MatrixXd NeuralNetwork::applyActivation(const Eigen::MatrixXd& X, Activation activation) const {
-    Eigen::MatrixXd result = X;
+void NeuralNetwork::trainLBFGS(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                               const Eigen::VectorXd& sampleWeights) {
+    const double armijo = 1e-4;
+    const int maxLineSearchSteps = 30;
+    
+    Eigen::Index n = parameterCount();
+    Eigen::VectorXd parameters(n);
+    Eigen::VectorXd gradient(n);
+    Eigen::VectorXd direction(n);
+    Eigen::VectorXd trialParameters(n);
+    Eigen::VectorXd trialGradient(n);
+    TrainingWorkspace<double> workspace;
+    allocateWorkspace(workspace, X.rows(), true);
     
+    packParameters(parameters);
+    double loss = evaluateObjective(X, y, sampleWeights, workspace, gradient);
+    double totalWeight = sampleWeights.sum();
+    
+    // History pairs live in a ring of lbfgsMemory columns; newest is at (head - 1)
+    int stored = 0;
+    int head = 0;
+    
+    for (int iteration = 0; iteration < epochs; ++iteration) {
+        if (gradient.lpNorm<Eigen::Infinity>() <= tol) {
+            break;
+        }
+        
+        // Two-loop recursion: direction = -H * gradient
+        direction = -gradient;
+        for (int k = 0; k < stored; ++k) {
+            int column = (head - 1 - k + lbfgsMemory) % lbfgsMemory;
+            lbfgsAlpha(column) = lbfgsRho(column) * lbfgsSteps.col(column).dot(direction);
+            direction.noalias() -= lbfgsAlpha(column) * lbfgsGradientSteps.col(column);
+        }
+        if (stored > 0) {
+            // Scale by the curvature of the newest pair as the initial Hessian
+            int newest = (head - 1 + lbfgsMemory) % lbfgsMemory;
+            direction *= lbfgsSteps.col(newest).dot(lbfgsGradientSteps.col(newest)) /
+                         lbfgsGradientSteps.col(newest).squaredNorm();
+        }
+        for (int k = stored - 1; k >= 0; --k) {
+            int column = (head - 1 - k + lbfgsMemory) % lbfgsMemory;
+            double beta = lbfgsRho(column) * lbfgsGradientSteps.col(column).dot(direction);
+            direction.noalias() += (lbfgsAlpha(column) - beta) * lbfgsSteps.col(column);
+        }
+        
+        // Fall back to steepest descent if the history gives no descent direction
+        double slope = gradient.dot(direction);
+        if (slope >= 0.0) {
+            direction = -gradient;
+            slope = -gradient.squaredNorm();
+            stored = 0;
+        }
+        
+        // Backtracking line search on the Armijo condition
+        double step = stored > 0 ? 1.0 : std::min(1.0, 1.0 / gradient.lpNorm<Eigen::Infinity>());
+        double trialLoss = loss;
+        bool accepted = false;
+        for (int attempt = 0; attempt < maxLineSearchSteps; ++attempt) {
+            trialParameters.noalias() = parameters + step * direction;
+            unpackParameters(trialParameters);
+            trialLoss = evaluateObjective(X, y, sampleWeights, workspace, trialGradient);
+            if (std::isfinite(trialLoss) && trialLoss <= loss + armijo * step * slope) {
+                accepted = true;
+                break;
+            }
+            step *= 0.5;
+        }
+        if (!accepted) {
+            unpackParameters(parameters);
+            break;
+        }
+        nIterations = iteration + 1;
+        trainingLossHistory.push_back(sampleWeights.dot(
+            (workspace.activations.back().col(0) - y).array().square().matrix()) / totalWeight);
+        
+        // Keep the pair only if it has positive curvature
+        lbfgsSteps.col(head) = trialParameters - parameters;
+        lbfgsGradientSteps.col(head) = trialGradient - gradient;
+        double curvature = lbfgsSteps.col(head).dot(lbfgsGradientSteps.col(head));
+        if (curvature > 1e-10 * lbfgsGradientSteps.col(head).squaredNorm()) {
+            lbfgsRho(head) = 1.0 / curvature;
+            head = (head + 1) % lbfgsMemory;
+            stored = std::min(stored + 1, lbfgsMemory);
+        }
+        
+        parameters.swap(trialParameters);
+        gradient.swap(trialGradient);
+        loss = trialLoss;
+    }
+}
+
+template <typename Scalar>
+void NeuralNetwork::applyActivation(Eigen::Ref<Matrix<Scalar>> Z, const Vector<Scalar>& bias,
+                                    Activation activation) {
+    const Scalar one(1);
     switch (activation) {
         case Activation::RELU:
-            result = result.array().max(0.0);
+            Z.array() = (Z.array().rowwise() + bias.transpose().array()).max(Scalar(0));
             break;
         case Activation::SIGMOID:
-            result = 1.0 / (1.0 + (-result.array()).exp());
+            Z.array() = one / (one + (-(Z.array().rowwise() + bias.transpose().array())).exp());
             break;
         case Activation::TANH:
-            result = result.array().tanh();
+            Z.array() = (Z.array().rowwise() + bias.transpose().array()).tanh();
             break;
         case Activation::LINEAR:
             // No transformation for linear activation
+            Z.array().rowwise() += bias.transpose().array();
             break;
     }
-    
-    return result;
 }
 
-Eigen::MatrixXd NeuralNetwork::applyActivationDerivative(const Eigen::MatrixXd& X, Activation activation) const {
-    Eigen::MatrixXd result(X.rows(), X.cols());
-    
+template <typename Scalar>
+void NeuralNetwork::applyActivationDerivative(Eigen::Ref<Matrix<Scalar>> delta,
+                                              const Eigen::Ref<const Matrix<Scalar>>& output,
+                                              Activation activation) {
+    const Scalar one(1);
     switch (activation) {
         case Activation::RELU:
-            result = (X.array() > 0.0).cast<double>();
+            delta.array() *= (output.array() > Scalar(0)).template cast<Scalar>();
             break;
         case Activation::SIGMOID:
             // sigmoid derivative: f(x) * (1 - f(x))
-            result = X.array() * (1.0 - X.array());
+            delta.array() *= output.array() * (one - output.array());
             break;
         case Activation::TANH:
             // tanh derivative: 1 - f(x)^2
-            result = 1.0 - X.array().square();
+            delta.array() *= one - output.array().square();
             break;
         case Activation::LINEAR:
             // Derivative of linear is 1
-            result.setOnes();
             break;
     }
-    
-    return result;
 }
 
 Eigen::VectorXd NeuralNetwork::predict(const Eigen::MatrixXd& X) const {
+    // Eigen's thread count is process-wide and only read here. When it runs
+    // products on several threads, the blocks stay on the calling thread so
+    // the two do not multiply; otherwise the blocks use the cores. The
+    // predictions are the same either way
+    ParallelPredict::Options options;
+    if (Eigen::nbThreads() > 1) {
+        options.threads = 1;
+    }
+    return predictInBlocks(X, options);
+}
+
+void NeuralNetwork::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                                Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -395,18 +1806,316 @@ Eigen::VectorXd NeuralNetwork::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
+
+    // The inference paths read X in place; only the output is copied
+    predictions = predictWith(X, inferenceMode);
+}
+
+template <typename T>
+double NeuralNetwork::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    // The normalized row and two layers of activations, on the stack
+    if (nFeatures + 2 * maxLayerWidth > MAX_ROW_VALUES) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double scratch[MAX_ROW_VALUES];
+    double* input = scratch;
+    double* current = input + nFeatures;
+    double* next = current + maxLayerWidth;
+    
+    // The reference pass: standardize, run the network(s) and rescale
+    for (int j = 0; j < nFeatures; ++j) {
+        input[j] = (static_cast<double>(features[j]) - featureMeans(j)) / featureStdDevs(j);
+    }
+    if (ensembleMembers.empty()) {
+        return forwardRow(input, current, next) * targetStdDev + targetMean;
+    }
+    double sum = 0.0;
+    for (const auto& member : ensembleMembers) {
+        sum += member->forwardRow(input, current, next);
+    }
+    return sum / static_cast<double>(ensembleMembers.size()) * targetStdDev + targetMean;
+}
+
+double NeuralNetwork::forwardRow(const double* input, double* current, double* next) const noexcept {
+    const double* layerInput = input;
+    for (size_t l = 0; l < weights.size(); ++l) {
+        const Eigen::MatrixXd& W = weights[l];
+        Activation activation = l + 1 < weights.size() ? hiddenActivation : outputActivation;
+        
+        // Column by column, so the sums run over the inputs in order as in forwardPropagate
+        std::fill(next, next + W.rows(), 0.0);
+        for (Eigen::Index i = 0; i < W.cols(); ++i) {
+            const double* column = W.col(i).data();
+            double value = layerInput[i];
+            for (Eigen::Index o = 0; o < W.rows(); ++o) {
+                next[o] += column[o] * value;
+            }
+        }
+        for (Eigen::Index o = 0; o < W.rows(); ++o) {
+            double z = next[o] + biases[l](o);
+            switch (activation) {
+                case Activation::RELU:
+                    z = std::max(z, 0.0);
+                    break;
+                case Activation::SIGMOID:
+                    z = 1.0 / (1.0 + std::exp(-z));
+                    break;
+                case Activation::TANH:
+                    z = std::tanh(z);
+                    break;
+                case Activation::LINEAR:
+                    break;
+            }
+            next[o] = z;
+        }
+        std::swap(current, next);
+        layerInput = current;
+    }
+    return layerInput[0];
+}
+
+double NeuralNetwork::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double NeuralNetwork::predictOne(const float* features) const noexcept {
+    return predictRow(features);
+}
+
+size_t NeuralNetwork::predictRowBytes() const {
+    // The normalized inputs and the activations of two layers at a time
+    size_t values = 2 * static_cast<size_t>(nFeatures) + 1;
+    for (int size : layerSizes) {
+        values += 2 * static_cast<size_t>(size);
+    }
+    return sizeof(double) * values;
+}
+
+Eigen::VectorXd NeuralNetwork::predictWith(const Eigen::Ref<const Eigen::MatrixXd>& X, InferenceMode mode) const {
+    if (ensembleMembers.empty()) {
+        if (mode == InferenceMode::REFERENCE || compiledLayers.empty()) {
+            return predictReference(X);
+        }
+        return predictCompiled(X, mode == InferenceMode::INT8);
+    }
+    
+    // The members share the standardization, so the reference pass
+    // normalizes the batch once and averages the raw network outputs
+    Eigen::VectorXd sum = Eigen::VectorXd::Zero(X.rows());
+    if (mode == InferenceMode::REFERENCE) {
+        Eigen::MatrixXd X_norm = normalizeFeatures(X);
+        for (const auto& member : ensembleMembers) {
+            sum += member->forwardNormalized(X_norm);
+        }
+        return (sum / static_cast<double>(ensembleMembers.size())).array() * targetStdDev + targetMean;
+    }
+    for (const auto& member : ensembleMembers) {
+        sum += member->predictWith(X, mode);
+    }
+    return sum / static_cast<double>(ensembleMembers.size());
+}
+
+Eigen::VectorXd NeuralNetwork::predictReference(const Eigen::Ref<const Eigen::MatrixXd>& X) const {
+    // Normalize input, run the network and denormalize the output
+    return forwardNormalized(normalizeFeatures(X)).array() * targetStdDev + targetMean;
+}
+
+Eigen::VectorXd NeuralNetwork::forwardNormalized(const Eigen::MatrixXd& X_norm) const {
+    // Forward pass in the precision the network was trained in
+    if (useFloat32) {
+        TrainingWorkspace<float> workspace;
+        allocateWorkspace(workspace, X_norm.rows(), false);
+        forwardPropagate<float>(X_norm.cast<float>(), workspace);
+        return workspace.activations.back().col(0).cast<double>();
+    }
+    TrainingWorkspace<double> workspace;
+    allocateWorkspace(workspace, X_norm.rows(), false);
+    forwardPropagate<double>(X_norm, workspace);
+    return workspace.activations.back().col(0);
+}
+
+void NeuralNetwork::compileInference() {
+    size_t numLayers = weights.size();
+    compiledLayers.assign(numLayers, CompiledLayer());
+    compiledOutputScale = targetStdDev;
+    compiledOutputShift = targetMean;
+    
+    for (size_t l = 0; l < numLayers; ++l) {
+        CompiledLayer& layer = compiledLayers[l];
+        Eigen::MatrixXd W = weights[l];
+        Eigen::VectorXd b = biases[l];
+        layer.activation = (l + 1 == numLayers) ? outputActivation : hiddenActivation;
+        
+        // W * ((x - mean) / std) + b = (W / std) * x + (b - W * (mean / std))
+        if (l == 0) {
+            Eigen::VectorXd inverseStdDevs = featureStdDevs.cwiseInverse();
+            b -= W * featureMeans.cwiseProduct(inverseStdDevs);
+            W = W * inverseStdDevs.asDiagonal();
+        }
+        
+        // The target scaling y * std + mean passes through a linear output only
+        if (l + 1 == numLayers && outputActivation == Activation::LINEAR) {
+            W *= targetStdDev;
+            b = (b * targetStdDev).array() + targetMean;
+            compiledOutputScale = 1.0;
+            compiledOutputShift = 0.0;
+        }
+        
+        if (l == 0) {
+            layer.firstWeights = W.transpose();
+            layer.firstBias = b;
+            continue;
+        }
+        layer.weights = W.transpose().cast<float>();
+        layer.bias = b.cast<float>();
+        
+        // Symmetric int8 weights with one scale per output channel, stored as
+        // [input pair][output][2] with zero padding (see multiplyInt8)
+        Eigen::Index inputs = W.cols();
+        layer.paddedInputs = (inputs + 1) / 2 * 2;
+        layer.paddedOutputs = (W.rows() + 7) / 8 * 8;
+        layer.quantizedWeights.assign(static_cast<size_t>(layer.paddedInputs * layer.paddedOutputs), 0);
+        layer.channelScales.resize(W.rows());
+        for (Eigen::Index o = 0; o < W.rows(); ++o) {
+            double maxAbs = W.row(o).cwiseAbs().maxCoeff();
+            double scale = maxAbs > 0.0 ? maxAbs / 127.0 : 1.0;
+            layer.channelScales(o) = static_cast<float>(scale);
+            for (Eigen::Index i = 0; i < inputs; ++i) {
+                long q = std::lround(W(o, i) / scale);
+                layer.quantizedWeights[(i / 2 * layer.paddedOutputs + o) * 2 + i % 2] =
+                    static_cast<int8_t>(std::max(-127L, std::min(127L, q)));
+            }
+        }
+    }
+}
 
-    // Normalize input
-    Eigen::MatrixXd X_norm = normalizeFeatures(X);
+Eigen::VectorXd NeuralNetwork::predictCompiled(const Eigen::Ref<const Eigen::MatrixXd>& X, bool quantized) const {
+    const Eigen::Index tileRows = 256;
+    Eigen::Index nRows = X.rows();
+    Eigen::VectorXd result(nRows);
     
-    // Forward pass
-    std::vector<Eigen::MatrixXd> activations = forwardPropagate(X_norm);
+    // One tile of activations in two ping-pong buffers is all that is kept
+    Eigen::Index maxWidth = 1;
+    Eigen::Index maxPairs = 0;
+    Eigen::Index maxOutputs = 0;
+    for (const auto& layer : compiledLayers) {
+        maxWidth = std::max(maxWidth, layer.firstWeights.size() > 0 ? layer.firstWeights.cols() : layer.weights.cols());
+        maxPairs = std::max(maxPairs, layer.paddedInputs / 2);
+        maxOutputs = std::max(maxOutputs, layer.paddedOutputs);
+    }
+    const CompiledLayer& first = compiledLayers.front();
+    Eigen::MatrixXd firstOutput(std::min(tileRows, nRows), first.firstWeights.cols());
+    RowMatrixF current(std::min(tileRows, nRows), maxWidth);
+    RowMatrixF next(std::min(tileRows, nRows), maxWidth);
+    std::vector<int32_t> pairedRow(static_cast<size_t>(maxPairs), 0);
+    std::vector<int32_t> sums(static_cast<size_t>(maxOutputs), 0);
+    
+    for (Eigen::Index start = 0; start < nRows; start += tileRows) {
+        Eigen::Index rows = std::min(tileRows, nRows - start);
+        
+        // The first layer reads the raw rows of X in place, in double precision
+        auto firstTile = firstOutput.topRows(rows);
+        firstTile.noalias() = X.middleRows(start, rows) * first.firstWeights;
+        firstTile.rowwise() += first.firstBias.transpose();
+        Eigen::Index width = first.firstWeights.cols();
+        current.topLeftCorner(rows, width) = firstTile.cast<float>();
+        activateRows(current.topLeftCorner(rows, width), first.activation);
+        
+        for (size_t l = 1; l < compiledLayers.size(); ++l) {
+            const CompiledLayer& layer = compiledLayers[l];
+            Eigen::Index inputs = layer.weights.rows();
+            Eigen::Index outputs = layer.weights.cols();
+            auto out = next.topLeftCorner(rows, outputs);
+            if (quantized) {
+                // Quantize each activation row to int8 with its own scale
+                Eigen::Index pairs = layer.paddedInputs / 2;
+                for (Eigen::Index r = 0; r < rows; ++r) {
+                    const float* activations = current.row(r).data();
+                    float maxAbs = current.row(r).head(inputs).cwiseAbs().maxCoeff();
+                    float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+                    float inverseScale = 1.0f / scale;
+                    for (Eigen::Index k = 0; k < pairs; ++k) {
+                        int32_t low = std::lrint(activations[2 * k] * inverseScale);
+                        int32_t high = 2 * k + 1 < inputs ? std::lrint(activations[2 * k + 1] * inverseScale) : 0;
+                        pairedRow[k] = static_cast<int32_t>((static_cast<uint32_t>(high) << 16) |
+                                                            (static_cast<uint32_t>(low) & 0xFFFFu));
+                    }
+                    multiplyInt8(pairedRow.data(), layer.quantizedWeights.data(), pairs,
+                                 layer.paddedOutputs, sums.data());
+                    for (Eigen::Index o = 0; o < outputs; ++o) {
+                        out(r, o) = static_cast<float>(sums[o]) * scale * layer.channelScales(o) + layer.bias(o);
+                    }
+                }
+            } else {
+                out.noalias() = current.topLeftCorner(rows, inputs) * layer.weights;
+                out.rowwise() += layer.bias.transpose();
+            }
+            activateRows(out, layer.activation);
+            current.swap(next);
+        }
+        
+        for (Eigen::Index r = 0; r < rows; ++r) {
+            result(start + r) = current(r, 0) * compiledOutputScale + compiledOutputShift;
+        }
+    }
+    return result;
+}
+
+std::unordered_map<std::string, double> NeuralNetwork::benchmarkInference(const Eigen::MatrixXd& X,
+                                                                          const Eigen::VectorXd& y,
+                                                                          int repeats) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    if (X.cols() != nFeatures) {
+        throw std::invalid_argument("Number of features in X (" + std::to_string(X.cols()) + 
+                                   ") does not match the number of features the model was trained on (" + 
+                                   std::to_string(nFeatures) + ")");
+    }
     
-    // Get output (last activation)
-    Eigen::VectorXd y_norm = activations.back().col(0);
+    repeats = std::max(1, repeats);
+    std::unordered_map<std::string, double> results;
+    const char* modeNames[] = {"reference", "folded", "int8"};
+    Eigen::VectorXd reference;
+    for (int mode = 0; mode < 3; ++mode) {
+        Eigen::VectorXd predictions;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            predictions = predictWith(X, static_cast<InferenceMode>(mode));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::string name = modeNames[mode];
+        results["rows_per_sec_" + name] = seconds > 0.0 ? repeats * static_cast<double>(X.rows()) / seconds : 0.0;
+        
+        if (mode == 0) {
+            reference = predictions;
+        } else if (X.rows() > 0) {
+            Eigen::VectorXd delta = predictions - reference;
+            results["max_abs_delta_" + name] = delta.cwiseAbs().maxCoeff();
+            results["rms_delta_" + name] = std::sqrt(delta.squaredNorm() / X.rows());
+        }
+        if (y.size() == X.rows() && X.rows() > 0) {
+            results["rmse_" + name] = std::sqrt((predictions - y).squaredNorm() / X.rows());
+        }
+    }
     
-    // Denormalize output
-    return y_norm.array() * targetStdDev + targetMean;
+#if defined(__AVX2__)
+    results["simd_avx2"] = 1.0;
+#else
+    results["simd_avx2"] = 0.0;
+#endif
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+    results["simd_avx512_vnni"] = 1.0;
+#else
+    results["simd_avx512_vnni"] = 0.0;
+#endif
+    return results;
 }
 
 std::string NeuralNetwork::getName() const {
@@ -421,6 +2130,21 @@ std::unordered_map<std::string, double> NeuralNetwork::getParameters() const {
     params["epochs"] = static_cast<double>(epochs);
     params["batch_size"] = static_cast<double>(batchSize);
     params["tolerance"] = tol;
+    params["solver"] = static_cast<double>(solver);
+    params["alpha"] = alpha;
+    params["float32"] = useFloat32 ? 1.0 : 0.0;
+    params["n_threads"] = static_cast<double>(numThreads);
+    params["random_seed"] = static_cast<double>(randomSeed);
+    params["data_parallel_threads"] = static_cast<double>(dataParallelThreads);
+    params["hogwild"] = hogwild ? 1.0 : 0.0;
+    params["validation_fraction"] = validationFraction;
+    params["patience"] = static_cast<double>(patience);
+    params["lr_schedule"] = static_cast<double>(schedule);
+    params["lr_factor"] = scheduleFactor;
+    params["lr_step"] = static_cast<double>(scheduleStep);
+    params["inference_mode"] = static_cast<double>(inferenceMode);
+    params["restarts"] = static_cast<double>(restarts);
+    params["restart_ensemble"] = restartEnsemble ? 1.0 : 0.0;
     
     // Add layer sizes
     params["input_layer_size"] = static_cast<double>(nFeatures);
@@ -451,6 +2175,20 @@ std::unordered_map<std::string, double> NeuralNetwork::getStatistics() const {
     stats["rmse"] = rmse;
     stats["n_samples"] = static_cast<double>(nSamples);
     stats["n_features"] = static_cast<double>(nFeatures);
+    stats["n_iterations"] = static_cast<double>(nIterations);
+    stats["loader_stalls"] = static_cast<double>(loaderStalls);
+    if (!trainingLossHistory.empty()) {
+        stats["final_training_loss"] = trainingLossHistory.back();
+    }
+    if (bestEpoch > 0) {
+        stats["best_epoch"] = static_cast<double>(bestEpoch);
+        stats["validation_loss"] = validationLossHistory[bestEpoch - 1];
+    }
+    if (!restartScores.empty()) {
+        auto range = std::minmax_element(restartScores.begin(), restartScores.end());
+        stats["restart_best_loss"] = *range.first;
+        stats["restart_worst_loss"] = *range.second;
+    }
     
     return stats;
 }
@@ -488,6 +2226,29 @@ std::string NeuralNetwork::getDescription() const {
     
     ss << " (hidden: " << hiddenActStr << ", output: " << outputActStr << ")";
     
+    std::string solverStr;
+    switch (solver) {
+        case Solver::SGD: solverStr = "SGD"; break;
+        case Solver::ADAM: solverStr = "Adam"; break;
+        case Solver::LBFGS: solverStr = "L-BFGS"; break;
+    }
+    ss << ", trained with " << solverStr;
+    if (useFloat32 && solver != Solver::LBFGS) {
+        ss << " in float32";
+    }
+    if (alpha > 0.0) {
+        ss << " (L2 alpha = " << alpha << ")";
+    }
+    if (bestEpoch > 0) {
+        ss << ", early stopped on " << validationFraction * 100.0
+           << "% validation rows (best epoch " << bestEpoch << " of " << nIterations << ")";
+    }
+    if (!ensembleMembers.empty()) {
+        ss << ", averaged over an ensemble of " << ensembleMembers.size() << " networks";
+    } else if (!restartScores.empty()) {
+        ss << ", best of " << restartScores.size() << " restarts";
+    }
+    
     return ss.str();
 }
 
@@ -499,19 +2260,21 @@ std::string NeuralNetwork::getTargetName() const {
     return targetVariableName;
 }
 
-void NeuralNetwork::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+void NeuralNetwork::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                        const Eigen::VectorXd& sampleWeights) {
     // Get predictions
     Eigen::VectorXd y_pred = predict(X);
+    double totalWeight = sampleWeights.sum();
     
     // Calculate SST (total sum of squares)
-    double y_mean = y.mean();
-    double sst = (y.array() - y_mean).square().sum();
+    double y_mean = sampleWeights.dot(y) / totalWeight;
+    double sst = (sampleWeights.array() * (y.array() - y_mean).square()).sum();
     
     // Calculate SSR (regression sum of squares)
-    double ssr = (y_pred.array() - y_mean).square().sum();
+    double ssr = (sampleWeights.array() * (y_pred.array() - y_mean).square()).sum();
     
     // Calculate SSE (error sum of squares)
-    double sse = (y.array() - y_pred.array()).square().sum();
+    double sse = (sampleWeights.array() * (y.array() - y_pred.array()).square()).sum();
     
     // Calculate R²
     rSquared = ssr / sst;
@@ -520,74 +2283,315 @@ void NeuralNetwork::calculateStatistics(const Eigen::MatrixXd& X, const Eigen::V
     adjustedRSquared = 1.0 - (1.0 - rSquared) * (nSamples - 1) / (nSamples - nFeatures - 1);
     
     // Calculate RMSE
-    rmse = std::sqrt(sse / nSamples);
+    rmse = std::sqrt(sse / totalWeight);
 }
 
 std::unordered_map<std::string, double> NeuralNetwork::getFeatureImportance() const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
+    if (importanceX.rows() == 0) {
+        throw std::runtime_error("No rows were kept from the last fit for feature importance");
+    }
+    
+    // Permutations are seeded from the model's seed, so the scores of a
+    // seeded fit are reproducible
+    PermutationImportance::Options options;
+    options.threads = numThreads;
+    options.seed = randomSeed >= 0 ? static_cast<unsigned int>(randomSeed) : options.seed;
+    return PermutationImportance::normalizedMeans(
+        PermutationImportance::compute(*this, importanceX, importanceY, options, importanceWeights));
+}
+
+void NeuralNetwork::keepImportanceRows(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                       const Eigen::VectorXd& sampleWeights, const std::vector<int>& heldOutRows) {
+    const int maxRows = 2000;
+    std::vector<int> kept;
+    if (!heldOutRows.empty()) {
+        // The validation rows are already in random order
+        kept.assign(heldOutRows.begin(), heldOutRows.begin() + std::min<size_t>(heldOutRows.size(), maxRows));
+    } else {
+        int nRows = static_cast<int>(X.rows());
+        int nKept = std::min(nRows, maxRows);
+        for (int i = 0; i < nKept; ++i) {
+            kept.push_back(static_cast<int>(static_cast<int64_t>(i) * nRows / nKept));
+        }
+    }
+    importanceX = X(kept, Eigen::all);
+    importanceY = y(kept);
+    importanceWeights = sampleWeights(kept);
+}
+
+std::unordered_map<std::string, double> NeuralNetwork::benchmarkTraining(const std::vector<int>& hiddenLayers,
+                                                                         int nRows, int nFeatures, int epochs,
+                                                                         const std::vector<int>& threadCounts,
+                                                                         int batchSize) {
+    std::unordered_map<std::string, double> results;
+    
+    // Synthetic nonlinear regression problem from a fixed seed
+    std::mt19937 gen(42);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    Eigen::MatrixXd X(nRows, nFeatures);
+    Eigen::VectorXd y(nRows);
+    for (int r = 0; r < nRows; ++r) {
+        for (int c = 0; c < nFeatures; ++c) {
+            X(r, c) = dist(gen);
+        }
+        y(r) = std::sin(X(r, 0)) + (nFeatures > 1 ? X(r, 0) * X(r, 1) : 0.0) + 0.1 * dist(gen);
+    }
+    
+    for (int threads : threadCounts) {
+        for (bool float32 : {false, true}) {
+            // Zero tolerance so every measurement runs all epochs
+            NeuralNetwork network(hiddenLayers, Activation::RELU, Activation::LINEAR,
+                                  0.001, epochs, batchSize, 0.0);
+            network.solver = Solver::ADAM;
+            network.useFloat32 = float32;
+            network.setNumThreads(threads);
+            
+            auto start = std::chrono::steady_clock::now();
+            if (!network.fit(X, y)) {
+                continue;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::string key = std::string("epochs_per_sec_") + (float32 ? "f32" : "f64") +
+                              "_t" + std::to_string(threads);
+            results[key] = seconds > 0.0 ? network.nIterations / seconds : 0.0;
+        }
+        
+        // Synchronous data-parallel training with the same per-thread batch
+        NeuralNetwork network(hiddenLayers, Activation::RELU, Activation::LINEAR,
+                              0.001, epochs, batchSize, 0.0);
+        network.solver = Solver::ADAM;
+        network.setDataParallelThreads(std::max(1, threads));
+        auto start = std::chrono::steady_clock::now();
+        if (network.fit(X, y)) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            results["epochs_per_sec_dp_t" + std::to_string(threads)] =
+                seconds > 0.0 ? network.nIterations / seconds : 0.0;
+        }
+    }
+    
+    // Instruction sets Eigen's product kernels were compiled for
+#ifdef EIGEN_VECTORIZE_SSE2
+    results["simd_sse2"] = 1.0;
+#else
+    results["simd_sse2"] = 0.0;
+#endif
+#ifdef EIGEN_VECTORIZE_AVX
+    results["simd_avx"] = 1.0;
+#else
+    results["simd_avx"] = 0.0;
+#endif
+#ifdef EIGEN_VECTORIZE_AVX2
+    results["simd_avx2"] = 1.0;
+#else
+    results["simd_avx2"] = 0.0;
+#endif
+#ifdef EIGEN_VECTORIZE_FMA
+    results["simd_fma"] = 1.0;
+#else
+    results["simd_fma"] = 0.0;
+#endif
+#ifdef EIGEN_VECTORIZE_AVX512
+    results["simd_avx512"] = 1.0;
+#else
+    results["simd_avx512"] = 0.0;
+#endif
+#ifdef EIGEN_HAS_OPENMP
+    results["openmp"] = 1.0;
+#else
+    results["openmp"] = 0.0;
+#endif
+    
+    return results;
+}
+
+void NeuralNetwork::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    auto putLayers = [&writer](const std::string& prefix, const std::vector<Eigen::MatrixXd>& layerWeights,
+                               const std::vector<Eigen::VectorXd>& layerBiases) {
+        for (size_t i = 0; i < layerWeights.size(); ++i) {
+            writer.putMatrix(prefix + "weights." + std::to_string(i), layerWeights[i]);
+            writer.putVector(prefix + "biases." + std::to_string(i), layerBiases[i]);
+        }
+    };
     
-    std::unordered_map<std::string, double> importance;
+    // Architecture and training parameters
+    writer.putArray("layer_sizes", std::vector<int32_t>(layerSizes.begin(), layerSizes.end()));
+    writer.putValue<int32_t>("hidden_activation", static_cast<int32_t>(hiddenActivation));
+    writer.putValue<int32_t>("output_activation", static_cast<int32_t>(outputActivation));
+    writer.putValue<double>("learning_rate", learningRate);
+    writer.putValue<int32_t>("epochs", epochs);
+    writer.putValue<int32_t>("batch_size", batchSize);
+    writer.putValue<double>("tol", tol);
+    writer.putValue<int32_t>("solver", static_cast<int32_t>(solver));
+    writer.putValue<double>("alpha", alpha);
+    writer.putValue<uint8_t>("use_float32", useFloat32 ? 1 : 0);
+    writer.putValue<int32_t>("num_threads", numThreads);
+    writer.putValue<int32_t>("random_seed", randomSeed);
+    writer.putValue<int32_t>("data_parallel_threads", dataParallelThreads);
+    writer.putValue<uint8_t>("hogwild", hogwild ? 1 : 0);
+    writer.putValue<double>("validation_fraction", validationFraction);
+    writer.putValue<int32_t>("patience", patience);
+    writer.putValue<int32_t>("schedule", static_cast<int32_t>(schedule));
+    writer.putValue<double>("schedule_factor", scheduleFactor);
+    writer.putValue<int32_t>("schedule_step", scheduleStep);
+    writer.putValue<int32_t>("restarts", restarts);
+    writer.putValue<uint8_t>("restart_ensemble", restartEnsemble ? 1 : 0);
+    writer.putValue<int32_t>("restart_threads", restartThreads);
+    writer.putValue<int32_t>("inference_mode", static_cast<int32_t>(inferenceMode));
     
-    // Create a random number generator for permutation
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Fitted state
+    writer.putValue<double>("current_learning_rate", currentLearningRate);
+    writer.putValue<int32_t>("best_epoch", bestEpoch);
+    writer.putValue<int32_t>("n_iterations", nIterations);
+    writer.putValue<int64_t>("loader_stalls", static_cast<int64_t>(loaderStalls));
+    writer.putArray("training_loss_history", trainingLossHistory);
+    writer.putArray("validation_loss_history", validationLossHistory);
+    writer.putArray("restart_scores", restartScores);
+    writer.putValue<double>("r_squared", rSquared);
+    writer.putValue<double>("adjusted_r_squared", adjustedRSquared);
+    writer.putValue<double>("rmse", rmse);
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putValue<int32_t>("n_features", nFeatures);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+    writer.putVector("feature_means", featureMeans);
+    writer.putVector("feature_std_devs", featureStdDevs);
+    writer.putValue<double>("target_mean", targetMean);
+    writer.putValue<double>("target_std_dev", targetStdDev);
+    putLayers("", weights, biases);
     
-    // Create a test matrix with random values in the same range as the normalized data
-    int testSamples = 1000;
-    Eigen::MatrixXd X_test = Eigen::MatrixXd::Random(testSamples, nFeatures);
+    writer.putMatrix("importance_x", importanceX);
+    writer.putVector("importance_y", importanceY);
+    writer.putVector("importance_weights", importanceWeights);
     
-    // Normalize by standard deviation range (Random produces values in [-1,1])
-    for (int i = 0; i < nFeatures; ++i) {
-        X_test.col(i) = X_test.col(i).array() * 3.0; // Scale to cover typical normalized range
+    writer.putValue<int32_t>("ensemble_members", static_cast<int32_t>(ensembleMembers.size()));
+    for (size_t k = 0; k < ensembleMembers.size(); ++k) {
+        putLayers("member." + std::to_string(k) + ".", ensembleMembers[k]->weights, ensembleMembers[k]->biases);
     }
+}
+
+void NeuralNetwork::readModel(const ModelFile::Reader& reader) {
+    // Layer shapes follow from the architecture, so a file whose matrices
+    // do not match it is rejected before the model is changed
+    auto layerSizesView = reader.array<int32_t>("layer_sizes");
+    std::vector<int> storedLayerSizes(layerSizesView.begin(), layerSizesView.end());
+    int features = reader.value<int32_t>("n_features");
+    std::vector<int> architecture;
+    architecture.push_back(features);
+    architecture.insert(architecture.end(), storedLayerSizes.begin(), storedLayerSizes.end());
+    architecture.push_back(1);
     
-    // Get baseline predictions
-    Eigen::VectorXd baseline_pred = predict(X_test);
+    auto readLayers = [&reader, &architecture](const std::string& prefix, std::vector<Eigen::MatrixXd>& layerWeights,
+                                               std::vector<Eigen::VectorXd>& layerBiases) {
+        layerWeights.clear();
+        layerBiases.clear();
+        for (size_t i = 0; i + 1 < architecture.size(); ++i) {
+            layerWeights.push_back(reader.matrix(prefix + "weights." + std::to_string(i)));
+            layerBiases.push_back(reader.vector(prefix + "biases." + std::to_string(i)));
+            if (layerWeights[i].rows() != architecture[i + 1] || layerWeights[i].cols() != architecture[i] ||
+                layerBiases[i].size() != architecture[i + 1]) {
+                throw std::runtime_error("Layer " + std::to_string(i) + " of the model file does not match its architecture");
+            }
+        }
+    };
     
-    // Compute baseline MSE (irrelevant for importance calculation but needed for scale)
-    double baseline_mse = baseline_pred.array().square().mean();
+    std::vector<Eigen::MatrixXd> storedWeights;
+    std::vector<Eigen::VectorXd> storedBiases;
+    readLayers("", storedWeights, storedBiases);
+    std::vector<std::string> names = reader.strings("variable_names");
+    Eigen::VectorXd means = reader.vector("feature_means");
+    Eigen::VectorXd stdDevs = reader.vector("feature_std_devs");
+    if (names.size() != static_cast<size_t>(features) || means.size() != features || stdDevs.size() != features) {
+        throw std::runtime_error("NeuralNetwork model file sizes do not match");
+    }
     
-    // Store feature importance scores
-    std::vector<double> scores(nFeatures);
+    auto historyView = reader.array<double>("training_loss_history");
+    auto validationView = reader.array<double>("validation_loss_history");
+    auto scoresView = reader.array<double>("restart_scores");
+    int storedBestEpoch = reader.value<int32_t>("best_epoch");
+    if (storedBestEpoch < 0 || static_cast<size_t>(storedBestEpoch) > validationView.size) {
+        throw std::runtime_error("NeuralNetwork model file has an invalid best epoch");
+    }
     
-    // For each feature, calculate permutation importance
-    for (int i = 0; i < nFeatures; ++i) {
-        // Create a copy of the test data
-        Eigen::MatrixXd X_permuted = X_test;
-        
-        // Permute the current feature
-        Eigen::VectorXd feature = X_test.col(i);
-        std::shuffle(feature.data(), feature.data() + feature.size(), gen);
-        X_permuted.col(i) = feature;
-        
-        // Get predictions with permuted feature
-        Eigen::VectorXd permuted_pred = predict(X_permuted);
-        
-        // Calculate MSE with permuted feature
-        double permuted_mse = (permuted_pred - baseline_pred).array().square().mean();
-        
-        // Importance is the increase in error
-        scores[i] = permuted_mse;
+    layerSizes = storedLayerSizes;
+    hiddenActivation = static_cast<Activation>(reader.value<int32_t>("hidden_activation"));
+    outputActivation = static_cast<Activation>(reader.value<int32_t>("output_activation"));
+    learningRate = reader.value<double>("learning_rate");
+    epochs = reader.value<int32_t>("epochs");
+    batchSize = reader.value<int32_t>("batch_size");
+    tol = reader.value<double>("tol");
+    solver = static_cast<Solver>(reader.value<int32_t>("solver"));
+    alpha = reader.value<double>("alpha");
+    useFloat32 = reader.value<uint8_t>("use_float32") != 0;
+    numThreads = reader.value<int32_t>("num_threads");
+    randomSeed = reader.value<int32_t>("random_seed");
+    dataParallelThreads = reader.value<int32_t>("data_parallel_threads");
+    hogwild = reader.value<uint8_t>("hogwild") != 0;
+    validationFraction = reader.value<double>("validation_fraction");
+    patience = reader.value<int32_t>("patience");
+    schedule = static_cast<LearningRateSchedule>(reader.value<int32_t>("schedule"));
+    scheduleFactor = reader.value<double>("schedule_factor");
+    scheduleStep = reader.value<int32_t>("schedule_step");
+    restarts = reader.value<int32_t>("restarts");
+    restartEnsemble = reader.value<uint8_t>("restart_ensemble") != 0;
+    restartThreads = reader.value<int32_t>("restart_threads");
+    inferenceMode = static_cast<InferenceMode>(reader.value<int32_t>("inference_mode"));
+    
+    currentLearningRate = reader.value<double>("current_learning_rate");
+    bestEpoch = storedBestEpoch;
+    nIterations = reader.value<int32_t>("n_iterations");
+    loaderStalls = static_cast<size_t>(reader.value<int64_t>("loader_stalls"));
+    trainingLossHistory.assign(historyView.begin(), historyView.end());
+    validationLossHistory.assign(validationView.begin(), validationView.end());
+    restartScores.assign(scoresView.begin(), scoresView.end());
+    rSquared = reader.value<double>("r_squared");
+    adjustedRSquared = reader.value<double>("adjusted_r_squared");
+    rmse = reader.value<double>("rmse");
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    nFeatures = features;
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    featureMeans = means;
+    featureStdDevs = stdDevs;
+    targetMean = reader.value<double>("target_mean");
+    targetStdDev = reader.value<double>("target_std_dev");
+    weights = std::move(storedWeights);
+    biases = std::move(storedBiases);
+    maxLayerWidth = 1;
+    for (const auto& W : weights) {
+        maxLayerWidth = std::max(maxLayerWidth, static_cast<int>(W.rows()));
     }
+    initializeSolverState();
     
-    // Normalize scores
-    double sum = std::accumulate(scores.begin(), scores.end(), 0.0);
+    importanceX = reader.matrix("importance_x");
+    importanceY = reader.vector("importance_y");
+    importanceWeights = reader.vector("importance_weights");
     
-    // Handle case where all scores are zero
-    if (sum < 1e-10) {
-        for (int i = 0; i < nFeatures; ++i) {
-            std::string name = (i < inputVariableNames.size()) ? inputVariableNames[i] : "Variable_" + std::to_string(i+1);
-            importance[name] = 1.0 / nFeatures;
-        }
-    } else {
-        // Normalize to sum to 1
-        for (int i = 0; i < nFeatures; ++i) {
-            std::string name = (i < inputVariableNames.size()) ? inputVariableNames[i] : "Variable_" + std::to_string(i+1);
-            importance[name] = scores[i] / sum;
-        }
+    // Members are copies of this network with their own weights, as trainRestarts makes them
+    ensembleMembers.clear();
+    std::vector<std::shared_ptr<NeuralNetwork>> members;
+    int memberCount = reader.value<int32_t>("ensemble_members");
+    for (int k = 0; k < memberCount; ++k) {
+        auto member = std::make_shared<NeuralNetwork>(*this);
+        member->restarts = 1;
+        member->dataParallelThreads = 1;
+        member->checkpointPath.clear();
+        member->importanceX.resize(0, 0);
+        readLayers("member." + std::to_string(k) + ".", member->weights, member->biases);
+        member->initializeSolverState();
+        member->isFitted = true;
+        member->compileInference();
+        members.push_back(member);
     }
+    ensembleMembers = std::move(members);
     
-    return importance;
-} 
\ No newline at end of file
+    resumeState.reset();
+    isFitted = true;
+    compileInference();
+}
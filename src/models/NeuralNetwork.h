@@ -1,9 +1,14 @@
 #pragma once
 
 #include "models/Model.h"
+#include "data/BatchLoader.h"
+#include "utils/CheckpointWriter.h"
 #include <vector>
 #include <random>
 #include <functional>
+#include <limits>
+#include <cstdint>
+#include <memory>
 
 /**
  * @brief Activation function types for neural network layers
@@ -15,6 +20,34 @@ enum class Activation {
     LINEAR
 };
 
+/**
+ * @brief Optimization algorithms for training the network weights
+ */
+enum class Solver {
+    SGD,    // Mini-batch gradient descent with a fixed learning rate
+    ADAM,   // Mini-batch Adam with bias-corrected moment estimates
+    LBFGS   // Full-batch limited-memory BFGS, suited to small datasets
+};
+
+/**
+ * @brief Learning rate schedules for the mini-batch solvers
+ */
+enum class LearningRateSchedule {
+    CONSTANT,   // Keep the initial learning rate
+    STEP,       // Multiply by a factor every fixed number of epochs
+    COSINE,     // Anneal from the initial rate to zero over all epochs
+    PLATEAU     // Multiply by a factor when the monitored loss stops improving
+};
+
+/**
+ * @brief How predict evaluates a fitted network
+ */
+enum class InferenceMode {
+    REFERENCE,  // Forward pass over a standardized copy of the inputs
+    FOLDED,     // Standardization folded into the weights, float32 row tiles
+    INT8        // Folded, with int8 weights and int32 accumulation after the first layer
+};
+
 /**
  * @brief Simple feedforward neural network model
  * 
@@ -68,6 +101,240 @@ public:
     
     ~NeuralNetwork() override = default;
 
+    /**
+     * @brief Set the optimization algorithm
+     * 
+     * @param solver Solver name (adam, sgd, lbfgs)
+     * @throws std::invalid_argument If the solver name is not recognized
+     */
+    void setSolver(const std::string& solver);
+
+    /**
+     * @brief Set the L2 penalty on the weights
+     * 
+     * The penalty 0.5 * alpha * ||W||^2 is added to the loss; biases are not penalized.
+     * 
+     * @param alpha L2 penalty (non-negative)
+     * @throws std::invalid_argument If alpha is negative
+     */
+    void setAlpha(double alpha);
+
+    /**
+     * @brief Set the floating point precision of the mini-batch solvers
+     * 
+     * With float32 the forward and backward passes run on single precision
+     * copies of the weights, which doubles the SIMD width of the matrix
+     * products. The optimizer keeps double precision master weights. L-BFGS
+     * always runs in double precision.
+     * 
+     * @param precision "float64" or "float32"
+     * @throws std::invalid_argument If the precision is not recognized
+     */
+    void setPrecision(const std::string& precision);
+
+    /**
+     * @brief Set the number of threads for the matrix products
+     * 
+     * Applied to Eigen for the duration of fit. Eigen only runs products in
+     * parallel when built with OpenMP (-fopenmp); without it, fit warns that
+     * more than one thread has no effect. predict never changes Eigen's
+     * thread count: if Eigen already runs products on several threads, the
+     * row blocks run on the calling thread, otherwise they are spread over
+     * the cores.
+     * 
+     * @param numThreads Number of threads (0 keeps Eigen's default)
+     * @throws std::invalid_argument If numThreads is negative
+     */
+    void setNumThreads(int numThreads);
+
+    /**
+     * @brief Set the seed of the weight initialization and shuffling
+     * 
+     * @param seed Non-negative seed, or -1 to seed from std::random_device on every fit
+     */
+    void setRandomSeed(int seed);
+
+    /**
+     * @brief Set the number of data-parallel training threads
+     * 
+     * With more than one thread, every thread runs forward and backward on
+     * its own batchSize rows, so one step covers threads * batchSize rows.
+     * The per-thread gradients are summed with a tree reduction in a fixed
+     * order before a single optimizer step, so results with a fixed seed
+     * and thread count are reproducible. Eigen's product threads are set to
+     * one meanwhile. Does not apply to L-BFGS.
+     * 
+     * @param threads Number of threads (1 trains on the calling thread)
+     * @throws std::invalid_argument If threads is less than 1
+     */
+    void setDataParallelThreads(int threads);
+
+    /**
+     * @brief Enable asynchronous (Hogwild) data-parallel updates
+     * 
+     * Each thread trains on its own share of every epoch and updates the
+     * shared weights after each of its batches without synchronization.
+     * Faster than the synchronous reduction, but not reproducible.
+     * 
+     * @param enabled Whether to use Hogwild updates with data-parallel threads
+     */
+    void setHogwild(bool enabled);
+
+    /**
+     * @brief Hold out a validation set and stop when its loss stops improving
+     * 
+     * A random validationFraction of the rows is left out of training. After
+     * each epoch the weighted mean squared error on those rows is recorded,
+     * and training stops once it has not improved by more than tol for
+     * patience epochs. The weights of the best epoch are restored. Applies
+     * to the mini-batch solvers; L-BFGS trains on all rows.
+     * 
+     * @param validationFraction Fraction of rows to hold out (0 disables early stopping)
+     * @param patience Epochs without improvement before stopping
+     * @throws std::invalid_argument If validationFraction is not in [0, 1) or patience is less than 1
+     */
+    void setEarlyStopping(double validationFraction, int patience = 10);
+
+    /**
+     * @brief Set the learning rate schedule of the mini-batch solvers
+     * 
+     * @param schedule "constant", "step", "cosine" or "plateau"
+     * @param factor Multiplier applied by the step and plateau schedules
+     * @param stepEpochs Epochs between steps, or epochs without improvement before a plateau cut
+     * @throws std::invalid_argument If the schedule is not recognized, factor is not in (0, 1] or stepEpochs is less than 1
+     */
+    void setLearningRateSchedule(const std::string& schedule, double factor = 0.5, int stepEpochs = 10);
+
+    /**
+     * @brief Get the training loss of each epoch of the last fit
+     * 
+     * The loss is the weighted mean squared error on the standardized target,
+     * averaged over the batches of the epoch (L-BFGS: after each iteration).
+     * 
+     * @return const std::vector<double>& One entry per epoch
+     */
+    const std::vector<double>& getTrainingLossHistory() const;
+
+    /**
+     * @brief Get the validation loss of each epoch of the last fit
+     * 
+     * @return const std::vector<double>& One entry per epoch, empty without early stopping
+     */
+    const std::vector<double>& getValidationLossHistory() const;
+
+    /**
+     * @brief Train several networks from different random initializations
+     * 
+     * Each restart gets its own seed drawn from the model's generator and
+     * trains on the same standardized rows (and the same validation rows
+     * with early stopping) on a pool of worker threads. "best" keeps the
+     * network with the lowest validation loss, or the lowest final training
+     * loss without early stopping. "ensemble" keeps all of them and predict
+     * averages their outputs. Restarts train with one data-parallel thread
+     * each, since the pool already uses the cores.
+     * 
+     * @param restarts Number of networks to train (1 trains a single network)
+     * @param selection "best" or "ensemble"
+     * @param threads Worker threads (0 for one per hardware thread)
+     * @throws std::invalid_argument If restarts is less than 1, threads is negative or the selection is not recognized
+     */
+    void setRestarts(int restarts, const std::string& selection = "best", int threads = 0);
+
+    /**
+     * @brief Write training checkpoints while fitting
+     * 
+     * Every interval epochs, and once more when training ends, fit hands a
+     * copy of the weights, the optimizer and learning rate state, the early
+     * stopping state and the generator state to a CheckpointWriter, which
+     * writes it on its own thread. Checkpoints are not written for L-BFGS,
+     * for restarts or by fitFromCSV.
+     * 
+     * @param filePath Checkpoint file (empty to disable checkpointing)
+     * @param interval Epochs between checkpoints
+     * @throws std::invalid_argument If interval is less than 1
+     */
+    void setCheckpoint(const std::string& filePath, int interval = 10);
+
+    /**
+     * @brief Continue the next fit from a checkpoint
+     * 
+     * The next call to fit with the same data, architecture, solver and
+     * precision starts after the last epoch in the checkpoint and repeats
+     * exactly what the interrupted run would have done (except with Hogwild
+     * updates, which are not deterministic). Training runs up to the current
+     * epoch count, so raising it continues a finished run. If the data or
+     * network differ, fit warns and trains from scratch.
+     * 
+     * @param filePath Checkpoint written during an earlier fit
+     * @throws std::runtime_error If the file is not a readable NeuralNetwork checkpoint
+     */
+    void resumeFromCheckpoint(const std::string& filePath);
+
+    /**
+     * @brief Select how predict evaluates the fitted network
+     * 
+     * "reference" standardizes a copy of X and runs the training forward
+     * pass. "folded" folds the standardization into the first layer and the
+     * target scaling into the last, reads X in place and streams it through
+     * the network in tiles of rows, keeping only the current tile's
+     * activations; layers after the first run in float32. "int8" also
+     * quantizes the weights after the first layer per output channel to int8
+     * and each activation row to int8, and accumulates in int32. The kernel
+     * widens both to int16 and multiplies pairs (madd_epi16 on AVX2,
+     * dpwssd with AVX-512 VNNI), not int8 dot products, so it is usually
+     * slower than "folded" as well as less accurate; it is kept for
+     * comparison with benchmarkInference rather than for speed.
+     * 
+     * @param mode "reference", "folded" or "int8"
+     * @throws std::invalid_argument If the mode is not recognized
+     */
+    void setInferenceMode(const std::string& mode);
+
+    /**
+     * @brief Compare the inference modes on the given rows
+     * 
+     * Reports "rows_per_sec_<mode>" for reference, folded and int8, the
+     * largest and root mean square difference of each compiled mode from
+     * the reference predictions ("max_abs_delta_<mode>",
+     * "rms_delta_<mode>"), "rmse_<mode>" when targets are given, and flags
+     * for the integer kernels compiled in ("simd_avx2", "simd_avx512_vnni").
+     * The products use Eigen's current thread count, as predict does.
+     * 
+     * @param X Input features
+     * @param y Targets (empty to skip the accuracy against the target)
+     * @param repeats Timed passes per mode
+     * @return std::unordered_map<std::string, double> Throughput and accuracy per mode
+     * @throws std::runtime_error If the model is not fitted
+     */
+    std::unordered_map<std::string, double> benchmarkInference(const Eigen::MatrixXd& X,
+                                                               const Eigen::VectorXd& y = Eigen::VectorXd(),
+                                                               int repeats = 3) const;
+
+    /**
+     * @brief Measure training throughput on synthetic data
+     * 
+     * Trains a fixed architecture with Adam for a fixed number of epochs in
+     * float64 and float32 with each number of product threads, and with
+     * that many data-parallel threads. The result has the keys
+     * "epochs_per_sec_f64_t<n>", "epochs_per_sec_f32_t<n>" and
+     * "epochs_per_sec_dp_t<n>" plus flags for
+     * the instruction sets the matrix products were compiled for
+     * ("simd_sse2", "simd_avx", "simd_avx2", "simd_fma", "simd_avx512") and
+     * "openmp".
+     * 
+     * @param hiddenLayers Hidden layer sizes
+     * @param nRows Number of synthetic rows
+     * @param nFeatures Number of synthetic features
+     * @param epochs Epochs per measurement
+     * @param threadCounts Thread counts to measure
+     * @param batchSize Mini-batch size
+     * @return std::unordered_map<std::string, double> Throughput per configuration
+     */
+    static std::unordered_map<std::string, double> benchmarkTraining(const std::vector<int>& hiddenLayers,
+                                                                     int nRows, int nFeatures, int epochs,
+                                                                     const std::vector<int>& threadCounts,
+                                                                     int batchSize = 256);
+
     /**
      * @brief Fit the neural network to the given data
      * 
@@ -75,11 +342,32 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
      * @return bool True if fitting was successful, false otherwise
      */
     bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             const std::vector<std::string>& variableNames = {},
-            const std::string& targetName = "") override;
+            const std::string& targetName = "",
+            const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) override;
+
+    /**
+     * @brief Fit the neural network to a CSV file without loading it into memory
+     * 
+     * One pass over the file computes the standardization, then every epoch
+     * streams the file again in chunks through the batch loader. Rows are
+     * shuffled within each chunk. Requires a mini-batch solver (sgd or adam);
+     * early stopping and data-parallel threads are not applied. All rows have
+     * unit weight and must not contain missing values.
+     * 
+     * @param filePath Path to the CSV file
+     * @param featureColumns Names of the input columns
+     * @param targetColumn Name of the target column
+     * @param chunkRows Rows held in memory at a time
+     * @param separator Column separator character
+     * @return bool True if fitting was successful, false otherwise
+     */
+    bool fitFromCSV(const std::string& filePath, const std::vector<std::string>& featureColumns,
+                    const std::string& targetColumn, size_t chunkRows = 65536, char separator = ',');
 
     /**
      * @brief Make predictions using the fitted neural network
@@ -89,6 +377,37 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::MatrixXd& X) const override;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * @param X Input features for prediction, read in place
+     * @param predictions Output span with one element per row of X
+     */
+    void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                     Eigen::Ref<Eigen::VectorXd> predictions) const override;
+
+    /**
+     * @brief Values predictOne keeps on the stack: the normalized inputs
+     * and the activations of two layers
+     */
+    static constexpr int MAX_ROW_VALUES = 4096;
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * Always runs the reference pass in double precision, whatever the
+     * inference mode set by setInferenceMode, so it equals predict in
+     * "reference" mode for networks trained in float64 and differs from the
+     * folded and int8 modes by their rounding. The row is computed in a
+     * stack buffer of MAX_ROW_VALUES doubles; a network whose inputs plus
+     * twice its widest layer need more returns NaN, and predict must be used.
+     * 
+     * @param features First of the row's feature values, in training column order
+     * @return double Predicted value
+     */
+    double predictOne(const double* features) const noexcept override;
+    double predictOne(const float* features) const noexcept override;
+
     /**
      * @brief Get the name of the model
      * 
@@ -134,17 +453,24 @@ public:
     /**
      * @brief Get the feature importance scores
      * 
-     * For neural networks, feature importance is approximated using
-     * a permutation-based method. Each feature is permuted and the
-     * resulting change in prediction error is used as a measure of importance.
+     * Permutation importance (see PermutationImportance) on rows kept from
+     * the last fit: the early-stopping validation rows when there are any,
+     * otherwise an even sample of the training rows. The mean increase in
+     * squared error is normalized to shares summing to 1.
      * 
      * @return std::unordered_map<std::string, double> Map of feature names to importance scores
      */
     std::unordered_map<std::string, double> getFeatureImportance() const override;
 
+protected:
+    void writeModel(ModelFile::Writer& writer) const override;
+    void readModel(const ModelFile::Reader& reader) override;
+    size_t predictRowBytes() const override;
+
 private:
     // Network architecture
     std::vector<int> layerSizes;
+    int maxLayerWidth = 1;  // Widest layer of the fitted weights, for predictOne's buffer
     Activation hiddenActivation;
     Activation outputActivation;
     
@@ -153,6 +479,64 @@ private:
     int epochs;
     int batchSize;
     double tol;
+    Solver solver;
+    double alpha;
+    bool useFloat32;
+    int numThreads;
+    int randomSeed;
+    int dataParallelThreads;
+    bool hogwild;
+    
+    // Early stopping and learning rate schedule
+    double validationFraction;
+    int patience;
+    LearningRateSchedule schedule;
+    double scheduleFactor;
+    int scheduleStep;
+    double currentLearningRate;
+    int bestEpoch;
+    std::vector<double> trainingLossHistory;
+    std::vector<double> validationLossHistory;
+    
+    // Adam state: first and second moment estimates per parameter
+    double beta1;
+    double beta2;
+    double epsilon;
+    long long adamStep;
+    std::vector<Eigen::MatrixXd> weightMoments;
+    std::vector<Eigen::MatrixXd> weightSquaredMoments;
+    std::vector<Eigen::VectorXd> biasMoments;
+    std::vector<Eigen::VectorXd> biasSquaredMoments;
+    
+    // L-BFGS state: the last lbfgsMemory parameter and gradient differences
+    int lbfgsMemory;
+    Eigen::MatrixXd lbfgsSteps;
+    Eigen::MatrixXd lbfgsGradientSteps;
+    Eigen::VectorXd lbfgsRho;
+    Eigen::VectorXd lbfgsAlpha;
+    
+    int nIterations;
+    
+    // Shuffling and initialization draw from one generator that lives as long
+    // as the model; setRandomSeed reseeds it at the start of each fit
+    std::mt19937 rng;
+    size_t loaderStalls;    // Times the last fit waited for the batch loader
+    
+    // Multi-restart training
+    int restarts;
+    bool restartEnsemble;
+    int restartThreads;
+    std::vector<double> restartScores;      // Selection loss of each restart of the last fit
+    std::vector<std::shared_ptr<NeuralNetwork>> ensembleMembers;
+    
+    // Checkpointing
+    std::string checkpointPath;
+    int checkpointInterval;
+    
+    // Rows kept from the last fit for permutation importance
+    Eigen::MatrixXd importanceX;
+    Eigen::VectorXd importanceY;
+    Eigen::VectorXd importanceWeights;
     
     // Model state
     std::vector<Eigen::MatrixXd> weights;
@@ -173,31 +557,363 @@ private:
     Eigen::VectorXd featureStdDevs;
     double targetMean;
     double targetStdDev;
+    
+    /**
+     * @brief Inference form of one layer, built by compileInference
+     * 
+     * Weights are stored transposed (inputs x outputs) so a tile of rows
+     * multiplies them directly. The first layer keeps double precision
+     * because it sees the raw, unstandardized inputs.
+     */
+    struct CompiledLayer {
+        Eigen::MatrixXd firstWeights;           // First layer only
+        Eigen::VectorXd firstBias;
+        Eigen::MatrixXf weights;                // Other layers, float32
+        Eigen::VectorXf bias;
+        std::vector<int8_t> quantizedWeights;   // [input pair][paddedOutputs][2]
+        Eigen::VectorXf channelScales;          // Dequantization scale per output
+        Eigen::Index paddedInputs = 0;          // Inputs rounded up to a multiple of 2
+        Eigen::Index paddedOutputs = 0;         // Outputs rounded up to a multiple of 8
+        Activation activation = Activation::LINEAR;
+    };
+    
+    InferenceMode inferenceMode;
+    std::vector<CompiledLayer> compiledLayers;
+    double compiledOutputScale;     // Target scaling left after the last layer
+    double compiledOutputShift;     // (1 and 0 when folded into it)
+    
+    /**
+     * @brief Build the folded and quantized layers from the fitted weights
+     */
+    void compileInference();
+    
+    /**
+     * @brief Predict with the training forward pass
+     * 
+     * @param X Input features
+     * @return Eigen::VectorXd Predictions
+     */
+    Eigen::VectorXd predictReference(const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+    
+    /**
+     * @brief Predict with the compiled layers, one tile of rows at a time
+     * 
+     * @param X Input features
+     * @param quantized Whether to use the int8 weights after the first layer
+     * @return Eigen::VectorXd Predictions
+     */
+    Eigen::VectorXd predictCompiled(const Eigen::Ref<const Eigen::MatrixXd>& X, bool quantized) const;
 
     /**
      * @brief Initialize network weights and biases
+     * 
+     * Draws Xavier-scaled normal weights from rng for the architecture given
+     * by nFeatures and layerSizes, zeroes the biases and resets the solver state.
      */
     void initializeParameters();
     
+    template <typename Scalar>
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    template <typename Scalar>
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    
+    /**
+     * @brief Buffers reused by every training step
+     * 
+     * Sized once per fit for the largest batch. Smaller batches use the top
+     * rows of each buffer, so the training loop never allocates.
+     */
+    template <typename Scalar>
+    struct TrainingWorkspace {
+        Matrix<Scalar> inputs;                        // Gathered normalized rows, rows x features
+        Vector<Scalar> targets;                       // Gathered normalized targets
+        Vector<Scalar> rowWeights;                    // Gathered sample weights
+        std::vector<Matrix<Scalar>> activations;      // Output of each layer, rows x units
+        std::vector<Matrix<Scalar>> deltas;           // Loss gradient w.r.t. each layer's pre-activation
+        std::vector<Matrix<Scalar>> weightGrads;
+        std::vector<Vector<Scalar>> biasGrads;
+        std::vector<Matrix<Scalar>> weights;          // Weights in Scalar precision (unused for double)
+        std::vector<Vector<Scalar>> biases;
+    };
+    
+    /**
+     * @brief Per-fit state of the epoch loop
+     * 
+     * Holds the validation rows and the weights of the best epoch for early
+     * stopping and the progress of the learning rate schedule. All buffers
+     * are sized before the first epoch.
+     */
+    struct EpochMonitor {
+        const Eigen::MatrixXd* validationX = nullptr;     // Normalized validation rows, null without early stopping
+        const Eigen::VectorXd* validationY = nullptr;
+        const Eigen::VectorXd* validationWeights = nullptr;
+        TrainingWorkspace<double> validationWorkspace;
+        std::vector<Eigen::MatrixXd> bestWeights;
+        std::vector<Eigen::VectorXd> bestBiases;
+        double bestLoss = std::numeric_limits<double>::infinity();
+        double previousLoss = std::numeric_limits<double>::infinity();
+        int epochsWithoutImprovement = 0;
+        double plateauLoss = std::numeric_limits<double>::infinity();
+        int plateauEpochs = 0;
+        int firstEpoch = 0;                               // Epochs already trained by a resumed run
+        CheckpointWriter* checkpointWriter = nullptr;     // Null without checkpointing
+    };
+    
+    /**
+     * @brief Training state stored in a checkpoint
+     * 
+     * The data fingerprint decides whether a fit may resume. A resumed fit
+     * restarts rng from fitStartGenerator, so the initialization, validation
+     * split and shuffle seed are drawn as before, and then replaces the
+     * state of the epoch loop by the stored one.
+     */
+    struct TrainingCheckpoint {
+        // Data and network fingerprint
+        int64_t rows = 0;
+        int features = 0;
+        double featureSum = 0.0;
+        double targetSum = 0.0;
+        double weightSum = 0.0;
+        std::vector<int> layerSizes;
+        int solver = 0;
+        bool float32 = false;
+        double validationFraction = 0.0;
+        
+        std::mt19937 fitStartGenerator;     // rng as it was when the fit started
+        int epochsDone = 0;
+        std::vector<Eigen::MatrixXd> weights;
+        std::vector<Eigen::VectorXd> biases;
+        long long adamStep = 0;
+        std::vector<Eigen::MatrixXd> weightMoments;
+        std::vector<Eigen::MatrixXd> weightSquaredMoments;
+        std::vector<Eigen::VectorXd> biasMoments;
+        std::vector<Eigen::VectorXd> biasSquaredMoments;
+        double learningRate = 0.0;
+        int bestEpoch = 0;
+        std::vector<double> trainingLossHistory;
+        std::vector<double> validationLossHistory;
+        
+        // Early stopping and schedule progress (see EpochMonitor)
+        std::vector<Eigen::MatrixXd> bestWeights;
+        std::vector<Eigen::VectorXd> bestBiases;
+        double bestLoss = std::numeric_limits<double>::infinity();
+        double previousLoss = std::numeric_limits<double>::infinity();
+        int epochsWithoutImprovement = 0;
+        double plateauLoss = std::numeric_limits<double>::infinity();
+        int plateauEpochs = 0;
+        
+        /**
+         * @brief Append the state to a checkpoint payload
+         * 
+         * @param buffer Output buffer
+         */
+        void append(std::vector<char>& buffer) const;
+        
+        /**
+         * @brief Read a state written by append
+         * 
+         * @param buffer Checkpoint payload
+         * @return TrainingCheckpoint The stored state
+         * @throws std::runtime_error If the payload is malformed
+         */
+        static TrainingCheckpoint read(const std::vector<char>& buffer);
+        
+        /**
+         * @brief Check whether two checkpoints have the same data and network fingerprint
+         * 
+         * @param other Checkpoint to compare with
+         * @return bool True if a fit of one may resume from the other
+         */
+        bool sameFit(const TrainingCheckpoint& other) const;
+    };
+    
+    TrainingCheckpoint fitFingerprint;                          // Fingerprint and start generator of the current fit
+    std::shared_ptr<const TrainingCheckpoint> resumeState;     // Set by resumeFromCheckpoint until the next fit
+    
+    /**
+     * @brief Hand the current training state to the checkpoint writer
+     * 
+     * @param epochsDone Number of finished epochs
+     * @param monitor Epoch loop state holding the writer
+     */
+    void submitCheckpoint(int epochsDone, const EpochMonitor& monitor);
+    
+    /**
+     * @brief Load a checkpoint into the model and the epoch loop
+     * 
+     * @param checkpoint Stored training state
+     * @param monitor Epoch loop state to restore
+     */
+    void restoreCheckpoint(const TrainingCheckpoint& checkpoint, EpochMonitor& monitor);
+    
+    /**
+     * @brief Train the current weights on standardized rows
+     * 
+     * Resets the training history, runs the configured solver and, with
+     * validation rows, restores the weights of the best epoch.
+     * 
+     * @param X Normalized training features
+     * @param y Normalized training targets
+     * @param sampleWeights Training row weights
+     * @param validationX Normalized validation features (no rows to train without early stopping)
+     * @param validationY Normalized validation targets
+     * @param validationWeights Validation row weights
+     * @param generator Random generator for shuffling
+     * @param resume Checkpoint to continue from (null to train from the current weights)
+     */
+    void trainNetwork(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, const Eigen::VectorXd& sampleWeights,
+                      const Eigen::MatrixXd& validationX, const Eigen::VectorXd& validationY,
+                      const Eigen::VectorXd& validationWeights, std::mt19937& generator,
+                      const TrainingCheckpoint* resume = nullptr);
+    
+    /**
+     * @brief Train the restarts concurrently and keep the best or all of them
+     * 
+     * Takes the same arguments as trainNetwork; the seeds of the restarts
+     * are drawn from rng.
+     */
+    void trainRestarts(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, const Eigen::VectorXd& sampleWeights,
+                       const Eigen::MatrixXd& validationX, const Eigen::VectorXd& validationY,
+                       const Eigen::VectorXd& validationWeights);
+    
+    /**
+     * @brief Run the forward pass on standardized rows
+     * 
+     * @param X_norm Normalized input features
+     * @return Eigen::VectorXd Normalized predictions
+     */
+    Eigen::VectorXd forwardNormalized(const Eigen::MatrixXd& X_norm) const;
+    
+    /**
+     * @brief Predict in a given inference mode, averaging ensemble members
+     * 
+     * @param X Input features
+     * @param mode Inference mode
+     * @return Eigen::VectorXd Predictions
+     */
+    Eigen::VectorXd predictWith(const Eigen::Ref<const Eigen::MatrixXd>& X, InferenceMode mode) const;
+    
+    /**
+     * @brief Record an epoch, update the learning rate and decide whether to stop
+     * 
+     * @param epoch Zero-based index of the finished epoch
+     * @param trainingLoss Weighted mean squared error of the epoch
+     * @param monitor Epoch loop state
+     * @return bool True if training should stop
+     */
+    bool endEpoch(int epoch, double trainingLoss, EpochMonitor& monitor);
+    
+    /**
+     * @brief Size a workspace for the current architecture
+     * 
+     * @param workspace Workspace to size
+     * @param rows Largest number of rows passed through the network at once
+     * @param training Whether to size the batch, delta and gradient buffers too
+     */
+    template <typename Scalar>
+    void allocateWorkspace(TrainingWorkspace<Scalar>& workspace, Eigen::Index rows, bool training) const;
+    
+    /**
+     * @brief Refresh the reduced precision copies of the weights after an update
+     * 
+     * @param workspace Workspace holding the copies
+     */
+    template <typename Scalar>
+    void syncWorkspaceWeights(TrainingWorkspace<Scalar>& workspace) const;
+    
+    /**
+     * @brief Get the weights in the precision of a workspace
+     * 
+     * @param workspace Workspace holding the reduced precision copies
+     * @return const std::vector<Matrix<Scalar>>& The model weights for double, the copies otherwise
+     */
+    template <typename Scalar>
+    const std::vector<Matrix<Scalar>>& workspaceWeights(const TrainingWorkspace<Scalar>& workspace) const;
+    
+    /**
+     * @brief Get the biases in the precision of a workspace
+     * 
+     * @param workspace Workspace holding the reduced precision copies
+     * @return const std::vector<Vector<Scalar>>& The model biases for double, the copies otherwise
+     */
+    template <typename Scalar>
+    const std::vector<Vector<Scalar>>& workspaceBiases(const TrainingWorkspace<Scalar>& workspace) const;
+    
+    /**
+     * @brief Copy the given rows into the workspace batch
+     * 
+     * @param X Normalized input features
+     * @param y Normalized target values
+     * @param sampleWeights Sample weights
+     * @param rowIndices Indices of the rows to gather
+     * @param rows Number of rows to gather
+     * @param workspace Workspace receiving the batch
+     */
+    template <typename Scalar>
+    void gatherBatch(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                     const Eigen::VectorXd& sampleWeights, const int* rowIndices, Eigen::Index rows,
+                     TrainingWorkspace<Scalar>& workspace) const;
+    
     /**
      * @brief Forward propagation through the network
      * 
+     * Layer l writes its output to the top X.rows() rows of workspace.activations[l].
+     * 
      * @param X Input features matrix
-     * @return std::vector<Eigen::MatrixXd> Output and activations from each layer
+     * @param workspace Workspace receiving the activations
      */
-    std::vector<Eigen::MatrixXd> forwardPropagate(const Eigen::MatrixXd& X) const;
+    template <typename Scalar>
+    void forwardPropagate(const Eigen::Ref<const Matrix<Scalar>>& X, TrainingWorkspace<Scalar>& workspace) const;
     
     /**
      * @brief Backward propagation to compute gradients
      * 
+     * Expects the activations of forwardPropagate on the same X and writes
+     * the gradients of half the weighted mean squared error to
+     * workspace.weightGrads and workspace.biasGrads.
+     * 
      * @param X Input features matrix
      * @param y Target values
-     * @param activations Activations from forward propagation
-     * @return std::pair<std::vector<Eigen::MatrixXd>, std::vector<Eigen::VectorXd>> Gradients for weights and biases
+     * @param sampleWeights Per-row weights of the loss
+     * @param workspace Workspace holding the activations and receiving the gradients
      */
-    std::pair<std::vector<Eigen::MatrixXd>, std::vector<Eigen::VectorXd>> 
-    backwardPropagate(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, 
-                      const std::vector<Eigen::MatrixXd>& activations);
+    template <typename Scalar>
+    void backwardPropagate(const Eigen::Ref<const Matrix<Scalar>>& X,
+                           const Eigen::Ref<const Vector<Scalar>>& y,
+                           const Eigen::Ref<const Vector<Scalar>>& sampleWeights,
+                           TrainingWorkspace<Scalar>& workspace) const;
+    
+    /**
+     * @brief Train with mini-batch SGD or Adam
+     * 
+     * Batches are gathered by a BatchLoader on a producer thread while the
+     * previous batch trains.
+     * 
+     * @param source Normalized rows to train on
+     * @param nRows Number of rows in one pass
+     * @param totalWeight Sum of the row weights of one pass
+     * @param generator Random generator; seeds the loader's shuffling
+     * @param monitor Epoch loop state
+     */
+    template <typename Scalar>
+    void trainMiniBatch(std::unique_ptr<typename BatchLoader<Scalar>::Source> source, Eigen::Index nRows,
+                        double totalWeight, std::mt19937& generator, EpochMonitor& monitor);
+    
+    /**
+     * @brief Train with SGD or Adam on several threads
+     * 
+     * See setDataParallelThreads and setHogwild.
+     * 
+     * @param X Normalized input features
+     * @param y Normalized target values
+     * @param sampleWeights Per-row weights of the loss
+     * @param generator Random generator for shuffling
+     * @param monitor Epoch loop state
+     */
+    template <typename Scalar>
+    void trainDataParallel(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                           const Eigen::VectorXd& sampleWeights, std::mt19937& generator,
+                           EpochMonitor& monitor);
     
     /**
      * @brief Update weights and biases with computed gradients
@@ -205,26 +921,86 @@ private:
      * @param weightGrads Gradients for weights
      * @param biasGrads Gradients for biases
      */
-    void updateParameters(const std::vector<Eigen::MatrixXd>& weightGrads,
-                         const std::vector<Eigen::VectorXd>& biasGrads);
+    template <typename Scalar>
+    void updateParameters(const std::vector<Matrix<Scalar>>& weightGrads,
+                          const std::vector<Vector<Scalar>>& biasGrads);
+    
+    /**
+     * @brief Allocate and reset the optimizer state for the current weights
+     */
+    void initializeSolverState();
+    
+    /**
+     * @brief Train on the full batch with L-BFGS
+     * 
+     * Runs up to epochs iterations of two-loop recursion directions with a
+     * backtracking line search and stops once the largest gradient entry
+     * falls below tol. Records the training loss after each iteration.
+     * 
+     * @param X Normalized input features
+     * @param y Normalized target values
+     * @param sampleWeights Per-row weights of the loss
+     */
+    void trainLBFGS(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                    const Eigen::VectorXd& sampleWeights);
+    
+    /**
+     * @brief Compute the penalized loss and its gradient at the current weights
+     * 
+     * @param X Normalized input features
+     * @param y Normalized target values
+     * @param sampleWeights Per-row weights of the loss
+     * @param workspace Workspace sized for all rows of X
+     * @param gradient Flattened gradient, resized by the caller to the parameter count
+     * @return double 0.5 * weighted mean squared error + 0.5 * alpha * ||W||^2
+     */
+    double evaluateObjective(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                             const Eigen::VectorXd& sampleWeights, TrainingWorkspace<double>& workspace,
+                             Eigen::VectorXd& gradient);
+    
+    /**
+     * @brief Get the number of weights and biases in the network
+     * 
+     * @return Eigen::Index Parameter count
+     */
+    Eigen::Index parameterCount() const;
+    
+    /**
+     * @brief Copy the weights and biases into a flat vector
+     * 
+     * @param parameters Destination, already sized to parameterCount()
+     */
+    void packParameters(Eigen::VectorXd& parameters) const;
     
     /**
-     * @brief Apply activation function to a matrix
+     * @brief Copy a flat vector back into the weights and biases
      * 
-     * @param X Input matrix
+     * @param parameters Source laid out as by packParameters
+     */
+    void unpackParameters(const Eigen::VectorXd& parameters);
+    
+    /**
+     * @brief Add the biases to a layer's pre-activations and apply the activation in place
+     * 
+     * @param Z Pre-activations, rows x units
+     * @param bias Bias of each unit
      * @param activation Activation function to apply
-     * @return Eigen::MatrixXd Result after applying activation
      */
-    Eigen::MatrixXd applyActivation(const Eigen::MatrixXd& X, Activation activation) const;
+    template <typename Scalar>
+    static void applyActivation(Eigen::Ref<Matrix<Scalar>> Z, const Vector<Scalar>& bias,
+                                Activation activation);
     
     /**
-     * @brief Apply derivative of activation function to a matrix
+     * @brief Multiply gradients by the activation derivative in place
      * 
-     * @param X Input matrix
-     * @param activation Activation function whose derivative to apply
-     * @return Eigen::MatrixXd Result after applying activation derivative
+     * @param delta Loss gradient w.r.t. the layer output; becomes the gradient w.r.t. its pre-activation
+     * @param output Layer output the derivative is expressed in
+     * @param activation Activation function of the layer
      */
-    Eigen::MatrixXd applyActivationDerivative(const Eigen::MatrixXd& X, Activation activation) const;
+    template <typename Scalar>
+    static void applyActivationDerivative(Eigen::Ref<Matrix<Scalar>> delta,
+                                          const Eigen::Ref<const Matrix<Scalar>>& output,
+                                          Activation activation);
     
     /**
      * @brief Normalize input features
@@ -232,21 +1008,55 @@ private:
      * @param X Input features matrix
      * @return Eigen::MatrixXd Normalized features
      */
-    Eigen::MatrixXd normalizeFeatures(const Eigen::MatrixXd& X) const;
+    Eigen::MatrixXd normalizeFeatures(const Eigen::Ref<const Eigen::MatrixXd>& X) const;
+    
+    /**
+     * @brief Keep up to a fixed number of rows for permutation importance
+     * 
+     * @param X Input features used for fitting
+     * @param y Target values used for fitting
+     * @param sampleWeights Sample weights used for fitting
+     * @param heldOutRows Validation rows in random order (empty to sample all rows)
+     */
+    void keepImportanceRows(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                            const Eigen::VectorXd& sampleWeights, const std::vector<int>& heldOutRows);
     
     /**
      * @brief Calculate model statistics after fitting
      * 
      * @param X Input features used for fitting
      * @param y Target values used for fitting
+     * @param sampleWeights Sample weights used for fitting
      */
-    void calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
+    void calculateStatistics(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                             const Eigen::VectorXd& sampleWeights);
     
     /**
      * @brief Calculate feature means and standard deviations
      * 
      * @param X Input features matrix
      * @param y Target values
+     * @param sampleWeights Sample weights
+     */
+    void calculateNormalizationParams(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                                      const Eigen::VectorXd& sampleWeights);
+    
+    /**
+     * @brief Body of both predictOne overloads
+     * 
+     * @param features First of the row's feature values
+     * @return double Prediction value
+     */
+    template <typename T>
+    double predictRow(const T* features) const noexcept;
+    
+    /**
+     * @brief Run the network on one normalized row in double precision
+     * 
+     * @param input Normalized features
+     * @param current Scratch for the activations of one layer, the widest layer long
+     * @param next Scratch of the same length
+     * @return double Output of the network before the target scaling
      */
-    void calculateNormalizationParams(const Eigen::MatrixXd& X, const Eigen::VectorXd& y);
+    double forwardRow(const double* input, double* current, double* next) const noexcept;
 }; 
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "models/ParallelPredict.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const Eigen::Index MIN_BLOCK_ROWS = 256;
+const Eigen::Index MAX_BLOCK_ROWS = 65536;
+
+// Set on the executor's threads and inside a SerialScope
+thread_local bool serialThread = false;
+
+} // namespace
+
+namespace ParallelPredict {
+
+Eigen::Index cacheBlockRows(size_t bytesPerRow) {
+    // Eigen reads the cache sizes from the CPU, with defaults where it cannot
+    static const size_t budget = static_cast<size_t>(std::max<std::ptrdiff_t>(Eigen::l2CacheSize(), 64 * 1024)) / 2;
+    Eigen::Index rows = static_cast<Eigen::Index>(budget / std::max<size_t>(bytesPerRow, 1));
+    rows = std::min(std::max(rows, MIN_BLOCK_ROWS), MAX_BLOCK_ROWS);
+    return rows / 16 * 16;
+}
+
+Plan plan(Eigen::Index rows, size_t bytesPerRow, const Options& options) {
+    if (rows < 0 || options.threads < 0 || options.blockRows < 0) {
+        throw std::invalid_argument("Rows, threads and block size must be non-negative");
+    }
+    Plan result;
+    result.rows = rows;
+    result.blockRows = options.blockRows > 0 ? options.blockRows : cacheBlockRows(bytesPerRow);
+    Eigen::Index nBlocks = (rows + result.blockRows - 1) / result.blockRows;
+    int threads = options.threads > 0 ? options.threads
+                                      : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (serialThread) {
+        threads = 1;
+    }
+    result.workers = static_cast<int>(std::max<Eigen::Index>(1, std::min<Eigen::Index>(threads, nBlocks)));
+    return result;
+}
+
+void run(const Plan& plan, const BlockFunction& predictBlock) {
+    if (plan.rows == 0) {
+        predictBlock(0, 0, 0);
+        return;
+    }
+    Eigen::Index nBlocks = (plan.rows + plan.blockRows - 1) / plan.blockRows;
+    if (plan.workers <= 1) {
+        for (Eigen::Index block = 0; block < nBlocks; ++block) {
+            Eigen::Index first = block * plan.blockRows;
+            predictBlock(0, first, std::min(plan.blockRows, plan.rows - first));
+        }
+        return;
+    }
+
+    std::atomic<Eigen::Index> nextBlock(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::exception_ptr> errors(static_cast<size_t>(nBlocks));
+    auto work = [&](int worker) {
+        SerialScope nested;
+        for (Eigen::Index block = nextBlock++; block < nBlocks && !failed; block = nextBlock++) {
+            try {
+                Eigen::Index first = block * plan.blockRows;
+                predictBlock(worker, first, std::min(plan.blockRows, plan.rows - first));
+            } catch (...) {
+                errors[static_cast<size_t>(block)] = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < plan.workers; ++t) {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+SerialScope::SerialScope() : previous(serialThread) {
+    serialThread = true;
+}
+
+SerialScope::~SerialScope() {
+    serialThread = previous;
+}
+
+} // namespace ParallelPredict
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <functional>
+
+/**
+ * @brief Shared executor that spreads a prediction over row blocks and threads
+ *
+ * The rows are cut into blocks sized so that a block's inputs, outputs and
+ * the model's per-row working memory fit in about half the L2 cache. A pool
+ * of threads takes the blocks in turn, and each block writes its own range
+ * of the output, so no thread waits on another or copies results. The
+ * block boundaries depend only on the row count and the bytes per row, never
+ * on the number of threads, so the predictions do not either.
+ *
+ * Calls made from one of the executor's threads, or inside a SerialScope,
+ * run their blocks on the calling thread, so code that is already parallel
+ * does not multiply the threads.
+ */
+namespace ParallelPredict {
+
+/**
+ * @brief Settings of a parallel prediction
+ */
+struct Options {
+    int threads = 0;            // Worker threads (0 for the hardware concurrency)
+    Eigen::Index blockRows = 0; // Rows per block (0 to size blocks to the L2 cache)
+};
+
+/**
+ * @brief How the rows of one call are split
+ */
+struct Plan {
+    Eigen::Index rows = 0;      // Rows to predict
+    Eigen::Index blockRows = 1; // Rows per block; the last block may be shorter
+    int workers = 1;            // Threads that will run blocks, including the caller
+};
+
+/**
+ * @brief Predicts one block of rows
+ *
+ * Called with the index of the thread running it, below Plan::workers, so
+ * that the function can keep scratch space per thread, and with the range
+ * of rows. Blocks of the same call run concurrently on different threads.
+ */
+using BlockFunction = std::function<void(int worker, Eigen::Index firstRow, Eigen::Index rows)>;
+
+/**
+ * @brief Rows per block that keep a block in about half the L2 cache
+ *
+ * @param bytesPerRow Memory a row touches: its inputs, output and scratch
+ * @return Eigen::Index Rows per block, a multiple of 16 between 256 and 65536
+ */
+Eigen::Index cacheBlockRows(size_t bytesPerRow);
+
+/**
+ * @brief Split rows into blocks and choose the number of threads
+ *
+ * @param rows Number of rows to predict
+ * @param bytesPerRow Memory a row touches, used when options.blockRows is 0
+ * @param options Threads and block size
+ * @return Plan Block size and number of workers
+ * @throws std::invalid_argument If the options are negative
+ */
+Plan plan(Eigen::Index rows, size_t bytesPerRow, const Options& options = Options());
+
+/**
+ * @brief Run predictBlock on every block of a plan
+ *
+ * The calling thread works as worker 0. A plan without rows still calls
+ * predictBlock once with an empty range, so the model's own checks, such as
+ * whether it is fitted, run as they would for a direct call. If blocks
+ * throw, the remaining blocks are skipped and the exception of the first
+ * failed block is rethrown.
+ *
+ * @param plan Blocks and workers from plan()
+ * @param predictBlock Predicts one block
+ */
+void run(const Plan& plan, const BlockFunction& predictBlock);
+
+/**
+ * @brief Keeps the executor on the calling thread while in scope
+ *
+ * For threads that already run in parallel with each other, such as the
+ * workers of permutation importance. Scopes may nest.
+ */
+class SerialScope {
+public:
+    SerialScope();
+    ~SerialScope();
+
+    SerialScope(const SerialScope&) = delete;
+    SerialScope& operator=(const SerialScope&) = delete;
+
+private:
+    bool previous;
+};
+
+} // namespace ParallelPredict
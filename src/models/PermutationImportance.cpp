@@ -0,0 +1,178 @@
+#include "models/PermutationImportance.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace PermutationImportance {
+
+namespace {
+
+double weightedSquaredError(const Eigen::VectorXd& predictions, const Eigen::VectorXd& y,
+                            const Eigen::VectorXd& weights, double totalWeight) {
+    return (weights.array() * (predictions - y).array().square()).sum() / totalWeight;
+}
+
+} // namespace
+
+Result compute(const Model& model, const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+               const Options& options, const Eigen::VectorXd& sampleWeights,
+               const std::vector<Eigen::Index>& rows) {
+    if (X.rows() != y.size()) {
+        throw std::invalid_argument("Number of samples in X (" + std::to_string(X.rows()) +
+                                    ") does not match number of samples in y (" +
+                                    std::to_string(y.size()) + ")");
+    }
+    if (sampleWeights.size() != 0 && sampleWeights.size() != y.size()) {
+        throw std::invalid_argument("Number of sample weights does not match number of samples");
+    }
+    if (options.repeats < 1) {
+        throw std::invalid_argument("Number of repeats must be at least 1");
+    }
+    if (options.threads < 0 || options.maxRows < 0) {
+        throw std::invalid_argument("Number of threads and row limit must be non-negative");
+    }
+    for (Eigen::Index row : rows) {
+        if (row < 0 || row >= X.rows()) {
+            throw std::invalid_argument("Row index " + std::to_string(row) + " is out of range");
+        }
+    }
+
+    // Pick the evaluated rows: the given view, thinned evenly to the limit
+    std::vector<Eigen::Index> selected = rows;
+    if (selected.empty()) {
+        selected.resize(X.rows());
+        std::iota(selected.begin(), selected.end(), Eigen::Index(0));
+    }
+    if (options.maxRows > 0 && static_cast<Eigen::Index>(selected.size()) > options.maxRows) {
+        std::vector<Eigen::Index> thinned(options.maxRows);
+        for (Eigen::Index i = 0; i < options.maxRows; ++i) {
+            thinned[i] = selected[i * static_cast<Eigen::Index>(selected.size()) / options.maxRows];
+        }
+        selected.swap(thinned);
+    }
+    Eigen::Index nRows = static_cast<Eigen::Index>(selected.size());
+    Eigen::Index nFeatures = X.cols();
+    if (nRows == 0) {
+        throw std::invalid_argument("No rows to evaluate permutation importance on");
+    }
+
+    // Only copy the inputs when a subset of rows is evaluated
+    bool allRows = nRows == X.rows() && rows.empty();
+    Eigen::MatrixXd subset;
+    if (!allRows) {
+        subset = X(selected, Eigen::all);
+    }
+    const Eigen::MatrixXd& source = allRows ? X : subset;
+    Eigen::VectorXd target = allRows ? y : Eigen::VectorXd(y(selected));
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(nRows);
+    if (sampleWeights.size() != 0) {
+        weights = sampleWeights(selected);
+    }
+    double totalWeight = weights.sum();
+    if (!(totalWeight > 0.0)) {
+        throw std::invalid_argument("Sample weights of the evaluated rows must not all be zero");
+    }
+
+    Result result;
+    result.rows = nRows;
+    result.baselineLoss = weightedSquaredError(model.predict(source), target, weights, totalWeight);
+    if (!std::isfinite(result.baselineLoss)) {
+        throw std::invalid_argument("Loss of the unpermuted rows is not finite; evaluate only rows with a "
+                                    "target value and inputs the model can predict");
+    }
+
+    // Tasks are ordered by feature, so a thread usually takes several
+    // repeats of the same column in a row and restores its buffer rarely
+    int repeats = options.repeats;
+    Eigen::Index nTasks = nFeatures * repeats;
+    std::vector<double> increases(static_cast<size_t>(nTasks), 0.0);
+    std::vector<std::exception_ptr> errors(static_cast<size_t>(nTasks));
+    std::atomic<Eigen::Index> nextTask(0);
+    auto work = [&]() {
+        // The tasks already use the cores, so each predict stays on its thread
+        ParallelPredict::SerialScope serial;
+        Eigen::MatrixXd buffer = source;
+        std::vector<Eigen::Index> permutation(nRows);
+        Eigen::Index permutedColumn = -1;
+        for (Eigen::Index task = nextTask++; task < nTasks; task = nextTask++) {
+            Eigen::Index feature = task / repeats;
+            int repeat = static_cast<int>(task % repeats);
+            try {
+                if (permutedColumn >= 0 && permutedColumn != feature) {
+                    buffer.col(permutedColumn) = source.col(permutedColumn);
+                }
+                permutedColumn = feature;
+
+                std::seed_seq seed{options.seed, static_cast<unsigned int>(feature),
+                                   static_cast<unsigned int>(repeat)};
+                std::mt19937 generator(seed);
+                std::iota(permutation.begin(), permutation.end(), Eigen::Index(0));
+                std::shuffle(permutation.begin(), permutation.end(), generator);
+                for (Eigen::Index i = 0; i < nRows; ++i) {
+                    buffer(i, feature) = source(permutation[i], feature);
+                }
+
+                double loss = weightedSquaredError(model.predict(buffer), target, weights, totalWeight);
+                increases[static_cast<size_t>(task)] = loss - result.baselineLoss;
+            } catch (...) {
+                errors[static_cast<size_t>(task)] = std::current_exception();
+            }
+        }
+    };
+
+    int threads = options.threads > 0 ? options.threads
+                                      : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = static_cast<int>(std::min<Eigen::Index>(threads, nTasks));
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<std::string> names = model.getVariableNames();
+    result.features.resize(static_cast<size_t>(nFeatures));
+    for (Eigen::Index j = 0; j < nFeatures; ++j) {
+        FeatureScore& score = result.features[static_cast<size_t>(j)];
+        score.name = static_cast<Eigen::Index>(names.size()) == nFeatures ? names[j]
+                                                                         : "Variable_" + std::to_string(j + 1);
+        const double* values = increases.data() + j * repeats;
+        score.mean = std::accumulate(values, values + repeats, 0.0) / repeats;
+        if (repeats > 1) {
+            double squares = 0.0;
+            for (int r = 0; r < repeats; ++r) {
+                squares += (values[r] - score.mean) * (values[r] - score.mean);
+            }
+            score.stdDev = std::sqrt(squares / (repeats - 1));
+        }
+    }
+    return result;
+}
+
+std::unordered_map<std::string, double> normalizedMeans(const Result& result) {
+    double total = 0.0;
+    for (const auto& score : result.features) {
+        total += std::max(score.mean, 0.0);
+    }
+
+    std::unordered_map<std::string, double> importance;
+    for (const auto& score : result.features) {
+        importance[score.name] = total > 1e-12 ? std::max(score.mean, 0.0) / total
+                                               : 1.0 / result.features.size();
+    }
+    return importance;
+}
+
+} // namespace PermutationImportance
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "models/Model.h"
+#include <Eigen/Dense>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Model-agnostic permutation feature importance
+ *
+ * The importance of a feature is the increase in weighted mean squared error
+ * when its column is shuffled, which breaks its relation to the target while
+ * keeping its distribution. Each feature is shuffled several times and the
+ * mean and standard deviation of the increase are reported. Scores should be
+ * computed on real rows, preferably held-out ones, since importance on the
+ * training rows also reflects what the model memorized.
+ *
+ * The (feature, repeat) pairs run on a pool of threads. Every thread copies
+ * the evaluated rows once and permutes a column in that buffer by gathering
+ * from the original, restoring it only when it moves on to another feature.
+ * Each pair draws its permutation from its own seed, so the scores do not
+ * depend on the number of threads. Model::predict must be safe to call
+ * concurrently, which holds for the const predict of every model here;
+ * the workers run it inside a ParallelPredict::SerialScope.
+ */
+namespace PermutationImportance {
+
+/**
+ * @brief Settings of a permutation importance run
+ */
+struct Options {
+    int repeats = 5;            // Permutations per feature
+    int threads = 0;            // Worker threads (0 for the hardware concurrency)
+    unsigned int seed = 42;     // Seed of the permutations
+    Eigen::Index maxRows = 0;   // Evenly spaced rows to evaluate at most (0 for all)
+};
+
+/**
+ * @brief Importance of one feature
+ */
+struct FeatureScore {
+    std::string name;
+    double mean = 0.0;          // Mean increase of the weighted MSE
+    double stdDev = 0.0;        // Standard deviation over the repeats
+};
+
+/**
+ * @brief Scores of all features, in column order
+ */
+struct Result {
+    double baselineLoss = 0.0;  // Weighted MSE before any permutation
+    Eigen::Index rows = 0;      // Number of rows evaluated
+    std::vector<FeatureScore> features;
+};
+
+/**
+ * @brief Compute permutation importance for a fitted model
+ *
+ * @param model Fitted model
+ * @param X Input features, with the columns the model was trained on
+ * @param y True target values
+ * @param options Repeats, threads, seed and row limit
+ * @param sampleWeights Per-row weights (empty for unit weights)
+ * @param rows Rows of X to evaluate, e.g. a validation split (empty for all rows)
+ * @return Result Mean and standard deviation of the loss increase per feature
+ * @throws std::invalid_argument If the sizes, row indices or options are invalid,
+ *         or if the loss before permutation is not finite (e.g. a missing target)
+ */
+Result compute(const Model& model, const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+               const Options& options = Options(),
+               const Eigen::VectorXd& sampleWeights = Eigen::VectorXd(),
+               const std::vector<Eigen::Index>& rows = {});
+
+/**
+ * @brief Mean scores as shares of the total, keyed by feature name
+ *
+ * Negative means (shuffling helped by chance) count as zero. If no feature
+ * matters, every feature gets an equal share.
+ *
+ * @param result Scores from compute
+ * @return std::unordered_map<std::string, double> Importance summing to 1
+ */
+std::unordered_map<std::string, double> normalizedMeans(const Result& result);
+
+} // namespace PermutationImportance
@@ -1,14 +1,24 @@
 #include "models/RandomForest.h"
+#include "models/TreeCompaction.h"
+#include "models/CategoricalSplit.h"
+#include "models/ThresholdSplit.h"
+#include "models/HistogramTree.h"
+#include "models/ModelFile.h"
+#include "models/TreeWalk.h"
+#include <cassert>
 #include <cmath>
+#include <chrono>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <unordered_set>
 #include <numeric>
 
 RandomForest::RandomForest()
     : nEstimators(100), maxDepth(10), minSamplesSplit(2), minSamplesLeaf(1),
-      maxFeatures("auto"), bootstrap(true), isFitted(false), nSamples(0), nFeatures(0), rmse(0.0) {
+      maxFeatures("auto"), bootstrap(true), warmStart(false), isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0),
+      trainingTargetSum(0.0) {
     // Initialize random number generator with a random seed
     std::random_device rd;
     rng = std::mt19937(rd());
@@ -18,7 +28,8 @@ RandomForest::RandomForest(int n_estimators, int max_depth, int min_samples_spli
                          int min_samples_leaf, const std::string& max_features, bool bootstrap)
     : nEstimators(n_estimators), maxDepth(max_depth), minSamplesSplit(min_samples_split),
       minSamplesLeaf(min_samples_leaf), maxFeatures(max_features), bootstrap(bootstrap),
-      isFitted(false), nSamples(0), nFeatures(0), rmse(0.0) {
+      warmStart(false), isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0),
+      trainingTargetSum(0.0) {
     // Initialize random number generator with a random seed
     std::random_device rd;
     rng = std::mt19937(rd());
@@ -26,8 +37,11 @@ RandomForest::RandomForest(int n_estimators, int max_depth, int min_samples_spli
 
 bool RandomForest::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                       const std::vector<std::string>& variableNames,
-                      const std::string& targetName) {
+                      const std::string& targetName,
+                      const Eigen::VectorXd& sampleWeights) {
     try {
+        materializeTrees();
+        
         // Check dimensions
         if (X.rows() != y.rows()) {
             std::cerr << "Error: Number of samples in X (" << X.rows() 
@@ -35,7 +49,32 @@ bool RandomForest::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             return false;
         }
         
+        // Missing feature values are handled by the splits, a missing target is not
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        Eigen::VectorXd weights;
+        if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+            return false;
+        }
+        
+        // Warm start keeps the fitted trees only for the data they were fitted on
+        double targetSum = y.sum();
+        bool resume = warmStart && isFitted &&
+                      X.rows() == nSamples && X.cols() == nFeatures &&
+                      targetSum == trainingTargetSum &&
+                      weights.sum() == sampleWeightSum &&
+                      static_cast<int>(trees.size()) <= nEstimators;
+        if (warmStart && isFitted && !resume) {
+            std::cerr << "Warning: Warm start not possible (training data or tree count changed). "
+                      << "Retraining Random Forest from scratch." << std::endl;
+        }
+        
         nSamples = X.rows();
+        sampleWeightSum = weights.sum();
+        trainingTargetSum = targetSum;
         nFeatures = X.cols();
         
         // Store variable names
@@ -63,45 +102,158 @@ bool RandomForest::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         // Store target variable name
         targetVariableName = targetName.empty() ? "Target" : targetName;
         
-        // Clear existing trees
-        trees.clear();
+        // Mark categorical features
+        categoricalMask.assign(nFeatures, false);
+        for (int idx : categoricalFeatureIndices) {
+            if (idx >= 0 && idx < nFeatures) {
+                categoricalMask[idx] = true;
+            }
+        }
+        
+        // Clear existing trees unless we are growing an existing forest
+        if (!resume) {
+            trees.clear();
+        }
+        
+        // Train each missing tree in the forest
+        for (int i = static_cast<int>(trees.size()); i < nEstimators; ++i) {
+            // Bootstrap sampling (sampling with replacement) as per-row counts,
+            // or all samples with their weights without bootstrap
+            Eigen::VectorXd treeWeights = bootstrap ? drawBootstrapCounts(weights) : weights;
+            
+            // The tree only visits rows that carry weight
+            std::vector<int> sampleIndices;
+            sampleIndices.reserve(nSamples);
+            for (int j = 0; j < nSamples; ++j) {
+                if (treeWeights(j) > 0.0) {
+                    sampleIndices.push_back(j);
+                }
+            }
+            
+            // Create a new tree
+            DecisionTree tree;
+            tree.featureImportance.resize(nFeatures, 0.0);
+            
+            // Build the tree
+            tree.root = buildTree(X, y, treeWeights, sampleIndices, 0, tree);
+            
+            // Add the tree to the forest
+            trees.push_back(tree);
+        }
         
-        // Create bootstrap indices for each tree
+        // Calculate feature importance
+        calculateFeatureImportance();
+        
+        // Set isFitted to true before calling functions that depend on it
+        isFitted = true;
+        
+        // Calculate RMSE
+        Eigen::VectorXd predictions = predict(X);
+        rmse = std::sqrt(weights.dot((predictions - y).array().square().matrix()) / sampleWeightSum);
+        
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting Random Forest model: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool RandomForest::fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                       const std::vector<std::string>& variableNames,
+                       const std::string& targetName) {
+    try {
+        materializeTrees();
+        
+        // Check dimensions
+        if (static_cast<size_t>(y.size()) != data.rows()) {
+            std::cerr << "Error: Number of samples in binned data (" << data.rows() 
+                    << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
+            return false;
+        }
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        nSamples = static_cast<int>(data.rows());
+        sampleWeightSum = static_cast<double>(nSamples);
+        trainingTargetSum = y.sum();
+        nFeatures = static_cast<int>(data.cols());
+        
+        // Store variable names
+        if (variableNames.size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = variableNames;
+        } else if (data.getFeatureNames().size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = data.getFeatureNames();
+        } else {
+            inputVariableNames.clear();
+            for (int i = 0; i < nFeatures; ++i) {
+                inputVariableNames.push_back("Variable_" + std::to_string(i+1));
+            }
+        }
+        
+        // Store target variable name
+        if (!targetName.empty()) {
+            targetVariableName = targetName;
+        } else {
+            targetVariableName = data.getTargetName().empty() ? "Target" : data.getTargetName();
+        }
+        
+        // Binned training treats every feature as numeric
+        categoricalMask.assign(nFeatures, false);
+        
+        HistogramTree::Params params;
+        params.maxDepth = maxDepth;
+        params.minChildWeight = minSamplesLeaf;
+        params.minSplitWeight = std::max(minSamplesSplit, minSamplesLeaf + 1);
+        
+        // Each node considers a random subset of the features
+        int numFeaturesToConsider = getNumFeaturesToConsider();
+        std::vector<int> allFeatureIndices(nFeatures);
+        std::iota(allFeatureIndices.begin(), allFeatureIndices.end(), 0);
+        auto selectFeatures = [&]() {
+            std::shuffle(allFeatureIndices.begin(), allFeatureIndices.end(), rng);
+            return std::vector<int>(allFeatureIndices.begin(),
+                                    allFeatureIndices.begin() + numFeaturesToConsider);
+        };
+        auto leafValue = [](double sum, double count) { return count > 0.0 ? sum / count : 0.0; };
+        Eigen::VectorXd ones = Eigen::VectorXd::Ones(nSamples);
+        
+        trees.clear();
         std::uniform_int_distribution<int> dist(0, nSamples - 1);
+        Eigen::VectorXd predictions = Eigen::VectorXd::Zero(nSamples);
         
-        // Train each tree in the forest
         for (int i = 0; i < nEstimators; ++i) {
             // Create sample indices for this tree
-            std::vector<int> sampleIndices;
-            
+            std::vector<int> sampleIndices(nSamples);
             if (bootstrap) {
-                // Bootstrap sampling (sampling with replacement)
-                sampleIndices.resize(nSamples);
                 for (int j = 0; j < nSamples; ++j) {
                     sampleIndices[j] = dist(rng);
                 }
             } else {
-                // Use all samples without bootstrap
-                sampleIndices.resize(nSamples);
                 std::iota(sampleIndices.begin(), sampleIndices.end(), 0);
             }
             
-            // Create a new tree
             DecisionTree tree;
-            tree.featureImportance.resize(nFeatures, 0);
+            tree.featureImportance.resize(nFeatures, 0.0);
+            auto onSplit = [&tree](TreeNode& node, int feature, double gain, double count) {
+                node.impurityDecrease = gain / count;
+                tree.featureImportance[feature] += gain;
+            };
+            tree.root = HistogramTree::build<TreeNode>(data, sampleIndices, y, ones, params,
+                                                       leafValue, selectFeatures, onSplit);
             
-            // Build the tree
-            tree.root = buildTree(X, y, sampleIndices, 0, tree);
-            
-            // Add the tree to the forest
+            for (int j = 0; j < nSamples; ++j) {
+                predictions(j) += HistogramTree::predict(tree.root, data, j);
+            }
             trees.push_back(tree);
         }
         
         // Calculate feature importance
         calculateFeatureImportance();
         
-        // Calculate RMSE
-        Eigen::VectorXd predictions = predict(X);
+        // Calculate RMSE on the binned training rows
+        predictions /= static_cast<double>(trees.size());
         rmse = std::sqrt((predictions - y).array().square().mean());
         
         isFitted = true;
@@ -115,6 +267,7 @@ bool RandomForest::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
 std::shared_ptr<RandomForest::TreeNode> RandomForest::buildTree(
     const Eigen::MatrixXd& X, 
     const Eigen::VectorXd& y,
+    const Eigen::VectorXd& weights,
     const std::vector<int>& sampleIndices,
     int depth,
     DecisionTree& tree) {
@@ -122,23 +275,30 @@ std::shared_ptr<RandomForest::TreeNode> RandomForest::buildTree(
     // Create a new node
     auto node = std::make_shared<TreeNode>();
     
+    // Sample counts are weight sums, so a row with weight k counts as k samples
+    double nodeWeight = 0.0;
+    for (int idx : sampleIndices) {
+        nodeWeight += weights(idx);
+    }
+    node->cover = nodeWeight;
+    
     // Check stopping criteria
     if (depth >= maxDepth || 
-        static_cast<int>(sampleIndices.size()) < minSamplesSplit || 
-        static_cast<int>(sampleIndices.size()) <= minSamplesLeaf) {
+        nodeWeight < minSamplesSplit || 
+        nodeWeight <= minSamplesLeaf) {
         
         node->isLeaf = true;
-        node->outputValue = calculateMean(y, sampleIndices);
+        node->outputValue = calculateMean(y, weights, sampleIndices);
         return node;
     }
     
     // Calculate the variance before splitting
-    double nodeVariance = calculateVariance(y, sampleIndices);
+    double nodeVariance = calculateVariance(y, weights, sampleIndices);
     
     // If the variance is 0, all targets are the same, so make it a leaf
     if (nodeVariance < 1e-6) {
         node->isLeaf = true;
-        node->outputValue = calculateMean(y, sampleIndices);
+        node->outputValue = calculateMean(y, weights, sampleIndices);
         return node;
     }
     
@@ -159,17 +319,17 @@ std::shared_ptr<RandomForest::TreeNode> RandomForest::buildTree(
     double bestScore;
     double impurityDecrease;
     std::vector<int> leftIndices, rightIndices;
+    std::vector<uint64_t> bestCategories;
+    bool bestMissingLeft = false;
     
-    findBestSplit(X, y, sampleIndices, featureIndices, bestFeatureIndex, bestSplitValue, 
-                bestScore, impurityDecrease, leftIndices, rightIndices);
+    findBestSplit(X, y, weights, sampleIndices, featureIndices, bestFeatureIndex, bestSplitValue, 
+                bestScore, impurityDecrease, leftIndices, rightIndices, bestCategories, bestMissingLeft);
     
     // If we couldn't find a good split or one side is empty, make it a leaf
-    if (bestFeatureIndex == -1 || leftIndices.empty() || rightIndices.empty() || 
-        static_cast<int>(leftIndices.size()) < minSamplesLeaf || 
-        static_cast<int>(rightIndices.size()) < minSamplesLeaf) {
-        
+    // (findBestSplit already enforces minSamplesLeaf on the child weights)
+    if (bestFeatureIndex == -1 || leftIndices.empty() || rightIndices.empty()) {
         node->isLeaf = true;
-        node->outputValue = calculateMean(y, sampleIndices);
+        node->outputValue = calculateMean(y, weights, sampleIndices);
         return node;
     }
     
@@ -177,14 +337,18 @@ std::shared_ptr<RandomForest::TreeNode> RandomForest::buildTree(
     node->isLeaf = false;
     node->featureIndex = bestFeatureIndex;
     node->splitValue = bestSplitValue;
+    node->isCategorical = !bestCategories.empty();
+    node->categoryBitset = bestCategories;
+    node->defaultLeft = bestMissingLeft;
     node->impurityDecrease = impurityDecrease;
+    node->gain = nodeWeight * impurityDecrease;
     
     // Update feature importance in this tree
-    tree.featureImportance[bestFeatureIndex] += static_cast<int>(sampleIndices.size()) * impurityDecrease;
+    tree.featureImportance[bestFeatureIndex] += nodeWeight * impurityDecrease;
     
     // Recursively build left and right subtrees
-    node->leftChild = buildTree(X, y, leftIndices, depth + 1, tree);
-    node->rightChild = buildTree(X, y, rightIndices, depth + 1, tree);
+    node->leftChild = buildTree(X, y, weights, leftIndices, depth + 1, tree);
+    node->rightChild = buildTree(X, y, weights, rightIndices, depth + 1, tree);
     
     return node;
 }
@@ -192,6 +356,7 @@ std::shared_ptr<RandomForest::TreeNode> RandomForest::buildTree(
 void RandomForest::findBestSplit(
     const Eigen::MatrixXd& X,
     const Eigen::VectorXd& y,
+    const Eigen::VectorXd& weights,
     const std::vector<int>& sampleIndices,
     const std::vector<int>& featureIndices,
     int& bestFeatureIndex,
@@ -199,118 +364,143 @@ void RandomForest::findBestSplit(
     double& bestScore,
     double& impurityDecrease,
     std::vector<int>& leftIndices,
-    std::vector<int>& rightIndices) {
+    std::vector<int>& rightIndices,
+    std::vector<uint64_t>& bestCategories,
+    bool& bestMissingLeft) {
     
     // Initialize best values
     bestScore = std::numeric_limits<double>::lowest();
     bestFeatureIndex = -1;
     bestSplitValue = 0.0;
+    bestCategories.clear();
+    bestMissingLeft = false;
     impurityDecrease = 0.0;
     
-    // Get the variance before splitting
-    double nodeVariance = calculateVariance(y, sampleIndices);
-    double nodeSize = static_cast<double>(sampleIndices.size());
+    double nodeSize = 0.0;
+    for (int idx : sampleIndices) {
+        nodeSize += weights(idx);
+    }
     
     // Try splitting on each feature
     for (int featIdx : featureIndices) {
-        // Sort sample indices by the feature value
-        std::vector<std::pair<double, int>> featureValueIndices;
-        for (int idx : sampleIndices) {
-            featureValueIndices.push_back({X(idx, featIdx), idx});
-        }
-        
-        std::sort(featureValueIndices.begin(), featureValueIndices.end());
-        
-        // Try each possible split point
-        for (size_t i = 0; i < featureValueIndices.size() - 1; ++i) {
-            // Skip if the next value is the same as the current one
-            if (i < featureValueIndices.size() - 1 && 
-                featureValueIndices[i].first == featureValueIndices[i + 1].first) {
-                continue;
-            }
-            
-            // Generate left and right sample indices
-            std::vector<int> tempLeftIndices, tempRightIndices;
-            for (const auto& pair : featureValueIndices) {
-                if (pair.first <= featureValueIndices[i].first) {
-                    tempLeftIndices.push_back(pair.second);
-                } else {
-                    tempRightIndices.push_back(pair.second);
-                }
-            }
+        // Categorical features use a Fisher-ordered partition of their categories
+        if (isCategoricalFeature(featIdx)) {
+            CategoricalSplit::Result split = CategoricalSplit::findBestPartition(
+                sampleIndices,
+                [&X, featIdx](int idx) { return X(idx, featIdx); },
+                [&y, &weights](int idx) { return weights(idx) * y(idx); },
+                [&weights](int idx) { return weights(idx); },
+                static_cast<double>(minSamplesLeaf));
             
-            // Skip if either side has too few samples
-            if (static_cast<int>(tempLeftIndices.size()) < minSamplesLeaf || 
-                static_cast<int>(tempRightIndices.size()) < minSamplesLeaf) {
-                continue;
-            }
-            
-            // Calculate variances after splitting
-            double leftVariance = calculateVariance(y, tempLeftIndices);
-            double rightVariance = calculateVariance(y, tempRightIndices);
-            
-            // Calculate weighted variance reduction (score)
-            double leftSize = static_cast<double>(tempLeftIndices.size());
-            double rightSize = static_cast<double>(tempRightIndices.size());
-            
-            double weightedVariance = (leftSize * leftVariance + rightSize * rightVariance) / nodeSize;
-            double score = nodeVariance - weightedVariance;
-            
-            // Check if this is the best split so far
-            if (score > bestScore) {
+            // The partition gain is a reduction of the summed squared error
+            double score = split.gain / nodeSize;
+            if (split.found && score > bestScore) {
                 bestScore = score;
                 bestFeatureIndex = featIdx;
+                bestSplitValue = 0.0;
+                bestCategories = split.leftCategories;
+                bestMissingLeft = split.missingLeft;
+                impurityDecrease = score;
                 
-                // Use average of current and next value as split point if possible
-                if (i < featureValueIndices.size() - 1) {
-                    bestSplitValue = (featureValueIndices[i].first + featureValueIndices[i + 1].first) / 2.0;
+                leftIndices.clear();
+                rightIndices.clear();
+                for (int idx : sampleIndices) {
+                    if (CategoricalSplit::goesLeft(bestCategories, X(idx, featIdx), bestMissingLeft)) {
+                        leftIndices.push_back(idx);
+                    } else {
+                        rightIndices.push_back(idx);
+                    }
+                }
+            }
+            continue;
+        }
+        
+        // Sweep thresholds over the present values, trying missing values on both sides
+        ThresholdSplit::Result split = ThresholdSplit::findBestThreshold(
+            sampleIndices,
+            [&X, featIdx](int idx) { return X(idx, featIdx); },
+            [&y, &weights](int idx) { return weights(idx) * y(idx); },
+            [&weights](int idx) { return weights(idx); },
+            static_cast<double>(minSamplesLeaf));
+        
+        // The split gain is a reduction of the summed squared error
+        double score = split.gain / nodeSize;
+        
+        // Check if this is the best split so far
+        if (split.found && score > bestScore) {
+            bestScore = score;
+            bestFeatureIndex = featIdx;
+            bestSplitValue = split.threshold;
+            bestMissingLeft = split.missingLeft;
+            bestCategories.clear();
+            impurityDecrease = score;
+            
+            // Update the sample indices for left and right children
+            leftIndices.clear();
+            rightIndices.clear();
+            for (int idx : sampleIndices) {
+                if (ThresholdSplit::goesLeft(X(idx, featIdx), bestSplitValue, bestMissingLeft)) {
+                    leftIndices.push_back(idx);
                 } else {
-                    bestSplitValue = featureValueIndices[i].first;
+                    rightIndices.push_back(idx);
                 }
-                
-                // Calculate impurity decrease
-                impurityDecrease = nodeVariance - weightedVariance;
-                
-                // Update the sample indices for left and right children
-                leftIndices = tempLeftIndices;
-                rightIndices = tempRightIndices;
             }
         }
     }
 }
 
-double RandomForest::calculateVariance(const Eigen::VectorXd& y, const std::vector<int>& indices) const {
-    if (indices.empty()) {
-        return 0.0;
-    }
-    
-    double sum = 0.0;
+double RandomForest::calculateVariance(const Eigen::VectorXd& y, const Eigen::VectorXd& weights,
+                                       const std::vector<int>& indices) const {
+    double totalWeight = 0.0;
     for (int idx : indices) {
-        sum += y(idx);
+        totalWeight += weights(idx);
+    }
+    if (totalWeight <= 0.0) {
+        return 0.0;
     }
     
-    double mean = sum / indices.size();
+    double mean = calculateMean(y, weights, indices);
     
     double sumSquaredDiff = 0.0;
     for (int idx : indices) {
         double diff = y(idx) - mean;
-        sumSquaredDiff += diff * diff;
+        sumSquaredDiff += weights(idx) * diff * diff;
     }
     
-    return sumSquaredDiff / indices.size();
+    return sumSquaredDiff / totalWeight;
 }
 
-double RandomForest::calculateMean(const Eigen::VectorXd& y, const std::vector<int>& indices) const {
-    if (indices.empty()) {
-        return 0.0;
-    }
-    
+double RandomForest::calculateMean(const Eigen::VectorXd& y, const Eigen::VectorXd& weights,
+                                   const std::vector<int>& indices) const {
     double sum = 0.0;
+    double totalWeight = 0.0;
     for (int idx : indices) {
-        sum += y(idx);
+        sum += weights(idx) * y(idx);
+        totalWeight += weights(idx);
+    }
+    
+    return totalWeight > 0.0 ? sum / totalWeight : 0.0;
+}
+
+Eigen::VectorXd RandomForest::drawBootstrapCounts(const Eigen::VectorXd& weights) {
+    Eigen::VectorXd counts = Eigen::VectorXd::Zero(weights.size());
+    
+    // Multinomial draw as a chain of binomials, one per row
+    int remainingDraws = std::max(1, static_cast<int>(std::round(weights.sum())));
+    double remainingWeight = weights.sum();
+    for (int j = 0; j < weights.size() && remainingDraws > 0; ++j) {
+        if (weights(j) <= 0.0) {
+            continue;
+        }
+        double probability = std::min(1.0, weights(j) / remainingWeight);
+        std::binomial_distribution<int> draw(remainingDraws, probability);
+        int count = draw(rng);
+        counts(j) = count;
+        remainingDraws -= count;
+        remainingWeight -= weights(j);
     }
     
-    return sum / indices.size();
+    return counts;
 }
 
 double RandomForest::predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const {
@@ -322,8 +512,16 @@ double RandomForest::predictTree(const Eigen::VectorXd& x, const std::shared_ptr
         return node->outputValue;
     }
     
+    // Categorical nodes send the categories in the bitset to the left child
+    if (node->isCategorical) {
+        if (CategoricalSplit::goesLeft(node->categoryBitset, x(node->featureIndex), node->defaultLeft)) {
+            return predictTree(x, node->leftChild);
+        }
+        return predictTree(x, node->rightChild);
+    }
+    
     // Navigate to the appropriate child based on the feature value
-    if (x(node->featureIndex) <= node->splitValue) {
+    if (ThresholdSplit::goesLeft(x(node->featureIndex), node->splitValue, node->defaultLeft)) {
         return predictTree(x, node->leftChild);
     } else {
         return predictTree(x, node->rightChild);
@@ -345,6 +543,11 @@ int RandomForest::getNumFeaturesToConsider() const {
 }
 
 Eigen::VectorXd RandomForest::predict(const Eigen::MatrixXd& X) const {
+    return predictInBlocks(X);
+}
+
+void RandomForest::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                               Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -354,18 +557,184 @@ Eigen::VectorXd RandomForest::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
     
     // Initialize predictions vector
-    Eigen::VectorXd predictions = Eigen::VectorXd::Zero(X.rows());
+    predictions.setZero();
     
-    // Average predictions from all trees
+    // A loaded forest is scored from the mapped node arrays
+    if (!flatTrees.empty()) {
+        flatTrees.accumulate(X, 1.0, predictions);
+        predictions /= static_cast<double>(flatTrees.treeCount());
+        return;
+    }
+    
+    // Average predictions from all trees, copying each row once for all tree walks
+    Eigen::VectorXd row(nFeatures);
+    for (Eigen::Index i = 0; i < X.rows(); ++i) {
+        row = X.row(i).transpose();
+        for (const auto& tree : trees) {
+            predictions(i) += predictTree(row, tree.root);
+        }
+    }
+    
+    predictions /= static_cast<double>(trees.size());
+}
+
+template <typename T>
+double RandomForest::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    // Trees are summed in order and averaged, as in predictInto
+    double sum = 0.0;
+    if (!flatTrees.empty()) {
+        for (size_t t = 0; t < flatTrees.treeCount(); ++t) {
+            sum += flatTrees.predictTree(t, features, 1);
+        }
+        return sum / static_cast<double>(flatTrees.treeCount());
+    }
     for (const auto& tree : trees) {
-        for (int i = 0; i < X.rows(); ++i) {
-            predictions(i) += predictTree(X.row(i), tree.root);
+        sum += TreeWalk::leafValue(tree.root.get(), features);
+    }
+    return sum / static_cast<double>(trees.size());
+}
+
+double RandomForest::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double RandomForest::predictOne(const float* features) const noexcept {
+    return predictRow(features);
+}
+
+void RandomForest::setWarmStart(bool enabled) {
+    warmStart = enabled;
+}
+
+bool RandomForest::getWarmStart() const {
+    return warmStart;
+}
+
+void RandomForest::setNEstimators(int n_estimators) {
+    nEstimators = n_estimators;
+}
+
+std::unordered_map<std::string, double> RandomForest::compact(const Eigen::MatrixXd& calibrationX,
+                                                              double leafEpsilon,
+                                                              double treeTolerance) {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    bool hasCalibration = calibrationX.rows() > 0;
+    if (hasCalibration && calibrationX.cols() != nFeatures) {
+        throw std::invalid_argument("Number of features in calibration data (" + std::to_string(calibrationX.cols()) + 
+                                   ") does not match the number of features the model was trained on (" + 
+                                   std::to_string(nFeatures) + ")");
+    }
+    
+    materializeTrees();
+    std::unordered_map<std::string, double> report;
+    
+    auto countAllNodes = [this]() {
+        int total = 0;
+        for (const auto& tree : trees) {
+            total += TreeCompaction::countNodes(tree.root);
+        }
+        return total;
+    };
+    
+    report["trees_before"] = static_cast<double>(trees.size());
+    report["nodes_before"] = static_cast<double>(countAllNodes());
+    
+    // Reference predictions and latency of the uncompacted forest
+    Eigen::VectorXd reference;
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        reference = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_before"] = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    
+    // Node-level compaction of every tree
+    for (auto& tree : trees) {
+        tree.root = TreeCompaction::compactTree(tree.root, nFeatures, leafEpsilon);
+    }
+    
+    // Drop trees whose removal keeps the forest average within tolerance
+    if (hasCalibration && trees.size() > 1) {
+        int nTrees = static_cast<int>(trees.size());
+        Eigen::MatrixXd treePredictions(calibrationX.rows(), nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            for (int i = 0; i < calibrationX.rows(); ++i) {
+                treePredictions(i, t) = predictTree(calibrationX.row(i), trees[t].root);
+            }
         }
+        
+        // Try the trees closest to the ensemble average first
+        std::vector<int> order(nTrees);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<double> deviation(nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            deviation[t] = (treePredictions.col(t) - reference).cwiseAbs().maxCoeff();
+        }
+        std::sort(order.begin(), order.end(), [&deviation](int a, int b) {
+            return deviation[a] < deviation[b];
+        });
+        
+        Eigen::VectorXd sum = treePredictions.rowwise().sum();
+        int remaining = nTrees;
+        std::vector<bool> keep(nTrees, true);
+        
+        for (int t : order) {
+            if (remaining <= 1) {
+                break;
+            }
+            Eigen::VectorXd candidateSum = sum - treePredictions.col(t);
+            double change = (candidateSum / (remaining - 1) - reference).cwiseAbs().maxCoeff();
+            if (change < treeTolerance) {
+                sum = candidateSum;
+                keep[t] = false;
+                --remaining;
+            }
+        }
+        
+        std::vector<DecisionTree> keptTrees;
+        keptTrees.reserve(remaining);
+        for (int t = 0; t < nTrees; ++t) {
+            if (keep[t]) {
+                keptTrees.push_back(trees[t]);
+            }
+        }
+        trees = std::move(keptTrees);
+    }
+    
+    calculateFeatureImportance();
+    
+    report["trees_after"] = static_cast<double>(trees.size());
+    report["nodes_after"] = static_cast<double>(countAllNodes());
+    
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        Eigen::VectorXd compacted = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_after"] = std::chrono::duration<double, std::milli>(end - start).count();
+        report["max_prediction_change"] = (compacted - reference).cwiseAbs().maxCoeff();
     }
     
-    return predictions / nEstimators;
+    return report;
+}
+
+void RandomForest::setCategoricalFeatures(const std::vector<int>& featureIndices) {
+    categoricalFeatureIndices = featureIndices;
+}
+
+bool RandomForest::isCategoricalFeature(int featureIndex) const {
+    return featureIndex >= 0 && featureIndex < static_cast<int>(categoricalMask.size()) &&
+           categoricalMask[featureIndex];
 }
 
 std::string RandomForest::getName() const {
@@ -386,9 +755,9 @@ std::unordered_map<std::string, double> RandomForest::getParameters() const {
 std::unordered_map<std::string, double> RandomForest::getStatistics() const {
     std::unordered_map<std::string, double> stats;
     stats["rmse"] = rmse;
-    stats["n_samples"] = static_cast<double>(nSamples);
+    stats["n_samples"] = sampleWeightSum;
     stats["n_features"] = static_cast<double>(nFeatures);
-    stats["n_trees"] = static_cast<double>(trees.size());
+    stats["n_trees"] = static_cast<double>(getTreeCount());
     
     return stats;
 }
@@ -450,4 +819,130 @@ std::unordered_map<std::string, double> RandomForest::getFeatureImportance() con
     }
     
     return featureImportanceScores;
-} 
\ No newline at end of file
+}
+
+size_t RandomForest::getTreeCount() const {
+    return flatTrees.empty() ? trees.size() : flatTrees.treeCount();
+}
+
+std::vector<TreeInspection::NodeInfo> RandomForest::inspectTree(size_t treeIndex, int nodeId, int maxDepth) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    if (treeIndex >= getTreeCount()) {
+        throw std::out_of_range("Tree index " + std::to_string(treeIndex) + " is out of range");
+    }
+    if (!flatTrees.empty()) {
+        return TreeInspection::collect(flatTrees.buildTree<TreeNode>(treeIndex), nodeId, maxDepth);
+    }
+    return TreeInspection::collect(trees[treeIndex].root, nodeId, maxDepth);
+}
+
+void RandomForest::materializeTrees() {
+    if (flatTrees.empty()) {
+        return;
+    }
+    std::vector<DecisionTree> built(flatTrees.treeCount());
+    for (size_t t = 0; t < built.size(); ++t) {
+        built[t].root = flatTrees.buildTree<TreeNode>(t);
+        built[t].featureImportance.assign(flatTreeImportance.col(t).data(),
+                                          flatTreeImportance.col(t).data() + nFeatures);
+    }
+    trees = std::move(built);
+    flatTrees = FlatForest();
+    flatTreeImportance.resize(0, 0);
+}
+
+void RandomForest::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    writer.putValue<int32_t>("n_estimators", nEstimators);
+    writer.putValue<int32_t>("max_depth", maxDepth);
+    writer.putValue<int32_t>("min_samples_split", minSamplesSplit);
+    writer.putValue<int32_t>("min_samples_leaf", minSamplesLeaf);
+    writer.putString("max_features", maxFeatures);
+    writer.putValue<uint8_t>("bootstrap", bootstrap ? 1 : 0);
+    writer.putValue<uint8_t>("warm_start", warmStart ? 1 : 0);
+    writer.putArray("categorical_indices", std::vector<int32_t>(categoricalFeatureIndices.begin(),
+                                                                categoricalFeatureIndices.end()));
+    
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putValue<double>("sample_weight_sum", sampleWeightSum);
+    writer.putValue<double>("training_target_sum", trainingTargetSum);
+    writer.putValue<int32_t>("n_features", nFeatures);
+    writer.putValue<double>("rmse", rmse);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+    
+    std::vector<double> importance;
+    for (const auto& name : inputVariableNames) {
+        importance.push_back(featureImportanceScores.at(name));
+    }
+    writer.putArray("feature_importance", importance);
+    
+    if (!flatTrees.empty()) {
+        writer.putMatrix("trees.importance", flatTreeImportance);
+        flatTrees.write(writer);
+        return;
+    }
+    Eigen::MatrixXd treeImportance(nFeatures, static_cast<Eigen::Index>(trees.size()));
+    std::vector<std::shared_ptr<TreeNode>> roots;
+    for (size_t t = 0; t < trees.size(); ++t) {
+        treeImportance.col(t) = Eigen::Map<const Eigen::VectorXd>(trees[t].featureImportance.data(), nFeatures);
+        roots.push_back(trees[t].root);
+    }
+    writer.putMatrix("trees.importance", treeImportance);
+    FlatForest::fromTrees(roots).write(writer);
+}
+
+void RandomForest::readModel(const ModelFile::Reader& reader) {
+    int features = reader.value<int32_t>("n_features");
+    std::vector<std::string> names = reader.strings("variable_names");
+    auto importance = reader.array<double>("feature_importance");
+    auto categorical = reader.array<int32_t>("categorical_indices");
+    Eigen::MatrixXd treeImportance = reader.matrix("trees.importance");
+    FlatForest forest = FlatForest::fromFile(reader, features);
+    if (forest.empty() || names.size() != static_cast<size_t>(features) ||
+        importance.size != static_cast<size_t>(features) || treeImportance.rows() != features ||
+        static_cast<size_t>(treeImportance.cols()) != forest.treeCount()) {
+        throw std::runtime_error("Random Forest model file sizes do not match");
+    }
+    
+    nEstimators = reader.value<int32_t>("n_estimators");
+    maxDepth = reader.value<int32_t>("max_depth");
+    minSamplesSplit = reader.value<int32_t>("min_samples_split");
+    minSamplesLeaf = reader.value<int32_t>("min_samples_leaf");
+    maxFeatures = reader.string("max_features");
+    bootstrap = reader.value<uint8_t>("bootstrap") != 0;
+    warmStart = reader.value<uint8_t>("warm_start") != 0;
+    
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    sampleWeightSum = reader.value<double>("sample_weight_sum");
+    // Files written before the checksum was stored never warm start
+    trainingTargetSum = reader.has("training_target_sum") ? reader.value<double>("training_target_sum")
+                                                          : std::numeric_limits<double>::quiet_NaN();
+    nFeatures = features;
+    rmse = reader.value<double>("rmse");
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    
+    featureImportanceScores.clear();
+    for (int i = 0; i < nFeatures; ++i) {
+        featureImportanceScores[inputVariableNames[i]] = importance[i];
+    }
+    
+    categoricalFeatureIndices.assign(categorical.begin(), categorical.end());
+    categoricalMask.assign(nFeatures, false);
+    for (int idx : categoricalFeatureIndices) {
+        if (idx >= 0 && idx < nFeatures) {
+            categoricalMask[idx] = true;
+        }
+    }
+    
+    trees.clear();
+    flatTrees = forest;
+    flatTreeImportance = treeImportance;
+    isFitted = true;
+}
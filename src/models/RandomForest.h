@@ -1,8 +1,11 @@
 #pragma once
 
 #include "models/Model.h"
+#include "models/FlatForest.h"
+#include "data/BinnedMatrix.h"
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <random>
 
 /**
@@ -38,11 +41,31 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
      * @return bool True if fitting was successful, false otherwise
      */
     bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             const std::vector<std::string>& variableNames = {},
-            const std::string& targetName = "") override;
+            const std::string& targetName = "",
+            const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) override;
+
+    /**
+     * @brief Fit the Random Forest model to binned data
+     * 
+     * Trees are grown from per-bin gradient histograms, so the raw feature
+     * matrix never needs to be in memory. Split thresholds are the bin cut
+     * values, and the fitted model predicts on raw data as usual. Categorical
+     * feature settings and warm start are not used on this path.
+     * 
+     * @param data Binned input features
+     * @param y Target variable (response variable)
+     * @param variableNames Names of the input variables (defaults to the binned feature names)
+     * @param targetName Name of the target variable
+     * @return bool True if fitting was successful, false otherwise
+     */
+    bool fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                  const std::vector<std::string>& variableNames = {},
+                  const std::string& targetName = "");
 
     /**
      * @brief Make predictions using the fitted Random Forest model
@@ -52,6 +75,24 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::MatrixXd& X) const override;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * @param X Input features for prediction, read in place
+     * @param predictions Output span with one element per row of X
+     */
+    void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                     Eigen::Ref<Eigen::VectorXd> predictions) const override;
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * @param features First of the row's feature values, in training column order
+     * @return double Predicted value
+     */
+    double predictOne(const double* features) const noexcept override;
+    double predictOne(const float* features) const noexcept override;
+
     /**
      * @brief Get the name of the model
      * 
@@ -104,6 +145,81 @@ public:
      */
     std::unordered_map<std::string, double> getFeatureImportance() const override;
 
+    /**
+     * @brief Get the number of trees in the fitted model
+     * 
+     * @return size_t Number of trees
+     */
+    size_t getTreeCount() const override;
+
+    /**
+     * @brief Inspect the nodes of one fitted tree
+     * 
+     * @param treeIndex Index of the tree, below getTreeCount()
+     * @param nodeId Preorder id of the subtree root (0 for the whole tree)
+     * @param maxDepth Levels below the subtree root to include (-1 for all)
+     * @return std::vector<TreeInspection::NodeInfo> Nodes of the subtree
+     */
+    std::vector<TreeInspection::NodeInfo> inspectTree(size_t treeIndex, int nodeId = 0,
+                                                      int maxDepth = -1) const override;
+
+    /**
+     * @brief Enable or disable warm-start training
+     * 
+     * When enabled and the model is already fitted on the same data (same
+     * shape, sample weight total and target checksum), the next call to fit()
+     * keeps the existing trees and only grows the forest up to the configured
+     * number of estimators.
+     * 
+     * @param enabled Whether to reuse the existing trees on the next fit
+     */
+    void setWarmStart(bool enabled);
+
+    /**
+     * @brief Check whether warm-start training is enabled
+     * 
+     * @return bool True if warm start is enabled
+     */
+    bool getWarmStart() const;
+
+    /**
+     * @brief Set the number of trees in the forest
+     * 
+     * @param n_estimators Number of trees to train
+     */
+    void setNEstimators(int n_estimators);
+
+    /**
+     * @brief Mark input features as categorical
+     * 
+     * Categorical features hold non-negative integer category codes. The trees split
+     * them by category membership instead of by threshold, so they do not need to be
+     * one-hot encoded.
+     * 
+     * @param featureIndices Column indices of the categorical features
+     */
+    void setCategoricalFeatures(const std::vector<int>& featureIndices);
+
+    /**
+     * @brief Compact the fitted forest for faster inference
+     * 
+     * Removes splits already decided by an ancestor, merges leaves whose outputs
+     * differ by at most leafEpsilon, collapses identical subtrees and drops trees
+     * whose removal changes every calibration prediction by less than treeTolerance.
+     * 
+     * @param calibrationX Calibration inputs used to validate tree removal (may be empty)
+     * @param leafEpsilon Tolerance for merging leaf values
+     * @param treeTolerance Maximum allowed change of any calibration prediction
+     * @return std::unordered_map<std::string, double> Model size and predict latency before and after
+     */
+    std::unordered_map<std::string, double> compact(const Eigen::MatrixXd& calibrationX,
+                                                    double leafEpsilon = 1e-6,
+                                                    double treeTolerance = 1e-4);
+
+protected:
+    void writeModel(ModelFile::Writer& writer) const override;
+    void readModel(const ModelFile::Reader& reader) override;
+
 private:
     // Model hyperparameters
     int nEstimators;
@@ -112,13 +228,18 @@ private:
     int minSamplesLeaf;
     std::string maxFeatures;
     bool bootstrap;
+    bool warmStart;
     
     // Model state
     bool isFitted;
     int nSamples;
+    double sampleWeightSum;
     int nFeatures;
     double rmse;
     
+    // Target checksum kept for warm start
+    double trainingTargetSum;
+    
     // Variable names storage
     std::vector<std::string> inputVariableNames;
     std::string targetVariableName;
@@ -126,6 +247,10 @@ private:
     // Feature importance scores
     std::unordered_map<std::string, double> featureImportanceScores;
     
+    // Categorical feature indices and the per-feature mask derived from them
+    std::vector<int> categoricalFeatureIndices;
+    std::vector<bool> categoricalMask;
+    
     // Random number generator
     std::mt19937 rng;
     
@@ -138,16 +263,22 @@ private:
         double outputValue;
         std::shared_ptr<TreeNode> leftChild;
         std::shared_ptr<TreeNode> rightChild;
+        bool isCategorical;
+        std::vector<uint64_t> categoryBitset;
+        bool defaultLeft;  // Direction taken by samples with a missing feature value
         double impurityDecrease;
+        double cover;  // Sample weight reaching the node
+        double gain;   // Reduction of the weighted squared error by the split
         
         TreeNode() : isLeaf(true), featureIndex(-1), splitValue(0.0), outputValue(0.0),
-                   leftChild(nullptr), rightChild(nullptr), impurityDecrease(0.0) {}
+                   leftChild(nullptr), rightChild(nullptr), isCategorical(false), defaultLeft(false), impurityDecrease(0.0),
+                   cover(0.0), gain(0.0) {}
     };
     
     class DecisionTree {
     public:
         std::shared_ptr<TreeNode> root;
-        std::vector<int> featureImportance;
+        std::vector<double> featureImportance;
         
         DecisionTree() : root(std::make_shared<TreeNode>()) {
         }
@@ -155,11 +286,24 @@ private:
     
     std::vector<DecisionTree> trees;
     
+    // Trees of a loaded model and their per-tree importances (one column per tree),
+    // scored from the model file until the forest is trained further
+    FlatForest flatTrees;
+    Eigen::MatrixXd flatTreeImportance;
+    
+    /**
+     * @brief Rebuild the trees of a loaded model as nodes
+     * 
+     * Does nothing unless the model was loaded and not modified since.
+     */
+    void materializeTrees();
+    
     /**
      * @brief Build a decision tree
      * 
      * @param X Input features
      * @param y Target values
+     * @param weights Per-row weights for this tree (bootstrap counts times sample weights)
      * @param sampleIndices Indices of samples to use for this tree
      * @param depth Current depth
      * @param tree Reference to the tree being built
@@ -167,6 +311,7 @@ private:
      */
     std::shared_ptr<TreeNode> buildTree(const Eigen::MatrixXd& X, 
                                       const Eigen::VectorXd& y,
+                                      const Eigen::VectorXd& weights,
                                       const std::vector<int>& sampleIndices,
                                       int depth,
                                       DecisionTree& tree);
@@ -176,6 +321,7 @@ private:
      * 
      * @param X Input features
      * @param y Target values
+     * @param weights Per-row weights
      * @param sampleIndices Indices of samples to use
      * @param featureIndices Indices of features to consider
      * @param bestFeatureIndex Best feature index (output)
@@ -184,9 +330,12 @@ private:
      * @param impurityDecrease Decrease in impurity (output)
      * @param leftIndices Left child sample indices (output)
      * @param rightIndices Right child sample indices (output)
+     * @param bestCategories Left-child category set if the best split is categorical (output)
+     * @param bestMissingLeft Whether samples with a missing value go left (output)
      */
     void findBestSplit(const Eigen::MatrixXd& X,
                      const Eigen::VectorXd& y,
+                     const Eigen::VectorXd& weights,
                      const std::vector<int>& sampleIndices,
                      const std::vector<int>& featureIndices,
                      int& bestFeatureIndex,
@@ -194,25 +343,52 @@ private:
                      double& bestScore,
                      double& impurityDecrease,
                      std::vector<int>& leftIndices,
-                     std::vector<int>& rightIndices);
+                     std::vector<int>& rightIndices,
+                     std::vector<uint64_t>& bestCategories,
+                     bool& bestMissingLeft);
     
     /**
-     * @brief Calculate the variance (impurity measure for regression)
+     * @brief Calculate the weighted variance (impurity measure for regression)
      * 
      * @param y Target values
+     * @param weights Per-row weights
      * @param indices Sample indices
      * @return double Variance
      */
-    double calculateVariance(const Eigen::VectorXd& y, const std::vector<int>& indices) const;
+    double calculateVariance(const Eigen::VectorXd& y, const Eigen::VectorXd& weights,
+                             const std::vector<int>& indices) const;
     
     /**
-     * @brief Calculate the mean of target values for a set of samples
+     * @brief Calculate the weighted mean of target values for a set of samples
      * 
      * @param y Target values
+     * @param weights Per-row weights
      * @param indices Sample indices
      * @return double Mean value
      */
-    double calculateMean(const Eigen::VectorXd& y, const std::vector<int>& indices) const;
+    double calculateMean(const Eigen::VectorXd& y, const Eigen::VectorXd& weights,
+                         const std::vector<int>& indices) const;
+    
+    /**
+     * @brief Draw bootstrap counts for one tree
+     * 
+     * Draws round(sum of weights) rows with replacement, each row with
+     * probability proportional to its weight, as one multinomial sample.
+     * With unit weights this is the usual bootstrap of nSamples rows, but
+     * the tree only visits each drawn row once, with its count as weight.
+     * 
+     * @param weights Sample weights
+     * @return Eigen::VectorXd Number of times each row was drawn
+     */
+    Eigen::VectorXd drawBootstrapCounts(const Eigen::VectorXd& weights);
+    
+    /**
+     * @brief Check whether a feature was marked as categorical
+     * 
+     * @param featureIndex Feature index
+     * @return bool True if the feature is categorical
+     */
+    bool isCategoricalFeature(int featureIndex) const;
     
     /**
      * @brief Predict using a single tree
@@ -223,6 +399,15 @@ private:
      */
     double predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const;
     
+    /**
+     * @brief Body of both predictOne overloads: all trees for one row
+     * 
+     * @param features First of the row's feature values
+     * @return double Prediction value
+     */
+    template <typename T>
+    double predictRow(const T* features) const noexcept;
+    
     /**
      * @brief Get the number of features to consider at each split
      * 
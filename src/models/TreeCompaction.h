@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+
+/**
+ * @brief Node-level compaction passes shared by the tree ensembles
+ *
+ * The helpers work on any node type exposing isLeaf, featureIndex, splitValue,
+ * outputValue, leftChild, rightChild, isCategorical, categoryBitset and
+ * defaultLeft (RandomForest, GradientBoosting and XGBoost all use this layout for their
+ * tree nodes).
+ */
+namespace TreeCompaction {
+
+/**
+ * @brief Count the nodes in a subtree
+ *
+ * @param node Root of the subtree
+ * @return int Number of nodes
+ */
+template <typename NodePtr>
+int countNodes(const NodePtr& node) {
+    if (!node) {
+        return 0;
+    }
+    if (node->isLeaf) {
+        return 1;
+    }
+    return 1 + countNodes(node->leftChild) + countNodes(node->rightChild);
+}
+
+/**
+ * @brief Check whether two subtrees make the same predictions
+ *
+ * Subtrees are equal when they have the same split structure and their leaf
+ * values differ by at most epsilon.
+ *
+ * @param a First subtree
+ * @param b Second subtree
+ * @param epsilon Tolerance for leaf values
+ * @return bool True if the subtrees are equivalent
+ */
+template <typename NodePtr>
+bool subtreesEqual(const NodePtr& a, const NodePtr& b, double epsilon) {
+    if (!a || !b) {
+        return !a && !b;
+    }
+    if (a->isLeaf != b->isLeaf) {
+        return false;
+    }
+    if (a->isLeaf) {
+        return std::abs(a->outputValue - b->outputValue) <= epsilon;
+    }
+    return a->featureIndex == b->featureIndex &&
+           a->splitValue == b->splitValue &&
+           a->isCategorical == b->isCategorical &&
+           a->categoryBitset == b->categoryBitset &&
+           a->defaultLeft == b->defaultLeft &&
+           subtreesEqual(a->leftChild, b->leftChild, epsilon) &&
+           subtreesEqual(a->rightChild, b->rightChild, epsilon);
+}
+
+/**
+ * @brief Compact a subtree in place
+ *
+ * Removes splits that are already decided by an ancestor split on the same
+ * feature, merges sibling leaves whose outputs differ by at most epsilon and
+ * collapses nodes whose two subtrees are equivalent.
+ *
+ * @param node Root of the subtree
+ * @param lower Per-feature lower bound (exclusive) implied by the path to node
+ * @param upper Per-feature upper bound (inclusive) implied by the path to node
+ * @param epsilon Tolerance for merging leaf values
+ * @return NodePtr The (possibly replaced) root of the compacted subtree
+ */
+template <typename NodePtr>
+NodePtr compactSubtree(NodePtr node, std::vector<double>& lower, std::vector<double>& upper,
+                       double epsilon) {
+    if (!node || node->isLeaf) {
+        return node;
+    }
+
+    // Categorical splits carry no threshold bounds; only compact their children
+    if (node->isCategorical) {
+        node->leftChild = compactSubtree(node->leftChild, lower, upper, epsilon);
+        node->rightChild = compactSubtree(node->rightChild, lower, upper, epsilon);
+    } else {
+        int feature = node->featureIndex;
+        double threshold = node->splitValue;
+
+        // Every sample reaching this node already goes the same way. The bounds
+        // say nothing about missing values, so the default direction must agree.
+        if (upper[feature] <= threshold && node->defaultLeft) {
+            return compactSubtree(node->leftChild, lower, upper, epsilon);
+        }
+        if (lower[feature] >= threshold && !node->defaultLeft) {
+            return compactSubtree(node->rightChild, lower, upper, epsilon);
+        }
+
+        // Left branch: x <= threshold
+        double savedUpper = upper[feature];
+        upper[feature] = threshold;
+        node->leftChild = compactSubtree(node->leftChild, lower, upper, epsilon);
+        upper[feature] = savedUpper;
+
+        // Right branch: x > threshold
+        double savedLower = lower[feature];
+        lower[feature] = threshold;
+        node->rightChild = compactSubtree(node->rightChild, lower, upper, epsilon);
+        lower[feature] = savedLower;
+    }
+
+    // Merge sibling leaves with nearly identical outputs
+    if (node->leftChild->isLeaf && node->rightChild->isLeaf &&
+        std::abs(node->leftChild->outputValue - node->rightChild->outputValue) <= epsilon) {
+        node->outputValue = 0.5 * (node->leftChild->outputValue + node->rightChild->outputValue);
+        node->isLeaf = true;
+        node->isCategorical = false;
+        node->categoryBitset.clear();
+        node->defaultLeft = false;
+        node->featureIndex = -1;
+        node->gain = 0.0;
+        node->leftChild = nullptr;
+        node->rightChild = nullptr;
+        return node;
+    }
+
+    // Both branches predict the same thing, so the split is dead weight
+    if (subtreesEqual(node->leftChild, node->rightChild, epsilon)) {
+        return node->leftChild;
+    }
+
+    return node;
+}
+
+/**
+ * @brief Compact a whole tree in place
+ *
+ * @param root Root of the tree
+ * @param nFeatures Number of input features
+ * @param epsilon Tolerance for merging leaf values
+ * @return NodePtr The new root of the tree
+ */
+template <typename NodePtr>
+NodePtr compactTree(NodePtr root, int nFeatures, double epsilon) {
+    std::vector<double> lower(nFeatures, -std::numeric_limits<double>::infinity());
+    std::vector<double> upper(nFeatures, std::numeric_limits<double>::infinity());
+    return compactSubtree(root, lower, upper, epsilon);
+}
+
+} // namespace TreeCompaction
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "models/TreeCompaction.h"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+/**
+ * @brief Read-only views of fitted trees for summaries and visualization
+ *
+ * Nodes are identified by their preorder index within the tree (the root is
+ * 0, its left child 1). Ids stay valid until the model is refitted or
+ * compacted, so a viewer can fetch the top levels of a tree first and page
+ * in the subtree below a collapsed node later by passing that node's id.
+ * The templates work on any node type exposing isLeaf, featureIndex,
+ * splitValue, outputValue, leftChild, rightChild, isCategorical,
+ * categoryBitset, defaultLeft, cover and gain.
+ */
+namespace TreeInspection {
+
+/**
+ * @brief Flat description of one tree node
+ */
+struct NodeInfo {
+    int id = 0;                 // Preorder index within the tree
+    int parentId = -1;          // -1 for the root
+    int depth = 0;              // Depth below the tree root
+    bool isLeaf = true;
+    int featureIndex = -1;      // -1 for leaves
+    double splitValue = 0.0;
+    bool isCategorical = false;
+    std::vector<uint64_t> categoryBitset;
+    bool defaultLeft = false;   // Direction of missing values
+    double value = 0.0;         // Node output
+    double cover = 0.0;         // Sample weight (hessian for XGBoost) reaching the node
+    double gain = 0.0;          // Loss reduction of the split, 0 for leaves
+    int leftId = -1;            // -1 for leaves
+    int rightId = -1;
+    int subtreeSize = 1;        // Nodes in the subtree rooted here
+    bool expanded = true;       // Whether the children are part of the result
+};
+
+/**
+ * @brief Append a subtree in preorder, returning its node count
+ */
+template <typename NodePtr>
+int collectSubtree(const NodePtr& node, int id, int parentId, int depth, int lastDepth,
+                   std::vector<NodeInfo>& nodes) {
+    bool include = lastDepth < 0 || depth <= lastDepth;
+    size_t position = nodes.size();
+    if (include) {
+        NodeInfo info;
+        info.id = id;
+        info.parentId = parentId;
+        info.depth = depth;
+        info.isLeaf = node->isLeaf;
+        info.value = node->outputValue;
+        info.cover = node->cover;
+        if (!node->isLeaf) {
+            info.featureIndex = node->featureIndex;
+            info.splitValue = node->splitValue;
+            info.isCategorical = node->isCategorical;
+            info.categoryBitset = node->categoryBitset;
+            info.defaultLeft = node->defaultLeft;
+            info.gain = node->gain;
+            info.expanded = lastDepth < 0 || depth < lastDepth;
+        }
+        nodes.push_back(info);
+    }
+    if (node->isLeaf) {
+        return 1;
+    }
+
+    // Nodes below the page are still walked to number their siblings
+    int leftSize = collectSubtree(node->leftChild, id + 1, id, depth + 1, lastDepth, nodes);
+    int rightId = id + 1 + leftSize;
+    int rightSize = collectSubtree(node->rightChild, rightId, id, depth + 1, lastDepth, nodes);
+    if (include) {
+        nodes[position].leftId = id + 1;
+        nodes[position].rightId = rightId;
+        nodes[position].subtreeSize = 1 + leftSize + rightSize;
+    }
+    return 1 + leftSize + rightSize;
+}
+
+/**
+ * @brief Describe a subtree of a tree
+ *
+ * @param root Root of the tree
+ * @param nodeId Id of the subtree root
+ * @param maxDepth Levels below the subtree root to include (-1 for all)
+ * @return std::vector<NodeInfo> Nodes of the subtree in preorder
+ * @throws std::out_of_range If nodeId is not a node of the tree
+ */
+template <typename NodePtr>
+std::vector<NodeInfo> collect(const NodePtr& root, int nodeId = 0, int maxDepth = -1) {
+    // Walk down to the requested node using the preorder numbering
+    NodePtr node = root;
+    int id = 0;
+    int parentId = -1;
+    int depth = 0;
+    while (node && id != nodeId) {
+        if (node->isLeaf || nodeId < id) {
+            node = nullptr;
+            break;
+        }
+        int leftSize = TreeCompaction::countNodes(node->leftChild);
+        parentId = id;
+        if (nodeId <= id + leftSize) {
+            node = node->leftChild;
+            id = id + 1;
+        } else {
+            node = node->rightChild;
+            id = id + 1 + leftSize;
+        }
+        ++depth;
+    }
+    if (!node) {
+        throw std::out_of_range("Node id " + std::to_string(nodeId) + " is not in the tree");
+    }
+
+    std::vector<NodeInfo> nodes;
+    collectSubtree(node, id, parentId, depth, maxDepth < 0 ? -1 : depth + maxDepth, nodes);
+    return nodes;
+}
+
+/**
+ * @brief Count the nodes at each depth
+ *
+ * @param nodes Nodes of a tree
+ * @return std::vector<int> Entry d is the number of nodes at depth d
+ */
+inline std::vector<int> depthHistogram(const std::vector<NodeInfo>& nodes) {
+    std::vector<int> histogram;
+    for (const auto& node : nodes) {
+        if (node.depth >= static_cast<int>(histogram.size())) {
+            histogram.resize(node.depth + 1, 0);
+        }
+        ++histogram[node.depth];
+    }
+    return histogram;
+}
+
+/**
+ * @brief Summarize a tree
+ *
+ * @param nodes Nodes of a tree
+ * @return std::unordered_map<std::string, double> Node, leaf and split counts, depth and total gain
+ */
+inline std::unordered_map<std::string, double> summarize(const std::vector<NodeInfo>& nodes) {
+    std::unordered_map<std::string, double> summary;
+    double leaves = 0.0;
+    double totalGain = 0.0;
+    int maxDepth = 0;
+    for (const auto& node : nodes) {
+        if (node.isLeaf) {
+            leaves += 1.0;
+        }
+        totalGain += node.gain;
+        maxDepth = std::max(maxDepth, node.depth);
+    }
+    summary["n_nodes"] = static_cast<double>(nodes.size());
+    summary["n_leaves"] = leaves;
+    summary["n_splits"] = static_cast<double>(nodes.size()) - leaves;
+    summary["depth"] = static_cast<double>(maxDepth);
+    summary["total_gain"] = totalGain;
+    summary["cover"] = nodes.empty() ? 0.0 : nodes.front().cover;
+    return summary;
+}
+
+/**
+ * @brief Write nodes as one JSON page
+ *
+ * The page is {"tree": t, "nodes": [...]}. Every node carries its id, parent,
+ * depth, cover and value; splits add the feature, threshold (or category
+ * codes), missing-value direction, gain, child ids and "expanded", which is
+ * false when the children are not in the page.
+ *
+ * @param nodes Nodes to write, as returned by collect
+ * @param featureNames Names of the input features
+ * @param treeIndex Index of the tree in the ensemble
+ * @return std::string JSON text
+ */
+inline std::string toJSON(const std::vector<NodeInfo>& nodes,
+                          const std::vector<std::string>& featureNames, int treeIndex) {
+    auto escape = [](const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            if (static_cast<unsigned char>(c) >= 0x20) {
+                result += c;
+            }
+        }
+        return result;
+    };
+    auto number = [](double value) {
+        if (!std::isfinite(value)) {
+            return std::string("null");
+        }
+        std::ostringstream out;
+        out << std::setprecision(10) << value;
+        return out.str();
+    };
+
+    std::ostringstream json;
+    json << "{\"tree\":" << treeIndex << ",\"nodes\":[";
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const NodeInfo& node = nodes[i];
+        if (i > 0) {
+            json << ",";
+        }
+        json << "{\"id\":" << node.id << ",\"parent\":" << node.parentId
+             << ",\"depth\":" << node.depth << ",\"leaf\":" << (node.isLeaf ? "true" : "false")
+             << ",\"cover\":" << number(node.cover) << ",\"value\":" << number(node.value);
+        if (!node.isLeaf) {
+            std::string name = node.featureIndex >= 0 && node.featureIndex < static_cast<int>(featureNames.size())
+                               ? featureNames[node.featureIndex]
+                               : "Variable_" + std::to_string(node.featureIndex + 1);
+            json << ",\"feature\":\"" << escape(name) << "\"";
+            if (node.isCategorical) {
+                json << ",\"categories\":[";
+                bool first = true;
+                for (size_t w = 0; w < node.categoryBitset.size(); ++w) {
+                    for (int b = 0; b < 64; ++b) {
+                        if (node.categoryBitset[w] & (uint64_t(1) << b)) {
+                            json << (first ? "" : ",") << (w * 64 + b);
+                            first = false;
+                        }
+                    }
+                }
+                json << "]";
+            } else {
+                json << ",\"threshold\":" << number(node.splitValue);
+            }
+            json << ",\"missing_left\":" << (node.defaultLeft ? "true" : "false")
+                 << ",\"gain\":" << number(node.gain)
+                 << ",\"left\":" << node.leftId << ",\"right\":" << node.rightId
+                 << ",\"size\":" << node.subtreeSize
+                 << ",\"expanded\":" << (node.expanded ? "true" : "false");
+        }
+        json << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+/**
+ * @brief Write nodes as packed little-endian records
+ *
+ * Layout: uint32 node count, then per node int32 id, parent, left, right,
+ * feature and depth, uint8 flags (1 leaf, 2 categorical, 4 missing left,
+ * 8 expanded) and double threshold, value, cover and gain (57 bytes).
+ * Category sets are not included; use toJSON for categorical splits.
+ *
+ * @param nodes Nodes to write, as returned by collect
+ * @return std::vector<char> Encoded nodes
+ */
+inline std::vector<char> toBinary(const std::vector<NodeInfo>& nodes) {
+    const size_t recordSize = 6 * sizeof(int32_t) + 1 + 4 * sizeof(double);
+    std::vector<char> buffer(sizeof(uint32_t) + nodes.size() * recordSize);
+    char* out = buffer.data();
+    auto put = [&out](const void* value, size_t size) {
+        std::memcpy(out, value, size);
+        out += size;
+    };
+
+    uint32_t count = static_cast<uint32_t>(nodes.size());
+    put(&count, sizeof(count));
+    for (const auto& node : nodes) {
+        int32_t ints[6] = {node.id, node.parentId, node.leftId, node.rightId, node.featureIndex, node.depth};
+        put(ints, sizeof(ints));
+        uint8_t flags = (node.isLeaf ? 1 : 0) | (node.isCategorical ? 2 : 0) |
+                        (node.defaultLeft ? 4 : 0) | (node.expanded ? 8 : 0);
+        put(&flags, 1);
+        double values[4] = {node.splitValue, node.value, node.cover, node.gain};
+        put(values, sizeof(values));
+    }
+    return buffer;
+}
+
+} // namespace TreeInspection
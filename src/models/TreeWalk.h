@@ -0,0 +1,39 @@
+#pragma once
+
+#include "models/CategoricalSplit.h"
+#include "models/ThresholdSplit.h"
+
+/**
+ * @brief Walk of a node tree for a single row, for Model::predictOne
+ *
+ * Follows raw child pointers in a loop, so a walk neither allocates nor
+ * touches reference counts, and reads the row through a plain pointer in
+ * either precision. The template works on any node type exposing isLeaf,
+ * featureIndex, splitValue, outputValue, leftChild, rightChild,
+ * isCategorical, categoryBitset and defaultLeft.
+ */
+namespace TreeWalk {
+
+/**
+ * @brief Output of the leaf a row reaches
+ *
+ * Rows go left and right exactly as in the models' recursive predictTree,
+ * and a missing node predicts 0 as it does there.
+ *
+ * @param node Root of the tree
+ * @param x First feature of the row, in the model's column order
+ * @return double Output value of the leaf
+ */
+template <typename Node, typename T>
+double leafValue(const Node* node, const T* x) noexcept {
+    while (node && !node->isLeaf) {
+        double value = static_cast<double>(x[node->featureIndex]);
+        bool left = node->isCategorical
+                        ? CategoricalSplit::goesLeft(node->categoryBitset, value, node->defaultLeft)
+                        : ThresholdSplit::goesLeft(value, node->splitValue, node->defaultLeft);
+        node = left ? node->leftChild.get() : node->rightChild.get();
+    }
+    return node ? node->outputValue : 0.0;
+}
+
+} // namespace TreeWalk
@@ -1,14 +1,30 @@
 #include "models/XGBoost.h"
+#include "models/TreeCompaction.h"
+#include "models/CategoricalSplit.h"
+#include "models/ThresholdSplit.h"
+#include "models/HistogramTree.h"
+#include "models/ModelFile.h"
+#include "models/TreeWalk.h"
+#include "utils/BinaryBuffer.h"
+#include <cassert>
 #include <cmath>
+#include <chrono>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <random>
+#include <numeric>
+#include <sstream>
 #include <unordered_set>
+#include <stdexcept>
 
 XGBoost::XGBoost()
     : learningRate(0.1), maxDepth(6), nEstimators(100), 
-      subsample(1.0), colsampleBytree(1.0), minChildWeight(1), gamma(0.0),
-      isFitted(false), nSamples(0), nFeatures(0), rmse(0.0), initialPrediction(0.0) {
+      subsample(1.0), colsampleBytree(1.0), minChildWeight(1), gamma(0.0), lambda(1.0), alpha(0.0),
+      objective("squared_error"), huberSlope(1.0), tweedieVariancePower(1.5), warmStart(false),
+      numWorkers(1), isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0), trainingTargetSum(0.0),
+      randomSeed(-1), rng(std::random_device()()), checkpointInterval(10), resumePending(false),
+      initialPrediction(0.0), objectiveFunction(std::make_shared<SquaredErrorObjective>()) {
 }
 
 XGBoost::XGBoost(double learning_rate, int max_depth, int n_estimators,
@@ -16,13 +32,30 @@ XGBoost::XGBoost(double learning_rate, int max_depth, int n_estimators,
                 int min_child_weight, double gamma)
     : learningRate(learning_rate), maxDepth(max_depth), nEstimators(n_estimators),
       subsample(subsample), colsampleBytree(colsample_bytree), 
-      minChildWeight(min_child_weight), gamma(gamma),
-      isFitted(false), nSamples(0), nFeatures(0), rmse(0.0), initialPrediction(0.0) {
+      minChildWeight(min_child_weight), gamma(gamma), lambda(1.0), alpha(0.0),
+      objective("squared_error"), huberSlope(1.0), tweedieVariancePower(1.5), warmStart(false),
+      numWorkers(1), isFitted(false), nSamples(0), sampleWeightSum(0.0), nFeatures(0), rmse(0.0), trainingTargetSum(0.0),
+      randomSeed(-1), rng(std::random_device()()), checkpointInterval(10), resumePending(false),
+      initialPrediction(0.0), objectiveFunction(std::make_shared<SquaredErrorObjective>()) {
 }
 
 bool XGBoost::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                  const std::vector<std::string>& variableNames,
-                 const std::string& targetName) {
+                 const std::string& targetName,
+                 const Eigen::VectorXd& sampleWeights) {
+    materializeTrees();
+    
+    if (numWorkers > 1) {
+        if (!checkpointPath.empty() || resumePending) {
+            std::cerr << "Warning: Checkpoints are not used in distributed training." << std::endl;
+            resumePending = false;
+        }
+        if (!categoricalFeatureIndices.empty()) {
+            std::cerr << "Warning: Categorical features are split as numeric in distributed training." << std::endl;
+        }
+        return fitDistributed(X, y, numWorkers, variableNames, targetName, sampleWeights);
+    }
+    
     try {
         // Check dimensions
         if (X.rows() != y.rows()) {
@@ -31,12 +64,43 @@ bool XGBoost::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             return false;
         }
         
+        // Missing feature values are handled by the splits, a missing target is not
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        Eigen::VectorXd weights;
+        if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+            return false;
+        }
+        
+        // Resolve the objective and check the target lies in its domain
+        std::shared_ptr<BoostingObjective> newObjective =
+            BoostingObjective::create(objective, huberSlope, tweedieVariancePower);
+        newObjective->checkTarget(y);
+        
+        // Warm start resumes from the stored training predictions, which are
+        // only valid for the exact data the existing trees were fitted on.
+        // A loaded checkpoint resumes the same way
+        bool continuing = warmStart || resumePending;
+        bool resume = continuing && isFitted &&
+                      X.rows() == nSamples && X.cols() == nFeatures &&
+                      trainingPredictions.size() == y.size() &&
+                      y.sum() == trainingTargetSum &&
+                      weights.sum() == sampleWeightSum &&
+                      objectiveFunction->getName() == newObjective->getName() &&
+                      static_cast<int>(trees.size()) <= nEstimators;
+        if (continuing && isFitted && !resume) {
+            std::cerr << "Warning: Warm start not possible (training data, objective or tree count changed). "
+                      << "Retraining XGBoost from scratch." << std::endl;
+        }
+        resumePending = false;
+        
         nSamples = X.rows();
+        sampleWeightSum = weights.sum();
         nFeatures = X.cols();
-        
-        // Initialize random number generator
-        std::random_device rd;
-        std::mt19937 generator(rd());
+        objectiveFunction = newObjective;
         
         // Store variable names
         if (variableNames.size() == 0) {
@@ -63,22 +127,49 @@ bool XGBoost::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
         // Store target variable name
         targetVariableName = targetName.empty() ? "Target" : targetName;
         
-        // Clear existing trees
-        trees.clear();
-        
-        // Initialize with the mean of the target variable
-        initialPrediction = y.mean();
+        // Mark categorical features
+        categoricalMask.assign(nFeatures, false);
+        for (int idx : categoricalFeatureIndices) {
+            if (idx >= 0 && idx < nFeatures) {
+                categoricalMask[idx] = true;
+            }
+        }
         
         // Current predictions
-        Eigen::VectorXd F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        Eigen::VectorXd F;
         
-        // Boosting iterations
-        for (int iter = 0; iter < nEstimators; ++iter) {
-            // Calculate gradients (for squared error loss, gradient = prediction - target)
-            Eigen::VectorXd gradients = F - y;
+        if (resume) {
+            // Keep the existing trees and continue from their predictions
+            F = trainingPredictions;
+        } else {
+            // Clear existing trees
+            trees.clear();
+            if (randomSeed >= 0) {
+                rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+            }
             
-            // For squared error loss, hessian is constant = 1 for all samples
-            Eigen::VectorXd hessians = Eigen::VectorXd::Ones(nSamples);
+            // Start from the constant margin that minimizes the loss
+            initialPrediction = objectiveFunction->initialMargin(y, weights);
+            F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        }
+        
+        // Snapshots are written on the writer's thread while boosting goes on
+        double targetSum = y.sum();
+        std::unique_ptr<CheckpointWriter> checkpointWriter;
+        if (!checkpointPath.empty()) {
+            checkpointWriter = std::make_unique<CheckpointWriter>(checkpointPath, getName());
+        }
+        size_t firstTree = trees.size();
+        
+        // Boosting iterations
+        Eigen::VectorXd gradients(nSamples);
+        Eigen::VectorXd hessians(nSamples);
+        for (int iter = static_cast<int>(trees.size()); iter < nEstimators; ++iter) {
+            // First and second derivatives of the loss at the current margins,
+            // scaled by the sample weights
+            objectiveFunction->computeGradients(y, F, gradients, hessians);
+            gradients.array() *= weights.array();
+            hessians.array() *= weights.array();
             
             // Subsample training instances
             std::vector<int> sampleIndices;
@@ -89,7 +180,7 @@ bool XGBoost::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
                     sampleIndices[i] = i;
                 }
                 
-                std::shuffle(sampleIndices.begin(), sampleIndices.end(), generator);
+                std::shuffle(sampleIndices.begin(), sampleIndices.end(), rng);
                 sampleIndices.resize(subsampleSize);
             } else {
                 // Use all samples
@@ -111,14 +202,143 @@ bool XGBoost::fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             }
             
             F += learningRate * treeOutput;
+            
+            if (checkpointWriter && trees.size() % checkpointInterval == 0) {
+                submitCheckpoint(*checkpointWriter, F, targetSum);
+            }
         }
+        if (checkpointWriter && trees.size() > firstTree && trees.size() % checkpointInterval != 0) {
+            submitCheckpoint(*checkpointWriter, F, targetSum);
+        }
+        
+        // Store the training predictions so a later warm start can resume from them
+        trainingPredictions = F;
+        trainingTargetSum = targetSum;
         
         // Calculate feature importance
         calculateFeatureImportance();
         
-        // Calculate RMSE
-        Eigen::VectorXd predictions = predict(X);
-        rmse = std::sqrt((predictions - y).array().square().mean());
+        // Calculate RMSE (F holds the training margins)
+        rmse = std::sqrt(weights.dot((objectiveFunction->transform(F) - y).array().square().matrix()) /
+                         sampleWeightSum);
+        
+        isFitted = true;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting XGBoost model: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool XGBoost::fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                       const std::vector<std::string>& variableNames,
+                       const std::string& targetName) {
+    try {
+        materializeTrees();
+        
+        // Check dimensions
+        if (static_cast<size_t>(y.size()) != data.rows()) {
+            std::cerr << "Error: Number of samples in binned data (" << data.rows() 
+                    << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
+            return false;
+        }
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        
+        std::shared_ptr<BoostingObjective> newObjective =
+            BoostingObjective::create(objective, huberSlope, tweedieVariancePower);
+        newObjective->checkTarget(y);
+        objectiveFunction = newObjective;
+        
+        nSamples = static_cast<int>(data.rows());
+        sampleWeightSum = static_cast<double>(nSamples);
+        nFeatures = static_cast<int>(data.cols());
+        
+        // Store variable names
+        if (variableNames.size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = variableNames;
+        } else if (data.getFeatureNames().size() == static_cast<size_t>(nFeatures)) {
+            inputVariableNames = data.getFeatureNames();
+        } else {
+            inputVariableNames.clear();
+            for (int i = 0; i < nFeatures; ++i) {
+                inputVariableNames.push_back("Variable_" + std::to_string(i+1));
+            }
+        }
+        
+        // Store target variable name
+        if (!targetName.empty()) {
+            targetVariableName = targetName;
+        } else {
+            targetVariableName = data.getTargetName().empty() ? "Target" : data.getTargetName();
+        }
+        
+        // Binned training treats every feature as numeric
+        categoricalMask.assign(nFeatures, false);
+        
+        HistogramTree::Params params;
+        params.maxDepth = maxDepth;
+        params.minChildWeight = minChildWeight;
+        params.minSplitWeight = 2.0 * minChildWeight;
+        params.lambda = lambda;
+        params.alpha = alpha;
+        params.minGain = 2.0 * gamma;
+        
+        // Column subsampling at each node, from the member generator so a
+        // fixed seed also makes binned fits reproducible
+        if (randomSeed >= 0) {
+            rng.seed(static_cast<std::mt19937::result_type>(randomSeed));
+        }
+        std::vector<int> allFeatureIndices(nFeatures);
+        std::iota(allFeatureIndices.begin(), allFeatureIndices.end(), 0);
+        int colsampleSize = std::max(1, static_cast<int>(nFeatures * colsampleBytree));
+        auto selectFeatures = [&]() {
+            if (colsampleBytree >= 1.0) {
+                return allFeatureIndices;
+            }
+            std::shuffle(allFeatureIndices.begin(), allFeatureIndices.end(), rng);
+            return std::vector<int>(allFeatureIndices.begin(), allFeatureIndices.begin() + colsampleSize);
+        };
+        auto leafValue = [this](double sumGradients, double sumHessians) {
+            return regularizedLeafValue(sumGradients, sumHessians);
+        };
+        auto onSplit = [](TreeNode&, int, double, double) {};
+        
+        // Start from the constant margin that minimizes the loss
+        trees.clear();
+        initialPrediction = objectiveFunction->initialMargin(y, Eigen::VectorXd::Ones(nSamples));
+        Eigen::VectorXd F = Eigen::VectorXd::Constant(nSamples, initialPrediction);
+        Eigen::VectorXd gradients(nSamples);
+        Eigen::VectorXd hessians(nSamples);
+        
+        for (int iter = 0; iter < nEstimators; ++iter) {
+            objectiveFunction->computeGradients(y, F, gradients, hessians);
+            
+            // Subsample training instances
+            std::vector<int> sampleIndices(nSamples);
+            std::iota(sampleIndices.begin(), sampleIndices.end(), 0);
+            if (subsample < 1.0) {
+                std::shuffle(sampleIndices.begin(), sampleIndices.end(), rng);
+                sampleIndices.resize(static_cast<int>(nSamples * subsample));
+            }
+            
+            Tree tree;
+            tree.root = HistogramTree::build<TreeNode>(data, sampleIndices, gradients, hessians, params,
+                                                       leafValue, selectFeatures, onSplit);
+            
+            for (int i = 0; i < nSamples; ++i) {
+                F(i) += learningRate * HistogramTree::predict(tree.root, data, i);
+            }
+            trees.push_back(tree);
+        }
+        
+        // The stored predictions belong to the raw-data path, so warm start is not possible
+        trainingPredictions.resize(0);
+        
+        calculateFeatureImportance();
+        rmse = std::sqrt((objectiveFunction->transform(F) - y).array().square().mean());
         
         isFitted = true;
         return true;
@@ -138,8 +358,14 @@ std::shared_ptr<XGBoost::TreeNode> XGBoost::buildTree(
     // Create a new node
     auto node = std::make_shared<TreeNode>();
     
-    // Check if we've reached maximum depth or have too few samples
-    if (depth >= maxDepth || sampleIndices.size() <= minChildWeight) {
+    double sumHessians = 0.0;
+    for (int idx : sampleIndices) {
+        sumHessians += hessians(idx);
+    }
+    node->cover = sumHessians;
+    
+    // Check if we've reached maximum depth or cannot give both children min_child_weight
+    if (depth >= maxDepth || sumHessians < 2.0 * minChildWeight) {
         node->isLeaf = true;
         node->outputValue = calculateLeafValue(gradients, hessians, sampleIndices);
         return node;
@@ -148,16 +374,13 @@ std::shared_ptr<XGBoost::TreeNode> XGBoost::buildTree(
     // Select features for this tree (column subsampling)
     std::vector<int> featureIndices;
     if (colsampleBytree < 1.0) {
-        std::random_device rd;
-        std::mt19937 generator(rd());
-        
         int colsampleSize = static_cast<int>(nFeatures * colsampleBytree);
         featureIndices.resize(nFeatures);
         for (int i = 0; i < nFeatures; ++i) {
             featureIndices[i] = i;
         }
         
-        std::shuffle(featureIndices.begin(), featureIndices.end(), generator);
+        std::shuffle(featureIndices.begin(), featureIndices.end(), rng);
         featureIndices.resize(colsampleSize);
     } else {
         // Use all features
@@ -172,12 +395,14 @@ std::shared_ptr<XGBoost::TreeNode> XGBoost::buildTree(
     double bestSplitValue;
     double bestGain;
     std::vector<int> leftIndices, rightIndices;
+    std::vector<uint64_t> bestCategories;
+    bool bestMissingLeft = false;
     
     findBestSplit(X, gradients, hessians, sampleIndices, featureIndices,
-                 bestFeatureIndex, bestSplitValue, bestGain, leftIndices, rightIndices);
+                 bestFeatureIndex, bestSplitValue, bestGain, leftIndices, rightIndices, bestCategories, bestMissingLeft);
     
-    // If no good split is found or the gain is below gamma threshold, make it a leaf
-    if (bestGain <= gamma || leftIndices.empty() || rightIndices.empty()) {
+    // The loss reduction of a split is half its score gain; keep it only if it exceeds gamma
+    if (bestFeatureIndex < 0 || 0.5 * bestGain <= gamma || leftIndices.empty() || rightIndices.empty()) {
         node->isLeaf = true;
         node->outputValue = calculateLeafValue(gradients, hessians, sampleIndices);
         return node;
@@ -187,6 +412,10 @@ std::shared_ptr<XGBoost::TreeNode> XGBoost::buildTree(
     node->isLeaf = false;
     node->featureIndex = bestFeatureIndex;
     node->splitValue = bestSplitValue;
+    node->isCategorical = !bestCategories.empty();
+    node->categoryBitset = bestCategories;
+    node->defaultLeft = bestMissingLeft;
+    node->gain = bestGain;
     
     // Recursively build left and right subtrees
     node->leftChild = buildTree(X, gradients, hessians, leftIndices, depth + 1);
@@ -205,81 +434,71 @@ void XGBoost::findBestSplit(
     double& bestSplitValue,
     double& bestGain,
     std::vector<int>& leftIndices,
-    std::vector<int>& rightIndices) {
+    std::vector<int>& rightIndices,
+    std::vector<uint64_t>& bestCategories,
+    bool& bestMissingLeft) {
     
     // Initialize best values
     bestGain = -1.0;
     bestFeatureIndex = -1;
     bestSplitValue = 0.0;
-    
-    // Calculate sum of gradients and hessians for the current node
-    double sumGradients = 0.0;
-    double sumHessians = 0.0;
-    for (int idx : sampleIndices) {
-        sumGradients += gradients(idx);
-        sumHessians += hessians(idx);
-    }
-    
-    // Current node score (without splitting)
-    double currentScore = sumGradients * sumGradients / (sumHessians + 1e-6);
+    bestCategories.clear();
+    bestMissingLeft = false;
     
     // Try splitting on each feature
     for (int featIdx : featureIndices) {
-        // Sort sample indices by the feature value
-        std::vector<std::pair<double, int>> featureValueIndices;
-        for (int idx : sampleIndices) {
-            featureValueIndices.push_back({X(idx, featIdx), idx});
-        }
-        
-        std::sort(featureValueIndices.begin(), featureValueIndices.end());
-        
-        // Try each possible split point
-        double leftGradSum = 0.0;
-        double leftHessSum = 0.0;
-        
-        // Skip the last element since we need at least one sample on each side
-        for (size_t i = 0; i < featureValueIndices.size() - 1; ++i) {
-            int idx = featureValueIndices[i].second;
-            leftGradSum += gradients(idx);
-            leftHessSum += hessians(idx);
-            
-            double rightGradSum = sumGradients - leftGradSum;
-            double rightHessSum = sumHessians - leftHessSum;
+        // Categorical features use a Fisher-ordered partition of their categories
+        if (isCategoricalFeature(featIdx)) {
+            CategoricalSplit::Result split = CategoricalSplit::findBestPartition(
+                sampleIndices,
+                [&X, featIdx](int idx) { return X(idx, featIdx); },
+                [&gradients](int idx) { return gradients(idx); },
+                [&hessians](int idx) { return hessians(idx); },
+                static_cast<double>(minChildWeight), lambda, alpha);
             
-            // Skip if either side has too few hessians (weights)
-            if (leftHessSum < minChildWeight || rightHessSum < minChildWeight) {
-                continue;
-            }
-            
-            // Calculate the gain for this split
-            double leftScore = leftGradSum * leftGradSum / (leftHessSum + 1e-6);
-            double rightScore = rightGradSum * rightGradSum / (rightHessSum + 1e-6);
-            double gain = leftScore + rightScore - currentScore;
-            
-            // Check if this is the best split so far
-            if (gain > bestGain) {
-                bestGain = gain;
+            if (split.found && split.gain > bestGain) {
+                bestGain = split.gain;
                 bestFeatureIndex = featIdx;
-                
-                // Use average of current and next value as split point if not the last element
-                if (i < featureValueIndices.size() - 1) {
-                    bestSplitValue = (featureValueIndices[i].first + featureValueIndices[i + 1].first) / 2.0;
-                } else {
-                    bestSplitValue = featureValueIndices[i].first;
-                }
-                
-                // Update the sample indices for left and right children
-                leftIndices.clear();
-                rightIndices.clear();
-                
-                for (int idx : sampleIndices) {
-                    if (X(idx, featIdx) <= bestSplitValue) {
-                        leftIndices.push_back(idx);
-                    } else {
-                        rightIndices.push_back(idx);
-                    }
-                }
+                bestSplitValue = 0.0;
+                bestCategories = split.leftCategories;
+                bestMissingLeft = split.missingLeft;
             }
+            continue;
+        }
+        
+        // Sweep thresholds over the present values, trying missing values on both sides
+        ThresholdSplit::Result split = ThresholdSplit::findBestThreshold(
+            sampleIndices,
+            [&X, featIdx](int idx) { return X(idx, featIdx); },
+            [&gradients](int idx) { return gradients(idx); },
+            [&hessians](int idx) { return hessians(idx); },
+            static_cast<double>(minChildWeight), lambda, alpha);
+        
+        // Check if this is the best split so far
+        if (split.found && split.gain > bestGain) {
+            bestGain = split.gain;
+            bestFeatureIndex = featIdx;
+            bestSplitValue = split.threshold;
+            bestMissingLeft = split.missingLeft;
+            bestCategories.clear();
+        }
+    }
+    
+    // Partition the samples once, now that the best split is known
+    leftIndices.clear();
+    rightIndices.clear();
+    if (bestFeatureIndex < 0) {
+        return;
+    }
+    for (int idx : sampleIndices) {
+        double value = X(idx, bestFeatureIndex);
+        bool left = bestCategories.empty()
+            ? ThresholdSplit::goesLeft(value, bestSplitValue, bestMissingLeft)
+            : CategoricalSplit::goesLeft(bestCategories, value, bestMissingLeft);
+        if (left) {
+            leftIndices.push_back(idx);
+        } else {
+            rightIndices.push_back(idx);
         }
     }
 }
@@ -297,8 +516,18 @@ double XGBoost::calculateLeafValue(
         sumHessians += hessians(idx);
     }
     
-    // Newton step: -sum(grad) / sum(hess)
-    return -sumGradients / (sumHessians + 1e-6);
+    return regularizedLeafValue(sumGradients, sumHessians);
+}
+
+double XGBoost::regularizedLeafValue(double sumGradients, double sumHessians) const {
+    // Newton step with L1/L2 penalties: -T(G) / (H + lambda), T soft-thresholds G by alpha
+    double denominator = sumHessians + lambda;
+    if (denominator <= 0.0) {
+        return 0.0;
+    }
+    double thresholded = sumGradients > alpha ? sumGradients - alpha
+                       : (sumGradients < -alpha ? sumGradients + alpha : 0.0);
+    return -thresholded / denominator;
 }
 
 double XGBoost::predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const {
@@ -310,27 +539,52 @@ double XGBoost::predictTree(const Eigen::VectorXd& x, const std::shared_ptr<Tree
         return node->outputValue;
     }
     
+    // Categorical nodes send the categories in the bitset to the left child
+    if (node->isCategorical) {
+        if (CategoricalSplit::goesLeft(node->categoryBitset, x(node->featureIndex), node->defaultLeft)) {
+            return predictTree(x, node->leftChild);
+        }
+        return predictTree(x, node->rightChild);
+    }
+    
     // Navigate to the appropriate child based on the feature value
-    if (x(node->featureIndex) <= node->splitValue) {
+    if (ThresholdSplit::goesLeft(x(node->featureIndex), node->splitValue, node->defaultLeft)) {
         return predictTree(x, node->leftChild);
     } else {
         return predictTree(x, node->rightChild);
     }
 }
 
-Eigen::VectorXd XGBoost::predictAllTrees(const Eigen::MatrixXd& X) const {
-    Eigen::VectorXd predictions = Eigen::VectorXd::Constant(X.rows(), initialPrediction);
+void XGBoost::predictAllTrees(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                              Eigen::Ref<Eigen::VectorXd> predictions) const {
+    predictions.setConstant(initialPrediction);
     
-    for (const auto& tree : trees) {
-        for (int i = 0; i < X.rows(); ++i) {
-            predictions(i) += learningRate * predictTree(X.row(i), tree.root);
+    if (!flatTrees.empty()) {
+        // A loaded ensemble is scored from the mapped node arrays
+        flatTrees.accumulate(X, learningRate, predictions);
+    } else {
+        // Copy each row once for all tree walks
+        Eigen::VectorXd row(nFeatures);
+        for (Eigen::Index i = 0; i < X.rows(); ++i) {
+            row = X.row(i).transpose();
+            for (const auto& tree : trees) {
+                predictions(i) += learningRate * predictTree(row, tree.root);
+            }
         }
     }
     
-    return predictions;
+    // Map the margins to the prediction scale in place
+    for (Eigen::Index i = 0; i < predictions.size(); ++i) {
+        predictions(i) = objectiveFunction->transform(predictions(i));
+    }
 }
 
 Eigen::VectorXd XGBoost::predict(const Eigen::MatrixXd& X) const {
+    return predictInBlocks(X);
+}
+
+void XGBoost::predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                          Eigen::Ref<Eigen::VectorXd> predictions) const {
     if (!isFitted) {
         throw std::runtime_error("Model has not been fitted yet");
     }
@@ -340,8 +594,303 @@ Eigen::VectorXd XGBoost::predict(const Eigen::MatrixXd& X) const {
                                    ") does not match the number of features the model was trained on (" + 
                                    std::to_string(nFeatures) + ")");
     }
+    checkOutputSize(X, predictions);
+    
+    predictAllTrees(X, predictions);
+}
+
+template <typename T>
+double XGBoost::predictRow(const T* features) const noexcept {
+    assert(features != nullptr && isFitted);
+    if (!isFitted) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    // Trees are added in order to the initial prediction, as in predictAllTrees
+    double margin = initialPrediction;
+    if (!flatTrees.empty()) {
+        for (size_t t = 0; t < flatTrees.treeCount(); ++t) {
+            margin += learningRate * flatTrees.predictTree(t, features, 1);
+        }
+    } else {
+        for (const auto& tree : trees) {
+            margin += learningRate * TreeWalk::leafValue(tree.root.get(), features);
+        }
+    }
+    return objectiveFunction->transform(margin);
+}
+
+double XGBoost::predictOne(const double* features) const noexcept {
+    return predictRow(features);
+}
+
+double XGBoost::predictOne(const float* features) const noexcept {
+    return predictRow(features);
+}
+
+void XGBoost::setWarmStart(bool enabled) {
+    warmStart = enabled;
+}
+
+bool XGBoost::getWarmStart() const {
+    return warmStart;
+}
+
+void XGBoost::setNEstimators(int n_estimators) {
+    nEstimators = n_estimators;
+}
+
+void XGBoost::setNumWorkers(int n_workers) {
+    if (n_workers < 1) {
+        throw std::invalid_argument("Number of workers must be at least 1");
+    }
+    numWorkers = n_workers;
+}
+
+void XGBoost::setRandomSeed(int seed) {
+    randomSeed = seed < 0 ? -1 : seed;
+}
+
+void XGBoost::setCheckpoint(const std::string& filePath, int interval) {
+    if (interval < 1) {
+        throw std::invalid_argument("Checkpoint interval must be at least 1 round");
+    }
+    checkpointPath = filePath;
+    checkpointInterval = interval;
+}
+
+void XGBoost::submitCheckpoint(CheckpointWriter& writer, const Eigen::VectorXd& F, double targetSum) const {
+    // The trees are not modified after they are added, so the writer thread
+    // can share them; everything else is copied
+    writer.submit([trees = trees, F = Eigen::VectorXd(F), generator = rng, targetSum,
+                   objective = objective, huberSlope = huberSlope, variancePower = tweedieVariancePower,
+                   names = inputVariableNames, target = targetVariableName, rows = nSamples,
+                   features = nFeatures, weightSum = sampleWeightSum,
+                   initial = initialPrediction](std::vector<char>& buffer) {
+        using namespace BinaryBuffer;
+        appendValue<int64_t>(buffer, rows);
+        appendValue<int32_t>(buffer, features);
+        appendValue<double>(buffer, weightSum);
+        appendValue<double>(buffer, targetSum);
+        appendString(buffer, objective);
+        appendValue<double>(buffer, huberSlope);
+        appendValue<double>(buffer, variancePower);
+        appendValue<double>(buffer, initial);
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(names.size()));
+        for (const auto& name : names) {
+            appendString(buffer, name);
+        }
+        appendString(buffer, target);
+        
+        std::ostringstream generatorState;
+        generatorState << generator;
+        appendString(buffer, generatorState.str());
+        appendMatrix(buffer, F);
+        
+        appendValue<uint32_t>(buffer, static_cast<uint32_t>(trees.size()));
+        for (const auto& tree : trees) {
+            serializeTree(tree.root, buffer);
+        }
+    });
+}
+
+void XGBoost::resumeFromCheckpoint(const std::string& filePath) {
+    using namespace BinaryBuffer;
+    std::vector<char> buffer = CheckpointWriter::readPayload(filePath, getName());
+    size_t offset = 0;
+    int rows = static_cast<int>(readValue<int64_t>(buffer, offset));
+    int features = readValue<int32_t>(buffer, offset);
+    double weightSum = readValue<double>(buffer, offset);
+    double targetSum = readValue<double>(buffer, offset);
+    std::string storedObjective = readString(buffer, offset);
+    double storedHuberSlope = readValue<double>(buffer, offset);
+    double storedVariancePower = readValue<double>(buffer, offset);
+    double initial = readValue<double>(buffer, offset);
+    std::vector<std::string> names(readValue<uint32_t>(buffer, offset));
+    for (auto& name : names) {
+        name = readString(buffer, offset);
+    }
+    std::string target = readString(buffer, offset);
+    
+    std::istringstream generatorState(readString(buffer, offset));
+    std::mt19937 generator;
+    generatorState >> generator;
+    if (!generatorState) {
+        throw std::runtime_error("Malformed generator state in checkpoint");
+    }
+    Eigen::VectorXd F = readVector(buffer, offset);
+    
+    std::vector<Tree> storedTrees(readValue<uint32_t>(buffer, offset));
+    for (auto& tree : storedTrees) {
+        tree.root = deserializeTree(buffer, offset);
+    }
+    if (F.size() != rows || names.size() != static_cast<size_t>(features)) {
+        throw std::runtime_error("Checkpoint sizes do not match");
+    }
+    std::shared_ptr<BoostingObjective> storedFunction =
+        BoostingObjective::create(storedObjective, storedHuberSlope, storedVariancePower);
+    
+    // Only change the model once the whole file has been read
+    nSamples = rows;
+    nFeatures = features;
+    sampleWeightSum = weightSum;
+    trainingTargetSum = targetSum;
+    objective = storedObjective;
+    huberSlope = storedHuberSlope;
+    tweedieVariancePower = storedVariancePower;
+    objectiveFunction = storedFunction;
+    initialPrediction = initial;
+    inputVariableNames = names;
+    targetVariableName = target;
+    rng = generator;
+    trainingPredictions = F;
+    trees = std::move(storedTrees);
+    flatTrees = FlatForest();
+    categoricalMask.assign(nFeatures, false);
+    for (int idx : categoricalFeatureIndices) {
+        if (idx >= 0 && idx < nFeatures) {
+            categoricalMask[idx] = true;
+        }
+    }
+    calculateFeatureImportance();
+    isFitted = true;
+    resumePending = true;
+}
+
+std::unordered_map<std::string, double> XGBoost::compact(const Eigen::MatrixXd& calibrationX,
+                                                          double leafEpsilon,
+                                                          double treeTolerance) {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    bool hasCalibration = calibrationX.rows() > 0;
+    if (hasCalibration && calibrationX.cols() != nFeatures) {
+        throw std::invalid_argument("Number of features in calibration data (" + std::to_string(calibrationX.cols()) + 
+                                   ") does not match the number of features the model was trained on (" + 
+                                   std::to_string(nFeatures) + ")");
+    }
+    
+    materializeTrees();
+    std::unordered_map<std::string, double> report;
+    
+    auto countAllNodes = [this]() {
+        int total = 0;
+        for (const auto& tree : trees) {
+            total += TreeCompaction::countNodes(tree.root);
+        }
+        return total;
+    };
+    
+    report["trees_before"] = static_cast<double>(trees.size());
+    report["nodes_before"] = static_cast<double>(countAllNodes());
+    
+    // Reference predictions and latency of the uncompacted ensemble
+    Eigen::VectorXd reference;
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        reference = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_before"] = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    
+    // Node-level compaction of every tree
+    for (auto& tree : trees) {
+        tree.root = TreeCompaction::compactTree(tree.root, nFeatures, leafEpsilon);
+    }
+    
+    // Drop trees whose shrunken contribution keeps the predictions within tolerance
+    if (hasCalibration && !trees.empty()) {
+        int nTrees = static_cast<int>(trees.size());
+        Eigen::MatrixXd contributions(calibrationX.rows(), nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            for (int i = 0; i < calibrationX.rows(); ++i) {
+                contributions(i, t) = learningRate * predictTree(calibrationX.row(i), trees[t].root);
+            }
+        }
+        
+        // Try the trees with the smallest contribution first
+        std::vector<int> order(nTrees);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<double> magnitude(nTrees);
+        for (int t = 0; t < nTrees; ++t) {
+            magnitude[t] = contributions.col(t).cwiseAbs().maxCoeff();
+        }
+        std::sort(order.begin(), order.end(), [&magnitude](int a, int b) {
+            return magnitude[a] < magnitude[b];
+        });
+        
+        Eigen::VectorXd current = Eigen::VectorXd::Constant(calibrationX.rows(), initialPrediction) +
+                                  contributions.rowwise().sum();
+        std::vector<bool> keep(nTrees, true);
+        
+        for (int t : order) {
+            Eigen::VectorXd candidate = current - contributions.col(t);
+            if ((objectiveFunction->transform(candidate) - reference).cwiseAbs().maxCoeff() < treeTolerance) {
+                current = candidate;
+                keep[t] = false;
+            }
+        }
+        
+        std::vector<Tree> keptTrees;
+        for (int t = 0; t < nTrees; ++t) {
+            if (keep[t]) {
+                keptTrees.push_back(trees[t]);
+            }
+        }
+        trees = std::move(keptTrees);
+    }
+    
+    // The stored training predictions no longer match the trees
+    trainingPredictions.resize(0);
+    
+    calculateFeatureImportance();
+    
+    report["trees_after"] = static_cast<double>(trees.size());
+    report["nodes_after"] = static_cast<double>(countAllNodes());
+    
+    if (hasCalibration) {
+        auto start = std::chrono::steady_clock::now();
+        Eigen::VectorXd compacted = predict(calibrationX);
+        auto end = std::chrono::steady_clock::now();
+        report["predict_ms_after"] = std::chrono::duration<double, std::milli>(end - start).count();
+        report["max_prediction_change"] = (compacted - reference).cwiseAbs().maxCoeff();
+    }
     
-    return predictAllTrees(X);
+    return report;
+}
+
+void XGBoost::setLambda(double reg_lambda) {
+    if (reg_lambda < 0.0) {
+        throw std::invalid_argument("reg_lambda must be non-negative");
+    }
+    lambda = reg_lambda;
+}
+
+void XGBoost::setAlpha(double reg_alpha) {
+    if (reg_alpha < 0.0) {
+        throw std::invalid_argument("reg_alpha must be non-negative");
+    }
+    alpha = reg_alpha;
+}
+
+void XGBoost::setObjective(const std::string& objective_name,
+                           double huber_slope,
+                           double tweedie_variance_power) {
+    // Validate now so a bad setting fails here rather than inside fit()
+    BoostingObjective::create(objective_name, huber_slope, tweedie_variance_power);
+    objective = objective_name;
+    huberSlope = huber_slope;
+    tweedieVariancePower = tweedie_variance_power;
+}
+
+void XGBoost::setCategoricalFeatures(const std::vector<int>& featureIndices) {
+    categoricalFeatureIndices = featureIndices;
+}
+
+bool XGBoost::isCategoricalFeature(int featureIndex) const {
+    return featureIndex >= 0 && featureIndex < static_cast<int>(categoricalMask.size()) &&
+           categoricalMask[featureIndex];
 }
 
 std::string XGBoost::getName() const {
@@ -357,6 +906,17 @@ std::unordered_map<std::string, double> XGBoost::getParameters() const {
     params["colsample_bytree"] = colsampleBytree;
     params["min_child_weight"] = static_cast<double>(minChildWeight);
     params["gamma"] = gamma;
+    params["reg_lambda"] = lambda;
+    params["reg_alpha"] = alpha;
+    params["random_seed"] = static_cast<double>(randomSeed);
+    if (numWorkers > 1) {
+        params["n_workers"] = static_cast<double>(numWorkers);
+    }
+    if (objective == "pseudo_huber") {
+        params["huber_slope"] = huberSlope;
+    } else if (objective == "tweedie") {
+        params["tweedie_variance_power"] = tweedieVariancePower;
+    }
     
     return params;
 }
@@ -364,9 +924,9 @@ std::unordered_map<std::string, double> XGBoost::getParameters() const {
 std::unordered_map<std::string, double> XGBoost::getStatistics() const {
     std::unordered_map<std::string, double> stats;
     stats["rmse"] = rmse;
-    stats["n_samples"] = static_cast<double>(nSamples);
+    stats["n_samples"] = sampleWeightSum;
     stats["n_features"] = static_cast<double>(nFeatures);
-    stats["n_trees"] = static_cast<double>(trees.size());
+    stats["n_trees"] = static_cast<double>(getTreeCount());
     
     return stats;
 }
@@ -447,4 +1007,146 @@ std::unordered_map<std::string, double> XGBoost::getFeatureImportance() const {
     }
     
     return featureImportanceScores;
-} 
\ No newline at end of file
+}
+
+size_t XGBoost::getTreeCount() const {
+    return flatTrees.empty() ? trees.size() : flatTrees.treeCount();
+}
+
+std::vector<TreeInspection::NodeInfo> XGBoost::inspectTree(size_t treeIndex, int nodeId, int maxDepth) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    if (treeIndex >= getTreeCount()) {
+        throw std::out_of_range("Tree index " + std::to_string(treeIndex) + " is out of range");
+    }
+    if (!flatTrees.empty()) {
+        return TreeInspection::collect(flatTrees.buildTree<TreeNode>(treeIndex), nodeId, maxDepth);
+    }
+    return TreeInspection::collect(trees[treeIndex].root, nodeId, maxDepth);
+}
+
+void XGBoost::materializeTrees() {
+    if (flatTrees.empty()) {
+        return;
+    }
+    std::vector<Tree> built(flatTrees.treeCount());
+    for (size_t t = 0; t < built.size(); ++t) {
+        built[t].root = flatTrees.buildTree<TreeNode>(t);
+    }
+    trees = std::move(built);
+    flatTrees = FlatForest();
+}
+
+void XGBoost::writeModel(ModelFile::Writer& writer) const {
+    if (!isFitted) {
+        throw std::runtime_error("Model has not been fitted yet");
+    }
+    
+    writer.putValue<double>("learning_rate", learningRate);
+    writer.putValue<int32_t>("max_depth", maxDepth);
+    writer.putValue<int32_t>("n_estimators", nEstimators);
+    writer.putValue<double>("subsample", subsample);
+    writer.putValue<double>("colsample_bytree", colsampleBytree);
+    writer.putValue<int32_t>("min_child_weight", minChildWeight);
+    writer.putValue<double>("gamma", gamma);
+    writer.putValue<double>("lambda", lambda);
+    writer.putValue<double>("alpha", alpha);
+    writer.putString("objective", objective);
+    writer.putValue<double>("huber_slope", huberSlope);
+    writer.putValue<double>("tweedie_variance_power", tweedieVariancePower);
+    writer.putValue<uint8_t>("warm_start", warmStart ? 1 : 0);
+    writer.putValue<int32_t>("random_seed", randomSeed);
+    writer.putValue<int32_t>("num_workers", numWorkers);
+    writer.putArray("categorical_indices", std::vector<int32_t>(categoricalFeatureIndices.begin(),
+                                                                categoricalFeatureIndices.end()));
+    
+    writer.putValue<int64_t>("n_samples", nSamples);
+    writer.putValue<double>("sample_weight_sum", sampleWeightSum);
+    writer.putValue<int32_t>("n_features", nFeatures);
+    writer.putValue<double>("rmse", rmse);
+    writer.putValue<double>("initial_prediction", initialPrediction);
+    writer.putStrings("variable_names", inputVariableNames);
+    writer.putString("target_name", targetVariableName);
+    
+    // Training margins let a loaded model continue with a warm start
+    writer.putVector("training_predictions", trainingPredictions);
+    writer.putValue<double>("training_target_sum", trainingTargetSum);
+    
+    std::vector<double> importance;
+    for (const auto& name : inputVariableNames) {
+        importance.push_back(featureImportanceScores.at(name));
+    }
+    writer.putArray("feature_importance", importance);
+    
+    if (!flatTrees.empty()) {
+        flatTrees.write(writer);
+        return;
+    }
+    std::vector<std::shared_ptr<TreeNode>> roots;
+    for (const auto& tree : trees) {
+        roots.push_back(tree.root);
+    }
+    FlatForest::fromTrees(roots).write(writer);
+}
+
+void XGBoost::readModel(const ModelFile::Reader& reader) {
+    int features = reader.value<int32_t>("n_features");
+    std::vector<std::string> names = reader.strings("variable_names");
+    auto importance = reader.array<double>("feature_importance");
+    auto categorical = reader.array<int32_t>("categorical_indices");
+    FlatForest forest = FlatForest::fromFile(reader, features);
+    if (names.size() != static_cast<size_t>(features) || importance.size != static_cast<size_t>(features)) {
+        throw std::runtime_error("XGBoost model file sizes do not match");
+    }
+    std::string storedObjective = reader.string("objective");
+    double storedHuberSlope = reader.value<double>("huber_slope");
+    double storedVariancePower = reader.value<double>("tweedie_variance_power");
+    std::shared_ptr<BoostingObjective> storedFunction =
+        BoostingObjective::create(storedObjective, storedHuberSlope, storedVariancePower);
+    
+    learningRate = reader.value<double>("learning_rate");
+    maxDepth = reader.value<int32_t>("max_depth");
+    nEstimators = reader.value<int32_t>("n_estimators");
+    subsample = reader.value<double>("subsample");
+    colsampleBytree = reader.value<double>("colsample_bytree");
+    minChildWeight = reader.value<int32_t>("min_child_weight");
+    gamma = reader.value<double>("gamma");
+    lambda = reader.value<double>("lambda");
+    alpha = reader.value<double>("alpha");
+    objective = storedObjective;
+    huberSlope = storedHuberSlope;
+    tweedieVariancePower = storedVariancePower;
+    objectiveFunction = storedFunction;
+    warmStart = reader.value<uint8_t>("warm_start") != 0;
+    randomSeed = reader.has("random_seed") ? reader.value<int32_t>("random_seed") : -1;
+    numWorkers = reader.value<int32_t>("num_workers");
+    
+    nSamples = static_cast<int>(reader.value<int64_t>("n_samples"));
+    sampleWeightSum = reader.value<double>("sample_weight_sum");
+    nFeatures = features;
+    rmse = reader.value<double>("rmse");
+    initialPrediction = reader.value<double>("initial_prediction");
+    inputVariableNames = names;
+    targetVariableName = reader.string("target_name");
+    trainingPredictions = reader.vector("training_predictions");
+    trainingTargetSum = reader.value<double>("training_target_sum");
+    
+    featureImportanceScores.clear();
+    for (int i = 0; i < nFeatures; ++i) {
+        featureImportanceScores[inputVariableNames[i]] = importance[i];
+    }
+    
+    categoricalFeatureIndices.assign(categorical.begin(), categorical.end());
+    categoricalMask.assign(nFeatures, false);
+    for (int idx : categoricalFeatureIndices) {
+        if (idx >= 0 && idx < nFeatures) {
+            categoricalMask[idx] = true;
+        }
+    }
+    
+    trees.clear();
+    flatTrees = forest;
+    resumePending = false;
+    isFitted = true;
+}
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "models/Model.h"
+#include "models/FlatForest.h"
+#include "data/BinnedMatrix.h"
+#include "models/BoostingObjective.h"
+#include "utils/CheckpointWriter.h"
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <random>
 
 /**
  * @brief XGBoost gradient boosting tree model
@@ -39,11 +45,76 @@ public:
      * @param y Target variable (response variable)
      * @param variableNames Names of the input variables (features)
      * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
      * @return bool True if fitting was successful, false otherwise
      */
     bool fit(const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
             const std::vector<std::string>& variableNames = {},
-            const std::string& targetName = "") override;
+            const std::string& targetName = "",
+            const Eigen::VectorXd& sampleWeights = Eigen::VectorXd()) override;
+
+    /**
+     * @brief Fit the XGBoost model to binned data
+     * 
+     * Trees are grown from per-bin gradient histograms, so the raw feature
+     * matrix never needs to be in memory. Split thresholds are the bin cut
+     * values, and the fitted model predicts on raw data as usual. Categorical
+     * feature settings and warm start are not used on this path.
+     * 
+     * @param data Binned input features
+     * @param y Target variable (response variable)
+     * @param variableNames Names of the input variables (defaults to the binned feature names)
+     * @param targetName Name of the target variable
+     * @return bool True if fitting was successful, false otherwise
+     */
+    bool fitBinned(const BinnedMatrix& data, const Eigen::VectorXd& y,
+                  const std::vector<std::string>& variableNames = {},
+                  const std::string& targetName = "");
+
+    /**
+     * @brief Fit the model with data-parallel training on local worker processes
+     * 
+     * This process acts as the coordinator: it computes the histogram bin cuts
+     * and the starting margin on the full data, starts nWorkers worker
+     * processes, and sends each worker the configuration and a contiguous
+     * shard of the rows over a loopback TCP connection. The workers connect
+     * in a ring and grow every tree together: each builds gradient/hessian
+     * histograms of its own rows, the histograms are summed with a ring
+     * allreduce, and every worker takes the same split decisions from the
+     * identical sums. Worker 0 sends the trees back and the coordinator
+     * assembles the model. Trees are grown as in fitBinned, so the result
+     * matches fitBinned on the same data up to floating-point summation order.
+     * If a worker exits before connecting or fails later, the fit returns
+     * false instead of waiting for it. Only available on POSIX systems; categorical features are treated as numeric.
+     * 
+     * @param X Input features (predictor variables)
+     * @param y Target variable (response variable)
+     * @param nWorkers Number of worker processes
+     * @param variableNames Names of the input variables (features)
+     * @param targetName Name of the target variable
+     * @param sampleWeights Non-negative per-row weights (empty for unit weights)
+     * @param maxBins Maximum number of histogram bins per feature
+     * @return bool True if fitting was successful, false otherwise
+     */
+    bool fitDistributed(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, int nWorkers,
+                        const std::vector<std::string>& variableNames = {},
+                        const std::string& targetName = "",
+                        const Eigen::VectorXd& sampleWeights = Eigen::VectorXd(),
+                        int maxBins = BinnedMatrix::MAX_BINS);
+
+    /**
+     * @brief Run one worker of a distributed fit
+     * 
+     * Connects to the coordinator started by fitDistributed, receives the
+     * configuration and its row shard, trains with the other workers and
+     * reports back. fitDistributed calls this in the worker processes it
+     * starts; a separately launched process can call it as well.
+     * 
+     * @param rank Rank of the worker, in [0, nWorkers)
+     * @param coordinatorPort Loopback port of the coordinator
+     * @return bool True if the worker finished successfully
+     */
+    static bool runDistributedWorker(int rank, uint16_t coordinatorPort);
 
     /**
      * @brief Make predictions using the fitted XGBoost model
@@ -53,6 +124,24 @@ public:
      */
     Eigen::VectorXd predict(const Eigen::MatrixXd& X) const override;
 
+    /**
+     * @brief Make predictions into caller-provided storage
+     * 
+     * @param X Input features for prediction, read in place
+     * @param predictions Output span with one element per row of X
+     */
+    void predictInto(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                     Eigen::Ref<Eigen::VectorXd> predictions) const override;
+
+    /**
+     * @brief Predict a single row without allocating or throwing
+     * 
+     * @param features First of the row's feature values, in training column order
+     * @return double Predicted value
+     */
+    double predictOne(const double* features) const noexcept override;
+    double predictOne(const float* features) const noexcept override;
+
     /**
      * @brief Get the name of the model
      * 
@@ -105,6 +194,153 @@ public:
      */
     std::unordered_map<std::string, double> getFeatureImportance() const override;
 
+    /**
+     * @brief Get the number of trees in the fitted model
+     * 
+     * @return size_t Number of trees
+     */
+    size_t getTreeCount() const override;
+
+    /**
+     * @brief Inspect the nodes of one fitted tree
+     * 
+     * @param treeIndex Index of the tree, below getTreeCount()
+     * @param nodeId Preorder id of the subtree root (0 for the whole tree)
+     * @param maxDepth Levels below the subtree root to include (-1 for all)
+     * @return std::vector<TreeInspection::NodeInfo> Nodes of the subtree
+     */
+    std::vector<TreeInspection::NodeInfo> inspectTree(size_t treeIndex, int nodeId = 0,
+                                                      int maxDepth = -1) const override;
+
+    /**
+     * @brief Enable or disable warm-start training
+     * 
+     * When enabled and the model is already fitted on the same data, the next
+     * call to fit() keeps the existing trees and resumes boosting from the stored
+     * training predictions, so only the additional rounds are trained.
+     * 
+     * @param enabled Whether to reuse the existing trees on the next fit
+     */
+    void setWarmStart(bool enabled);
+
+    /**
+     * @brief Check whether warm-start training is enabled
+     * 
+     * @return bool True if warm start is enabled
+     */
+    bool getWarmStart() const;
+
+    /**
+     * @brief Set the number of boosting rounds
+     * 
+     * @param n_estimators Number of trees (boosting rounds)
+     */
+    void setNEstimators(int n_estimators);
+
+    /**
+     * @brief Set the number of local worker processes used by fit()
+     * 
+     * With more than one worker, fit() trains with fitDistributed.
+     * 
+     * @param n_workers Number of worker processes (1 trains in this process)
+     */
+    void setNumWorkers(int n_workers);
+
+    /**
+     * @brief Set the L2 regularization of the leaf weights
+     * 
+     * @param reg_lambda L2 penalty added to the hessian sum of every leaf (>= 0)
+     */
+    void setLambda(double reg_lambda);
+
+    /**
+     * @brief Set the L1 regularization of the leaf weights
+     * 
+     * @param reg_alpha L1 penalty that soft-thresholds the gradient sum of every leaf (>= 0)
+     */
+    void setAlpha(double reg_alpha);
+
+    /**
+     * @brief Set the seed of the row and column sampling
+     * 
+     * A fit that starts from scratch reseeds the generator, so it is
+     * reproducible; a warm start or resumed checkpoint continues its stream.
+     * Distributed fits derive the workers' generators from the seed.
+     * 
+     * @param seed Non-negative seed, or -1 to continue the model's random stream
+     */
+    void setRandomSeed(int seed);
+
+    /**
+     * @brief Set the training objective
+     * 
+     * @param objective_name "squared_error", "pseudo_huber" or "tweedie"
+     * @param huber_slope Slope (delta) of the pseudo-Huber loss
+     * @param tweedie_variance_power Variance power of the Tweedie loss, in (1, 2)
+     */
+    void setObjective(const std::string& objective_name,
+                      double huber_slope = 1.0,
+                      double tweedie_variance_power = 1.5);
+
+    /**
+     * @brief Mark input features as categorical
+     * 
+     * Categorical features hold non-negative integer category codes. The trees split
+     * them by category membership instead of by threshold, so they do not need to be
+     * one-hot encoded.
+     * 
+     * @param featureIndices Column indices of the categorical features
+     */
+    void setCategoricalFeatures(const std::vector<int>& featureIndices);
+
+    /**
+     * @brief Compact the fitted ensemble for faster inference
+     * 
+     * Removes splits already decided by an ancestor, merges leaves whose outputs
+     * differ by at most leafEpsilon, collapses identical subtrees and drops trees
+     * whose removal changes every calibration prediction by less than treeTolerance.
+     * 
+     * @param calibrationX Calibration inputs used to validate tree removal (may be empty)
+     * @param leafEpsilon Tolerance for merging leaf values
+     * @param treeTolerance Maximum allowed change of any calibration prediction
+     * @return std::unordered_map<std::string, double> Model size and predict latency before and after
+     */
+    std::unordered_map<std::string, double> compact(const Eigen::MatrixXd& calibrationX,
+                                                    double leafEpsilon = 1e-6,
+                                                    double treeTolerance = 1e-4);
+
+    /**
+     * @brief Write training checkpoints while fitting
+     * 
+     * Every interval rounds, and once more when boosting ends, fit hands the
+     * trees, the training margins and the generator state to a
+     * CheckpointWriter, which writes them on its own thread. Not used by
+     * fitBinned or distributed training.
+     * 
+     * @param filePath Checkpoint file (empty to disable checkpointing)
+     * @param interval Rounds between checkpoints
+     * @throws std::invalid_argument If interval is less than 1
+     */
+    void setCheckpoint(const std::string& filePath, int interval = 10);
+
+    /**
+     * @brief Load a checkpoint and continue boosting from it on the next fit
+     * 
+     * The model takes the trees, objective, variable names and generator
+     * state of the checkpoint and can predict right away. The next fit on
+     * the same data resumes like a warm start and grows exactly the trees the
+     * interrupted fit would have, up to the current number of estimators.
+     * The other hyperparameters must match the interrupted fit.
+     * 
+     * @param filePath Checkpoint written during an earlier fit
+     * @throws std::runtime_error If the file is not a readable XGBoost checkpoint
+     */
+    void resumeFromCheckpoint(const std::string& filePath);
+
+protected:
+    void writeModel(ModelFile::Writer& writer) const override;
+    void readModel(const ModelFile::Reader& reader) override;
+
 private:
     // Model hyperparameters
     double learningRate;
@@ -114,13 +350,35 @@ private:
     double colsampleBytree;
     int minChildWeight;
     double gamma;
+    double lambda;
+    double alpha;
+    std::string objective;
+    double huberSlope;
+    double tweedieVariancePower;
+    bool warmStart;
+    int numWorkers;
     
     // Model state
     bool isFitted;
     int nSamples;
+    double sampleWeightSum;
     int nFeatures;
     double rmse;
     
+    // Training predictions (F) and target checksum kept for warm start
+    Eigen::VectorXd trainingPredictions;
+    double trainingTargetSum;
+    
+    // Row and column sampling generator; lives as long as the model so
+    // checkpoints can store it
+    int randomSeed;         // -1 if fits do not reseed the generator
+    std::mt19937 rng;
+    
+    // Checkpointing
+    std::string checkpointPath;
+    int checkpointInterval;
+    bool resumePending;     // Set by resumeFromCheckpoint until the next fit
+    
     // Variable names storage
     std::vector<std::string> inputVariableNames;
     std::string targetVariableName;
@@ -128,6 +386,10 @@ private:
     // Feature importance scores
     std::unordered_map<std::string, double> featureImportanceScores;
     
+    // Categorical feature indices and the per-feature mask derived from them
+    std::vector<int> categoricalFeatureIndices;
+    std::vector<bool> categoricalMask;
+    
     // Model implementation details
     class TreeNode {
     public:
@@ -137,9 +399,15 @@ private:
         double outputValue;
         std::shared_ptr<TreeNode> leftChild;
         std::shared_ptr<TreeNode> rightChild;
+        bool isCategorical;
+        std::vector<uint64_t> categoryBitset;
+        bool defaultLeft;  // Direction taken by samples with a missing feature value
+        double cover;      // Hessian sum of the samples reaching the node
+        double gain;       // Regularized score gain of the split
         
         TreeNode() : isLeaf(true), featureIndex(-1), splitValue(0.0), outputValue(0.0),
-                   leftChild(nullptr), rightChild(nullptr) {}
+                   leftChild(nullptr), rightChild(nullptr), isCategorical(false), defaultLeft(false),
+                   cover(0.0), gain(0.0) {}
     };
     
     class Tree {
@@ -151,6 +419,20 @@ private:
     std::vector<Tree> trees;
     double initialPrediction;
     
+    // Trees of a loaded model, scored from the model file until the
+    // ensemble is trained further
+    FlatForest flatTrees;
+    
+    /**
+     * @brief Rebuild the trees of a loaded model as nodes
+     * 
+     * Does nothing unless the model was loaded and not modified since.
+     */
+    void materializeTrees();
+    
+    // Loss the trees were fitted to; maps margins to predictions
+    std::shared_ptr<BoostingObjective> objectiveFunction;
+    
     /**
      * @brief Build a regression tree
      * 
@@ -180,6 +462,8 @@ private:
      * @param bestGain Best gain value (output)
      * @param leftIndices Left child sample indices (output)
      * @param rightIndices Right child sample indices (output)
+     * @param bestCategories Left-child category set if the best split is categorical (output)
+     * @param bestMissingLeft Whether samples with a missing value go left (output)
      */
     void findBestSplit(const Eigen::MatrixXd& X,
                      const Eigen::VectorXd& gradients,
@@ -190,7 +474,9 @@ private:
                      double& bestSplitValue,
                      double& bestGain,
                      std::vector<int>& leftIndices,
-                     std::vector<int>& rightIndices);
+                     std::vector<int>& rightIndices,
+                     std::vector<uint64_t>& bestCategories,
+                     bool& bestMissingLeft);
     
     /**
      * @brief Calculate the output value for a leaf node
@@ -204,6 +490,23 @@ private:
                             const Eigen::VectorXd& hessians,
                             const std::vector<int>& sampleIndices);
     
+    /**
+     * @brief Regularized Newton leaf value -T(G) / (H + lambda)
+     * 
+     * @param sumGradients Sum of gradients in the leaf
+     * @param sumHessians Sum of hessians in the leaf
+     * @return double Leaf value, with G soft-thresholded by alpha
+     */
+    double regularizedLeafValue(double sumGradients, double sumHessians) const;
+    
+    /**
+     * @brief Check whether a feature was marked as categorical
+     * 
+     * @param featureIndex Feature index
+     * @return bool True if the feature is categorical
+     */
+    bool isCategoricalFeature(int featureIndex) const;
+    
     /**
      * @brief Predict using a single tree
      * 
@@ -213,13 +516,50 @@ private:
      */
     double predictTree(const Eigen::VectorXd& x, const std::shared_ptr<TreeNode>& node) const;
     
+    /**
+     * @brief Body of both predictOne overloads: all trees for one row
+     * 
+     * @param features First of the row's feature values
+     * @return double Prediction value
+     */
+    template <typename T>
+    double predictRow(const T* features) const noexcept;
+    
     /**
      * @brief Calculate tree prediction for all instances
      * 
      * @param X Input features
-     * @return Eigen::VectorXd Predictions
+     * @param predictions Output span with one element per row of X
+     */
+    void predictAllTrees(const Eigen::Ref<const Eigen::MatrixXd>& X,
+                         Eigen::Ref<Eigen::VectorXd> predictions) const;
+    
+    /**
+     * @brief Hand the current boosting state to the checkpoint writer
+     * 
+     * @param writer Checkpoint writer of the running fit
+     * @param F Current training margins
+     * @param targetSum Sum of the training targets
+     */
+    void submitCheckpoint(CheckpointWriter& writer, const Eigen::VectorXd& F, double targetSum) const;
+    
+    /**
+     * @brief Append a tree to a byte buffer in preorder
+     * 
+     * @param node Root of the tree
+     * @param buffer Output buffer
+     */
+    static void serializeTree(const std::shared_ptr<TreeNode>& node, std::vector<char>& buffer);
+    
+    /**
+     * @brief Read a tree written by serializeTree
+     * 
+     * @param buffer Input buffer
+     * @param offset Read position, advanced past the tree
+     * @return std::shared_ptr<TreeNode> Root of the tree
+     * @throws std::runtime_error If the buffer is malformed
      */
-    Eigen::VectorXd predictAllTrees(const Eigen::MatrixXd& X) const;
+    static std::shared_ptr<TreeNode> deserializeTree(const std::vector<char>& buffer, size_t& offset);
     
     /**
      * @brief Calculate feature importance based on the trained trees
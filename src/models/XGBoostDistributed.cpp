@@ -0,0 +1,406 @@
+#include "models/XGBoost.h"
+#include "models/HistogramTree.h"
+#include "utils/SocketChannel.h"
+#include "utils/RingAllreduce.h"
+#include "utils/BinaryBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using BinaryBuffer::appendValue;
+using BinaryBuffer::readValue;
+
+void XGBoost::serializeTree(const std::shared_ptr<TreeNode>& node, std::vector<char>& buffer) {
+    appendValue<uint8_t>(buffer, node->isLeaf ? 1 : 0);
+    appendValue<uint8_t>(buffer, node->isCategorical ? 1 : 0);
+    appendValue<uint8_t>(buffer, node->defaultLeft ? 1 : 0);
+    appendValue<int32_t>(buffer, node->featureIndex);
+    appendValue<double>(buffer, node->splitValue);
+    appendValue<double>(buffer, node->outputValue);
+    appendValue<double>(buffer, node->cover);
+    appendValue<double>(buffer, node->gain);
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(node->categoryBitset.size()));
+    for (uint64_t word : node->categoryBitset) {
+        appendValue<uint64_t>(buffer, word);
+    }
+    if (!node->isLeaf) {
+        serializeTree(node->leftChild, buffer);
+        serializeTree(node->rightChild, buffer);
+    }
+}
+
+std::shared_ptr<XGBoost::TreeNode> XGBoost::deserializeTree(const std::vector<char>& buffer, size_t& offset) {
+    auto node = std::make_shared<TreeNode>();
+    node->isLeaf = readValue<uint8_t>(buffer, offset) != 0;
+    node->isCategorical = readValue<uint8_t>(buffer, offset) != 0;
+    node->defaultLeft = readValue<uint8_t>(buffer, offset) != 0;
+    node->featureIndex = readValue<int32_t>(buffer, offset);
+    node->splitValue = readValue<double>(buffer, offset);
+    node->outputValue = readValue<double>(buffer, offset);
+    node->cover = readValue<double>(buffer, offset);
+    node->gain = readValue<double>(buffer, offset);
+    uint32_t words = readValue<uint32_t>(buffer, offset);
+    for (uint32_t i = 0; i < words; ++i) {
+        node->categoryBitset.push_back(readValue<uint64_t>(buffer, offset));
+    }
+    if (!node->isLeaf) {
+        node->leftChild = deserializeTree(buffer, offset);
+        node->rightChild = deserializeTree(buffer, offset);
+    }
+    return node;
+}
+
+#ifndef _WIN32
+
+bool XGBoost::fitDistributed(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, int nWorkers,
+                             const std::vector<std::string>& variableNames,
+                             const std::string& targetName,
+                             const Eigen::VectorXd& sampleWeights,
+                             int maxBins) {
+    std::vector<pid_t> workerPids;
+    std::vector<Tree> newTrees;
+    std::shared_ptr<BoostingObjective> newObjective;
+    Eigen::VectorXd weights;
+    double newInitialPrediction = 0.0;
+    double newRmse = 0.0;
+    bool success = false;
+
+    try {
+        // Check dimensions
+        if (X.rows() != y.rows()) {
+            std::cerr << "Error: Number of samples in X (" << X.rows()
+                    << ") does not match number of samples in y (" << y.rows() << ")." << std::endl;
+            return false;
+        }
+        if (y.hasNaN()) {
+            std::cerr << "Error: Target contains missing values." << std::endl;
+            return false;
+        }
+        if (nWorkers < 1) {
+            std::cerr << "Error: Number of workers must be at least 1." << std::endl;
+            return false;
+        }
+        if (!resolveSampleWeights(sampleWeights, y.size(), weights)) {
+            return false;
+        }
+
+        newObjective = BoostingObjective::create(objective, huberSlope, tweedieVariancePower);
+        newObjective->checkTarget(y);
+
+        // The coordinator sees all rows, so the bin cuts and the starting
+        // margin are computed once here rather than reduced from the workers
+        std::vector<std::vector<double>> cuts = BinnedMatrix::computeCuts(X, maxBins);
+        newInitialPrediction = newObjective->initialMargin(y, weights);
+        uint64_t seed = randomSeed >= 0 ? static_cast<uint64_t>(randomSeed) : std::random_device()();
+
+        // Flush buffered output so the worker processes do not repeat it
+        std::cout.flush();
+        std::cerr.flush();
+
+        SocketListener listener;
+        for (int rank = 0; rank < nWorkers; ++rank) {
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                throw std::runtime_error("Could not start worker process");
+            }
+            if (pid == 0) {
+                // Worker process: leave without running the parent's exit handlers
+                listener.close();
+                bool ok = runDistributedWorker(rank, listener.getPort());
+                ::_exit(ok ? 0 : 1);
+            }
+            workerPids.push_back(pid);
+        }
+
+        // Each worker reports its rank and the port of its ring listener
+        std::vector<SocketChannel> channels(nWorkers);
+        std::vector<uint16_t> ringPorts(nWorkers);
+        for (int i = 0; i < nWorkers; ++i) {
+            // A worker that dies before connecting would leave accept blocked,
+            // so poll the listener and check on the workers between polls
+            while (!listener.waitForConnection(100)) {
+                for (size_t rank = 0; rank < workerPids.size(); ++rank) {
+                    int status = 0;
+                    if (workerPids[rank] > 0 && ::waitpid(workerPids[rank], &status, WNOHANG) == workerPids[rank]) {
+                        workerPids[rank] = -1;
+                        throw std::runtime_error("Worker " + std::to_string(rank) +
+                                                 " exited before connecting");
+                    }
+                }
+            }
+            SocketChannel channel = listener.accept();
+            int32_t rank = channel.receiveValue<int32_t>();
+            if (rank < 0 || rank >= nWorkers || channels[rank].isOpen()) {
+                throw std::runtime_error("Unexpected worker rank " + std::to_string(rank));
+            }
+            ringPorts[rank] = channel.receiveValue<uint16_t>();
+            channels[rank] = std::move(channel);
+        }
+
+        // Send the configuration and a contiguous row shard to every worker
+        Eigen::Index nRows = X.rows();
+        for (int rank = 0; rank < nWorkers; ++rank) {
+            SocketChannel& channel = channels[rank];
+            channel.sendValue<int32_t>(nWorkers);
+            channel.sendVector(ringPorts);
+
+            channel.sendValue<double>(learningRate);
+            channel.sendValue<int32_t>(maxDepth);
+            channel.sendValue<int32_t>(nEstimators);
+            channel.sendValue<double>(subsample);
+            channel.sendValue<double>(colsampleBytree);
+            channel.sendValue<int32_t>(minChildWeight);
+            channel.sendValue<double>(gamma);
+            channel.sendValue<double>(lambda);
+            channel.sendValue<double>(alpha);
+            channel.sendString(objective);
+            channel.sendValue<double>(huberSlope);
+            channel.sendValue<double>(tweedieVariancePower);
+            channel.sendValue<double>(newInitialPrediction);
+            channel.sendValue<uint64_t>(seed);
+
+            channel.sendValue<uint64_t>(cuts.size());
+            for (const auto& featureCuts : cuts) {
+                channel.sendVector(featureCuts);
+            }
+
+            Eigen::Index begin = nRows * rank / nWorkers;
+            Eigen::Index count = nRows * (rank + 1) / nWorkers - begin;
+            Eigen::MatrixXd shardX = X.middleRows(begin, count);
+            channel.sendValue<int64_t>(count);
+            channel.sendValue<int64_t>(shardX.cols());
+            channel.send(shardX.data(), static_cast<size_t>(shardX.size()) * sizeof(double));
+            channel.send(y.data() + begin, static_cast<size_t>(count) * sizeof(double));
+            channel.send(weights.data() + begin, static_cast<size_t>(count) * sizeof(double));
+        }
+
+        // All workers hold the same trees; worker 0 sends them back
+        for (int rank = 0; rank < nWorkers; ++rank) {
+            if (channels[rank].receiveValue<int32_t>() != 1) {
+                throw std::runtime_error("Worker " + std::to_string(rank) + " failed");
+            }
+        }
+        newRmse = channels[0].receiveValue<double>();
+        uint64_t treeCount = channels[0].receiveValue<uint64_t>();
+        for (uint64_t t = 0; t < treeCount; ++t) {
+            std::vector<char> buffer = channels[0].receiveVector<char>();
+            size_t offset = 0;
+            Tree tree;
+            tree.root = deserializeTree(buffer, offset);
+            newTrees.push_back(tree);
+        }
+        success = true;
+    } catch (const std::exception& e) {
+        // The sockets are closed by now, so blocked workers see the error and exit
+        std::cerr << "Error fitting distributed XGBoost model: " << e.what() << std::endl;
+    }
+
+    for (size_t rank = 0; rank < workerPids.size(); ++rank) {
+        // Workers reaped while waiting for connections have already failed the fit
+        if (workerPids[rank] < 0) {
+            continue;
+        }
+        int status = 0;
+        while (::waitpid(workerPids[rank], &status, 0) < 0 && errno == EINTR) {
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (success) {
+                std::cerr << "Error: XGBoost worker " << rank << " exited abnormally." << std::endl;
+            }
+            success = false;
+        }
+    }
+    if (!success) {
+        return false;
+    }
+
+    nSamples = static_cast<int>(X.rows());
+    sampleWeightSum = weights.sum();
+    nFeatures = static_cast<int>(X.cols());
+    objectiveFunction = newObjective;
+    initialPrediction = newInitialPrediction;
+    trees = newTrees;
+    rmse = newRmse;
+
+    // Store variable names
+    if (variableNames.size() == static_cast<size_t>(nFeatures)) {
+        inputVariableNames = variableNames;
+    } else {
+        if (!variableNames.empty()) {
+            std::cerr << "Warning: Number of variable names (" << variableNames.size()
+                    << ") does not match number of features (" << nFeatures
+                    << "). Using default names." << std::endl;
+        }
+        inputVariableNames.clear();
+        for (int i = 0; i < nFeatures; ++i) {
+            inputVariableNames.push_back("Variable_" + std::to_string(i+1));
+        }
+    }
+    targetVariableName = targetName.empty() ? "Target" : targetName;
+
+    // Distributed training treats every feature as numeric and keeps no
+    // training predictions, so warm start is not possible afterwards
+    categoricalMask.assign(nFeatures, false);
+    trainingPredictions.resize(0);
+
+    calculateFeatureImportance();
+    isFitted = true;
+    return true;
+}
+
+bool XGBoost::runDistributedWorker(int rank, uint16_t coordinatorPort) {
+    try {
+        SocketChannel coordinator = SocketChannel::connectTo(coordinatorPort);
+        SocketListener ringListener;
+        coordinator.sendValue<int32_t>(rank);
+        coordinator.sendValue<uint16_t>(ringListener.getPort());
+
+        int worldSize = coordinator.receiveValue<int32_t>();
+        std::vector<uint16_t> ringPorts = coordinator.receiveVector<uint16_t>();
+
+        // A local model carries the hyperparameters and the leaf value rule
+        XGBoost model;
+        model.learningRate = coordinator.receiveValue<double>();
+        model.maxDepth = coordinator.receiveValue<int32_t>();
+        model.nEstimators = coordinator.receiveValue<int32_t>();
+        model.subsample = coordinator.receiveValue<double>();
+        model.colsampleBytree = coordinator.receiveValue<double>();
+        model.minChildWeight = coordinator.receiveValue<int32_t>();
+        model.gamma = coordinator.receiveValue<double>();
+        model.lambda = coordinator.receiveValue<double>();
+        model.alpha = coordinator.receiveValue<double>();
+        model.objective = coordinator.receiveString();
+        model.huberSlope = coordinator.receiveValue<double>();
+        model.tweedieVariancePower = coordinator.receiveValue<double>();
+        double initialMargin = coordinator.receiveValue<double>();
+        uint64_t seed = coordinator.receiveValue<uint64_t>();
+
+        std::vector<std::vector<double>> cuts(coordinator.receiveValue<uint64_t>());
+        for (auto& featureCuts : cuts) {
+            featureCuts = coordinator.receiveVector<double>();
+        }
+
+        Eigen::Index nRows = coordinator.receiveValue<int64_t>();
+        Eigen::Index nCols = coordinator.receiveValue<int64_t>();
+        Eigen::MatrixXd X(nRows, nCols);
+        Eigen::VectorXd y(nRows);
+        Eigen::VectorXd weights(nRows);
+        coordinator.receive(X.data(), static_cast<size_t>(X.size()) * sizeof(double));
+        coordinator.receive(y.data(), static_cast<size_t>(nRows) * sizeof(double));
+        coordinator.receive(weights.data(), static_cast<size_t>(nRows) * sizeof(double));
+
+        BinnedMatrix data = BinnedMatrix::fromMatrix(X, cuts, {});
+        X.resize(0, 0);
+        std::shared_ptr<BoostingObjective> objectiveFunction =
+            BoostingObjective::create(model.objective, model.huberSlope, model.tweedieVariancePower);
+
+        RingAllreduce ring(rank, worldSize, ringListener, ringPorts);
+        ringListener.close();
+
+        HistogramTree::Params params;
+        params.maxDepth = model.maxDepth;
+        params.minChildWeight = model.minChildWeight;
+        params.minSplitWeight = 2.0 * model.minChildWeight;
+        params.lambda = model.lambda;
+        params.alpha = model.alpha;
+        params.minGain = 2.0 * model.gamma;
+
+        // Column subsampling must pick the same features on every worker, so
+        // it shares the seed; row subsampling is local to the shard
+        std::mt19937 featureGenerator(static_cast<std::mt19937::result_type>(seed));
+        std::mt19937 rowGenerator(static_cast<std::mt19937::result_type>(seed + rank + 1));
+        int nFeatures = static_cast<int>(nCols);
+        std::vector<int> allFeatureIndices(nFeatures);
+        std::iota(allFeatureIndices.begin(), allFeatureIndices.end(), 0);
+        int colsampleSize = std::max(1, static_cast<int>(nFeatures * model.colsampleBytree));
+        auto selectFeatures = [&]() {
+            if (model.colsampleBytree >= 1.0) {
+                return allFeatureIndices;
+            }
+            std::shuffle(allFeatureIndices.begin(), allFeatureIndices.end(), featureGenerator);
+            return std::vector<int>(allFeatureIndices.begin(), allFeatureIndices.begin() + colsampleSize);
+        };
+        auto leafValue = [&model](double sumGradients, double sumHessians) {
+            return model.regularizedLeafValue(sumGradients, sumHessians);
+        };
+        auto onSplit = [](TreeNode&, int, double, double) {};
+        auto reduce = [&ring](std::vector<double>& values) { ring.sum(values); };
+
+        Eigen::VectorXd F = Eigen::VectorXd::Constant(nRows, initialMargin);
+        Eigen::VectorXd gradients(nRows);
+        Eigen::VectorXd hessians(nRows);
+        for (int iter = 0; iter < model.nEstimators; ++iter) {
+            objectiveFunction->computeGradients(y, F, gradients, hessians);
+            gradients.array() *= weights.array();
+            hessians.array() *= weights.array();
+
+            // Subsample the rows of this shard; rows with zero weight add nothing
+            std::vector<int> sampleIndices;
+            for (Eigen::Index i = 0; i < nRows; ++i) {
+                if (weights(i) > 0.0) {
+                    sampleIndices.push_back(static_cast<int>(i));
+                }
+            }
+            if (model.subsample < 1.0) {
+                std::shuffle(sampleIndices.begin(), sampleIndices.end(), rowGenerator);
+                sampleIndices.resize(static_cast<size_t>(sampleIndices.size() * model.subsample));
+            }
+
+            Tree tree;
+            tree.root = HistogramTree::build<TreeNode>(data, sampleIndices, gradients, hessians, params,
+                                                       leafValue, selectFeatures, onSplit, 0, reduce);
+            for (Eigen::Index i = 0; i < nRows; ++i) {
+                F(i) += model.learningRate * HistogramTree::predict(tree.root, data, static_cast<size_t>(i));
+            }
+            model.trees.push_back(tree);
+        }
+
+        // Weighted training RMSE over all shards
+        Eigen::VectorXd residuals = objectiveFunction->transform(F) - y;
+        std::vector<double> errorSums = {weights.dot(residuals.cwiseProduct(residuals)), weights.sum()};
+        ring.sum(errorSums);
+
+        coordinator.sendValue<int32_t>(1);
+        if (rank == 0) {
+            coordinator.sendValue<double>(std::sqrt(errorSums[0] / errorSums[1]));
+            coordinator.sendValue<uint64_t>(model.trees.size());
+            std::vector<char> buffer;
+            for (const auto& tree : model.trees) {
+                buffer.clear();
+                serializeTree(tree.root, buffer);
+                coordinator.sendVector(buffer);
+            }
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error in XGBoost worker " << rank << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+#else
+
+bool XGBoost::fitDistributed(const Eigen::MatrixXd&, const Eigen::VectorXd&, int,
+                             const std::vector<std::string>&, const std::string&,
+                             const Eigen::VectorXd&, int) {
+    std::cerr << "Error: Distributed XGBoost training is only available on POSIX systems." << std::endl;
+    return false;
+}
+
+bool XGBoost::runDistributedWorker(int, uint16_t) {
+    std::cerr << "Error: Distributed XGBoost training is only available on POSIX systems." << std::endl;
+    return false;
+}
+
+#endif
@@ -26,12 +26,14 @@ Arguments:
     For learning_curve:
         --width: Width of the plot in inches
         --height: Height of the plot in inches
+        --x_label: Label of the X axis (default: Training Set Size)
+        --y_label: Label of the Y axis (default: Score)
         
     For nn_architecture:
         --layer_sizes: Comma-separated list of integers representing layer sizes
         
     For tree:
-        --tree_structure: JSON string representing the tree structure
+        --tree_structure: JSON page of tree nodes (read from --data_file if omitted)
 """
 
 import pandas as pd
@@ -111,9 +113,16 @@ def create_importance_plot(data, title, output_file, width=10, height=6):
     if 'importance' in data.columns and 'feature' in data.columns:
         data = data.sort_values('importance', ascending=True)
         
-        # Create horizontal bar plot
+        # Create horizontal bar plot, with error bars when the spread of
+        # repeated permutations is given
         y_pos = np.arange(len(data['feature']))
-        plt.barh(y_pos, data['importance'], align='center', height=0.5)
+        if 'std' in data.columns:
+            plt.barh(y_pos, data['importance'], xerr=data['std'], align='center', height=0.5,
+                     capsize=3, error_kw={'elinewidth': 1})
+            for pos, (mean, std) in enumerate(zip(data['importance'], data['std'])):
+                plt.text(mean + std, pos, f'  {mean:.3f} ± {std:.3f}', va='center', fontsize=7)
+        else:
+            plt.barh(y_pos, data['importance'], align='center', height=0.5)
         plt.yticks(y_pos, data['feature'], fontsize=8)
     else:
         # Handle the case where data is passed as a JSON string
@@ -173,18 +182,22 @@ def create_residual_plot(data, title, output_file, width=10, height=6):
     plt.savefig(output_file, format='png', dpi=150)
     plt.close()
 
-def create_learning_curve_plot(data, title, output_file, width=10, height=6):
+def create_learning_curve_plot(data, title, output_file, width=10, height=6,
+                               x_label='Training Set Size', y_label='Score'):
     """Create learning curve plot showing training and validation scores vs training sizes."""
     plt.figure(figsize=(width, height))
     
-    # Create learning curve plot
+    # Create learning curve plot; the validation column may be empty
     if all(col in data.columns for col in ['training_size', 'training_score', 'validation_score']):
-        plt.plot(data['training_size'], data['training_score'], 'o-', label='Training score')
-        plt.plot(data['training_size'], data['validation_score'], 'o-', label='Validation score')
+        # Long per-epoch curves are drawn without markers
+        style = 'o-' if len(data) <= 50 else '-'
+        plt.plot(data['training_size'], data['training_score'], style, label='Training score')
+        if data['validation_score'].notna().any():
+            plt.plot(data['training_size'], data['validation_score'], style, label='Validation score')
         
         # Add labels and title
-        plt.xlabel('Training Set Size')
-        plt.ylabel('Score')
+        plt.xlabel(x_label)
+        plt.ylabel(y_label)
         plt.title(title)
         plt.legend(loc='best')
         plt.grid(True, linestyle='--', alpha=0.7)
@@ -246,15 +259,72 @@ def create_neural_network_architecture_plot(layer_sizes, title, output_file, wid
     plt.close()
 
 def create_tree_visualization_plot(tree_structure, title, output_file, width=12, height=8):
-    """Create a decision tree visualization."""
-    # This is a simplified version - in a real implementation, you would parse the tree structure
-    # and use libraries like networkx to visualize it properly
+    """Create a decision tree visualization from a JSON page of nodes.
     
-    plt.figure(figsize=(width, height))
-    plt.text(0.5, 0.5, "Tree Visualization\n(Placeholder - Implement full tree viz)",
-             horizontalalignment='center', verticalalignment='center', fontsize=14)
-    plt.title(title)
-    plt.axis('off')
+    The page holds {"tree": t, "nodes": [...]} as written by TreeInspection::toJSON.
+    Split nodes whose children are not in the page are drawn as collapsed.
+    """
+    page = json.loads(tree_structure)
+    nodes = {node['id']: node for node in page['nodes']}
+    if not nodes:
+        raise ValueError("Tree structure contains no nodes")
+    root = page['nodes'][0]
+    
+    # Place the displayed leaves left to right and center parents over their children
+    positions = {}
+    next_slot = [0]
+    
+    def place(node_id):
+        node = nodes[node_id]
+        if node['leaf'] or not node.get('expanded', False):
+            positions[node_id] = next_slot[0]
+            next_slot[0] += 1
+        else:
+            place(node['left'])
+            place(node['right'])
+            positions[node_id] = (positions[node['left']] + positions[node['right']]) / 2.0
+    
+    place(root['id'])
+    
+    fig = plt.figure(figsize=(width, height))
+    ax = fig.gca()
+    ax.axis('off')
+    min_depth = root['depth']
+    max_depth = max(node['depth'] for node in nodes.values())
+    span = max(1, next_slot[0] - 1)
+    levels = max(1, max_depth - min_depth)
+    
+    def coords(node_id):
+        node = nodes[node_id]
+        return positions[node_id] / span, 1.0 - (node['depth'] - min_depth) / levels
+    
+    for node_id, node in nodes.items():
+        x, y = coords(node_id)
+        if not node['leaf'] and node.get('expanded', False):
+            for child, label in ((node['left'], 'yes'), (node['right'], 'no')):
+                cx, cy = coords(child)
+                ax.plot([x, cx], [y, cy], color='gray', linewidth=0.8, zorder=1)
+                ax.text((x + cx) / 2, (y + cy) / 2, label, fontsize=6, color='gray', ha='center')
+        
+        if node['leaf']:
+            text = f"value {node['value']:.4g}\ncover {node['cover']:.4g}"
+            color = '#d9ead3'
+        else:
+            if 'categories' in node:
+                condition = f"{node['feature']} in {node['categories']}"
+            else:
+                condition = f"{node['feature']} <= {node['threshold']:.4g}"
+            text = f"{condition}\ngain {node['gain']:.4g}\ncover {node['cover']:.4g}"
+            color = '#cfe2f3'
+            if not node.get('expanded', False):
+                text += f"\n[+{node['size'] - 1} nodes, id {node['id']}]"
+                color = '#eeeeee'
+        ax.text(x, y, text, fontsize=7, ha='center', va='center', zorder=2,
+                bbox=dict(boxstyle='round,pad=0.3', facecolor=color, edgecolor='gray'))
+    
+    ax.set_xlim(-0.08, 1.08)
+    ax.set_ylim(-0.1, 1.1)
+    plt.title(f"{title} (tree {page.get('tree', 0) + 1})")
     
     # Save plot
     plt.tight_layout()
@@ -289,6 +359,10 @@ def main():
                         help='Width of the plot in inches')
     parser.add_argument('--height', type=float, default=6.0, 
                         help='Height of the plot in inches')
+    parser.add_argument('--x_label', default='Training Set Size',
+                        help='Label of the X axis for learning curves')
+    parser.add_argument('--y_label', default='Score',
+                        help='Label of the Y axis for learning curves')
     parser.add_argument('--layer_sizes', 
                         help='Comma-separated list of integers representing layer sizes')
     parser.add_argument('--tree_structure', 
@@ -304,8 +378,8 @@ def main():
         # Create output directory if it doesn't exist
         os.makedirs(output_file.parent, exist_ok=True)
         
-        # Load data
-        data = pd.read_csv(data_file)
+        # Load data (tree pages are JSON, not CSV)
+        data = None if args.plot_type == 'tree' else pd.read_csv(data_file)
         
         # Process based on plot type
         if args.plot_type == 'scatter':
@@ -333,7 +407,8 @@ def main():
             create_importance_plot(data, args.title, str(output_file), args.width, args.height)
         
         elif args.plot_type == 'learning_curve':
-            create_learning_curve_plot(data, args.title, str(output_file), args.width, args.height)
+            create_learning_curve_plot(data, args.title, str(output_file), args.width, args.height,
+                                       args.x_label, args.y_label)
         
         elif args.plot_type == 'nn_architecture':
             if not args.layer_sizes:
@@ -343,10 +418,12 @@ def main():
                                                  args.width, args.height)
         
         elif args.plot_type == 'tree':
-            if not args.tree_structure:
-                raise ValueError("Tree visualization plots require tree_structure argument")
+            tree_structure = args.tree_structure
+            if not tree_structure:
+                with open(data_file) as f:
+                    tree_structure = f.read()
             
-            create_tree_visualization_plot(args.tree_structure, args.title, str(output_file), 
+            create_tree_visualization_plot(tree_structure, args.title, str(output_file), 
                                          args.width, args.height)
         
         print(f"Plot saved as: {output_file}")
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Helpers for writing and reading plain values in a byte buffer
+ *
+ * Values are stored in the byte order and layout of the machine that wrote
+ * them, so buffers are meant to be read back on the same platform (tree
+ * transfer between worker processes, training checkpoints). Readers advance
+ * an offset and throw std::runtime_error when the buffer ends early.
+ */
+namespace BinaryBuffer {
+
+template <typename T>
+void appendValue(std::vector<char>& buffer, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "appendValue needs a trivially copyable type");
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T readValue(const std::vector<char>& buffer, size_t& offset) {
+    static_assert(std::is_trivially_copyable<T>::value, "readValue needs a trivially copyable type");
+    if (offset + sizeof(T) > buffer.size()) {
+        throw std::runtime_error("Truncated binary data");
+    }
+    T value;
+    std::memcpy(&value, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+inline void appendString(std::vector<char>& buffer, const std::string& value) {
+    appendValue<uint64_t>(buffer, value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+inline std::string readString(const std::vector<char>& buffer, size_t& offset) {
+    uint64_t size = readValue<uint64_t>(buffer, offset);
+    if (size > buffer.size() - offset) {
+        throw std::runtime_error("Truncated binary data");
+    }
+    std::string value(buffer.data() + offset, static_cast<size_t>(size));
+    offset += static_cast<size_t>(size);
+    return value;
+}
+
+/**
+ * @brief Append a double matrix or vector as its dimensions and column-major values
+ */
+template <typename Derived>
+void appendMatrix(std::vector<char>& buffer, const Eigen::MatrixBase<Derived>& matrix) {
+    appendValue<int64_t>(buffer, matrix.rows());
+    appendValue<int64_t>(buffer, matrix.cols());
+    Eigen::MatrixXd values = matrix.template cast<double>();
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    buffer.insert(buffer.end(), bytes, bytes + values.size() * sizeof(double));
+}
+
+/**
+ * @brief Read a matrix written by appendMatrix
+ */
+inline Eigen::MatrixXd readMatrix(const std::vector<char>& buffer, size_t& offset) {
+    int64_t rows = readValue<int64_t>(buffer, offset);
+    int64_t cols = readValue<int64_t>(buffer, offset);
+    if (rows < 0 || cols < 0 ||
+        (rows > 0 && static_cast<uint64_t>(cols) > (buffer.size() - offset) / sizeof(double) / rows)) {
+        throw std::runtime_error("Truncated binary data");
+    }
+    Eigen::MatrixXd matrix(rows, cols);
+    std::memcpy(matrix.data(), buffer.data() + offset, matrix.size() * sizeof(double));
+    offset += matrix.size() * sizeof(double);
+    return matrix;
+}
+
+/**
+ * @brief Read a vector written by appendMatrix
+ */
+inline Eigen::VectorXd readVector(const std::vector<char>& buffer, size_t& offset) {
+    Eigen::MatrixXd matrix = readMatrix(buffer, offset);
+    if (matrix.cols() != 1 && matrix.size() != 0) {
+        throw std::runtime_error("Expected a vector in binary data");
+    }
+    return Eigen::Map<const Eigen::VectorXd>(matrix.data(), matrix.size());
+}
+
+inline void appendDoubles(std::vector<char>& buffer, const std::vector<double>& values) {
+    appendMatrix(buffer, Eigen::Map<const Eigen::VectorXd>(values.data(), values.size()));
+}
+
+inline std::vector<double> readDoubles(const std::vector<char>& buffer, size_t& offset) {
+    Eigen::VectorXd values = readVector(buffer, offset);
+    return std::vector<double>(values.data(), values.data() + values.size());
+}
+
+} // namespace BinaryBuffer
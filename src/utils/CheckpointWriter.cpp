@@ -0,0 +1,121 @@
+#include "utils/CheckpointWriter.h"
+#include "utils/BinaryBuffer.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t CHECKPOINT_MAGIC = 0x4B43424D;   // "MBCK"
+const uint32_t CHECKPOINT_VERSION = 1;
+
+} // namespace
+
+CheckpointWriter::CheckpointWriter(const std::string& filePath, const std::string& modelName)
+    : filePath(filePath), modelName(modelName), written(0), dropped(0), stopping(false) {
+    writer = std::thread([this]() { run(); });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    snapshotReady.notify_one();
+    writer.join();
+}
+
+void CheckpointWriter::submit(Snapshot snapshot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending) {
+            ++dropped;
+        }
+        pending = std::move(snapshot);
+    }
+    snapshotReady.notify_one();
+}
+
+size_t CheckpointWriter::getWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+size_t CheckpointWriter::getDropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+void CheckpointWriter::run() {
+    for (;;) {
+        Snapshot snapshot;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            snapshotReady.wait(lock, [this]() { return pending || stopping; });
+            if (!pending) {
+                return;
+            }
+            snapshot = std::move(pending);
+            pending = nullptr;
+        }
+
+        // Serializing and writing happen outside the lock, so submit never waits
+        try {
+            buffer.clear();
+            BinaryBuffer::appendValue<uint32_t>(buffer, CHECKPOINT_MAGIC);
+            BinaryBuffer::appendValue<uint32_t>(buffer, CHECKPOINT_VERSION);
+            BinaryBuffer::appendString(buffer, modelName);
+            snapshot(buffer);
+            writeFile();
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Could not write checkpoint " << filePath << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+void CheckpointWriter::writeFile() {
+    std::string temporaryPath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("cannot open " + temporaryPath);
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!file) {
+            throw std::runtime_error("write failed");
+        }
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(filePath.c_str());
+#endif
+    if (std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+        throw std::runtime_error("cannot replace " + filePath);
+    }
+}
+
+std::vector<char> CheckpointWriter::readPayload(const std::string& filePath, const std::string& modelName) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open checkpoint " + filePath);
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    size_t offset = 0;
+    if (BinaryBuffer::readValue<uint32_t>(contents, offset) != CHECKPOINT_MAGIC) {
+        throw std::runtime_error(filePath + " is not a checkpoint file");
+    }
+    uint32_t version = BinaryBuffer::readValue<uint32_t>(contents, offset);
+    if (version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+    }
+    std::string storedName = BinaryBuffer::readString(contents, offset);
+    if (storedName != modelName) {
+        throw std::runtime_error("Checkpoint was written by " + storedName + ", not " + modelName);
+    }
+    return std::vector<char>(contents.begin() + offset, contents.end());
+}
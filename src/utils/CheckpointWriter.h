@@ -0,0 +1,98 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Writes training checkpoints to disk on a background thread
+ *
+ * The training loop hands over a snapshot as a callable that appends the
+ * checkpoint payload to a byte buffer. The callable should capture copies of
+ * the state it writes; it runs on the writer thread, together with the file
+ * I/O, so submitting never waits for the disk. If a snapshot is still
+ * waiting when the next one arrives, the older one is dropped: only the
+ * newest state matters for a resume.
+ *
+ * Each checkpoint is written to a temporary file that is then renamed over
+ * the previous checkpoint, so a crash during a write leaves the last
+ * complete checkpoint in place. Files start with a magic number, a format
+ * version and the model name, which readPayload checks. Write errors are
+ * reported on std::cerr and do not interrupt training.
+ */
+class CheckpointWriter {
+public:
+    using Snapshot = std::function<void(std::vector<char>&)>;
+
+    /**
+     * @brief Start the writer thread
+     *
+     * @param filePath Path of the checkpoint file
+     * @param modelName Name of the model stored in the file header
+     */
+    CheckpointWriter(const std::string& filePath, const std::string& modelName);
+
+    /**
+     * @brief Write the pending snapshot, if any, and stop the writer thread
+     */
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * @brief Queue a snapshot for writing
+     *
+     * Replaces a snapshot that has not been started yet.
+     *
+     * @param snapshot Callable appending the checkpoint payload to a buffer
+     */
+    void submit(Snapshot snapshot);
+
+    /**
+     * @brief Get the number of checkpoints written so far
+     *
+     * @return size_t Number of completed writes
+     */
+    size_t getWritten() const;
+
+    /**
+     * @brief Get the number of snapshots replaced before they were written
+     *
+     * @return size_t Number of dropped snapshots
+     */
+    size_t getDropped() const;
+
+    /**
+     * @brief Read the payload of a checkpoint file
+     *
+     * @param filePath Path of the checkpoint file
+     * @param modelName Model name the file must have been written for
+     * @return std::vector<char> Payload following the header
+     * @throws std::runtime_error If the file cannot be read or belongs to another model or format version
+     */
+    static std::vector<char> readPayload(const std::string& filePath, const std::string& modelName);
+
+private:
+    std::string filePath;
+    std::string modelName;
+    Snapshot pending;
+    std::vector<char> buffer;       // Used only by the writer thread
+    size_t written;
+    size_t dropped;
+    bool stopping;
+    mutable std::mutex mutex;
+    std::condition_variable snapshotReady;
+    std::thread writer;
+
+    void run();
+
+    /**
+     * @brief Replace the checkpoint file with the contents of buffer
+     */
+    void writeFile();
+};
@@ -9,8 +9,11 @@
 #include <iomanip>
 #include <sstream>
 #include <filesystem>
+#include <cstdlib>
+#ifdef _WIN32
 #include <windows.h>
 #include <shlobj.h>  // For SHGetFolderPathA and CSIDL_LOCAL_APPDATA
+#endif
 
 enum class LogLevel {
     DEBUG,
@@ -65,12 +68,13 @@ public:
         std::ofstream logFile;
         static bool firstLog = true;
 
-        // Get the application data directory for Windows
-        char appDataPath[MAX_PATH];
-        if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, appDataPath))) {
-            std::filesystem::path logDir = std::filesystem::path(appDataPath) / "Model_Builder_Tool" / "logs";
-            std::filesystem::create_directories(logDir);
-            
+        // Get the per-user log directory
+        std::filesystem::path logDir = logDirectory();
+        std::error_code error;
+        if (!logDir.empty()) {
+            std::filesystem::create_directories(logDir, error);
+        }
+        if (!logDir.empty() && !error) {
             std::filesystem::path logPath = logDir / "application.log";
             
             if (firstLog) {
@@ -100,7 +104,11 @@ public:
         auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
         
         std::tm now_tm;
+#ifdef _WIN32
         localtime_s(&now_tm, &now_time_t);
+#else
+        localtime_r(&now_time_t, &now_tm);
+#endif
         
         std::stringstream ss;
         ss << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << now_ms.count();
@@ -128,10 +136,10 @@ public:
 private:
     Logger() : m_logLevel(LogLevel::DEBUG) {
         // Initialize logging directory on construction
-        char appDataPath[MAX_PATH];
-        if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, appDataPath))) {
-            std::filesystem::path logDir = std::filesystem::path(appDataPath) / "Model_Builder_Tool" / "logs";
-            std::filesystem::create_directories(logDir);
+        std::filesystem::path logDir = logDirectory();
+        if (!logDir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(logDir, error);
         }
     }
     ~Logger() = default;
@@ -140,6 +148,27 @@ private:
 
     LogLevel m_logLevel;
     std::mutex m_mutex;
+
+    // Per-user directory of the log file, empty if it cannot be determined
+    static std::filesystem::path logDirectory() {
+#ifdef _WIN32
+        char appDataPath[MAX_PATH];
+        if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, appDataPath))) {
+            return std::filesystem::path(appDataPath) / "Model_Builder_Tool" / "logs";
+        }
+#else
+        // XDG state directory, which defaults to ~/.local/state
+        const char* stateHome = std::getenv("XDG_STATE_HOME");
+        if (stateHome && *stateHome) {
+            return std::filesystem::path(stateHome) / "Model_Builder_Tool" / "logs";
+        }
+        const char* home = std::getenv("HOME");
+        if (home && *home) {
+            return std::filesystem::path(home) / ".local" / "state" / "Model_Builder_Tool" / "logs";
+        }
+#endif
+        return {};
+    }
 };
 
 #define LOG_DEBUG(message, component) Logger::getInstance().debug(message, component)
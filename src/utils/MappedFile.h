@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The contents are paged in by the operating system on first access, so
+ * opening a large file is cheap and only the parts that are read cost I/O.
+ * The mapping starts on a page boundary, so data at aligned file offsets is
+ * aligned in memory as well. Uses mmap on POSIX systems and a file mapping
+ * on Windows.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file
+     *
+     * @param filePath Path of the file
+     * @throws std::runtime_error If the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& filePath);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Get the start of the mapped contents
+     *
+     * @return const char* First byte of the file (nullptr for an empty file)
+     */
+    const char* data() const { return contents; }
+
+    /**
+     * @brief Get the file size
+     *
+     * @return size_t Number of mapped bytes
+     */
+    size_t size() const { return length; }
+
+    /**
+     * @brief Get the path the file was mapped from
+     *
+     * @return const std::string& File path
+     */
+    const std::string& path() const { return filePath; }
+
+private:
+    std::string filePath;
+    const char* contents;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
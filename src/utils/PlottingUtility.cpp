@@ -2,18 +2,15 @@
 #include <algorithm>
 #include <filesystem>
 #include <string>
-#include <windows.h>
 
 // Static method to get the path to the plotting script
 std::filesystem::path PlottingUtility::getPlottingScriptPath() {
-    // Get the executable path
-    char execPath[MAX_PATH];
-    if (GetModuleFileNameA(NULL, execPath, MAX_PATH) == 0) {
+    // Get the directory containing the executable
+    std::string execDir = getExecutableDir();
+    if (execDir.empty()) {
         return {};
     }
-    
-    // Get the directory containing the executable
-    std::filesystem::path appDir = std::filesystem::path(execPath).parent_path();
+    std::filesystem::path appDir(execDir);
     
     // Check for the plotting script in various locations
     std::vector<std::filesystem::path> possibleLocations = {
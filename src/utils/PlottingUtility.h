@@ -10,10 +10,14 @@
 #include <chrono>
 #include <algorithm>  // Add algorithm before Windows.h
 
+#ifdef _WIN32
 // Prevent Windows from defining min/max macros
 #define NOMINMAX
 #include <windows.h>
 #include <shlobj.h>  // For SHGetFolderPathA and CSIDL_LOCAL_APPDATA
+#else
+#include <unistd.h>
+#endif
 
 #include <Eigen/Dense>
 #include "data/DataFrame.h"
@@ -43,17 +47,18 @@ public:
         const std::string& title = "Linear Regression Results") 
     {
         try {
-            // Get Windows temp directory
-            char tempPath[MAX_PATH];
-            if (GetTempPathA(MAX_PATH, tempPath) == 0) {
+            // Get the system temp directory
+            std::error_code tempError;
+            fs::path tempPath = fs::temp_directory_path(tempError);
+            if (tempError) {
                 std::cerr << "Error: Failed to get temp directory" << std::endl;
                 return "";
             }
 
             // Create a unique subdirectory for our temporary files
-            std::string uniqueDir = std::to_string(GetCurrentProcessId()) + "_" + 
+            std::string uniqueDir = std::to_string(getProcessId()) + "_" + 
                                   std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
-            fs::path tempDir = fs::path(tempPath) / "Model_Builder_Tool" / uniqueDir;
+            fs::path tempDir = tempPath / "Model_Builder_Tool" / uniqueDir;
             fs::create_directories(tempDir);
             
             // Create paths for temporary files
@@ -143,17 +148,18 @@ public:
                 return "";
             }
 
-            // Get Windows temp directory
-            char tempPath[MAX_PATH];
-            if (GetTempPathA(MAX_PATH, tempPath) == 0) {
+            // Get the system temp directory
+            std::error_code tempError;
+            fs::path tempPath = fs::temp_directory_path(tempError);
+            if (tempError) {
                 std::cerr << "Error: Failed to get temp directory" << std::endl;
                 return "";
             }
 
             // Create a unique subdirectory for our temporary files
-            std::string uniqueDir = std::to_string(GetCurrentProcessId()) + "_" + 
+            std::string uniqueDir = std::to_string(getProcessId()) + "_" + 
                                     std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
-            fs::path tempDir = fs::path(tempPath) / "Model_Builder_Tool" / uniqueDir;
+            fs::path tempDir = tempPath / "Model_Builder_Tool" / uniqueDir;
             fs::create_directories(tempDir);
             
             // Create paths for temporary files
@@ -250,17 +256,18 @@ public:
                 return "";
             }
 
-            // Get Windows temp directory
-            char tempPath[MAX_PATH];
-            if (GetTempPathA(MAX_PATH, tempPath) == 0) {
+            // Get the system temp directory
+            std::error_code tempError;
+            fs::path tempPath = fs::temp_directory_path(tempError);
+            if (tempError) {
                 std::cerr << "Error: Failed to get temp directory" << std::endl;
                 return "";
             }
 
             // Create a unique subdirectory for our temporary files
-            std::string uniqueDir = std::to_string(GetCurrentProcessId()) + "_" + 
+            std::string uniqueDir = std::to_string(getProcessId()) + "_" + 
                                     std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
-            fs::path tempDir = fs::path(tempPath) / "Model_Builder_Tool" / uniqueDir;
+            fs::path tempDir = tempPath / "Model_Builder_Tool" / uniqueDir;
             fs::create_directories(tempDir);
             
             // Create paths for temporary files
@@ -451,9 +458,15 @@ private:
      * @return std::string Path to the executable directory
      */
     static std::string getExecutableDir() {
+#ifdef _WIN32
         char buffer[MAX_PATH];
         GetModuleFileNameA(NULL, buffer, MAX_PATH);
         return fs::path(buffer).parent_path().string();
+#else
+        std::error_code error;
+        fs::path executable = fs::read_symlink("/proc/self/exe", error);
+        return error ? "" : executable.parent_path().string();
+#endif
     }
     
     /**
@@ -462,10 +475,35 @@ private:
      * @return std::string Path to the AppData directory
      */
     static std::string getAppDataDir() {
+#ifdef _WIN32
         char path[MAX_PATH];
         if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, path))) {
             return std::string(path);
         }
+#else
+        // XDG data directory, which defaults to ~/.local/share
+        const char* dataHome = std::getenv("XDG_DATA_HOME");
+        if (dataHome && *dataHome) {
+            return std::string(dataHome);
+        }
+        const char* home = std::getenv("HOME");
+        if (home && *home) {
+            return (fs::path(home) / ".local" / "share").string();
+        }
+#endif
         return "";
     }
+
+    /**
+     * @brief Get the ID of the running process
+     * 
+     * @return unsigned long Process ID
+     */
+    static unsigned long getProcessId() {
+#ifdef _WIN32
+        return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "utils/RingAllreduce.h"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const size_t INLINE_SEND_BYTES = 8192;
+
+} // namespace
+
+RingAllreduce::RingAllreduce(int rank, int worldSize, SocketListener& listener,
+                             const std::vector<uint16_t>& ports)
+    : rank(rank), worldSize(worldSize) {
+    if (worldSize < 1 || rank < 0 || rank >= worldSize ||
+        ports.size() != static_cast<size_t>(worldSize)) {
+        throw std::invalid_argument("Invalid ring configuration");
+    }
+    if (worldSize == 1) {
+        return;
+    }
+    next = SocketChannel::connectTo(ports[(rank + 1) % worldSize]);
+    previous = listener.accept();
+}
+
+void RingAllreduce::exchange(const double* sendData, size_t sendCount, size_t receiveCount) {
+    incoming.resize(receiveCount);
+
+    // Small chunks fit in the socket buffers, so a plain send cannot block
+    if (sendCount * sizeof(double) <= INLINE_SEND_BYTES) {
+        next.send(sendData, sendCount * sizeof(double));
+        previous.receive(incoming.data(), receiveCount * sizeof(double));
+        return;
+    }
+
+    std::exception_ptr sendError;
+    std::thread sender([&]() {
+        try {
+            next.send(sendData, sendCount * sizeof(double));
+        } catch (...) {
+            sendError = std::current_exception();
+        }
+    });
+    try {
+        previous.receive(incoming.data(), receiveCount * sizeof(double));
+    } catch (...) {
+        sender.join();
+        throw;
+    }
+    sender.join();
+    if (sendError) {
+        std::rethrow_exception(sendError);
+    }
+}
+
+void RingAllreduce::sum(std::vector<double>& values) {
+    if (worldSize == 1 || values.empty()) {
+        return;
+    }
+
+    // Chunk c covers [begin(c), begin(c + 1))
+    size_t n = values.size();
+    size_t parts = static_cast<size_t>(worldSize);
+    auto begin = [n, parts](size_t chunk) { return chunk * n / parts; };
+    auto chunkAt = [this](int offset) {
+        return static_cast<size_t>(((rank + offset) % worldSize + worldSize) % worldSize);
+    };
+
+    // Reduce-scatter: after step s this worker holds the partial sum of
+    // chunk (rank - s - 1) over s + 2 workers
+    for (int step = 0; step < worldSize - 1; ++step) {
+        size_t sendChunk = chunkAt(-step);
+        size_t receiveChunk = chunkAt(-step - 1);
+        exchange(values.data() + begin(sendChunk), begin(sendChunk + 1) - begin(sendChunk),
+                 begin(receiveChunk + 1) - begin(receiveChunk));
+        double* target = values.data() + begin(receiveChunk);
+        for (size_t i = 0; i < incoming.size(); ++i) {
+            target[i] += incoming[i];
+        }
+    }
+
+    // Allgather: chunk (rank + 1) is now complete here; pass the complete chunks on
+    for (int step = 0; step < worldSize - 1; ++step) {
+        size_t sendChunk = chunkAt(1 - step);
+        size_t receiveChunk = chunkAt(-step);
+        exchange(values.data() + begin(sendChunk), begin(sendChunk + 1) - begin(sendChunk),
+                 begin(receiveChunk + 1) - begin(receiveChunk));
+        std::copy(incoming.begin(), incoming.end(), values.begin() + begin(receiveChunk));
+    }
+}
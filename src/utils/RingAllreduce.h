@@ -0,0 +1,80 @@
+#pragma once
+
+#include "utils/SocketChannel.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Element-wise sum of a buffer across worker processes over a TCP ring
+ *
+ * Every worker is connected to the next worker and accepts a connection from
+ * the previous one. A sum runs as a reduce-scatter followed by an allgather:
+ * the buffer is cut into one chunk per worker, each chunk is accumulated
+ * while it travels once around the ring, and the finished chunks travel
+ * around again. Each worker sends and receives about twice the buffer size
+ * regardless of the number of workers.
+ *
+ * Every element of the result is added up by exactly one worker and copied
+ * to the others, so all workers end up with bitwise identical sums. Callers
+ * that take decisions from the sums (e.g. tree splits) therefore agree.
+ */
+class RingAllreduce {
+public:
+    /**
+     * @brief Connect a worker to its ring neighbours
+     *
+     * Each worker connects to the listener of worker (rank + 1) % worldSize
+     * and accepts one connection on its own listener. The connect is queued
+     * by the listener backlog, so all workers may call this at the same time.
+     *
+     * @param rank Rank of this worker
+     * @param worldSize Number of workers
+     * @param listener Listener of this worker, whose port is ports[rank]
+     * @param ports Listener ports of all workers, indexed by rank
+     * @throws std::runtime_error If a connection fails
+     */
+    RingAllreduce(int rank, int worldSize, SocketListener& listener,
+                  const std::vector<uint16_t>& ports);
+
+    /**
+     * @brief Sum a buffer across all workers in place
+     *
+     * All workers must call this with buffers of the same size, in the same order.
+     *
+     * @param values Local values on input, global sums on output
+     */
+    void sum(std::vector<double>& values);
+
+    /**
+     * @brief Get the rank of this worker
+     *
+     * @return int Rank in [0, worldSize)
+     */
+    int getRank() const { return rank; }
+
+    /**
+     * @brief Get the number of workers
+     *
+     * @return int Number of workers
+     */
+    int getWorldSize() const { return worldSize; }
+
+private:
+    int rank;
+    int worldSize;
+    SocketChannel next;
+    SocketChannel previous;
+    std::vector<double> incoming;
+
+    /**
+     * @brief Send one chunk to the next worker while receiving one from the previous
+     *
+     * Large sends run on a helper thread so that they cannot deadlock the
+     * ring when every socket buffer is full.
+     *
+     * @param sendData First element to send
+     * @param sendCount Number of elements to send
+     * @param receiveCount Number of elements to receive into incoming
+     */
+    void exchange(const double* sendData, size_t sendCount, size_t receiveCount);
+};
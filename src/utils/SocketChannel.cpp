@@ -0,0 +1,235 @@
+#include "utils/SocketChannel.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error socketError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+SocketChannel::SocketChannel() : fd(-1) {
+}
+
+SocketChannel::SocketChannel(int fd) : fd(fd) {
+    // Histogram messages are latency bound, so do not wait to coalesce them
+    int flag = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+SocketChannel::~SocketChannel() {
+    close();
+}
+
+SocketChannel::SocketChannel(SocketChannel&& other) noexcept : fd(other.fd) {
+    other.fd = -1;
+}
+
+SocketChannel& SocketChannel::operator=(SocketChannel&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = other.fd;
+        other.fd = -1;
+    }
+    return *this;
+}
+
+SocketChannel SocketChannel::connectTo(uint16_t port) {
+    int socketFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socketFd < 0) {
+        throw socketError("Could not create socket");
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::runtime_error error = socketError("Could not connect to port " + std::to_string(port));
+        ::close(socketFd);
+        throw error;
+    }
+    return SocketChannel(socketFd);
+}
+
+void SocketChannel::send(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw socketError("Socket send failed");
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+void SocketChannel::receive(void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(fd, bytes, size, 0);
+        if (received == 0) {
+            throw std::runtime_error("Connection closed by peer");
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw socketError("Socket receive failed");
+        }
+        bytes += received;
+        size -= static_cast<size_t>(received);
+    }
+}
+
+void SocketChannel::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+SocketListener::SocketListener(int backlog) : fd(-1), port(0) {
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw socketError("Could not create socket");
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(fd, backlog) < 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) < 0) {
+        std::runtime_error error = socketError("Could not listen on loopback");
+        close();
+        throw error;
+    }
+    port = ntohs(address.sin_port);
+}
+
+SocketListener::~SocketListener() {
+    close();
+}
+
+SocketChannel SocketListener::accept() {
+    while (true) {
+        int connection = ::accept(fd, nullptr, nullptr);
+        if (connection >= 0) {
+            return SocketChannel(connection);
+        }
+        if (errno != EINTR) {
+            throw socketError("Accepting a connection failed");
+        }
+    }
+}
+
+bool SocketListener::waitForConnection(int timeoutMs) {
+    pollfd request{};
+    request.fd = fd;
+    request.events = POLLIN;
+    int ready = ::poll(&request, 1, timeoutMs);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return false;
+        }
+        throw socketError("Waiting for a connection failed");
+    }
+    return ready > 0;
+}
+
+void SocketListener::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+#else
+
+SocketChannel::SocketChannel() : fd(-1) {
+}
+
+SocketChannel::SocketChannel(int) : fd(-1) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+SocketChannel::~SocketChannel() {
+}
+
+SocketChannel::SocketChannel(SocketChannel&& other) noexcept : fd(other.fd) {
+    other.fd = -1;
+}
+
+SocketChannel& SocketChannel::operator=(SocketChannel&& other) noexcept {
+    fd = other.fd;
+    other.fd = -1;
+    return *this;
+}
+
+SocketChannel SocketChannel::connectTo(uint16_t) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+void SocketChannel::send(const void*, size_t) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+void SocketChannel::receive(void*, size_t) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+void SocketChannel::close() {
+    fd = -1;
+}
+
+SocketListener::SocketListener(int) : fd(-1), port(0) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+SocketListener::~SocketListener() {
+}
+
+SocketChannel SocketListener::accept() {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+bool SocketListener::waitForConnection(int) {
+    throw std::runtime_error("Socket channels are only available on POSIX systems");
+}
+
+void SocketListener::close() {
+    fd = -1;
+}
+
+#endif
+
+void SocketChannel::sendString(const std::string& value) {
+    sendValue<uint64_t>(value.size());
+    send(value.data(), value.size());
+}
+
+std::string SocketChannel::receiveString() {
+    std::string value(static_cast<size_t>(receiveValue<uint64_t>()), '\0');
+    if (!value.empty()) {
+        receive(&value[0], value.size());
+    }
+    return value;
+}
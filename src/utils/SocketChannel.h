@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Blocking, message-oriented TCP connection on the loopback interface
+ *
+ * Used by the local multi-process trainers to exchange configuration, data
+ * shards and histograms. Every transfer either completes in full or throws
+ * std::runtime_error, so a peer that dies surfaces as an exception rather
+ * than a hang. Only available on POSIX systems; on Windows the constructors
+ * throw.
+ */
+class SocketChannel {
+public:
+    SocketChannel();
+
+    /**
+     * @brief Take ownership of a connected socket
+     *
+     * @param fd Connected socket descriptor
+     */
+    explicit SocketChannel(int fd);
+
+    ~SocketChannel();
+
+    SocketChannel(SocketChannel&& other) noexcept;
+    SocketChannel& operator=(SocketChannel&& other) noexcept;
+    SocketChannel(const SocketChannel&) = delete;
+    SocketChannel& operator=(const SocketChannel&) = delete;
+
+    /**
+     * @brief Connect to a listener on 127.0.0.1
+     *
+     * @param port Port of the listener
+     * @return SocketChannel Connected channel
+     * @throws std::runtime_error If the connection cannot be made
+     */
+    static SocketChannel connectTo(uint16_t port);
+
+    /**
+     * @brief Send a block of bytes
+     *
+     * @param data Bytes to send
+     * @param size Number of bytes
+     */
+    void send(const void* data, size_t size);
+
+    /**
+     * @brief Receive exactly size bytes
+     *
+     * @param data Destination buffer
+     * @param size Number of bytes
+     * @throws std::runtime_error If the peer closes the connection first
+     */
+    void receive(void* data, size_t size);
+
+    /**
+     * @brief Send a trivially copyable value
+     */
+    template <typename T>
+    void sendValue(const T& value) {
+        send(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Receive a trivially copyable value
+     */
+    template <typename T>
+    T receiveValue() {
+        T value;
+        receive(&value, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Send a length-prefixed vector of trivially copyable values
+     */
+    template <typename T>
+    void sendVector(const std::vector<T>& values) {
+        sendValue<uint64_t>(values.size());
+        if (!values.empty()) {
+            send(values.data(), values.size() * sizeof(T));
+        }
+    }
+
+    /**
+     * @brief Receive a vector sent with sendVector
+     */
+    template <typename T>
+    std::vector<T> receiveVector() {
+        std::vector<T> values(static_cast<size_t>(receiveValue<uint64_t>()));
+        if (!values.empty()) {
+            receive(values.data(), values.size() * sizeof(T));
+        }
+        return values;
+    }
+
+    /**
+     * @brief Send a length-prefixed string
+     */
+    void sendString(const std::string& value);
+
+    /**
+     * @brief Receive a string sent with sendString
+     */
+    std::string receiveString();
+
+    /**
+     * @brief Check whether the channel holds a socket
+     *
+     * @return bool True if connected
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Close the connection
+     */
+    void close();
+
+private:
+    int fd;
+};
+
+/**
+ * @brief Listening TCP socket on 127.0.0.1 with a kernel-assigned port
+ */
+class SocketListener {
+public:
+    /**
+     * @brief Bind to an ephemeral loopback port and start listening
+     *
+     * @param backlog Maximum number of pending connections
+     * @throws std::runtime_error If the socket cannot be created
+     */
+    explicit SocketListener(int backlog = 64);
+
+    ~SocketListener();
+
+    SocketListener(const SocketListener&) = delete;
+    SocketListener& operator=(const SocketListener&) = delete;
+
+    /**
+     * @brief Get the port the listener is bound to
+     *
+     * @return uint16_t Port number
+     */
+    uint16_t getPort() const { return port; }
+
+    /**
+     * @brief Wait for the next incoming connection
+     *
+     * @return SocketChannel Connected channel
+     */
+    SocketChannel accept();
+
+    /**
+     * @brief Wait until a connection is pending or the timeout expires
+     *
+     * Lets a caller check on its peers between waits instead of blocking in
+     * accept for a peer that may never connect.
+     *
+     * @param timeoutMs Longest wait in milliseconds
+     * @return bool True if accept will not block
+     * @throws std::runtime_error If polling the socket fails
+     */
+    bool waitForConnection(int timeoutMs);
+
+    /**
+     * @brief Stop listening
+     */
+    void close();
+
+private:
+    int fd;
+    uint16_t port;
+};
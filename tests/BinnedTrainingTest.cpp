@@ -0,0 +1,173 @@
+#include "Check.h"
+#include "data/BinnedMatrix.h"
+#include "models/GradientBoosting.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks the out-of-core path from a CSV file to a binned tree model
+ *
+ * The bin cuts sketched in a streaming pass over a CSV file must lie within
+ * the sketch's documented rank error of the exact quantiles, and be exact
+ * for columns with fewer distinct values than bins. Tree models trained on
+ * the binned copy of a file must reach about the RMSE of the same models
+ * trained on the raw rows in memory.
+ */
+
+namespace {
+
+const std::string csvPath = "BinnedTrainingTest.csv";
+const std::string binnedPath = "BinnedTrainingTest.bin";
+
+double target(const double* x, std::mt19937& generator) {
+    std::normal_distribution<double> noise(0.0, 0.3);
+    double a = std::isnan(x[0]) ? 0.5 : x[0];
+    return std::sin(2.0 * a) + x[1] * x[1] - 0.5 * x[2] + (x[3] > 2.0 ? 1.0 : 0.0) + noise(generator);
+}
+
+void randomRow(double* x, std::mt19937& generator) {
+    // Quantile bins are wide in long tails, so the squared feature is bounded
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(-2.0, 2.0);
+    std::exponential_distribution<double> exponential(1.0);
+    x[0] = normal(generator);
+    x[1] = uniform(generator);
+    x[2] = exponential(generator);
+    x[3] = static_cast<double>(generator() % 5);
+}
+
+void checkSketchCuts() {
+    const int rows = 200000;
+    const int maxBins = 64;
+    std::mt19937 generator(2);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::exponential_distribution<double> exponential(1.0);
+    std::vector<std::vector<double>> columns(3, std::vector<double>(rows));
+    std::ofstream out(csvPath);
+    out.precision(17);
+    out << "normal,exponential,level\n";
+    for (int i = 0; i < rows; ++i) {
+        columns[0][i] = normal(generator);
+        columns[1][i] = exponential(generator);
+        columns[2][i] = static_cast<double>(generator() % 7);
+        out << columns[0][i] << "," << columns[1][i] << "," << columns[2][i] << "\n";
+    }
+    out.close();
+
+    // The default sketch keeps 256 entries and buffers 4096 values
+    double buffers = std::ceil(rows / 4096.0);
+    double bound = (std::log2(buffers) + 2.0) / 255.0;
+    for (int threads : {1, 4}) {
+        auto cuts = BinnedMatrix::computeCutsFromCSV(csvPath, {"normal", "exponential", "level"}, maxBins, 10000,
+                                                     threads);
+        for (int c = 0; c < 2; ++c) {
+            std::vector<double> sorted = columns[c];
+            std::sort(sorted.begin(), sorted.end());
+            CHECK_MSG(cuts[c].size() == maxBins - 1, "column " + std::to_string(c));
+            double worst = 0.0;
+            for (size_t k = 0; k < cuts[c].size(); ++k) {
+                double rank = static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), cuts[c][k]) -
+                                                  sorted.begin()) / rows;
+                worst = std::max(worst, std::abs(rank - static_cast<double>(k + 1) / maxBins));
+            }
+            CHECK_MSG(worst <= bound, "column " + std::to_string(c) + " threads " + std::to_string(threads) +
+                                          ": rank error " + std::to_string(worst));
+        }
+        CHECK((cuts[2] == std::vector<double>{0, 1, 2, 3, 4, 5}));
+    }
+    std::remove(csvPath.c_str());
+}
+
+template <typename TreeModel>
+void checkBinnedTraining(TreeModel& inMemory, TreeModel& binned, const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+                         const Eigen::MatrixXd& testX, const Eigen::VectorXd& testY) {
+    const std::vector<std::string> names = {"a", "b", "c", "d"};
+    CHECK(inMemory.fit(X, y, names, "y"));
+
+    auto cuts = BinnedMatrix::computeCutsFromCSV(csvPath, names);
+    size_t rows = BinnedMatrix::writeBinnedCSV(csvPath, names, "y", cuts, binnedPath);
+    CHECK(rows == static_cast<size_t>(y.size()));
+    Eigen::VectorXd binnedY;
+    BinnedMatrix data = BinnedMatrix::load(binnedPath, binnedY);
+    CHECK(binnedY == y);
+    CHECK(binned.fitBinned(data, binnedY));
+    std::remove(binnedPath.c_str());
+
+    double inMemoryRmse = std::sqrt((inMemory.predict(testX) - testY).squaredNorm() / testY.size());
+    double binnedRmse = std::sqrt((binned.predict(testX) - testY).squaredNorm() / testY.size());
+    CHECK_MSG(binnedRmse <= 1.1 * inMemoryRmse, binned.getName() + ": binned RMSE " + std::to_string(binnedRmse) +
+                                                    ", in memory " + std::to_string(inMemoryRmse));
+}
+
+} // namespace
+
+int main() {
+    checkSketchCuts();
+
+    // Training rows go to a CSV file, with some missing inputs and targets;
+    // the rows with a target are also kept in memory
+    const int rows = 20000;
+    std::mt19937 generator(3);
+    Eigen::MatrixXd X(rows, 4);
+    Eigen::VectorXd y(rows);
+    Eigen::Index kept = 0;
+    std::ofstream out(csvPath);
+    out.precision(17);
+    out << "a,b,c,d,y\n";
+    for (int i = 0; i < rows; ++i) {
+        double x[4];
+        randomRow(x, generator);
+        if (i % 10 == 0) {
+            x[0] = std::nan("");
+        }
+        double value = target(x, generator);
+        for (int j = 0; j < 4; ++j) {
+            out << (std::isnan(x[j]) ? std::string("") : std::to_string(x[j])) << ",";
+        }
+        if (i % 50 == 7) {
+            out << "\n";
+            continue;
+        }
+        out << value << "\n";
+        // Keep the values as written, so both paths see the same data
+        for (int j = 0; j < 4; ++j) {
+            X(kept, j) = std::isnan(x[j]) ? x[j] : std::stod(std::to_string(x[j]));
+        }
+        y(kept) = value;
+        ++kept;
+    }
+    out.close();
+    X.conservativeResize(kept, Eigen::NoChange);
+    y.conservativeResize(kept);
+
+    Eigen::MatrixXd testX(5000, 4);
+    Eigen::VectorXd testY(5000);
+    for (Eigen::Index i = 0; i < testX.rows(); ++i) {
+        double x[4];
+        randomRow(x, generator);
+        testX.row(i) << x[0], x[1], x[2], x[3];
+        testY(i) = target(x, generator);
+    }
+
+    RandomForest forest(30, 10, 2, 1, "all", true);
+    RandomForest binnedForest(30, 10, 2, 1, "all", true);
+    checkBinnedTraining(forest, binnedForest, X, y, testX, testY);
+
+    GradientBoosting boosting(0.1, 150, 4, 2, 1, 1.0, "squared_error");
+    GradientBoosting binnedBoosting(0.1, 150, 4, 2, 1, 1.0, "squared_error");
+    checkBinnedTraining(boosting, binnedBoosting, X, y, testX, testY);
+
+    XGBoost xgboost(0.1, 5, 150, 1.0, 1.0, 1, 0.0);
+    XGBoost binnedXgboost(0.1, 5, 150, 1.0, 1.0, 1, 0.0);
+    checkBinnedTraining(xgboost, binnedXgboost, X, y, testX, testY);
+
+    std::remove(csvPath.c_str());
+    return Check::exitCode();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Minimal checks for the standalone test programs in tests/
+ *
+ * Each test is a small executable built from its own .cpp file and the
+ * data/ and models/ sources. A failed CHECK prints the file, line and
+ * condition and the test carries on; main returns Check::exitCode() so
+ * the program exits non-zero if any check failed.
+ */
+namespace Check {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void report(bool ok, const char* condition, const std::string& context, const char* file, int line) {
+    if (!ok) {
+        ++failures();
+        std::cerr << file << ":" << line << ": check failed: " << condition;
+        if (!context.empty()) {
+            std::cerr << " (" << context << ")";
+        }
+        std::cerr << std::endl;
+    }
+}
+
+inline int exitCode() {
+    if (failures() > 0) {
+        std::cerr << failures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
+
+} // namespace Check
+
+#define CHECK(condition) Check::report(static_cast<bool>(condition), #condition, "", __FILE__, __LINE__)
+#define CHECK_MSG(condition, context) \
+    Check::report(static_cast<bool>(condition), #condition, context, __FILE__, __LINE__)
@@ -0,0 +1,104 @@
+#include "Check.h"
+#include "data/BinnedMatrix.h"
+#include "models/GradientBoosting.h"
+#include "models/NeuralNetwork.h"
+#include "models/XGBoost.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks that a fit resumed from a checkpoint equals an uninterrupted one
+ *
+ * A fit with a fixed seed is stopped early, with checkpoints written along
+ * the way. A fresh model loads the last checkpoint and fits the same rows up
+ * to the full length; its predictions must be bit-identical to those of one
+ * fit that ran the full length with the same seed. Row and column sampling
+ * are on, so the generator state in the checkpoint matters. With the seed,
+ * two binned fits must also agree.
+ */
+
+namespace {
+
+const std::string checkpointPath = "CheckpointResumeTest.ckpt";
+
+bool samePredictions(const Model& a, const Model& b, const Eigen::MatrixXd& X) {
+    return (a.predict(X).array() == b.predict(X).array()).all();
+}
+
+// make(length) builds a seeded model that trains for length trees or epochs
+template <typename Make>
+void checkResume(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, Make make, int shortLength, int fullLength) {
+    const std::vector<std::string> names = {"a", "b", "c"};
+
+    auto uninterrupted = make(fullLength);
+    CHECK(uninterrupted->fit(X, y, names, "target"));
+
+    auto interrupted = make(shortLength);
+    interrupted->setCheckpoint(checkpointPath, 7);
+    CHECK(interrupted->fit(X, y, names, "target"));
+
+    auto resumed = make(fullLength);
+    resumed->resumeFromCheckpoint(checkpointPath);
+    CHECK(resumed->fit(X, y, names, "target"));
+    std::remove(checkpointPath.c_str());
+
+    const std::string what = resumed->getName();
+    CHECK_MSG(!samePredictions(*interrupted, *uninterrupted, X), what + ": the short fit should differ");
+    CHECK_MSG(samePredictions(*resumed, *uninterrupted, X), what + ": resumed fit differs");
+}
+
+} // namespace
+
+int main() {
+    const int rows = 500;
+    std::mt19937 generator(11);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 3);
+    Eigen::VectorXd y(rows);
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = normal(generator);
+        y(i) = X(i, 0) * X(i, 1) + std::sin(X(i, 2)) + 0.1 * normal(generator);
+    }
+
+    checkResume(X, y, [](int length) {
+        auto model = std::make_unique<GradientBoosting>(0.1, length, 3, 2, 1, 0.7, "squared_error");
+        model->setRandomSeed(5);
+        return model;
+    }, 20, 50);
+
+    checkResume(X, y, [](int length) {
+        auto model = std::make_unique<XGBoost>(0.1, 4, length, 0.7, 0.7, 1, 0.0);
+        model->setRandomSeed(5);
+        return model;
+    }, 20, 50);
+
+    checkResume(X, y, [](int length) {
+        auto model = std::make_unique<NeuralNetwork>(std::vector<int>{16, 8}, "tanh", 0.01, length, 32, "adam", 0.0);
+        model->setRandomSeed(5);
+        return model;
+    }, 15, 40);
+
+    // The binned fits draw their samples from the seeded member generator
+    BinnedMatrix binned = BinnedMatrix::fromMatrix(X, BinnedMatrix::computeCuts(X));
+    GradientBoosting boosting(0.1, 30, 3, 2, 1, 0.7, "squared_error");
+    GradientBoosting boostingAgain(0.1, 30, 3, 2, 1, 0.7, "squared_error");
+    boosting.setRandomSeed(3);
+    boostingAgain.setRandomSeed(3);
+    CHECK(boosting.fitBinned(binned, y) && boostingAgain.fitBinned(binned, y));
+    CHECK_MSG(samePredictions(boosting, boostingAgain, X), "Gradient Boosting: seeded binned fits differ");
+
+    XGBoost xgboost(0.1, 4, 30, 0.7, 0.7, 1, 0.0);
+    XGBoost xgboostAgain(0.1, 4, 30, 0.7, 0.7, 1, 0.0);
+    xgboost.setRandomSeed(3);
+    xgboostAgain.setRandomSeed(3);
+    CHECK(xgboost.fitBinned(binned, y) && xgboostAgain.fitBinned(binned, y));
+    CHECK_MSG(samePredictions(xgboost, xgboostAgain, X), "XGBoost: seeded binned fits differ");
+
+    return Check::exitCode();
+}
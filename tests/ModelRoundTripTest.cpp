@@ -0,0 +1,186 @@
+#include "Check.h"
+#include "data/DataFrame.h"
+#include "models/ElasticNet.h"
+#include "models/GradientBoosting.h"
+#include "models/LinearRegression.h"
+#include "models/NeuralNetwork.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Checks that every model predicts the same after save and load
+ *
+ * Each of the six models is fitted, saved and loaded back, and the loaded
+ * model must give bit-identical predictions through predict and predictOne,
+ * with the same names and category labels. The tree ensembles are fitted
+ * with a categorical feature and missing values; the loaded ensembles are
+ * saved once more from their mapped arrays and must still agree.
+ *
+ * Before saving, every prediction path of the fitted model is checked as
+ * well. predict on all cores (predictInBlocks) and on the calling thread
+ * must agree bit for bit, and so must predictChunked on a data frame with
+ * several thread counts. predictChunked on differently sized blocks, and
+ * predictOne row by row, must match predict up to rounding.
+ */
+
+namespace {
+
+const std::string path = "ModelRoundTripTest.mbm";
+
+void checkSameModel(const Model& model, const Model& loaded, const Eigen::MatrixXd& X, const std::string& what) {
+    CHECK_MSG(loaded.getName() == model.getName(), what);
+    CHECK_MSG(loaded.getVariableNames() == model.getVariableNames(), what);
+    CHECK_MSG(loaded.getTargetName() == model.getTargetName(), what);
+    CHECK_MSG(loaded.getCategoryLevels() == model.getCategoryLevels(), what);
+
+    Eigen::VectorXd expected = model.predict(X);
+    Eigen::VectorXd actual = loaded.predict(X);
+    // NaN never compares equal, so missing predictions are matched separately
+    bool same = expected.size() == actual.size();
+    for (Eigen::Index i = 0; same && i < expected.size(); ++i) {
+        same = expected(i) == actual(i) || (std::isnan(expected(i)) && std::isnan(actual(i)));
+    }
+    CHECK_MSG(same, what + ": predict");
+
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> rows = X;
+    bool sameRows = true;
+    for (Eigen::Index i = 0; sameRows && i < rows.rows(); ++i) {
+        sameRows = model.predictOne(rows.row(i).data()) == loaded.predictOne(rows.row(i).data());
+    }
+    CHECK_MSG(sameRows, what + ": predictOne");
+}
+
+// Largest difference relative to the size of the predictions
+double relativeDifference(const Eigen::VectorXd& a, const Eigen::VectorXd& b) {
+    return (a - b).cwiseAbs().maxCoeff() / std::max(1.0, b.cwiseAbs().maxCoeff());
+}
+
+void checkPredictionPaths(const Model& model, const Eigen::MatrixXd& X, const std::vector<std::string>& names) {
+    const std::string what = model.getName();
+    const double rounding = 1e-12;
+    Eigen::VectorXd expected = model.predict(X);
+    Eigen::VectorXd serial;
+    {
+        ParallelPredict::SerialScope scope;
+        serial = model.predict(X);
+    }
+    CHECK_MSG((serial.array() == expected.array()).all(), what + ": predict on one thread");
+
+    DataFrame data;
+    for (Eigen::Index j = 0; j < X.cols(); ++j) {
+        data.addColumn(names[j], std::vector<double>(X.col(j).data(), X.col(j).data() + X.rows()));
+    }
+    Eigen::VectorXd oneThread(X.rows());
+    ParallelPredict::Options options;
+    options.threads = 1;
+    options.blockRows = 64;
+    model.predictChunked(data, oneThread, options);
+    CHECK_MSG(relativeDifference(oneThread, expected) <= rounding, what + ": predictChunked on a data frame");
+    for (int threads : {2, 3, 8}) {
+        Eigen::VectorXd chunked(X.rows());
+        options.threads = threads;
+        model.predictChunked(data, chunked, options);
+        CHECK_MSG((chunked.array() == oneThread.array()).all(),
+                  what + ": predictChunked with " + std::to_string(threads) + " threads");
+    }
+
+    Eigen::VectorXd streamed(X.rows());
+    auto source = [&X](Eigen::Index first, Eigen::Ref<Eigen::MatrixXd> block) {
+        block = X.middleRows(first, block.rows());
+    };
+    model.predictChunked(X.rows(), source, streamed, 100);
+    CHECK_MSG(relativeDifference(streamed, expected) <= rounding, what + ": predictChunked from a source");
+
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> rows = X;
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> floatRows = X.cast<float>();
+    Eigen::VectorXd single(X.rows());
+    Eigen::VectorXd singleFloat(X.rows());
+    for (Eigen::Index i = 0; i < X.rows(); ++i) {
+        single(i) = model.predictOne(rows.row(i).data());
+        singleFloat(i) = model.predictOne(floatRows.row(i).data());
+    }
+    CHECK_MSG(relativeDifference(single, expected) <= rounding, what + ": predictOne");
+    // Float rows differ by the rounding of the inputs only
+    CHECK_MSG(relativeDifference(singleFloat, model.predict(X.cast<float>().cast<double>())) <= rounding,
+              what + ": predictOne on float rows");
+}
+
+void roundTrip(Model& model, const Eigen::MatrixXd& X, const Eigen::VectorXd& y,
+               const std::vector<std::string>& names) {
+    const std::string what = model.getName();
+    if (!model.fit(X, y, names, "target")) {
+        CHECK_MSG(false, what + ": fit");
+        return;
+    }
+    checkPredictionPaths(model, X, names);
+    model.save(path);
+    std::shared_ptr<Model> loaded = Model::load(path);
+    checkSameModel(model, *loaded, X, what);
+
+    if (model.getTreeCount() > 0) {
+        loaded->save(path);
+        std::shared_ptr<Model> again = Model::load(path);
+        checkSameModel(model, *again, X, what + " saved from a loaded model");
+    }
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    const int rows = 600;
+    std::mt19937 generator(3);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 4);
+    Eigen::VectorXd y(rows);
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = normal(generator);
+        X(i, 3) = static_cast<double>(generator() % 3);
+        y(i) = 2.0 * X(i, 0) - X(i, 1) + 0.5 * X(i, 3) + 0.1 * normal(generator);
+    }
+    const std::vector<std::string> names = {"a", "b", "c", "colour"};
+    const std::unordered_map<std::string, std::vector<std::string>> levels = {{"colour", {"red", "green", "blue"}}};
+
+    Eigen::MatrixXd Xmissing = X;
+    for (int i = 0; i < rows; i += 7) {
+        Xmissing(i, 1) = std::nan("");
+    }
+
+    LinearRegression linear;
+    roundTrip(linear, X, y, names);
+
+    // The coordinate descent update assumes columns of about unit norm
+    ElasticNet elasticNet(0.5, 0.01, 1000, 1e-4);
+    roundTrip(elasticNet, X / std::sqrt(static_cast<double>(rows)), y, names);
+
+    RandomForest forest(20, 6, 2, 1, "all", true);
+    forest.setCategoricalFeatures({3});
+    forest.setCategoryLevels(levels);
+    roundTrip(forest, Xmissing, y, names);
+
+    GradientBoosting boosting(0.1, 30, 3, 2, 1, 1.0, "squared_error");
+    boosting.setCategoricalFeatures({3});
+    boosting.setCategoryLevels(levels);
+    roundTrip(boosting, Xmissing, y, names);
+
+    XGBoost xgboost;
+    xgboost.setNEstimators(30);
+    xgboost.setCategoricalFeatures({3});
+    xgboost.setCategoryLevels(levels);
+    roundTrip(xgboost, Xmissing, y, names);
+
+    NeuralNetwork network({8, 4}, "tanh", 0.01, 20, 32, "adam", 0.0);
+    network.setRandomSeed(1);
+    roundTrip(network, X, y, names);
+
+    return Check::exitCode();
+}
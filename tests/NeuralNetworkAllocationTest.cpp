@@ -0,0 +1,105 @@
+#include "Check.h"
+#include "models/NeuralNetwork.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+/**
+ * @brief Checks that a NeuralNetwork training step does not allocate
+ *
+ * Every operator new in the process is counted. Two fits on the same rows
+ * differ only in the batch size, one taking 256 steps per epoch and the
+ * other 8, so everything a fit allocates once or once per epoch is the
+ * same for both. Equal counts mean the steps themselves allocate nothing
+ * once the workspaces exist, for each solver, precision and the
+ * data-parallel loop. predictOne must not allocate even on its first call,
+ * and must return NaN for a network too wide for its stack buffer.
+ */
+
+namespace {
+
+std::atomic<long> allocations(0);
+
+long countFitAllocations(const Eigen::MatrixXd& X, const Eigen::VectorXd& y, int batchSize,
+                         const std::string& solver, const std::string& precision, int dataParallelThreads) {
+    // tol 0 runs every epoch, so both fits see the same number of epochs
+    NeuralNetwork network({16, 8}, Activation::RELU, Activation::LINEAR, 0.01, 5, batchSize, 0.0);
+    network.setSolver(solver);
+    network.setPrecision(precision);
+    network.setRandomSeed(7);
+    if (dataParallelThreads > 1) {
+        network.setDataParallelThreads(dataParallelThreads);
+    }
+
+    long before = allocations;
+    bool fitted = network.fit(X, y);
+    long count = allocations - before;
+    CHECK_MSG(fitted, solver + " " + precision);
+    return count;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main() {
+    const int rows = 4096;
+    std::mt19937 generator(1);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 5);
+    Eigen::VectorXd y(rows);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < X.cols(); ++j) {
+            X(i, j) = normal(generator);
+        }
+        y(i) = X(i, 0) - X(i, 1) * X(i, 2) + 0.1 * normal(generator);
+    }
+
+    for (const std::string solver : {"sgd", "adam"}) {
+        for (const std::string precision : {"float64", "float32"}) {
+            for (int threads : {1, 2}) {
+                long manySteps = countFitAllocations(X, y, 16, solver, precision, threads);
+                long fewSteps = countFitAllocations(X, y, 512, solver, precision, threads);
+                CHECK_MSG(manySteps == fewSteps,
+                          solver + " " + precision + " threads=" + std::to_string(threads) + ": " +
+                              std::to_string(manySteps) + " allocations with 1280 steps, " +
+                              std::to_string(fewSteps) + " with 40");
+            }
+        }
+    }
+    NeuralNetwork network({32, 16}, Activation::RELU, Activation::LINEAR, 0.01, 2, 64, 0.0);
+    network.setRandomSeed(7);
+    CHECK(network.fit(X, y));
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> rowsX = X.topRows(100);
+    long before = allocations;
+    double sum = 0.0;
+    for (Eigen::Index i = 0; i < rowsX.rows(); ++i) {
+        sum += network.predictOne(rowsX.row(i).data());
+    }
+    long rowAllocations = allocations - before;
+    CHECK_MSG(rowAllocations == 0, std::to_string(rowAllocations) + " allocations in predictOne");
+    CHECK(std::isfinite(sum));
+
+    NeuralNetwork wide({NeuralNetwork::MAX_ROW_VALUES / 2}, Activation::RELU, Activation::LINEAR, 0.01, 1, 64, 0.0);
+    CHECK(wide.fit(X.topRows(64), y.head(64)));
+    CHECK(std::isnan(wide.predictOne(rowsX.row(0).data())));
+
+    return Check::exitCode();
+}
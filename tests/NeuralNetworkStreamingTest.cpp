@@ -0,0 +1,116 @@
+#include "Check.h"
+#include "models/NeuralNetwork.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks that training from a streamed CSV file converges like fit
+ *
+ * The same rows are fitted in memory and streamed from a CSV file in chunks
+ * smaller than the file, for each solver that supports streaming and in
+ * float32. Both runs must learn the target well, and the streamed run must
+ * reach about the same held-out RMSE and final training loss as fit. When
+ * one chunk holds the whole file, the streamed run must equal fit up to the
+ * rounding of the standardization.
+ */
+
+namespace {
+
+const std::string csvPath = "NeuralNetworkStreamingTest.csv";
+
+double rmse(const Eigen::VectorXd& predicted, const Eigen::VectorXd& actual) {
+    return std::sqrt((predicted - actual).squaredNorm() / actual.size());
+}
+
+void checkStreaming(const std::string& solver, const std::string& precision, const Eigen::MatrixXd& X,
+                    const Eigen::VectorXd& y, const Eigen::MatrixXd& testX, const Eigen::VectorXd& testY) {
+    const std::vector<std::string> names = {"a", "b", "c"};
+    const std::string what = solver + " " + precision;
+    double learningRate = solver == "sgd" ? 0.05 : 0.005;
+
+    // A zero tolerance runs every epoch, so both fits see the same number
+    auto makeNetwork = [&]() {
+        auto network = std::make_unique<NeuralNetwork>(std::vector<int>{32, 16}, Activation::TANH,
+                                                       Activation::LINEAR, learningRate, 40, 32, 0.0);
+        network->setSolver(solver);
+        network->setRandomSeed(4);
+        network->setPrecision(precision);
+        return network;
+    };
+    auto inMemory = makeNetwork();
+    CHECK_MSG(inMemory->fit(X, y, names, "y"), what);
+
+    // Rows are shuffled within chunks of 700 of the 3000 rows only
+    auto streamed = makeNetwork();
+    CHECK_MSG(streamed->fitFromCSV(csvPath, names, "y", 700), what);
+    CHECK_MSG(streamed->getVariableNames() == names && streamed->getTargetName() == "y", what);
+    CHECK_MSG(streamed->getStatistics().at("n_iterations") == 40.0, what + ": epochs");
+
+    // Predicting the mean gives an RMSE of about the target's spread
+    double baseline = std::sqrt((testY.array() - testY.mean()).square().mean());
+    double inMemoryRmse = rmse(inMemory->predict(testX), testY);
+    double streamedRmse = rmse(streamed->predict(testX), testY);
+    CHECK_MSG(inMemoryRmse < 0.3 * baseline, what + ": fit RMSE " + std::to_string(inMemoryRmse));
+    CHECK_MSG(streamedRmse <= 1.2 * inMemoryRmse, what + ": streamed RMSE " + std::to_string(streamedRmse) +
+                                                      ", in memory " + std::to_string(inMemoryRmse));
+
+    const std::vector<double>& inMemoryLoss = inMemory->getTrainingLossHistory();
+    const std::vector<double>& streamedLoss = streamed->getTrainingLossHistory();
+    CHECK_MSG(!streamedLoss.empty() && streamedLoss.back() < 0.5 * streamedLoss.front(), what + ": loss");
+    CHECK_MSG(streamedLoss.back() <= 1.5 * inMemoryLoss.back(),
+              what + ": final loss " + std::to_string(streamedLoss.back()) + ", fit " +
+                  std::to_string(inMemoryLoss.back()));
+
+    // One chunk shuffles the whole file like fit shuffles its rows; the
+    // means and deviations are only summed in another order
+    auto oneChunk = makeNetwork();
+    CHECK_MSG(oneChunk->fitFromCSV(csvPath, names, "y", 100000), what);
+    double difference = (oneChunk->predict(testX) - inMemory->predict(testX)).cwiseAbs().maxCoeff();
+    CHECK_MSG(difference <= 1e-9, what + ": one chunk differs by " + std::to_string(difference));
+}
+
+} // namespace
+
+int main() {
+    const int rows = 3000;
+    std::mt19937 generator(8);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    auto target = [&](double a, double b, double c) {
+        return 3.0 + 2.0 * std::sin(a) + a * b - 0.5 * c + 0.1 * normal(generator);
+    };
+
+    Eigen::MatrixXd X(rows, 3);
+    Eigen::VectorXd y(rows);
+    std::ofstream out(csvPath);
+    out.precision(17);
+    out << "a,b,c,y\n";
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = 5.0 + 2.0 * normal(generator);
+        y(i) = target(X(i, 0), X(i, 1), X(i, 2));
+        out << X(i, 0) << "," << X(i, 1) << "," << X(i, 2) << "," << y(i) << "\n";
+    }
+    out.close();
+
+    Eigen::MatrixXd testX(1000, 3);
+    Eigen::VectorXd testY(1000);
+    for (Eigen::Index i = 0; i < testX.rows(); ++i) {
+        testX(i, 0) = normal(generator);
+        testX(i, 1) = normal(generator);
+        testX(i, 2) = 5.0 + 2.0 * normal(generator);
+        testY(i) = target(testX(i, 0), testX(i, 1), testX(i, 2));
+    }
+
+    checkStreaming("adam", "float64", X, y, testX, testY);
+    checkStreaming("sgd", "float64", X, y, testX, testY);
+    checkStreaming("adam", "float32", X, y, testX, testY);
+
+    std::remove(csvPath.c_str());
+    return Check::exitCode();
+}
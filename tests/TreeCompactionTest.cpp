@@ -0,0 +1,125 @@
+#include "Check.h"
+#include "models/GradientBoosting.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief Checks the compaction of the three tree ensembles
+ *
+ * With a tolerance, every prediction on the calibration rows must stay
+ * within it, as the report claims. Without one, compaction may only remove
+ * what cannot change a prediction: the predictions are bit-identical, also
+ * for rows with missing values and unseen categories, and every split left
+ * has a twin with the same threshold or categories and the same default
+ * direction in the uncompacted model.
+ */
+
+namespace {
+
+using SplitKey = std::tuple<int, bool, double, std::vector<uint64_t>, bool>;
+
+// Feature, threshold or categories and default direction of every split
+std::vector<SplitKey> splitsOf(const Model& model) {
+    std::vector<SplitKey> splits;
+    for (size_t t = 0; t < model.getTreeCount(); ++t) {
+        for (const auto& node : model.inspectTree(t)) {
+            if (!node.isLeaf) {
+                splits.emplace_back(node.featureIndex, node.isCategorical, node.splitValue, node.categoryBitset,
+                                    node.defaultLeft);
+            }
+        }
+    }
+    std::sort(splits.begin(), splits.end());
+    return splits;
+}
+
+double maxChange(const Eigen::VectorXd& a, const Eigen::VectorXd& b) {
+    return (a - b).cwiseAbs().maxCoeff();
+}
+
+template <typename TreeModel>
+void checkCompaction(TreeModel& withTolerance, TreeModel& lossless, const Eigen::MatrixXd& X,
+                     const Eigen::VectorXd& y, const Eigen::MatrixXd& probeX) {
+    const std::vector<std::string> names = {"a", "b", "c", "colour"};
+    const double tolerance = 0.05;
+    const double leafEpsilon = 1e-6;
+
+    CHECK(withTolerance.fit(X, y, names, "target"));
+    Eigen::VectorXd before = withTolerance.predict(X);
+    size_t treesBefore = withTolerance.getTreeCount();
+    auto report = withTolerance.compact(X, leafEpsilon, tolerance);
+    const std::string what = withTolerance.getName();
+    // Merged leaves may add up to leafEpsilon per tree on top of the tolerance
+    double bound = tolerance + leafEpsilon * static_cast<double>(treesBefore);
+    CHECK_MSG(maxChange(withTolerance.predict(X), before) <= bound, what);
+    CHECK_MSG(report.at("max_prediction_change") <= bound, what);
+
+    CHECK(lossless.fit(X, y, names, "target"));
+    Eigen::VectorXd probeBefore = lossless.predict(probeX);
+    std::vector<SplitKey> splitsBefore = splitsOf(lossless);
+    lossless.compact(X, 0.0, 0.0);
+    CHECK_MSG((lossless.predict(probeX).array() == probeBefore.array()).all(), what + ": lossless compaction");
+    std::vector<SplitKey> splitsAfter = splitsOf(lossless);
+    bool categorical = std::any_of(splitsAfter.begin(), splitsAfter.end(),
+                                   [](const SplitKey& split) { return std::get<1>(split); });
+    CHECK_MSG(categorical, what + ": no categorical splits left");
+    CHECK_MSG(std::includes(splitsBefore.begin(), splitsBefore.end(), splitsAfter.begin(), splitsAfter.end()),
+              what + ": a split changed");
+}
+
+} // namespace
+
+int main() {
+    const int rows = 1000;
+    std::mt19937 generator(5);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 4);
+    Eigen::VectorXd y(rows);
+    const double colourEffect[] = {-1.0, 2.0, 0.5, -2.5};
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = normal(generator);
+        X(i, 3) = static_cast<double>(generator() % 4);
+        y(i) = X(i, 0) + colourEffect[static_cast<int>(X(i, 3))] + 0.1 * normal(generator);
+        // Rows with a missing value have a target of their own, so the
+        // default directions the splits learn matter
+        if (i % 5 == 0) {
+            X(i, 0) = std::nan("");
+            y(i) += 4.0;
+        }
+    }
+
+    // Rows with every feature missing, and categories never seen in training
+    Eigen::MatrixXd probeX(rows + 3, 4);
+    probeX.topRows(rows) = X;
+    probeX.row(rows).setConstant(std::nan(""));
+    probeX.row(rows + 1) << 0.5, std::nan(""), 0.0, 7.0;
+    probeX.row(rows + 2) << std::nan(""), 1.0, -1.0, std::nan("");
+
+    RandomForest forest(30, 8, 2, 1, "all", true);
+    RandomForest losslessForest(30, 8, 2, 1, "all", true);
+    forest.setCategoricalFeatures({3});
+    losslessForest.setCategoricalFeatures({3});
+    checkCompaction(forest, losslessForest, X, y, probeX);
+
+    GradientBoosting boosting(0.1, 60, 4, 2, 1, 1.0, "squared_error");
+    GradientBoosting losslessBoosting(0.1, 60, 4, 2, 1, 1.0, "squared_error");
+    boosting.setCategoricalFeatures({3});
+    losslessBoosting.setCategoricalFeatures({3});
+    checkCompaction(boosting, losslessBoosting, X, y, probeX);
+
+    XGBoost xgboost(0.1, 5, 60, 1.0, 1.0, 1, 0.0);
+    XGBoost losslessXgboost(0.1, 5, 60, 1.0, 1.0, 1, 0.0);
+    xgboost.setCategoricalFeatures({3});
+    losslessXgboost.setCategoricalFeatures({3});
+    checkCompaction(xgboost, losslessXgboost, X, y, probeX);
+
+    return Check::exitCode();
+}
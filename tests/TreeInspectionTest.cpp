@@ -0,0 +1,146 @@
+#include "Check.h"
+#include "models/GradientBoosting.h"
+#include "models/RandomForest.h"
+#include "models/XGBoost.h"
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks that paging a tree by node id returns the nodes of a full dump
+ *
+ * For every node of the first trees and several depth limits, the subtree
+ * fetched by the node's id must be the slice of the full dump below that
+ * node, in the same preorder and with the same fields; only nodes on the
+ * depth limit are marked as not expanded. A viewer that starts from the top
+ * levels and fetches every collapsed node in turn must end up with the full
+ * dump. The trees of a loaded model, read from the mapped file, must page
+ * alike.
+ */
+
+namespace {
+
+const std::string path = "TreeInspectionTest.mbm";
+
+bool sameNode(const TreeInspection::NodeInfo& a, const TreeInspection::NodeInfo& b) {
+    return a.id == b.id && a.parentId == b.parentId && a.depth == b.depth && a.isLeaf == b.isLeaf &&
+           a.featureIndex == b.featureIndex && a.splitValue == b.splitValue && a.isCategorical == b.isCategorical &&
+           a.categoryBitset == b.categoryBitset && a.defaultLeft == b.defaultLeft && a.value == b.value &&
+           a.cover == b.cover && a.gain == b.gain && a.leftId == b.leftId && a.rightId == b.rightId &&
+           a.subtreeSize == b.subtreeSize;
+}
+
+void checkPaging(const Model& model, size_t tree, const std::string& what) {
+    std::vector<TreeInspection::NodeInfo> full = model.inspectTree(tree);
+    CHECK_MSG(!full.empty() && full.front().subtreeSize == static_cast<int>(full.size()), what);
+
+    bool slicesMatch = true;
+    for (const auto& root : full) {
+        for (int maxDepth : {-1, 0, 1, 2}) {
+            std::vector<TreeInspection::NodeInfo> page = model.inspectTree(tree, root.id, maxDepth);
+            // The preorder ids of a subtree are contiguous, starting at its root
+            std::vector<TreeInspection::NodeInfo> expected;
+            for (int id = root.id; id < root.id + root.subtreeSize; ++id) {
+                TreeInspection::NodeInfo node = full[static_cast<size_t>(id)];
+                int lastDepth = root.depth + maxDepth;
+                if (maxDepth >= 0 && node.depth > lastDepth) {
+                    continue;
+                }
+                node.expanded = node.isLeaf || maxDepth < 0 || node.depth < lastDepth;
+                expected.push_back(node);
+            }
+            bool same = page.size() == expected.size();
+            for (size_t i = 0; same && i < page.size(); ++i) {
+                same = sameNode(page[i], expected[i]) && page[i].expanded == expected[i].expanded;
+            }
+            slicesMatch = slicesMatch && same;
+        }
+    }
+    CHECK_MSG(slicesMatch, what + ": a subtree page differs from the full dump");
+
+    // Expand collapsed nodes one page at a time, as a viewer would
+    std::map<int, TreeInspection::NodeInfo> assembled;
+    std::vector<int> pending = {0};
+    while (!pending.empty()) {
+        int id = pending.back();
+        pending.pop_back();
+        for (const auto& node : model.inspectTree(tree, id, 2)) {
+            assembled[node.id] = node;
+            if (!node.expanded) {
+                pending.push_back(node.id);
+            }
+        }
+    }
+    bool complete = assembled.size() == full.size();
+    for (const auto& node : full) {
+        complete = complete && assembled.count(node.id) == 1 && sameNode(assembled.at(node.id), node);
+    }
+    CHECK_MSG(complete, what + ": expanding every collapsed node does not give the full tree");
+
+    bool threw = false;
+    try {
+        model.inspectTree(tree, static_cast<int>(full.size()));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    CHECK_MSG(threw, what + ": node id past the end");
+}
+
+void checkModel(Model& model, const Eigen::MatrixXd& X, const Eigen::VectorXd& y) {
+    const std::string what = model.getName();
+    CHECK(model.fit(X, y, {"a", "b", "c", "colour"}, "target"));
+    CHECK_MSG(model.getTreeCount() >= 3, what);
+    for (size_t tree = 0; tree < 3; ++tree) {
+        checkPaging(model, tree, what + " tree " + std::to_string(tree));
+    }
+
+    model.save(path);
+    std::shared_ptr<Model> loaded = Model::load(path);
+    std::remove(path.c_str());
+    checkPaging(*loaded, 0, what + " loaded");
+    std::vector<TreeInspection::NodeInfo> before = model.inspectTree(1);
+    std::vector<TreeInspection::NodeInfo> after = loaded->inspectTree(1);
+    bool same = before.size() == after.size();
+    for (size_t i = 0; same && i < before.size(); ++i) {
+        same = sameNode(before[i], after[i]);
+    }
+    CHECK_MSG(same, what + ": loaded tree differs");
+}
+
+} // namespace
+
+int main() {
+    const int rows = 800;
+    std::mt19937 generator(9);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 4);
+    Eigen::VectorXd y(rows);
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = normal(generator);
+        X(i, 3) = static_cast<double>(generator() % 4);
+        y(i) = X(i, 0) * X(i, 1) + X(i, 2) + (X(i, 3) == 2.0 ? 1.5 : 0.0) + 0.1 * normal(generator);
+        if (i % 6 == 0) {
+            X(i, 1) = std::nan("");
+        }
+    }
+
+    RandomForest forest(5, 8, 2, 1, "all", true);
+    forest.setCategoricalFeatures({3});
+    checkModel(forest, X, y);
+
+    GradientBoosting boosting(0.1, 5, 5, 2, 1, 1.0, "squared_error");
+    boosting.setCategoricalFeatures({3});
+    checkModel(boosting, X, y);
+
+    XGBoost xgboost(0.3, 6, 5, 1.0, 1.0, 1, 0.0);
+    xgboost.setCategoricalFeatures({3});
+    checkModel(xgboost, X, y);
+
+    return Check::exitCode();
+}
@@ -0,0 +1,92 @@
+#include "Check.h"
+#include "data/BinnedMatrix.h"
+#include "models/XGBoost.h"
+#include "utils/SocketChannel.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks that distributed XGBoost training agrees with one worker
+ *
+ * Without row or column sampling, every worker count sums the same
+ * histograms, so fits with one and with three worker processes, fit() with
+ * three workers and fitBinned on the same cuts must predict alike up to the
+ * order of the sums. Sample weights take the same route. A listener with no
+ * pending connection must time out rather than block, which is what lets the
+ * coordinator notice a worker that died before connecting.
+ */
+
+namespace {
+
+double maxDifference(const Model& a, const Model& b, const Eigen::MatrixXd& X) {
+    return (a.predict(X) - b.predict(X)).cwiseAbs().maxCoeff();
+}
+
+void checkClose(const Model& a, const Model& b, const Eigen::MatrixXd& X, const std::string& what) {
+    double difference = maxDifference(a, b, X);
+    CHECK_MSG(difference <= 1e-8, what + " differs by " + std::to_string(difference));
+}
+
+} // namespace
+
+int main() {
+    const int rows = 1200;
+    std::mt19937 generator(13);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::MatrixXd X(rows, 3);
+    Eigen::VectorXd y(rows);
+    Eigen::VectorXd weights(rows);
+    for (int i = 0; i < rows; ++i) {
+        X(i, 0) = normal(generator);
+        X(i, 1) = normal(generator);
+        X(i, 2) = normal(generator);
+        y(i) = X(i, 0) * X(i, 1) + std::sin(X(i, 2)) + 0.1 * normal(generator);
+        weights(i) = 0.5 + (i % 3);
+    }
+    const std::vector<std::string> names = {"a", "b", "c"};
+
+    XGBoost one(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    XGBoost three(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    CHECK(one.fitDistributed(X, y, 1, names, "y"));
+    CHECK(three.fitDistributed(X, y, 3, names, "y"));
+    CHECK(one.getTreeCount() == 30 && three.getTreeCount() == 30);
+    CHECK(three.getVariableNames() == names && three.getTargetName() == "y");
+    checkClose(one, three, X, "three workers");
+
+    // The model must have learned the target, not just agree with itself
+    double baseline = std::sqrt((y.array() - y.mean()).square().mean());
+    double rmse = std::sqrt((three.predict(X) - y).squaredNorm() / rows);
+    CHECK_MSG(rmse < 0.5 * baseline, "RMSE " + std::to_string(rmse));
+
+    XGBoost viaFit(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    viaFit.setNumWorkers(3);
+    CHECK(viaFit.fit(X, y, names, "y"));
+    checkClose(one, viaFit, X, "fit with three workers");
+
+    XGBoost binned(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    CHECK(binned.fitBinned(BinnedMatrix::fromMatrix(X, BinnedMatrix::computeCuts(X)), y));
+    checkClose(one, binned, X, "fitBinned");
+
+    XGBoost weightedOne(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    XGBoost weightedThree(0.2, 4, 30, 1.0, 1.0, 1, 0.0);
+    CHECK(weightedOne.fitDistributed(X, y, 1, names, "y", weights));
+    CHECK(weightedThree.fitDistributed(X, y, 3, names, "y", weights));
+    checkClose(weightedOne, weightedThree, X, "weighted three workers");
+    CHECK_MSG(maxDifference(one, weightedOne, X) > 1e-6, "weights are ignored");
+
+    CHECK(!one.fitDistributed(X, y, 0));
+
+    auto start = std::chrono::steady_clock::now();
+    SocketListener listener;
+    CHECK(!listener.waitForConnection(50));
+    double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK_MSG(waited < 5.0, "waiting took " + std::to_string(waited) + " s");
+    SocketChannel client = SocketChannel::connectTo(listener.getPort());
+    CHECK(listener.waitForConnection(1000));
+    CHECK(listener.accept().isOpen());
+
+    return Check::exitCode();
+}